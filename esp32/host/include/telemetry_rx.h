@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetry_frame.h"
+#include "ws_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MULTICAST TELEMETRY RECEIVER
+    // ============================================================================
+    // Joins the devices' telemetry group (telemetry_frame.h) and turns the
+    // datagrams back into one ordered message stream per device. Datagrams
+    // that arrive ahead of a missing one are held for a short reorder window;
+    // when the window runs out the missing seqs are reported as a gap and the
+    // stream moves on. A new stream_id from a device means it restarted.
+
+    typedef struct TelemetryRx TelemetryRx;
+
+    typedef struct
+    {
+        void* ctx;
+        /** Messages in seq order per device */
+        void (*on_message)(void* ctx, uint8_t device_id, uint32_t seq, const WsMessage* msg);
+        /** count datagrams starting at first_seq will never arrive (may be NULL) */
+        void (*on_gap)(void* ctx, uint8_t device_id, uint32_t first_seq, uint32_t count);
+        /** The device started a new stream, e.g. after a reboot (may be NULL) */
+        void (*on_restart)(void* ctx, uint8_t device_id, uint32_t stream_id);
+        uint16_t reorder_window; // datagrams held per device while waiting for a missing one, 0 = 32
+        uint16_t reorder_ms;     // how long a missing datagram is waited for, 0 = 100
+    } TelemetryRxConfig;
+
+    typedef struct
+    {
+        uint8_t device_id;
+        uint32_t stream_id;
+        uint32_t next_seq;   // next seq expected in order
+        uint32_t delivered;  // messages passed to on_message
+        uint32_t lost;       // seqs reported through on_gap
+        uint32_t duplicates; // repeats and datagrams that arrived after their gap was reported
+        uint32_t reordered;  // arrived ahead of a missing one and were held
+        uint32_t restarts;   // stream_id changes
+        uint32_t held;       // waiting in the reorder buffer right now
+    } TelemetryStreamStats;
+
+    /**
+     * @brief Create a receiver (no socket yet; see telemetry_rx_join)
+     * @return NULL on allocation failure
+     */
+    TelemetryRx* telemetry_rx_create(const TelemetryRxConfig* config);
+
+    void telemetry_rx_destroy(TelemetryRx* rx);
+
+    /**
+     * @brief Open a UDP socket on port and join the multicast group
+     * @param group Group address, NULL = TELEMETRY_MCAST_GROUP
+     * @param port UDP port, 0 = TELEMETRY_MCAST_PORT
+     * @param iface_addr IPv4 address of the interface to join on, NULL = any
+     */
+    bool telemetry_rx_join(TelemetryRx* rx, const char* group, uint16_t port, const char* iface_addr);
+
+    /**
+     * @brief Receive and deliver datagrams for up to timeout_ms
+     *
+     * Returns after the first batch of datagrams (or the timeout) and then
+     * expires overdue gaps, so call it in a loop.
+     * @return Messages delivered, or -1 if the socket failed
+     */
+    int telemetry_rx_poll(TelemetryRx* rx, int timeout_ms);
+
+    /**
+     * @brief Process one datagram received some other way (tests, capture replay)
+     * @param now_ms Monotonic arrival time in milliseconds
+     * @return false if the datagram is not a valid telemetry datagram
+     */
+    bool telemetry_rx_feed(TelemetryRx* rx, const uint8_t* data, size_t len, uint64_t now_ms);
+
+    /**
+     * @brief Give up on missing datagrams waited for longer than reorder_ms
+     */
+    void telemetry_rx_expire(TelemetryRx* rx, uint64_t now_ms);
+
+    /**
+     * @brief Snapshot per-device stream statistics, ordered by device_id
+     * @return Number of entries written to out
+     */
+    int telemetry_rx_get_stats(TelemetryRx* rx, TelemetryStreamStats* out, int max);
+
+    /**
+     * @brief Datagrams that failed to parse or decode
+     */
+    uint32_t telemetry_rx_malformed(TelemetryRx* rx);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+#include "ws_transport.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Start a WebSocket listener on the host and route it to the server core
+     *
+     * One poll() thread does accept, handshake and frame parsing; work posted
+     * by the core (send queue drains) runs on a worker thread. Only one instance can run at a time.
+     * @param port TCP port on 127.0.0.1 (0 = pick a free one)
+     * @param bound_port Receives the actual port (may be NULL)
+     * @return Transport to pass in WsCoreConfig, or NULL on failure
+     */
+    const WsTransport* ws_transport_posix_start(uint16_t port, uint16_t* bound_port);
+
+    /**
+     * @brief Close all connections and stop the threads
+     */
+    void ws_transport_posix_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+// Host port: ESP_LOGx to stderr. Build with -DRAYZ_HOST_LOG_LEVEL=4 for debug output.
+
+#include <stdio.h>
+
+#ifndef RAYZ_HOST_LOG_LEVEL
+#define RAYZ_HOST_LOG_LEVEL 2 // 1=E 2=W 3=I 4=D
+#endif
+
+#define RAYZ_HOST_LOG(level, letter, tag, fmt, ...)                                                                    \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (RAYZ_HOST_LOG_LEVEL >= level)                                                                              \
+            fprintf(stderr, letter " (%s) " fmt "\n", tag, ##__VA_ARGS__);                                             \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) RAYZ_HOST_LOG(1, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) RAYZ_HOST_LOG(2, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) RAYZ_HOST_LOG(3, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) RAYZ_HOST_LOG(4, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) RAYZ_HOST_LOG(5, "V", tag, fmt, ##__VA_ARGS__)
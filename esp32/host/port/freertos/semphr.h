@@ -0,0 +1,48 @@
+#pragma once
+
+// Host port: FreeRTOS mutexes mapped onto pthreads.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "FreeRTOS.h"
+
+typedef pthread_mutex_t* SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    SemaphoreHandle_t m = (SemaphoreHandle_t)malloc(sizeof(pthread_mutex_t));
+    if (m)
+        pthread_mutex_init(m, NULL);
+    return m;
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY)
+        return pthread_mutex_lock(m) == 0 ? pdTRUE : pdFALSE;
+    if (ticks == 0)
+        return pthread_mutex_trylock(m) == 0 ? pdTRUE : pdFALSE;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return pthread_mutex_timedlock(m, &ts) == 0 ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t m)
+{
+    return pthread_mutex_unlock(m) == 0 ? pdTRUE : pdFALSE;
+}
+
+static inline void vSemaphoreDelete(SemaphoreHandle_t m)
+{
+    pthread_mutex_destroy(m);
+    free(m);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Host port: the calling thread's name stands in for the task name. It is
+// read once per thread, so name threads before they call in here.
+
+#include <pthread.h>
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+
+static inline const char* pcTaskGetName(TaskHandle_t task)
+{
+    (void)task;
+    static thread_local char name[16];
+    static thread_local bool named = false;
+    if (!named && pthread_getname_np(pthread_self(), name, sizeof(name)) != 0)
+        name[0] = '\0';
+    named = true;
+    return name;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+// Host port: NVS as an in-memory map, with call counters for the benches and
+// a switch to make writes fail.
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_BASE           0x1100
+#define ESP_ERR_NVS_NOT_INITIALIZED (ESP_ERR_NVS_BASE + 0x01)
+#define ESP_ERR_NVS_NOT_FOUND      (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_TYPE_MISMATCH  (ESP_ERR_NVS_BASE + 0x03)
+#define ESP_ERR_NVS_INVALID_LENGTH (ESP_ERR_NVS_BASE + 0x0c)
+#define ESP_ERR_NVS_NO_FREE_PAGES  (ESP_ERR_NVS_BASE + 0x0d)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND (ESP_ERR_NVS_BASE + 0x10)
+
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum
+{
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+struct HostNvs
+{
+    std::map<std::string, std::string> values; // "ns\0key" -> type tag + bytes
+    std::map<nvs_handle_t, std::string> handles;
+    nvs_handle_t next_handle = 1;
+    uint32_t opens = 0, gets = 0, sets = 0, commits = 0;
+    bool fail_writes = false;
+};
+
+inline HostNvs g_host_nvs;
+
+static inline std::string host_nvs_key(nvs_handle_t h, const char* key)
+{
+    return g_host_nvs.handles[h] + '\0' + key;
+}
+
+static inline esp_err_t nvs_open(const char* ns, nvs_open_mode_t mode, nvs_handle_t* out)
+{
+    (void)mode;
+    g_host_nvs.opens++;
+    *out = g_host_nvs.next_handle++;
+    g_host_nvs.handles[*out] = ns;
+    return ESP_OK;
+}
+
+static inline void nvs_close(nvs_handle_t h)
+{
+    g_host_nvs.handles.erase(h);
+}
+
+static inline esp_err_t host_nvs_get(nvs_handle_t h, const char* key, char type, std::string* out)
+{
+    g_host_nvs.gets++;
+    auto it = g_host_nvs.values.find(host_nvs_key(h, key));
+    if (it == g_host_nvs.values.end())
+        return ESP_ERR_NVS_NOT_FOUND;
+    if (it->second[0] != type)
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    *out = it->second.substr(1);
+    return ESP_OK;
+}
+
+static inline esp_err_t host_nvs_set(nvs_handle_t h, const char* key, char type, const void* data, size_t len)
+{
+    if (g_host_nvs.fail_writes)
+        return ESP_FAIL;
+    g_host_nvs.sets++;
+    g_host_nvs.values[host_nvs_key(h, key)] = std::string(1, type) + std::string((const char*)data, len);
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_get_u8(nvs_handle_t h, const char* key, uint8_t* out)
+{
+    std::string v;
+    esp_err_t err = host_nvs_get(h, key, 'b', &v);
+    if (err == ESP_OK)
+        memcpy(out, v.data(), sizeof(*out));
+    return err;
+}
+
+static inline esp_err_t nvs_get_u32(nvs_handle_t h, const char* key, uint32_t* out)
+{
+    std::string v;
+    esp_err_t err = host_nvs_get(h, key, 'w', &v);
+    if (err == ESP_OK)
+        memcpy(out, v.data(), sizeof(*out));
+    return err;
+}
+
+static inline esp_err_t nvs_get_str(nvs_handle_t h, const char* key, char* out, size_t* len)
+{
+    std::string v;
+    esp_err_t err = host_nvs_get(h, key, 's', &v);
+    if (err != ESP_OK)
+        return err;
+    if (!out)
+    {
+        *len = v.size() + 1;
+        return ESP_OK;
+    }
+    if (*len < v.size() + 1)
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    memcpy(out, v.c_str(), v.size() + 1);
+    *len = v.size() + 1;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_set_u8(nvs_handle_t h, const char* key, uint8_t v)
+{
+    return host_nvs_set(h, key, 'b', &v, sizeof(v));
+}
+
+static inline esp_err_t nvs_set_u32(nvs_handle_t h, const char* key, uint32_t v)
+{
+    return host_nvs_set(h, key, 'w', &v, sizeof(v));
+}
+
+static inline esp_err_t nvs_set_str(nvs_handle_t h, const char* key, const char* v)
+{
+    return host_nvs_set(h, key, 's', v, strlen(v));
+}
+
+static inline esp_err_t nvs_commit(nvs_handle_t h)
+{
+    (void)h;
+    if (g_host_nvs.fail_writes)
+        return ESP_FAIL;
+    g_host_nvs.commits++;
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_erase_all(nvs_handle_t h)
+{
+    std::string prefix = g_host_nvs.handles[h] + '\0';
+    for (auto it = g_host_nvs.values.begin(); it != g_host_nvs.values.end();)
+    {
+        if (it->first.compare(0, prefix.size(), prefix) == 0)
+            it = g_host_nvs.values.erase(it);
+        else
+            ++it;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// Host port: the in-memory NVS needs no init.
+
+#include "nvs.h"
+
+static inline esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+static inline esp_err_t nvs_flash_erase(void)
+{
+    g_host_nvs.values.clear();
+    return ESP_OK;
+}
@@ -0,0 +1,307 @@
+#include "telemetry_rx.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <map>
+#include <new>
+#include <vector>
+#include "ws_codec.h"
+
+// Per-device reassembly of the multicast telemetry stream (see telemetry_rx.h).
+
+namespace
+{
+
+const uint16_t DEFAULT_REORDER_WINDOW = 32;
+const uint16_t DEFAULT_REORDER_MS = 100;
+
+// Orders seqs across the 32-bit wrap; held seqs are always within a window of each other
+struct SeqLess
+{
+    bool operator()(uint32_t a, uint32_t b) const
+    {
+        return (int32_t)(a - b) < 0;
+    }
+};
+
+struct Held
+{
+    std::vector<uint8_t> frame;
+    uint64_t arrived_ms;
+};
+
+struct Stream
+{
+    TelemetryStreamStats stats;
+    uint32_t prev_stream_id; // datagrams still in flight from before a restart are dropped
+    std::map<uint32_t, Held, SeqLess> pending;
+};
+
+uint64_t now_ms()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+struct TelemetryRx
+{
+    TelemetryRxConfig cfg;
+    int sock = -1;
+    std::map<uint8_t, Stream> streams;
+    uint32_t malformed = 0;
+    int delivered = 0; // since the start of the current poll
+};
+
+namespace
+{
+
+void deliver(TelemetryRx* rx, Stream& s, uint32_t seq, const uint8_t* frame, size_t len)
+{
+    s.stats.next_seq = seq + 1;
+
+    WsMessage msg;
+    if (!ws_codec_binary_decode(frame, len, &msg))
+    {
+        rx->malformed++;
+        return;
+    }
+    s.stats.delivered++;
+    rx->delivered++;
+    if (rx->cfg.on_message)
+        rx->cfg.on_message(rx->cfg.ctx, s.stats.device_id, seq, &msg);
+}
+
+// Deliver held datagrams that are now in order
+void drain(TelemetryRx* rx, Stream& s)
+{
+    while (!s.pending.empty() && s.pending.begin()->first == s.stats.next_seq)
+    {
+        auto it = s.pending.begin();
+        Held h = std::move(it->second);
+        uint32_t seq = it->first;
+        s.pending.erase(it);
+        deliver(rx, s, seq, h.frame.data(), h.frame.size());
+    }
+    s.stats.held = (uint32_t)s.pending.size();
+}
+
+// Stop waiting for the missing seqs before the oldest held datagram
+void skip_gap(TelemetryRx* rx, Stream& s)
+{
+    uint32_t first = s.pending.begin()->first;
+    uint32_t count = first - s.stats.next_seq;
+    s.stats.lost += count;
+    if (rx->cfg.on_gap)
+        rx->cfg.on_gap(rx->cfg.ctx, s.stats.device_id, s.stats.next_seq, count);
+    s.stats.next_seq = first;
+    drain(rx, s);
+}
+
+} // namespace
+
+TelemetryRx* telemetry_rx_create(const TelemetryRxConfig* config)
+{
+    TelemetryRx* rx = new (std::nothrow) TelemetryRx();
+    if (!rx)
+        return NULL;
+    if (config)
+        rx->cfg = *config;
+    if (rx->cfg.reorder_window == 0)
+        rx->cfg.reorder_window = DEFAULT_REORDER_WINDOW;
+    if (rx->cfg.reorder_ms == 0)
+        rx->cfg.reorder_ms = DEFAULT_REORDER_MS;
+    return rx;
+}
+
+void telemetry_rx_destroy(TelemetryRx* rx)
+{
+    if (!rx)
+        return;
+    if (rx->sock >= 0)
+        close(rx->sock);
+    delete rx;
+}
+
+bool telemetry_rx_join(TelemetryRx* rx, const char* group, uint16_t port, const char* iface_addr)
+{
+    if (rx->sock >= 0)
+    {
+        close(rx->sock);
+        rx->sock = -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0)
+    {
+        perror("telemetry_rx: socket");
+        return false;
+    }
+
+    // Several listeners (scoreboard, logger) may share one machine
+    int one = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+    int rcvbuf = 256 * 1024;
+    setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port ? port : TELEMETRY_MCAST_PORT);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        perror("telemetry_rx: bind");
+        close(sock);
+        return false;
+    }
+
+    ip_mreq mreq = {};
+    mreq.imr_multiaddr.s_addr = inet_addr(group ? group : TELEMETRY_MCAST_GROUP);
+    mreq.imr_interface.s_addr = iface_addr ? inet_addr(iface_addr) : htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+    {
+        perror("telemetry_rx: IP_ADD_MEMBERSHIP");
+        close(sock);
+        return false;
+    }
+
+    rx->sock = sock;
+    return true;
+}
+
+bool telemetry_rx_feed(TelemetryRx* rx, const uint8_t* data, size_t len, uint64_t now_ms)
+{
+    TelemetryHeader hdr;
+    const uint8_t* frame;
+    size_t frame_len;
+    if (!telemetry_frame_parse(data, len, &hdr, &frame, &frame_len))
+    {
+        rx->malformed++;
+        return false;
+    }
+
+    auto found = rx->streams.find(hdr.device_id);
+    if (found == rx->streams.end())
+    {
+        // Joining mid-stream is not a gap: start at whatever arrives first
+        Stream& s = rx->streams[hdr.device_id];
+        s.stats = {};
+        s.stats.device_id = hdr.device_id;
+        s.stats.stream_id = hdr.stream_id;
+        s.stats.next_seq = hdr.seq;
+        s.prev_stream_id = hdr.stream_id;
+        found = rx->streams.find(hdr.device_id);
+    }
+    Stream& s = found->second;
+
+    if (hdr.stream_id != s.stats.stream_id)
+    {
+        if (hdr.stream_id == s.prev_stream_id)
+        {
+            s.stats.duplicates++;
+            return true;
+        }
+        // Device restarted: finish the old stream, then follow the new one
+        while (!s.pending.empty())
+            skip_gap(rx, s);
+        s.prev_stream_id = s.stats.stream_id;
+        s.stats.stream_id = hdr.stream_id;
+        s.stats.next_seq = hdr.seq;
+        s.stats.restarts++;
+        if (rx->cfg.on_restart)
+            rx->cfg.on_restart(rx->cfg.ctx, hdr.device_id, hdr.stream_id);
+    }
+
+    int32_t ahead = (int32_t)(hdr.seq - s.stats.next_seq);
+    if (ahead < 0)
+    {
+        s.stats.duplicates++;
+        return true;
+    }
+    if (ahead == 0)
+    {
+        deliver(rx, s, hdr.seq, frame, frame_len);
+        drain(rx, s);
+        return true;
+    }
+
+    if (s.pending.count(hdr.seq))
+    {
+        s.stats.duplicates++;
+        return true;
+    }
+    s.pending.emplace(hdr.seq, Held{std::vector<uint8_t>(frame, frame + frame_len), now_ms});
+    s.stats.reordered++;
+    while (s.pending.size() > rx->cfg.reorder_window)
+        skip_gap(rx, s);
+    s.stats.held = (uint32_t)s.pending.size();
+    return true;
+}
+
+void telemetry_rx_expire(TelemetryRx* rx, uint64_t now_ms)
+{
+    for (auto& entry : rx->streams)
+    {
+        Stream& s = entry.second;
+        while (!s.pending.empty() && now_ms - s.pending.begin()->second.arrived_ms >= rx->cfg.reorder_ms)
+            skip_gap(rx, s);
+    }
+}
+
+int telemetry_rx_poll(TelemetryRx* rx, int timeout_ms)
+{
+    rx->delivered = 0;
+    if (rx->sock < 0)
+        return -1;
+
+    pollfd p = {rx->sock, POLLIN, 0};
+    int r = poll(&p, 1, timeout_ms);
+    if (r < 0 && errno != EINTR)
+        return -1;
+
+    if (r > 0)
+    {
+        uint8_t buf[TELEMETRY_MAX_DATAGRAM];
+        while (true)
+        {
+            ssize_t n = recv(rx->sock, buf, sizeof(buf), MSG_DONTWAIT);
+            if (n < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                    break;
+                return -1;
+            }
+            telemetry_rx_feed(rx, buf, (size_t)n, now_ms());
+        }
+    }
+    telemetry_rx_expire(rx, now_ms());
+    return rx->delivered;
+}
+
+int telemetry_rx_get_stats(TelemetryRx* rx, TelemetryStreamStats* out, int max)
+{
+    int n = 0;
+    for (auto& entry : rx->streams)
+    {
+        if (n >= max)
+            break;
+        out[n++] = entry.second.stats;
+    }
+    return n;
+}
+
+uint32_t telemetry_rx_malformed(TelemetryRx* rx)
+{
+    return rx->malformed;
+}
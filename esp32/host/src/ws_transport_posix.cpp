@@ -0,0 +1,520 @@
+#include "ws_transport_posix.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ws_codec.h"
+#include "ws_server_core.h"
+
+// Minimal RFC 6455 server for host builds: enough to run the shared server
+// core against real sockets (handshake, masking, fragmentation, control frames).
+
+namespace
+{
+
+const char* WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+const size_t MAX_MESSAGE = 64 * 1024;
+
+// ---------------------------------------------------------------- SHA-1 / base64
+
+void sha1(const uint8_t* data, size_t len, uint8_t out[20])
+{
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::vector<uint8_t> msg(data, data + len);
+    uint64_t bits = (uint64_t)len * 8;
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56)
+        msg.push_back(0);
+    for (int i = 7; i >= 0; i--)
+        msg.push_back((uint8_t)(bits >> (i * 8)));
+
+    auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+    for (size_t off = 0; off < msg.size(); off += 64)
+    {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++)
+            w[i] = (uint32_t)msg[off + i * 4] << 24 | (uint32_t)msg[off + i * 4 + 1] << 16 |
+                   (uint32_t)msg[off + i * 4 + 2] << 8 | msg[off + i * 4 + 3];
+        for (int i = 16; i < 80; i++)
+            w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++)
+        {
+            uint32_t f, k;
+            if (i < 20)
+                f = (b & c) | (~b & d), k = 0x5A827999;
+            else if (i < 40)
+                f = b ^ c ^ d, k = 0x6ED9EBA1;
+            else if (i < 60)
+                f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+            else
+                f = b ^ c ^ d, k = 0xCA62C1D6;
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rol(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 5; i++)
+        for (int j = 0; j < 4; j++)
+            out[i * 4 + j] = (uint8_t)(h[i] >> (24 - j * 8));
+}
+
+std::string base64(const uint8_t* data, size_t len)
+{
+    static const char* tbl = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len)
+            v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        out += tbl[(v >> 18) & 63];
+        out += tbl[(v >> 12) & 63];
+        out += i + 1 < len ? tbl[(v >> 6) & 63] : '=';
+        out += i + 2 < len ? tbl[v & 63] : '=';
+    }
+    return out;
+}
+
+std::string header_value(const std::string& req, const char* name)
+{
+    std::string lower_req = req;
+    std::string lower_name = name;
+    for (auto& c : lower_req)
+        c = (char)tolower((unsigned char)c);
+    for (auto& c : lower_name)
+        c = (char)tolower((unsigned char)c);
+    size_t pos = lower_req.find("\r\n" + lower_name + ":");
+    if (pos == std::string::npos)
+        return "";
+    pos += 3 + lower_name.size();
+    size_t end = req.find("\r\n", pos);
+    std::string v = req.substr(pos, end - pos);
+    size_t first = v.find_first_not_of(' ');
+    return first == std::string::npos ? "" : v.substr(first);
+}
+
+// ---------------------------------------------------------------- server state
+
+struct Connection
+{
+    int fd;
+    bool open = false;
+    std::string handshake;
+    std::vector<uint8_t> rx;
+    std::vector<uint8_t> fragments;
+    uint8_t fragment_type = 0;
+    std::mutex write_lock;
+};
+
+struct Work
+{
+    void (*fn)(void* arg);
+    void* arg;
+};
+
+struct Server
+{
+    int listen_fd = -1;
+    int wake_pipe[2] = {-1, -1};
+    std::atomic<bool> running{false};
+    std::thread poll_thread;
+    std::thread worker_thread;
+
+    std::mutex conn_lock;
+    std::map<int, std::shared_ptr<Connection>> conns;
+
+    std::mutex work_lock;
+    std::condition_variable work_cv;
+    std::deque<Work> work_queue;
+};
+
+Server s_server;
+
+std::shared_ptr<Connection> get_conn(int fd)
+{
+    std::lock_guard<std::mutex> g(s_server.conn_lock);
+    auto it = s_server.conns.find(fd);
+    return it == s_server.conns.end() ? nullptr : it->second;
+}
+
+std::vector<uint8_t> build_frame(WsFrameType type, const uint8_t* data, size_t len)
+{
+    std::vector<uint8_t> f;
+    f.reserve(len + 10);
+    f.push_back(0x80 | (uint8_t)type);
+    if (len < 126)
+    {
+        f.push_back((uint8_t)len);
+    }
+    else if (len <= 0xFFFF)
+    {
+        f.push_back(126);
+        f.push_back((uint8_t)(len >> 8));
+        f.push_back((uint8_t)len);
+    }
+    else
+    {
+        f.push_back(127);
+        for (int i = 7; i >= 0; i--)
+            f.push_back((uint8_t)((uint64_t)len >> (i * 8)));
+    }
+    if (len > 0)
+        f.insert(f.end(), data, data + len);
+    return f;
+}
+
+bool write_all(Connection& c, const uint8_t* data, size_t len)
+{
+    std::lock_guard<std::mutex> g(c.write_lock);
+    while (len > 0)
+    {
+        ssize_t n = ::send(c.fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+void close_conn(int fd)
+{
+    std::shared_ptr<Connection> c;
+    {
+        std::lock_guard<std::mutex> g(s_server.conn_lock);
+        auto it = s_server.conns.find(fd);
+        if (it == s_server.conns.end())
+            return;
+        c = it->second;
+        s_server.conns.erase(it);
+    }
+    if (c->open)
+        ws_core_on_close(fd);
+    ::close(fd);
+}
+
+// Runs work posted by the core (send queue drains), like httpd_queue_work
+void worker_loop()
+{
+    std::unique_lock<std::mutex> lk(s_server.work_lock);
+    while (s_server.running || !s_server.work_queue.empty())
+    {
+        s_server.work_cv.wait(lk, [] { return !s_server.work_queue.empty() || !s_server.running; });
+        while (!s_server.work_queue.empty())
+        {
+            Work w = s_server.work_queue.front();
+            s_server.work_queue.pop_front();
+            lk.unlock();
+            w.fn(w.arg);
+            lk.lock();
+        }
+    }
+}
+
+bool handle_handshake(Connection& c)
+{
+    size_t end = c.handshake.find("\r\n\r\n");
+    if (end == std::string::npos)
+        return c.handshake.size() < 8192;
+
+    std::string req = c.handshake.substr(0, end + 2);
+    std::string key = header_value(req, "Sec-WebSocket-Key");
+    if (key.empty())
+        return false;
+    bool offers_binary = header_value(req, "Sec-WebSocket-Protocol").find(WS_SUBPROTOCOL_BINARY) != std::string::npos;
+
+    std::string accept_src = key + WS_GUID;
+    uint8_t digest[20];
+    sha1((const uint8_t*)accept_src.data(), accept_src.size(), digest);
+    std::string resp = "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: " +
+                       base64(digest, sizeof(digest)) + "\r\n";
+    if (offers_binary)
+        resp += std::string("Sec-WebSocket-Protocol: ") + WS_SUBPROTOCOL_BINARY + "\r\n";
+    resp += "\r\n";
+    if (!write_all(c, (const uint8_t*)resp.data(), resp.size()))
+        return false;
+
+    // Bytes after the request already belong to the first frame
+    std::string rest = c.handshake.substr(end + 4);
+    c.rx.insert(c.rx.end(), rest.begin(), rest.end());
+    c.handshake.clear();
+    c.open = true;
+    ws_core_on_open(c.fd, offers_binary);
+    return true;
+}
+
+// Error reply plus CLOSE 1009, like the httpd transport; the caller closes
+bool reject_message(Connection& c, size_t len)
+{
+    ws_core_on_rx_error(c.fd, WS_RX_TOO_LARGE, len);
+    uint8_t status[2] = {WS_CLOSE_MESSAGE_TOO_BIG >> 8, WS_CLOSE_MESSAGE_TOO_BIG & 0xFF};
+    auto reply = build_frame(WS_FRAME_CLOSE, status, sizeof(status));
+    write_all(c, reply.data(), reply.size());
+    return false;
+}
+
+// Parses as many complete frames as are buffered; false = close the connection
+bool handle_frames(Connection& c)
+{
+    while (true)
+    {
+        if (c.rx.size() < 2)
+            return true;
+        const uint8_t* p = c.rx.data();
+        bool fin = p[0] & 0x80;
+        uint8_t opcode = p[0] & 0x0F;
+        bool masked = p[1] & 0x80;
+        uint64_t len = p[1] & 0x7F;
+        size_t hdr = 2;
+        if (len == 126)
+        {
+            if (c.rx.size() < 4)
+                return true;
+            len = (uint64_t)p[2] << 8 | p[3];
+            hdr = 4;
+        }
+        else if (len == 127)
+        {
+            if (c.rx.size() < 10)
+                return true;
+            len = 0;
+            for (int i = 0; i < 8; i++)
+                len = len << 8 | p[2 + i];
+            hdr = 10;
+        }
+        if (!masked || len > MAX_MESSAGE)
+            return false; // clients must mask (RFC 6455 5.1)
+        size_t so_far = opcode == 0 ? c.fragments.size() : 0;
+        if (!(opcode & 0x08) && so_far + len > ws_core_max_message_size())
+            return reject_message(c, so_far + (size_t)len);
+        if (c.rx.size() < hdr + 4 + len)
+            return true;
+
+        const uint8_t* mask = p + hdr;
+        std::vector<uint8_t> payload(p + hdr + 4, p + hdr + 4 + len);
+        for (size_t i = 0; i < payload.size(); i++)
+            payload[i] ^= mask[i % 4];
+        c.rx.erase(c.rx.begin(), c.rx.begin() + (long)(hdr + 4 + len));
+
+        if (opcode == WS_FRAME_CLOSE)
+        {
+            auto reply = build_frame(WS_FRAME_CLOSE, NULL, 0);
+            write_all(c, reply.data(), reply.size());
+            return false;
+        }
+        if (opcode == WS_FRAME_PING || opcode == WS_FRAME_PONG)
+        {
+            ws_core_on_frame(c.fd, (WsFrameType)opcode, payload.data(), payload.size());
+            continue;
+        }
+
+        if (opcode != 0)
+        {
+            c.fragment_type = opcode;
+            c.fragments.clear();
+        }
+        c.fragments.insert(c.fragments.end(), payload.begin(), payload.end());
+        if (fin)
+        {
+            ws_core_on_frame(c.fd, (WsFrameType)c.fragment_type, c.fragments.data(), c.fragments.size());
+            c.fragments.clear();
+        }
+    }
+}
+
+void poll_loop()
+{
+    while (s_server.running)
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({s_server.listen_fd, POLLIN, 0});
+        fds.push_back({s_server.wake_pipe[0], POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> g(s_server.conn_lock);
+            for (auto& kv : s_server.conns)
+                fds.push_back({kv.first, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), 100) <= 0)
+            continue;
+
+        if (fds[0].revents & POLLIN)
+        {
+            int fd = accept(s_server.listen_fd, NULL, NULL);
+            if (fd >= 0)
+            {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                // Behave like lwIP: small send buffer, and a blocked write gives
+                // up after the same time as httpd's send_wait_timeout
+                int sndbuf = 8 * 1024;
+                setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+                timeval tv = {2, 0};
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                auto c = std::make_shared<Connection>();
+                c->fd = fd;
+                std::lock_guard<std::mutex> g(s_server.conn_lock);
+                s_server.conns[fd] = c;
+            }
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            char drain[64];
+            if (read(s_server.wake_pipe[0], drain, sizeof(drain)) < 0)
+                continue;
+        }
+
+        for (size_t i = 2; i < fds.size(); i++)
+        {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+            auto c = get_conn(fds[i].fd);
+            if (!c)
+                continue;
+            uint8_t buf[4096];
+            ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+            bool keep = n > 0;
+            if (keep && !c->open)
+            {
+                c->handshake.append((const char*)buf, (size_t)n);
+                keep = handle_handshake(*c);
+            }
+            else if (keep)
+            {
+                c->rx.insert(c->rx.end(), buf, buf + n);
+            }
+            if (keep && c->open)
+                keep = handle_frames(*c);
+            if (!keep)
+                close_conn(c->fd);
+        }
+    }
+}
+
+bool posix_send(void* ctx, int fd, WsFrameType type, const uint8_t* data, size_t len)
+{
+    (void)ctx;
+    auto c = get_conn(fd);
+    if (!c || !c->open)
+        return false;
+    auto frame = build_frame(type, data, len);
+    return write_all(*c, frame.data(), frame.size());
+}
+
+bool posix_writable(void* ctx, int fd)
+{
+    (void)ctx;
+    pollfd p = {fd, POLLOUT, 0};
+    return poll(&p, 1, 0) > 0 && (p.revents & POLLOUT);
+}
+
+bool posix_post(void* ctx, void (*fn)(void* arg), void* arg)
+{
+    (void)ctx;
+    if (!s_server.running)
+        return false;
+    {
+        std::lock_guard<std::mutex> g(s_server.work_lock);
+        s_server.work_queue.push_back({fn, arg});
+    }
+    s_server.work_cv.notify_one();
+    return true;
+}
+
+void posix_close(void* ctx, int fd)
+{
+    (void)ctx;
+    // The poll loop sees EOF and reports the close to the core
+    shutdown(fd, SHUT_RDWR);
+    if (write(s_server.wake_pipe[1], "x", 1) < 0)
+        return;
+}
+
+const WsTransport s_transport = {"posix", NULL, posix_send, posix_writable, posix_post, posix_close};
+
+} // namespace
+
+const WsTransport* ws_transport_posix_start(uint16_t port, uint16_t* bound_port)
+{
+    if (s_server.running)
+        return NULL;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return NULL;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t addr_len = sizeof(addr);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0 ||
+        getsockname(fd, (sockaddr*)&addr, &addr_len) != 0 || pipe(s_server.wake_pipe) != 0)
+    {
+        ::close(fd);
+        return NULL;
+    }
+    if (bound_port)
+        *bound_port = ntohs(addr.sin_port);
+
+    s_server.listen_fd = fd;
+    s_server.running = true;
+    s_server.worker_thread = std::thread(worker_loop);
+    s_server.poll_thread = std::thread(poll_loop);
+    return &s_transport;
+}
+
+void ws_transport_posix_stop(void)
+{
+    if (!s_server.running)
+        return;
+    s_server.running = false;
+    s_server.work_cv.notify_all();
+    if (write(s_server.wake_pipe[1], "x", 1) < 0)
+    {
+        // poll() times out on its own
+    }
+    s_server.poll_thread.join();
+    s_server.worker_thread.join();
+
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> g(s_server.conn_lock);
+        for (auto& kv : s_server.conns)
+            fds.push_back(kv.first);
+    }
+    for (int fd : fds)
+        close_conn(fd);
+    ::close(s_server.listen_fd);
+    ::close(s_server.wake_pipe[0]);
+    ::close(s_server.wake_pipe[1]);
+    s_server.listen_fd = -1;
+    s_server.work_queue.clear();
+}
@@ -0,0 +1,34 @@
+// Pass/fail bookkeeping shared by the host benches: check() records a failed
+// expectation under the scenario it belongs to, and check_summary() prints
+// the closing line and gives main() its exit code.
+
+#pragma once
+
+#include <stdio.h>
+
+namespace
+{
+
+int s_failures = 0;
+
+void check(bool ok, const char* scenario, const char* what)
+{
+    if (!ok)
+    {
+        fprintf(stderr, "FAIL %-10s %s\n", scenario, what);
+        s_failures++;
+    }
+}
+
+int check_summary(const char* ok_line = "all checks OK")
+{
+    if (s_failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    printf("%s\n", ok_line);
+    return 0;
+}
+
+} // namespace
@@ -0,0 +1,202 @@
+// Runs the match clock estimator (clock_sync.cpp) against a simulated server
+// exchange: a device crystal off by a fixed skew, millisecond server
+// timestamps, and a network with jitter, asymmetry and queueing spikes.
+// Reports the device's match clock error against true server time while
+// synced and in holdover, then checks source selection between the server
+// and ESP-NOW peers.
+//
+// Usage: clock_sync_bench [skew ppm] [minutes]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "bench_check.h"
+#include "clock_sync.h"
+
+namespace
+{
+
+const int64_t EXCHANGE_US = 2000000; // bridge TIME_SYNC period
+const int64_t WARMUP_US = 60000000;  // the skew fit needs 20 s of filtered samples
+const uint8_t SELF_ID = 40;
+const int SERVER_FD = 7;
+
+uint32_t s_rand = 4242;
+
+double next_unit()
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return (double)(s_rand >> 8) / (double)(1u << 24);
+}
+
+// One-way WiFi delay of 1-3 ms (uplink a little slower), 15% queued behind other traffic
+int64_t one_way_us(bool uplink)
+{
+    int64_t d = 1000 + (int64_t)(next_unit() * 2000) + (uplink ? 300 : 0);
+    if (next_unit() < 0.15)
+        d += 5000 + (int64_t)(next_unit() * 45000);
+    return d;
+}
+
+struct SimClock
+{
+    double skew;       // the device crystal runs this much fast
+    int64_t origin_us; // its esp_timer reading at server time 0
+
+    int64_t local(int64_t server_us) const
+    {
+        return origin_us + server_us + (int64_t)llround((double)server_us * skew);
+    }
+};
+
+struct Errors
+{
+    std::vector<double> abs_us;
+
+    void add(double err_us)
+    {
+        abs_us.push_back(fabs(err_us));
+    }
+
+    double pct(double p)
+    {
+        if (abs_us.empty())
+            return 0;
+        std::sort(abs_us.begin(), abs_us.end());
+        return abs_us[(size_t)(p * (double)(abs_us.size() - 1))];
+    }
+};
+
+double error_us(const SimClock& clk, int64_t server_us)
+{
+    return (double)(clock_sync_match_us_at(clk.local(server_us)) - server_us);
+}
+
+// TIME_SYNC rounds as the bridge and ws_server.cpp run them: each request
+// carries the previous round's ref_ms and the millisecond its reply arrived.
+// Returns the server time after the last round.
+int64_t run_server(const SimClock& clk, int64_t start_us, int64_t duration_us, Errors* errors)
+{
+    struct
+    {
+        uint32_t ref_ms;
+        int64_t rx_us; // device t2
+        int64_t tx_us; // device t3
+        uint32_t reply_ms;
+        bool valid;
+    } prev = {};
+
+    int64_t t = start_us;
+    for (; t < start_us + duration_us; t += EXCHANGE_US)
+    {
+        if (prev.valid)
+        {
+            int64_t t1 = (int64_t)prev.ref_ms * 1000;
+            int64_t t4 = (int64_t)prev.reply_ms * 1000;
+            int64_t offset = ((t1 - prev.rx_us) + (t4 - prev.tx_us)) / 2;
+            int64_t delay = (t4 - t1) - (prev.tx_us - prev.rx_us);
+            clock_sync_add_sample(CLOCK_SRC_SERVER, SERVER_FD, 0, offset, delay, prev.tx_us);
+        }
+
+        int64_t t2 = t + one_way_us(false);
+        int64_t t3 = t2 + 150; // decode and dispatch on the device
+        int64_t t4 = t3 + one_way_us(true);
+        prev = {(uint32_t)(t / 1000), clk.local(t2), clk.local(t3), (uint32_t)(t4 / 1000), true};
+
+        // Events land anywhere between exchanges
+        if (errors && t - start_us >= WARMUP_US)
+        {
+            for (int i = 0; i < 4; i++)
+                errors->add(error_us(clk, t + (int64_t)(next_unit() * EXCHANGE_US)));
+        }
+    }
+    return t;
+}
+
+void run_synced(const SimClock& clk, int minutes, int64_t* end_us)
+{
+    Errors errors;
+    *end_us = run_server(clk, 0, (int64_t)minutes * 60000000, &errors);
+
+    ClockSyncStatus st;
+    clock_sync_get_status(&st);
+    double skew_err_ppm = fabs(st.skew_ppb / 1000.0 - clk.skew * -1e6);
+    printf("synced:   %zu events, error p50 %.0f us, p99 %.0f us, max %.0f us; skew %.2f ppm (true %.2f)\n",
+           errors.abs_us.size(), errors.pct(0.5), errors.pct(0.99), errors.pct(1.0), st.skew_ppb / 1000.0,
+           clk.skew * -1e6);
+
+    // Server timestamps are whole milliseconds, so ~0.5 ms is the floor
+    check(errors.pct(0.99) < 1500, "synced", "p99 error above 1.5 ms");
+    check(skew_err_ppm < 2.0, "synced", "skew off by more than 2 ppm");
+    check(st.ref_id == SERVER_FD && st.samples > 0, "synced", "server not selected");
+}
+
+// The bridge goes away: the clock keeps running on the last offset and skew
+void run_holdover(const SimClock& clk, int64_t from_us)
+{
+    double err_1m = error_us(clk, from_us + 60000000);
+    double err_10m = error_us(clk, from_us + 600000000);
+    printf("holdover: error after 1 min %.0f us, after 10 min %.0f us\n", err_1m, err_10m);
+    check(fabs(err_1m) < 2000, "holdover", "more than 2 ms off after 1 min");
+    check(fabs(err_10m) < 5000, "holdover", "more than 5 ms off after 10 min");
+}
+
+// Which sources win, by local time of the offered samples
+void run_selection(const SimClock& clk, int64_t from_us)
+{
+    int64_t t = clk.local(from_us);
+    const int64_t server_timeout = CLOCK_SYNC_SERVER_TIMEOUT_MS * 1000LL;
+    const int64_t peer_timeout = CLOCK_SYNC_PEER_TIMEOUT_MS * 1000LL;
+
+    // Server fresh (last sample at from_us): peers are ignored, another connection too
+    check(!clock_sync_add_sample(CLOCK_SRC_PEER, 3, 1, 0, 1000, t + 1000), "selection", "peer beat the server");
+    check(!clock_sync_add_sample(CLOCK_SRC_SERVER, SERVER_FD + 1, 0, 0, 1000, t + 1000), "selection",
+          "second server connection took over");
+
+    // Server gone: the best peer by stratum, then by device_id
+    t += server_timeout;
+    check(clock_sync_add_sample(CLOCK_SRC_PEER, 12, 2, 0, 1000, t), "selection", "stratum 2 peer refused");
+    check(!clock_sync_add_sample(CLOCK_SRC_PEER, 5, 4, 0, 1000, t + 1), "selection", "stratum 4 peer beat stratum 2");
+    check(clock_sync_add_sample(CLOCK_SRC_PEER, 9, 2, 0, 1000, t + 2), "selection", "lower device_id refused on tie");
+    check(clock_sync_add_sample(CLOCK_SRC_PEER, 9, 3, 0, 1000, t + 3), "selection", "current peer refused");
+    check(!clock_sync_add_sample(CLOCK_SRC_PEER, SELF_ID, 1, 0, 1000, t + 4), "selection", "followed itself");
+
+    ClockSyncStatus st;
+    clock_sync_get_status(&st);
+    // The status ages samples by the host clock, so only the recorded source is checked
+    check(st.ref_id == 9, "selection", "not following device 9");
+
+    // Everyone free-running: lower device_ids than ours become the root
+    t += peer_timeout + 4;
+    check(!clock_sync_add_sample(CLOCK_SRC_PEER, 50, CLOCK_SYNC_STRATUM_FREE, 0, 1000, t), "selection",
+          "free-running peer above our device_id followed");
+    check(clock_sync_add_sample(CLOCK_SRC_PEER, 20, CLOCK_SYNC_STRATUM_FREE, 0, 1000, t + 1), "selection",
+          "free-running peer below our device_id refused");
+    check(clock_sync_add_sample(CLOCK_SRC_SERVER, SERVER_FD, 0, 0, 1000, t + 2), "selection",
+          "server refused after peers");
+
+    printf("selection: server > stratum > device_id, free-running fleet follows the lowest device_id\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    double skew_ppm = argc > 1 ? atof(argv[1]) : 40.0;
+    int minutes = argc > 2 ? atoi(argv[2]) : 20;
+    if (minutes < 2)
+        minutes = 20;
+
+    clock_sync_init(SELF_ID);
+
+    // Device booted 123.456 s before the server started counting
+    SimClock clk = {skew_ppm * 1e-6, 123456789};
+    int64_t end_us;
+    run_synced(clk, minutes, &end_us);
+    run_holdover(clk, end_us);
+    run_selection(clk, end_us);
+
+    return check_summary();
+}
@@ -0,0 +1,273 @@
+// Drives the match log (match_log.cpp) with the actions game_state records
+// and checks that replaying it gives back the live counters: across the
+// ring wrapping (records folded into the base), from a dump cut short, after
+// a simulated software reset, and for several devices merged by match time.
+// Reports the append and replay cost.
+//
+// Usage: match_log_bench [actions]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "bench_check.h"
+#include "match_log.h"
+
+namespace
+{
+
+uint32_t s_rand = 4711;
+
+uint32_t next_rand()
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return s_rand >> 8;
+}
+
+// The live state as game_state keeps it, updated alongside each append
+struct Live
+{
+    uint32_t shots = 0, hits = 0, kills = 0, deaths = 0, ff = 0, points = 0;
+    uint8_t hearts = 0;
+    uint16_t played_s = 0;
+    bool running = false, paused = false, over = false, respawning = false;
+};
+
+const uint8_t MAX_HEARTS = 5;
+
+void act(Live* live)
+{
+    switch (next_rand() % 12)
+    {
+        case 0:
+        case 1:
+        case 2:
+            live->shots++;
+            match_log_append(MLOG_SHOT, 0, 0, 0);
+            break;
+        case 3:
+        case 4:
+            live->hits++;
+            live->points += 1;
+            match_log_append(MLOG_HIT_LANDED, 0, 0, 1);
+            break;
+        case 5:
+            live->kills++;
+            live->points += 3;
+            match_log_append(MLOG_KILL, 0, 0, 3);
+            break;
+        case 6:
+            match_log_append(MLOG_HIT_RECEIVED, (uint8_t)(next_rand() % 32), (uint8_t)(next_rand() % 64), 0);
+            live->deaths++;
+            if (live->hearts > 0)
+                live->hearts--;
+            live->respawning = true;
+            match_log_append(MLOG_DEATH, 0, 0, live->hearts);
+            break;
+        case 7:
+            if (live->respawning)
+            {
+                live->respawning = false;
+                live->hearts = MAX_HEARTS;
+                match_log_append(MLOG_RESPAWN, 0, 0, live->hearts);
+            }
+            break;
+        case 8:
+            live->ff++;
+            match_log_append(MLOG_FRIENDLY_FIRE, 0, 0, 0);
+            break;
+        case 9:
+            if (live->running && !live->paused)
+            {
+                live->paused = true;
+                match_log_append(MLOG_PAUSE, 0, 0, 0);
+            }
+            else if (live->paused)
+            {
+                live->paused = false;
+                match_log_append(MLOG_RESUME, 0, 0, 0);
+            }
+            break;
+        case 10:
+            match_log_append(MLOG_COMMAND, (uint8_t)(next_rand() % 8), 0, 0);
+            break;
+        default:
+            if (next_rand() % 50 == 0)
+            {
+                live->hearts = (uint8_t)(1 + next_rand() % MAX_HEARTS);
+                match_log_append(MLOG_HEARTS, 0, 0, live->hearts);
+            }
+            else if (live->running && !live->paused && next_rand() % 10 == 0)
+            {
+                live->played_s += 10;
+                match_log_append(MLOG_ELAPSED, 0, 0, live->played_s);
+            }
+            break;
+    }
+}
+
+void start_match(Live* live)
+{
+    *live = Live();
+    live->hearts = MAX_HEARTS;
+    match_log_append(MLOG_RESET, 0, 0, live->hearts);
+    match_log_new_match();
+    live->running = true;
+    match_log_append(MLOG_MATCH_START, 0, 0, live->hearts);
+}
+
+bool same(const MatchLogTotals& t, const Live& live)
+{
+    return t.shots_fired == live.shots && t.hits_landed == live.hits && t.kills == live.kills &&
+           t.deaths == live.deaths && t.friendly_fire_count == live.ff && t.points == live.points &&
+           t.hearts_remaining == live.hearts && t.played_s == live.played_s && ((t.flags & MLOG_FLAG_RUNNING) != 0) == live.running &&
+           ((t.flags & MLOG_FLAG_PAUSED) != 0) == live.paused && ((t.flags & MLOG_FLAG_OVER) != 0) == live.over &&
+           ((t.flags & MLOG_FLAG_RESPAWNING) != 0) == live.respawning;
+}
+
+MatchLogTotals replay_dump(const std::vector<uint8_t>& dump)
+{
+    MatchLogDumpHeader hdr;
+    memcpy(&hdr, dump.data(), sizeof(hdr));
+    MatchLogTotals t = hdr.base;
+    for (uint16_t i = 0; i < hdr.count; i++)
+    {
+        MatchLogRecord r;
+        memcpy(&r, dump.data() + sizeof(hdr) + i * sizeof(r), sizeof(r));
+        match_log_apply(&t, &r);
+    }
+    return t;
+}
+
+std::vector<uint8_t> dump(size_t records)
+{
+    std::vector<uint8_t> buf(sizeof(MatchLogDumpHeader) + records * sizeof(MatchLogRecord));
+    buf.resize(match_log_dump(buf.data(), buf.size()));
+    return buf;
+}
+
+// One device, several rings' worth of actions: replay matches the live state throughout
+void run_replay(int actions, Live* live)
+{
+    match_log_init(12);
+    start_match(live);
+
+    int mismatches = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < actions; i++)
+    {
+        act(live);
+        if (i % 97 == 0)
+        {
+            MatchLogTotals t;
+            match_log_replay(&t);
+            mismatches += !same(t, *live);
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    MatchLogTotals t;
+    match_log_replay(&t);
+    auto t2 = std::chrono::steady_clock::now();
+
+    check(mismatches == 0, "replay", "replay differed from the live state mid-match");
+    check(same(t, *live), "replay", "replay differs from the live state");
+
+    std::vector<uint8_t> full = dump(MATCH_LOG_CAPACITY);
+    std::vector<uint8_t> cut = dump(10);
+    MatchLogDumpHeader hdr;
+    memcpy(&hdr, full.data(), sizeof(hdr));
+    check(hdr.count == MATCH_LOG_CAPACITY, "replay", "ring not full after wrapping");
+    check(same(replay_dump(full), *live), "replay", "full dump does not replay to the live state");
+    check(same(replay_dump(cut), *live), "replay", "short dump does not replay to the live state");
+
+    // Game over, then a new match folds the old one into the base
+    live->running = false;
+    live->over = true;
+    match_log_append(MLOG_GAME_OVER, 0, 0, 0);
+    match_log_replay(&t);
+    check(same(t, *live), "replay", "game over not replayed");
+
+    double append_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / actions;
+    double replay_us = std::chrono::duration<double, std::micro>(t2 - t1).count();
+    printf("replay:  %d actions, %.0f ns/append (incl. periodic replays), full replay %.1f us, dump %zu bytes\n",
+           actions, append_ns, replay_us, full.size());
+}
+
+// The ring survives a software reset for the same device only
+void run_restore(const Live& live)
+{
+    check(match_log_init(12), "restore", "log not kept for the same device_id");
+    MatchLogTotals t;
+    match_log_replay(&t);
+    check(same(t, live), "restore", "kept log does not replay to the state before the reset");
+    check(!match_log_init(13), "restore", "log kept for another device_id");
+    match_log_replay(&t);
+    check(t.shots_fired == 0 && t.kills == 0, "restore", "log of another device_id replayed");
+    printf("restore: kept across re-init for device 12, dropped for device 13\n");
+}
+
+// Three devices in one match: dumps merge into one timeline, replay per device holds
+void run_merge(int actions)
+{
+    std::vector<MatchLogRecord> timeline;
+    std::vector<Live> lives(3);
+    for (uint8_t d = 0; d < 3; d++)
+    {
+        match_log_init((uint8_t)(20 + d));
+        start_match(&lives[d]);
+        for (int i = 0; i < actions / 8; i++)
+            act(&lives[d]);
+        std::vector<uint8_t> buf = dump(MATCH_LOG_CAPACITY);
+        check(same(replay_dump(buf), lives[d]), "merge", "device dump does not replay");
+
+        MatchLogDumpHeader hdr;
+        memcpy(&hdr, buf.data(), sizeof(hdr));
+        for (uint16_t i = 0; i < hdr.count; i++)
+        {
+            MatchLogRecord r;
+            memcpy(&r, buf.data() + sizeof(hdr) + i * sizeof(r), sizeof(r));
+            timeline.push_back(r);
+        }
+    }
+
+    std::stable_sort(timeline.begin(), timeline.end(), [](const MatchLogRecord& x, const MatchLogRecord& y) {
+        if (x.match_ms != y.match_ms)
+            return (int32_t)(x.match_ms - y.match_ms) < 0;
+        if (x.device_id != y.device_id)
+            return x.device_id < y.device_id;
+        return (int16_t)(x.seq - y.seq) < 0;
+    });
+
+    // Per device, the merged timeline keeps the device's own order
+    uint16_t last_seq[3] = {};
+    bool seen[3] = {};
+    bool ordered = true;
+    for (const MatchLogRecord& r : timeline)
+    {
+        int d = r.device_id - 20;
+        if (seen[d] && (int16_t)(r.seq - last_seq[d]) <= 0)
+            ordered = false;
+        seen[d] = true;
+        last_seq[d] = r.seq;
+    }
+    check(ordered, "merge", "merged timeline reorders a device's records");
+    printf("merge:   %zu records from 3 devices in one timeline\n", timeline.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int actions = argc > 1 ? atoi(argv[1]) : 20000;
+    if (actions < MATCH_LOG_CAPACITY * 2)
+        actions = 20000;
+
+    Live live;
+    run_replay(actions, &live);
+    run_restore(live);
+    run_merge(actions);
+
+    return check_summary();
+}
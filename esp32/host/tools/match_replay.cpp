@@ -0,0 +1,161 @@
+// Merges match log dumps (GET /api/match_log from each device, see
+// match_log.h) into one timeline ordered by match time, replays every
+// device's records through the firmware's own match_log_apply() and prints
+// the timeline, each device's totals and who hit whom.
+//
+// Usage: match_replay [-q] dump...
+//   curl -o d12.bin http://<device>/api/match_log
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "match_log.h"
+
+namespace
+{
+
+struct DeviceLog
+{
+    const char* path;
+    MatchLogDumpHeader header;
+    std::vector<MatchLogRecord> records;
+};
+
+bool load(const char* path, DeviceLog* out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    out->path = path;
+    bool ok = fread(&out->header, sizeof(out->header), 1, f) == 1 && out->header.magic[0] == MATCH_LOG_MAGIC0 &&
+              out->header.magic[1] == MATCH_LOG_MAGIC1 && out->header.version == MATCH_LOG_VERSION;
+    if (ok)
+    {
+        out->records.resize(out->header.count);
+        ok = fread(out->records.data(), sizeof(MatchLogRecord), out->records.size(), f) == out->records.size();
+    }
+    fclose(f);
+    if (!ok)
+        fprintf(stderr, "%s: not a match log dump (version %u expected)\n", path, MATCH_LOG_VERSION);
+    return ok;
+}
+
+// Same ordering on every run: match time, then device, then the device's own order
+bool earlier(const MatchLogRecord& x, const MatchLogRecord& y)
+{
+    if (x.match_ms != y.match_ms)
+        return (int32_t)(x.match_ms - y.match_ms) < 0;
+    if (x.device_id != y.device_id)
+        return x.device_id < y.device_id;
+    return (int16_t)(x.seq - y.seq) < 0;
+}
+
+void print_record(const MatchLogRecord& r, uint32_t t0)
+{
+    printf("%9.3f  D%-2u  %-13s", (double)(int32_t)(r.match_ms - t0) / 1000.0, r.device_id,
+           match_log_type_name(r.type));
+    switch (r.type)
+    {
+        case MLOG_HIT_RECEIVED:
+            printf(" from P:%u D:%u", r.a, r.b);
+            break;
+        case MLOG_HIT_LANDED:
+        case MLOG_KILL:
+            printf(" +%u", r.value);
+            break;
+        case MLOG_MATCH_START:
+        case MLOG_DEATH:
+        case MLOG_RESPAWN:
+        case MLOG_HEARTS:
+        case MLOG_RESET_STATS:
+        case MLOG_RESET:
+            printf(" hearts %u", r.value);
+            break;
+        case MLOG_COMMAND:
+            printf(" %u", r.a);
+            break;
+        case MLOG_CONFIG:
+            printf(" max_hearts %u spawn_hearts %u target %u", r.a, r.b, r.value);
+            break;
+        default:
+            break;
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool quiet = false;
+    std::vector<DeviceLog> logs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-q") == 0)
+        {
+            quiet = true;
+            continue;
+        }
+        DeviceLog log;
+        if (!load(argv[i], &log))
+            return 1;
+        logs.push_back(log);
+    }
+    if (logs.empty())
+    {
+        fprintf(stderr, "usage: match_replay [-q] dump...\n");
+        return 2;
+    }
+
+    std::vector<MatchLogRecord> timeline;
+    std::map<uint8_t, MatchLogTotals> totals;
+    for (const DeviceLog& log : logs)
+    {
+        if (totals.count(log.header.device_id))
+            fprintf(stderr, "%s: device %u appears twice, merging both\n", log.path, log.header.device_id);
+        else
+            totals[log.header.device_id] = log.header.base;
+        timeline.insert(timeline.end(), log.records.begin(), log.records.end());
+    }
+    std::stable_sort(timeline.begin(), timeline.end(), earlier);
+
+    // Replay in timeline order; per device that is the order it logged in
+    std::map<std::pair<uint8_t, uint8_t>, uint32_t> hits; // (victim device, shooter device)
+    uint32_t t0 = timeline.empty() ? 0 : timeline.front().match_ms;
+    for (const MatchLogRecord& r : timeline)
+    {
+        match_log_apply(&totals[r.device_id], &r);
+        if (r.type == MLOG_HIT_RECEIVED)
+            hits[{r.device_id, r.b}]++;
+        if (!quiet)
+            print_record(r, t0);
+    }
+
+    printf("\n%zu records from %zu devices\n", timeline.size(), logs.size());
+    printf("device  shots  hits  kills  deaths  ff  points  hearts  state\n");
+    for (const auto& it : totals)
+    {
+        const MatchLogTotals& t = it.second;
+        const char* state = (t.flags & MLOG_FLAG_OVER)      ? "over"
+                            : (t.flags & MLOG_FLAG_PAUSED)  ? "paused"
+                            : (t.flags & MLOG_FLAG_RUNNING) ? "running"
+                                                            : "idle";
+        printf("D%-5u %6lu %5lu %6lu %7lu %3lu %7lu %7u  %s%s\n", it.first, (unsigned long)t.shots_fired,
+               (unsigned long)t.hits_landed, (unsigned long)t.kills, (unsigned long)t.deaths,
+               (unsigned long)t.friendly_fire_count, (unsigned long)t.points, t.hearts_remaining, state,
+               (t.flags & MLOG_FLAG_RESPAWNING) ? ", respawning" : "");
+    }
+
+    if (!hits.empty())
+    {
+        printf("\nhits taken (victim <- shooter device: count)\n");
+        for (const auto& it : hits)
+            printf("D%-2u <- D%-2u: %lu\n", it.first.first, it.first.second, (unsigned long)it.second);
+    }
+    return 0;
+}
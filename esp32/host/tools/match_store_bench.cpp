@@ -0,0 +1,262 @@
+// Runs the match store (match_store.cpp) on a RAM flash with NOR semantics
+// (writes only clear bits, erase sets a sector to 0xFF) and cuts the power
+// at random points, in the middle of writes and erases included. After each
+// cut the device "reboots" with its RAM log gone and must come back with the
+// last checkpoint that completed. Also checks that the ring wears all
+// sectors evenly and reports the boot scan time.
+//
+// Usage: match_store_bench [trials]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "bench_check.h"
+#include "match_store.h"
+
+namespace
+{
+
+uint32_t s_rand = 1234;
+
+uint32_t next_rand()
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return s_rand >> 8;
+}
+
+const size_t SECTOR_SIZE = 4096;
+const size_t FLASH_SIZE = 16 * SECTOR_SIZE; // the "matchlog" partition
+const uint8_t DEVICE_ID = 7;
+
+struct RamFlash
+{
+    std::vector<uint8_t> mem = std::vector<uint8_t>(FLASH_SIZE, 0xFF);
+    std::vector<uint32_t> erases = std::vector<uint32_t>(FLASH_SIZE / SECTOR_SIZE, 0);
+    long budget = -1; // bytes until the power goes (-1 = never)
+    bool dead = false;
+    int write_cuts = 0;
+    int erase_cuts = 0;
+
+    // Spend n bytes of budget; false once the power is gone
+    bool spend(long n)
+    {
+        if (dead)
+            return false;
+        if (budget < 0)
+            return true;
+        if (budget < n)
+        {
+            dead = true;
+            return false;
+        }
+        budget -= n;
+        return true;
+    }
+};
+
+bool ram_read(void* ctx, size_t offset, void* dst, size_t len)
+{
+    RamFlash* f = (RamFlash*)ctx;
+    memcpy(dst, &f->mem[offset], len);
+    return true;
+}
+
+bool ram_write(void* ctx, size_t offset, const void* src, size_t len)
+{
+    RamFlash* f = (RamFlash*)ctx;
+    const uint8_t* p = (const uint8_t*)src;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (!f->spend(1))
+        {
+            f->write_cuts++; // torn: the bytes before this one are programmed
+            return false;
+        }
+        f->mem[offset + i] &= p[i];
+    }
+    return true;
+}
+
+bool ram_erase_sector(void* ctx, size_t offset)
+{
+    RamFlash* f = (RamFlash*)ctx;
+    // An erase costs as much as a sector's worth of writes; cut short it leaves noise
+    if (!f->spend(SECTOR_SIZE / 16))
+    {
+        f->erase_cuts++;
+        for (size_t i = 0; i < SECTOR_SIZE / 2; i++)
+            f->mem[offset + i] = (uint8_t)next_rand();
+        return false;
+    }
+    memset(&f->mem[offset], 0xFF, SECTOR_SIZE);
+    f->erases[offset / SECTOR_SIZE]++;
+    return true;
+}
+
+MatchStoreFlash flash_of(RamFlash* f)
+{
+    MatchStoreFlash flash = {};
+    flash.ctx = f;
+    flash.size = FLASH_SIZE;
+    flash.sector_size = SECTOR_SIZE;
+    flash.read = ram_read;
+    flash.write = ram_write;
+    flash.erase_sector = ram_erase_sector;
+    return flash;
+}
+
+// Power loss takes the RTC copy of the log with it
+void lose_ram()
+{
+    match_log_init(DEVICE_ID + 1);
+    match_log_init(DEVICE_ID);
+}
+
+// Boot as game_state_init does: the flash checkpoint seeds the log
+bool boot(RamFlash* f, MatchLogTotals* restored)
+{
+    f->dead = false;
+    f->budget = -1;
+    lose_ram();
+    MatchStoreFlash flash = flash_of(f);
+    if (!match_store_init(&flash, DEVICE_ID))
+        return false;
+    uint32_t log_seq = 0;
+    if (!match_store_load(restored, &log_seq))
+        return false;
+    match_log_seed(restored, log_seq);
+    return true;
+}
+
+void play(int actions)
+{
+    for (int i = 0; i < actions; i++)
+    {
+        switch (next_rand() % 4)
+        {
+            case 0:
+                match_log_append(MLOG_SHOT, 0, 0, 0);
+                break;
+            case 1:
+                match_log_append(MLOG_HIT_LANDED, 0, 0, 1);
+                break;
+            case 2:
+                match_log_append(MLOG_KILL, 0, 0, 3);
+                break;
+            default:
+                match_log_append(MLOG_DEATH, 0, 0, (uint16_t)(next_rand() % 5));
+                break;
+        }
+    }
+}
+
+bool same(const MatchLogTotals& a, const MatchLogTotals& b)
+{
+    return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// Flush after every few actions until the power goes at a random byte; reboot and compare
+void run_powercut(int trials)
+{
+    RamFlash f;
+    lose_ram();
+    MatchStoreFlash flash = flash_of(&f);
+    match_store_init(&flash, DEVICE_ID);
+    match_log_append(MLOG_MATCH_START, 0, 0, 5);
+    match_store_flush();
+
+    MatchLogTotals saved;
+    match_log_replay(&saved);
+    int mismatches = 0, not_found = 0, landed = 0;
+    uint32_t torn_max = 0;
+    uint32_t scan_max_us = 0;
+
+    for (int t = 0; t < trials; t++)
+    {
+        f.budget = (long)(next_rand() % (40 * MATCH_STORE_ENTRY_SIZE));
+        MatchLogTotals attempted = saved;
+        while (!f.dead)
+        {
+            play(1 + next_rand() % 5);
+            MatchLogTotals now;
+            match_log_replay(&now);
+            if (match_store_flush())
+                saved = now;
+            else
+                attempted = now;
+        }
+
+        MatchLogTotals restored;
+        if (!boot(&f, &restored))
+        {
+            not_found++;
+            continue;
+        }
+        // A cut in the last CRC byte can leave it as intended (it was 0xFF): the write failed, the entry is whole
+        bool whole = same(restored, attempted) && !same(attempted, saved);
+        landed += whole ? 1 : 0;
+        mismatches += !same(restored, saved) && !whole;
+        saved = restored;
+        MatchStoreStats st;
+        match_store_get_stats(&st);
+        torn_max = std::max(torn_max, st.torn_skipped);
+        scan_max_us = std::max(scan_max_us, st.scan_us);
+    }
+
+    check(not_found == 0, "powercut", "no checkpoint found after a power cut");
+    check(mismatches == 0, "powercut", "restored state is not the last completed checkpoint");
+    check(f.write_cuts > 0 && f.erase_cuts > 0, "powercut", "cuts never tore a write or an erase");
+    printf("powercut: %d cuts (%d mid-write, %d mid-erase, %d landed whole), up to %lu torn entries skipped, "
+           "boot scan <= %lu us\n",
+           trials, f.write_cuts, f.erase_cuts, landed, (unsigned long)torn_max, (unsigned long)scan_max_us);
+}
+
+// A long match: every sector erased the same number of times (+-1), the newest entry found after wrapping
+void run_wear(int flushes)
+{
+    RamFlash f;
+    lose_ram();
+    MatchStoreFlash flash = flash_of(&f);
+    match_store_init(&flash, DEVICE_ID);
+    for (int i = 0; i < flushes; i++)
+    {
+        play(1);
+        match_store_flush();
+        // Unchanged log: no write
+        match_store_flush();
+    }
+    MatchStoreStats st;
+    match_store_get_stats(&st);
+    MatchLogTotals live, restored;
+    match_log_replay(&live);
+
+    uint32_t lo = *std::min_element(f.erases.begin(), f.erases.end());
+    uint32_t hi = *std::max_element(f.erases.begin(), f.erases.end());
+    check(st.entries_written == (uint32_t)flushes, "wear", "unchanged log written again");
+    check(hi - lo <= 1, "wear", "sectors wear unevenly");
+    check(boot(&f, &restored) && same(restored, live), "wear", "newest checkpoint not found after wrapping");
+
+    MatchStoreFlash other = flash_of(&f);
+    check(match_store_init(&other, DEVICE_ID + 1) && !match_store_load(&restored, NULL), "wear",
+          "checkpoint of another device_id loaded");
+
+    double hours = (double)flushes * MATCH_STORE_FLUSH_MS / 3600000.0;
+    printf("wear:     %d checkpoints (%.1f h of play at one per %d ms), erases per sector %lu..%lu\n", flushes,
+           hours, MATCH_STORE_FLUSH_MS, (unsigned long)lo, (unsigned long)hi);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int trials = argc > 1 ? atoi(argv[1]) : 2000;
+    if (trials <= 0)
+        trials = 2000;
+
+    run_powercut(trials);
+    run_wear(20000);
+
+    return check_summary();
+}
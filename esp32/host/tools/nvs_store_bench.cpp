@@ -0,0 +1,172 @@
+// Runs the cached NVS store (nvs_store.cpp) on the in-memory NVS of
+// port/nvs.h and counts what reaches it: a burst of config pushes (the
+// writes of game_state_save_ids), repeated reads of the peer list
+// (GET /api/peers), unchanged writes, a failing flush, namespace erase and
+// more keys than the cache holds.
+//
+// Usage: nvs_store_bench [updates]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_check.h"
+#include "nvs.h"
+#include "nvs_store.h"
+
+namespace
+{
+
+const char* GAME_NS = "game";
+const char* WIFI_NS = "wifi";
+
+struct Ids
+{
+    uint8_t device_id, player_id, team_id;
+    uint32_t color;
+    const char* name;
+};
+
+// What game_state_save_ids() writes on every config_update
+void save_ids(const Ids& ids)
+{
+    nvs_store_begin();
+    nvs_store_write_u8(GAME_NS, "device_id", ids.device_id);
+    nvs_store_write_u8(GAME_NS, "player_id", ids.player_id);
+    nvs_store_write_u8(GAME_NS, "team_id", ids.team_id);
+    nvs_store_write_u32(GAME_NS, "color", ids.color);
+    nvs_store_write_str(GAME_NS, "device_name", ids.name);
+    nvs_store_end();
+}
+
+void run_burst(int updates)
+{
+    HostNvs before = g_host_nvs;
+    Ids ids = {12, 3, 1, 0xFF0000, "target-12"};
+    for (int i = 0; i < updates; i++)
+    {
+        // Mostly the same config pushed again; now and then the colour changes
+        if (i % 10 == 0)
+            ids.color = 0xFF0000 + (uint32_t)i;
+        save_ids(ids);
+    }
+    uint32_t sets_before_flush = g_host_nvs.sets - before.sets;
+    check(nvs_store_flush(), "burst", "flush failed");
+
+    uint32_t sets = g_host_nvs.sets - before.sets;
+    uint32_t commits = g_host_nvs.commits - before.commits;
+    check(sets_before_flush == 0, "burst", "writes reached NVS before the flush");
+    check(sets <= 5 && commits == 1, "burst", "burst not coalesced into one flush");
+
+    uint8_t u8 = 0;
+    uint32_t color = 0;
+    char name[32] = {};
+    check(nvs_store_read_u8(GAME_NS, "device_id", &u8) && u8 == 12, "burst", "device_id lost");
+    check(nvs_store_read_u32(GAME_NS, "color", &color) && color == ids.color, "burst", "last colour not kept");
+    check(nvs_store_read_str(GAME_NS, "device_name", name, sizeof(name)) && strcmp(name, "target-12") == 0,
+          "burst", "device_name lost");
+
+    // Before: open + set + commit + close per key, five keys per update
+    printf("burst:    %d config updates -> %lu nvs_set, %lu nvs_commit (was %d of each)\n", updates,
+           (unsigned long)sets, (unsigned long)commits, updates * 5);
+}
+
+void run_reads(int reads)
+{
+    nvs_store_write_str(WIFI_NS, "peers", "AA:BB:CC:DD:EE:01,AA:BB:CC:DD:EE:02");
+    nvs_store_flush();
+    uint32_t gets = g_host_nvs.gets;
+    uint32_t opens = g_host_nvs.opens;
+    char peers[256];
+    bool ok = true;
+    for (int i = 0; i < reads; i++)
+        ok &= nvs_store_read_str(WIFI_NS, "peers", peers, sizeof(peers));
+    check(ok && strncmp(peers, "AA:BB", 5) == 0, "reads", "peer list not read back");
+    check(g_host_nvs.gets == gets && g_host_nvs.opens == opens, "reads", "cached reads went to NVS");
+
+    char small[8];
+    check(!nvs_store_read_str(WIFI_NS, "peers", small, sizeof(small)), "reads", "short buffer accepted");
+    uint8_t missing;
+    check(!nvs_store_read_u8(WIFI_NS, "nope", &missing), "reads", "missing key found");
+    gets = g_host_nvs.gets;
+    check(!nvs_store_read_u8(WIFI_NS, "nope", &missing) && g_host_nvs.gets == gets, "reads",
+          "missing key not cached");
+    printf("reads:    %d peer list reads, 0 from NVS\n", reads);
+}
+
+void run_unchanged()
+{
+    uint32_t sets = g_host_nvs.sets, commits = g_host_nvs.commits;
+    nvs_store_write_str(WIFI_NS, "peers", "AA:BB:CC:DD:EE:01,AA:BB:CC:DD:EE:02");
+    nvs_store_write_u8(GAME_NS, "device_id", 12);
+    nvs_store_flush();
+    check(g_host_nvs.sets == sets && g_host_nvs.commits == commits, "unchanged", "unchanged values written");
+}
+
+void run_failure()
+{
+    g_host_nvs.fail_writes = true;
+    nvs_store_write_u8(GAME_NS, "team_id", 2);
+    check(!nvs_store_flush(), "failure", "failed write reported as flushed");
+    g_host_nvs.fail_writes = false;
+    check(nvs_store_flush(), "failure", "retry failed");
+    nvs_handle_t h;
+    nvs_open(GAME_NS, NVS_READONLY, &h);
+    uint8_t team = 0;
+    check(nvs_get_u8(h, "team_id", &team) == ESP_OK && team == 2, "failure", "key lost after a failed flush");
+    nvs_close(h);
+}
+
+void run_erase()
+{
+    check(nvs_store_erase_namespace(WIFI_NS), "erase", "erase failed");
+    char peers[256];
+    check(!nvs_store_read_str(WIFI_NS, "peers", peers, sizeof(peers)), "erase", "erased key still cached");
+    uint8_t id = 0;
+    check(nvs_store_read_u8(GAME_NS, "device_id", &id) && id == 12, "erase", "other namespace erased");
+}
+
+void run_evict()
+{
+    const int KEYS = NVS_STORE_MAX_KEYS * 2;
+    char key[16];
+    for (int i = 0; i < KEYS; i++)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        nvs_store_write_u32("evict", key, (uint32_t)i * 7);
+        if (i % 8 == 7)
+            nvs_store_flush();
+    }
+    nvs_store_flush();
+    bool ok = true;
+    for (int i = 0; i < KEYS; i++)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        uint32_t v = 0;
+        ok &= nvs_store_read_u32("evict", key, &v) && v == (uint32_t)i * 7;
+    }
+    check(ok, "evict", "value lost when the cache overflowed");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int updates = argc > 1 ? atoi(argv[1]) : 50;
+    if (updates <= 0)
+        updates = 50;
+
+    run_burst(updates);
+    run_reads(1000);
+    run_unchanged();
+    run_failure();
+    run_erase();
+    run_evict();
+
+    NvsStoreStats st;
+    nvs_store_get_stats(&st);
+    printf("stats:    %lu cached / %lu NVS reads, %lu writes (%lu unchanged), %lu keys in %lu commits\n",
+           (unsigned long)st.reads_cached, (unsigned long)st.reads_flash, (unsigned long)st.writes,
+           (unsigned long)st.writes_unchanged, (unsigned long)st.keys_flushed, (unsigned long)st.commits);
+
+    return check_summary();
+}
@@ -0,0 +1,202 @@
+// Runs the roster (roster.cpp) on the presence table (presence.cpp): the
+// admissible-shooter mask under each rule (self, field, server roster,
+// friendly fire, beacons expiring), a roster pushed over and over while
+// readers look players up without a lock, and the cost of a lookup.
+//
+// Usage: roster_bench [replacements]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "bench_check.h"
+#include "esp_timer.h"
+#include "presence.h"
+#include "roster.h"
+
+namespace
+{
+
+const uint8_t SELF = 3;
+const uint8_t SELF_TEAM = 1;
+
+uint32_t now_ms()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// A beacon from another device, as presence_on_beacon() records it
+void beacon(uint8_t device_id, uint8_t player_id, uint8_t team_id, uint32_t age_ms)
+{
+    PresenceEntry e = {};
+    e.device_id = device_id;
+    e.player_id = player_id;
+    e.team_id = team_id;
+    e.interval_ms = PRESENCE_INTERVAL_MS;
+    e.last_seen_ms = now_ms() - age_ms;
+    presence_update(&e);
+    roster_refresh_field();
+}
+
+void run_rules()
+{
+    roster_set_self(SELF, SELF_TEAM, true, false);
+    check(!roster_admits(SELF), "rules", "self-hit admitted");
+    check(roster_admits(5) && roster_admits(31), "rules", "nobody heard, yet a player refused");
+    check(!roster_admits(32) && !roster_admits(0xFF), "rules", "out of range player admitted");
+
+    beacon(10, 5, SELF_TEAM, 0);
+    beacon(11, 7, 2, 0);
+    RosterSlot slot;
+    check(roster_get(7, &slot) && slot.alive && slot.team_id == 2, "field", "beacon not in the slot");
+    check(roster_admits(7), "field", "player on the field refused");
+    check(!roster_admits(9), "field", "player not on the field admitted");
+    check(!roster_admits(5), "field", "teammate admitted with friendly fire off");
+
+    roster_set_self(SELF, SELF_TEAM, true, true);
+    check(roster_admits(5), "field", "teammate refused with friendly fire on");
+    roster_set_self(SELF, SELF_TEAM, false, false);
+    check(roster_admits(5), "field", "teammate refused without team play");
+    roster_set_self(SELF, SELF_TEAM, true, false);
+
+    roster_begin();
+    roster_add(7, "Bob");
+    roster_add(9, "Eve");
+    check(!roster_add(ROSTER_SLOTS, "Nobody"), "server", "out of range player added");
+    roster_commit();
+    char name[PLAYER_NAME_LEN];
+    check(roster_count() == 2, "server", "roster count");
+    check(roster_name(9, name, sizeof(name)) && strcmp(name, "Eve") == 0, "server", "name lookup");
+    check(!roster_name(5, NULL, 0), "server", "player outside the roster has a name");
+    check(!roster_admits(9), "server", "roster used without a server connected");
+
+    roster_set_server_connected(true);
+    check(roster_admits(9) && roster_admits(7), "server", "roster member refused");
+    check(!roster_admits(5) && !roster_admits(12), "server", "player outside the roster admitted");
+
+    // A push that renames one player and keeps the other: only the renamed slot changes
+    RosterSlot bob_before, eve_before, after;
+    roster_get(7, &bob_before);
+    roster_get(9, &eve_before);
+    roster_begin();
+    roster_add(7, "Bob");
+    roster_add(9, "Eva");
+    roster_commit();
+    check(roster_get(7, &after) && after.generation == bob_before.generation, "server",
+          "unchanged slot got a new generation");
+    check(roster_get(9, &after) && after.generation != eve_before.generation && strcmp(after.name, "Eva") == 0,
+          "server", "renamed slot kept its generation");
+
+    roster_set_server_connected(false);
+    check(roster_admits(7) && !roster_admits(9), "server", "field rules not back after the server left");
+
+    // Every beacon older than its timeout: nobody on the field, anyone may shoot again
+    beacon(10, 5, SELF_TEAM, PRESENCE_INTERVAL_MS * PRESENCE_MISSED_BEACONS);
+    beacon(11, 7, 2, PRESENCE_INTERVAL_MS * PRESENCE_MISSED_BEACONS);
+    check(roster_get(7, &slot) && !slot.alive, "expiry", "silent player still alive");
+    check(roster_admits(9) && roster_admits(12), "expiry", "field rules kept after everyone left");
+    // The team is remembered, so a teammate still cannot hit
+    check(!roster_admits(5), "expiry", "last known team forgotten");
+
+    printf("rules:    mask %08lx after the field emptied (self %u, team %u blocked)\n",
+           (unsigned long)roster_admissible(), SELF, SELF_TEAM);
+}
+
+void push_roster(bool a)
+{
+    roster_begin();
+    for (uint8_t id = a ? 0 : 16; id < (a ? 16 : 32); id++)
+    {
+        char name[PLAYER_NAME_LEN];
+        snprintf(name, sizeof(name), "%c%u", a ? 'A' : 'B', id);
+        roster_add(id, name);
+    }
+    roster_commit();
+}
+
+// Two rosters of 16 players each, swapped while readers check every slot
+void run_replace(int replacements)
+{
+    roster_set_server_connected(true);
+    push_roster(true);
+    std::atomic<bool> stop(false);
+    std::atomic<long> reads(0), torn(0), bad_count(0);
+
+    auto reader = [&]() {
+        long n = 0;
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            if (roster_count() != 16)
+                bad_count++;
+            for (uint8_t id = 0; id < ROSTER_SLOTS; id++)
+            {
+                RosterSlot slot;
+                roster_get(id, &slot);
+                char expect[PLAYER_NAME_LEN];
+                snprintf(expect, sizeof(expect), "%c%u", id < 16 ? 'A' : 'B', id);
+                if (slot.in_roster ? strcmp(slot.name, expect) != 0 : slot.name[0] != '\0')
+                    torn++;
+                n++;
+            }
+        }
+        reads += n;
+    };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; i++)
+        readers.emplace_back(reader);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < replacements; r++)
+        push_roster(r % 2 == 1);
+    double elapsed_us =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    stop = true;
+    for (auto& t : readers)
+        t.join();
+
+    check(torn == 0, "replace", "a reader saw a slot from neither roster");
+    check(bad_count == 0, "replace", "a reader saw a half-replaced roster");
+    printf("replace:  %d rosters pushed (%.1f us each) under %ld lock-free slot reads, %ld torn\n", replacements,
+           elapsed_us / replacements, (long)reads, (long)torn);
+    roster_set_server_connected(false);
+}
+
+void run_lookup()
+{
+    const int N = 10000000;
+    uint32_t admitted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++)
+        admitted += roster_admits((uint8_t)(i & 31)) ? 1 : 0;
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / N;
+
+    uint32_t named = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < N / 10; i++)
+        named += roster_name((uint8_t)(i & 31), NULL, 0) ? 1 : 0;
+    double name_ns =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (N / 10);
+    printf("lookup:   roster_admits %.1f ns, roster_name %.1f ns (%lu/%lu hits)\n", ns, name_ns,
+           (unsigned long)admitted, (unsigned long)named);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int replacements = argc > 1 ? atoi(argv[1]) : 20000;
+    if (replacements <= 0)
+        replacements = 20000;
+
+    presence_init();
+    roster_init();
+    run_rules();
+    run_replace(replacements);
+    run_lookup();
+
+    return check_summary();
+}
@@ -0,0 +1,282 @@
+// Feeds the offline scoreboard (scoreboard.cpp) the gossip a field of devices
+// would send over a lossy link: replicas dropped, duplicated and delivered out
+// of order, relayed through other devices, and a new match started halfway.
+// Checks that the board ends up with exactly the counts the devices made,
+// that its own gossip stays within a round's budget, and the totals and
+// last-side-standing answers the firmware uses to end an offline match, and
+// that the game modes (game_mode.cpp) leave the decision to a connected server.
+//
+// Usage: scoreboard_bench [devices] [events]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "bench_check.h"
+#include "game_mode.h"
+#include "scoreboard.h"
+
+namespace
+{
+
+const uint8_t SELF_ID = 0;
+const int ROUND = 6; // ESPNOW_SCORE_PER_ROUND
+
+uint32_t s_rand = 777;
+
+uint32_t next_rand()
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return s_rand >> 8;
+}
+
+struct Gossip
+{
+    uint16_t epoch;
+    ScoreReplica replica;
+};
+
+// The other devices' own counters; device i plays player 10 + i / 2 (a weapon
+// and a target each) on team 1 + (i / 2) % 3
+std::vector<ScoreReplica> make_fleet(int devices)
+{
+    std::vector<ScoreReplica> fleet(devices);
+    for (int i = 1; i < devices; i++)
+        fleet[i] = {(uint8_t)i, (uint8_t)(10 + i / 2), (uint8_t)(1 + (i / 2) % 3), 0, 0, 0};
+    return fleet;
+}
+
+// Each event bumps one device's counter and gossips a snapshot of it; the
+// wire loses 20%, duplicates 5% and holds 30% back to deliver later
+void play(std::vector<ScoreReplica>& fleet, int events, uint16_t epoch, uint32_t* delivered)
+{
+    std::vector<Gossip> late;
+    for (int e = 0; e < events; e++)
+    {
+        ScoreReplica& r = fleet[1 + next_rand() % (fleet.size() - 1)];
+        switch (next_rand() % 3)
+        {
+            case 0:
+                r.kills++;
+                break;
+            case 1:
+                r.deaths++;
+                break;
+            default:
+                r.hits++;
+                break;
+        }
+        Gossip g = {epoch, r};
+        uint32_t roll = next_rand() % 100;
+        if (roll < 20)
+            continue;
+        if (roll < 50)
+        {
+            late.push_back(g);
+        }
+        else
+        {
+            scoreboard_merge(g.epoch, &g.replica);
+            (*delivered)++;
+        }
+        if (roll < 5)
+            scoreboard_merge(g.epoch, &g.replica);
+        if (!late.empty() && next_rand() % 4 == 0)
+        {
+            size_t k = next_rand() % late.size();
+            scoreboard_merge(late[k].epoch, &late[k].replica);
+            late.erase(late.begin() + k);
+            (*delivered)++;
+        }
+    }
+    for (const Gossip& g : late)
+        scoreboard_merge(g.epoch, &g.replica);
+
+    // Anti-entropy: every device's current state arrives in the end, some via a relay
+    for (size_t i = 1; i < fleet.size(); i++)
+        scoreboard_merge(epoch, &fleet[i]);
+}
+
+bool board_matches(const std::vector<ScoreReplica>& fleet, uint16_t self_kills)
+{
+    ScoreReplica out[SCOREBOARD_MAX_DEVICES];
+    uint16_t epoch;
+    int n = scoreboard_take_gossip(out, SCOREBOARD_MAX_DEVICES, true, &epoch);
+    if (n != (int)fleet.size())
+        return false;
+    for (int i = 0; i < n; i++)
+    {
+        const ScoreReplica& r = out[i];
+        if (r.device_id == SELF_ID)
+        {
+            if (r.kills != self_kills)
+                return false;
+            continue;
+        }
+        const ScoreReplica& t = fleet[r.device_id];
+        if (r.kills != t.kills || r.deaths != t.deaths || r.hits != t.hits || r.player_id != t.player_id ||
+            r.team_id != t.team_id)
+            return false;
+    }
+    return true;
+}
+
+void run_convergence(int devices, int events)
+{
+    std::vector<ScoreReplica> fleet = make_fleet(devices);
+    scoreboard_add(SCORE_KILL);
+    scoreboard_add(SCORE_KILL);
+
+    uint32_t delivered = 0;
+    play(fleet, events, scoreboard_epoch(), &delivered);
+    check(board_matches(fleet, 2), "converge", "board differs from the devices' counts");
+
+    // Stale gossip from before never lowers a counter
+    ScoreReplica stale = fleet[1];
+    stale.kills = 0;
+    check(!scoreboard_merge(scoreboard_epoch(), &stale), "converge", "stale replica changed the board");
+    check(board_matches(fleet, 2), "converge", "stale replica lowered a counter");
+
+    printf("converge: %d devices, %d events, %u gossip delivered in any order, board exact\n", devices, events,
+           delivered);
+}
+
+// Own gossip: everything that changed goes out, a round at a time
+void run_gossip_budget(int devices)
+{
+    ScoreReplica out[ROUND];
+    uint16_t epoch;
+    int rounds = 0, sent = 0, n;
+    while ((n = scoreboard_take_gossip(out, ROUND, false, &epoch)) > 0)
+    {
+        rounds++;
+        sent += n;
+    }
+    check(sent == 0, "gossip", "changes left after board_matches took them");
+
+    // One change: a delta round carries just that replica
+    ScoreReplica r = {3, 11, 2, 500, 500, 500};
+    scoreboard_merge(epoch, &r);
+    n = scoreboard_take_gossip(out, ROUND, false, &epoch);
+    check(n == 1 && out[0].device_id == 3, "gossip", "delta round is not just the changed replica");
+
+    // Anti-entropy rounds cycle through everything
+    bool seen[SCOREBOARD_MAX_DEVICES] = {};
+    int full_rounds = (devices + ROUND - 1) / ROUND;
+    for (int i = 0; i < full_rounds; i++)
+    {
+        n = scoreboard_take_gossip(out, ROUND, true, &epoch);
+        check(n <= ROUND, "gossip", "round over budget");
+        for (int k = 0; k < n; k++)
+            seen[out[k].device_id] = true;
+    }
+    int covered = 0;
+    for (int i = 0; i < devices; i++)
+        covered += seen[i] ? 1 : 0;
+    check(covered == devices, "gossip", "anti-entropy rounds missed replicas");
+    printf("gossip: delta round of 1, %d full rounds of <= %d cover all %d replicas\n", full_rounds, ROUND, devices);
+}
+
+void run_new_match(int devices, int events)
+{
+    uint16_t old_epoch = scoreboard_epoch();
+    uint16_t new_epoch = old_epoch + 1;
+    std::vector<ScoreReplica> fleet = make_fleet(devices);
+
+    // A peer started the next match: the board follows, old-match gossip is ignored
+    ScoreReplica old = {1, 10, 2, 999, 999, 999};
+    uint32_t delivered = 0;
+    play(fleet, events, new_epoch, &delivered);
+    check(scoreboard_epoch() == new_epoch, "new-match", "higher epoch not adopted");
+    check(!scoreboard_merge(old_epoch, &old), "new-match", "old-match gossip merged");
+    check(board_matches(fleet, 0), "new-match", "board not rebuilt from the new match");
+
+    // Totals: team sums are the sums of their players
+    ScoreTotals players[SCOREBOARD_MAX_DEVICES], teams[SCOREBOARD_MAX_DEVICES];
+    int np = scoreboard_totals(players, SCOREBOARD_MAX_DEVICES, false);
+    int nt = scoreboard_totals(teams, SCOREBOARD_MAX_DEVICES, true);
+    uint32_t pk = 0, tk = 0, fleet_kills = 0;
+    for (int i = 0; i < np; i++)
+        pk += players[i].kills;
+    for (int i = 0; i < nt; i++)
+        tk += teams[i].kills;
+    for (const ScoreReplica& r : fleet)
+        fleet_kills += r.kills;
+    check(pk == fleet_kills && tk == fleet_kills, "totals", "player or team totals do not add up");
+    check(nt == 3 || devices < 4, "totals", "expected three teams");
+    for (int i = 1; i < np; i++)
+        check(players[i - 1].id < players[i].id, "totals", "players not sorted by id");
+
+    // Last side standing: only team 1 stays under the death limit
+    uint32_t limit = 1;
+    for (const ScoreReplica& r : fleet)
+    {
+        if (r.deaths + 1u > limit)
+            limit = r.deaths + 1u;
+    }
+    for (size_t i = 1; i < fleet.size(); i++)
+    {
+        if (fleet[i].team_id != 1)
+        {
+            fleet[i].deaths = (uint16_t)limit;
+            scoreboard_merge(new_epoch, &fleet[i]);
+        }
+    }
+    int sides = 0;
+    int standing = scoreboard_sides_standing(limit, &sides);
+    // This device (player 0, no team) is a side of its own with no deaths
+    check(sides == nt + 1, "standing", "sides miscounted");
+    check(standing == 2, "standing", "only team 1 and this device should stand");
+    printf("new-match: epoch %u adopted, old gossip ignored; %d players, %d teams, %d of %d sides standing\n",
+           new_epoch, np, nt, standing, sides);
+}
+
+// Everyone else far past the target score and out of hearts: offline the
+// board ends both kinds of match, with a server connected neither
+void run_modes(int devices)
+{
+    std::vector<ScoreReplica> fleet = make_fleet(devices);
+    for (size_t i = 1; i < fleet.size(); i++)
+    {
+        fleet[i].kills = 1000;
+        fleet[i].deaths = 1000;
+        scoreboard_merge(scoreboard_epoch(), &fleet[i]);
+    }
+
+    GameConfig cfg = {};
+    cfg.kill_score = 1;
+    cfg.target_score = 100;
+    cfg.spawn_hearts = 5;
+    const GameModePolicy* score = game_mode_find("score");
+    const GameModePolicy* lms = game_mode_find("last_man_standing");
+    check(score && lms, "modes", "mode not found");
+    if (!score || !lms)
+        return;
+
+    GameStateData st = {};
+    check(score->is_over(&st, &cfg), "modes", "offline score match not ended from the board");
+    check(lms->is_over(&st, &cfg), "modes", "offline last man standing not ended from the board");
+    st.server_connected = true;
+    check(!score->is_over(&st, &cfg), "modes", "board ended a score match the server runs");
+    check(!lms->is_over(&st, &cfg), "modes", "board ended a last man standing match the server runs");
+    st.kills = cfg.target_score;
+    check(score->is_over(&st, &cfg), "modes", "own target score ignored with a server connected");
+    printf("modes: offline the board ends score and last man standing, with a server connected it does not\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int devices = argc > 1 ? atoi(argv[1]) : 24;
+    int events = argc > 2 ? atoi(argv[2]) : 20000;
+    if (devices < 4 || devices > SCOREBOARD_MAX_DEVICES)
+        devices = 24;
+
+    scoreboard_init(SELF_ID, 0, 0);
+    run_convergence(devices, events);
+    run_gossip_budget(devices);
+    run_new_match(devices, events / 4);
+    run_modes(devices);
+
+    return check_summary();
+}
@@ -0,0 +1,271 @@
+// Checks the multicast telemetry receiver against a simulated lossy network
+// (drops, reordering, duplicates, a device restart) and then over a real
+// multicast socket on the loopback interface, if the host allows it.
+//
+// Usage: telemetry_bench [messages per device]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "bench_check.h"
+#include "telemetry_rx.h"
+
+namespace
+{
+
+const int DEVICES = 4;
+const uint16_t BENCH_PORT = TELEMETRY_MCAST_PORT + 1; // keep clear of a real listener
+
+struct Datagram
+{
+    std::vector<uint8_t> data;
+    bool pinned = false; // not dropped or reordered (stream start and restart)
+};
+
+struct Sink
+{
+    uint32_t delivered[256] = {};
+    uint32_t last_seq[256] = {};
+    bool seen[256] = {};
+    uint32_t out_of_order = 0;
+    uint32_t lost = 0;
+    uint32_t bad_payload = 0;
+};
+
+uint32_t s_rand = 12345;
+
+uint32_t next_rand()
+{
+    s_rand = s_rand * 1103515245 + 12345;
+    return s_rand >> 8;
+}
+
+void on_message(void* ctx, uint8_t device_id, uint32_t seq, const WsMessage* msg)
+{
+    Sink* sink = (Sink*)ctx;
+    if (sink->seen[device_id] && seq <= sink->last_seq[device_id])
+        sink->out_of_order++;
+    // The hit report carries its own seq, so payloads can be matched to headers
+    if (msg->op != OP_HIT_REPORT || msg->hit_report.seq_id != seq)
+        sink->bad_payload++;
+    sink->seen[device_id] = true;
+    sink->last_seq[device_id] = seq;
+    sink->delivered[device_id]++;
+}
+
+void on_gap(void* ctx, uint8_t, uint32_t, uint32_t count)
+{
+    ((Sink*)ctx)->lost += count;
+}
+
+void on_restart(void* ctx, uint8_t device_id, uint32_t)
+{
+    ((Sink*)ctx)->seen[device_id] = false; // seq starts over
+}
+
+Datagram make_datagram(uint8_t device_id, uint32_t stream_id, uint32_t seq)
+{
+    TelemetryHeader hdr = {device_id, stream_id, seq};
+    WsHitReportMsg hit = {};
+    hit.timestamp_ms = seq * 10;
+    hit.shooter_id = (uint8_t)(seq % 32);
+    hit.seq_id = seq;
+
+    Datagram d;
+    d.data.resize(TELEMETRY_MAX_DATAGRAM);
+    int n = telemetry_frame_encode(&hdr, OP_HIT_REPORT, &hit, d.data.data(), d.data.size());
+    d.data.resize(n > 0 ? n : 0);
+    return d;
+}
+
+// Interleaved device streams with 2% loss, 5% swaps with a neighbour and 1%
+// duplicates; device 1 restarts halfway and some of its old datagrams straggle in.
+void run_simulated(int messages)
+{
+    std::vector<Datagram> wire;
+    uint32_t dropped = 0;
+    uint32_t sent = 0;
+
+    for (int i = 0; i < messages; i++)
+    {
+        for (int dev = 0; dev < DEVICES; dev++)
+        {
+            bool restarted = dev == 1 && i >= messages / 2;
+            uint32_t stream_id = restarted ? 0xB0070002 : 0xB0070001 + dev * 16;
+            uint32_t seq = restarted ? (uint32_t)(i - messages / 2) : (uint32_t)i;
+            // A loss at the end of a stream is only visible to a later datagram of it, and a
+            // datagram reordered before the first one looks like a late duplicate
+            bool pinned = i == 0 || i == messages - 1 || (dev == 1 && abs(i - messages / 2) <= 2);
+            sent++;
+            if (!pinned && next_rand() % 100 < 2)
+            {
+                dropped++;
+                continue;
+            }
+            wire.push_back(make_datagram((uint8_t)dev, stream_id, seq));
+            wire.back().pinned = pinned;
+            if (next_rand() % 100 < 1)
+                wire.push_back(wire.back());
+            if (dev == 1 && i == messages / 2 + 1)
+            {
+                wire.push_back(make_datagram(1, 0xB0070001 + 16, (uint32_t)(messages / 2 - 3)));
+                wire.back().pinned = true;
+            }
+        }
+    }
+    for (size_t i = 1; i + 1 < wire.size(); i++)
+    {
+        if (!wire[i].pinned && !wire[i + 1].pinned && next_rand() % 100 < 5)
+            std::swap(wire[i], wire[i + 1]);
+    }
+
+    Sink sink;
+    TelemetryRxConfig cfg = {};
+    cfg.ctx = &sink;
+    cfg.on_message = on_message;
+    cfg.on_gap = on_gap;
+    cfg.on_restart = on_restart;
+    TelemetryRx* rx = telemetry_rx_create(&cfg);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (const Datagram& d : wire)
+        telemetry_rx_feed(rx, d.data.data(), d.data.size(), 0);
+    telemetry_rx_expire(rx, 1000);
+    auto t1 = std::chrono::steady_clock::now();
+
+    TelemetryStreamStats stats[DEVICES];
+    int n = telemetry_rx_get_stats(rx, stats, DEVICES);
+    uint32_t delivered = 0, duplicates = 0, restarts = 0;
+    for (int i = 0; i < n; i++)
+    {
+        delivered += stats[i].delivered;
+        duplicates += stats[i].duplicates;
+        restarts += stats[i].restarts;
+    }
+
+    check(n == DEVICES, "simulated", "one stream per device");
+    check(sink.out_of_order == 0, "simulated", "messages out of order");
+    check(sink.bad_payload == 0, "simulated", "payload does not match its header");
+    check(delivered + sink.lost == sent, "simulated", "delivered + lost != sent");
+    check(sink.lost == dropped, "simulated", "gaps do not match the dropped datagrams");
+    check(restarts == 1 && stats[1].restarts == 1, "simulated", "device restart not detected");
+    check(telemetry_rx_malformed(rx) == 0, "simulated", "malformed datagrams");
+
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    printf("simulated: %u sent, %u delivered, %u lost (%u dropped), %u duplicates, %u restart, %.0f ns/datagram\n", sent,
+           delivered, sink.lost, dropped, duplicates, restarts, us * 1000 / wire.size());
+    telemetry_rx_destroy(rx);
+}
+
+// A missing datagram is given up on after reorder_ms, not only when the window fills
+void run_expiry()
+{
+    Sink sink;
+    TelemetryRxConfig cfg = {};
+    cfg.ctx = &sink;
+    cfg.on_message = on_message;
+    cfg.on_gap = on_gap;
+    cfg.reorder_ms = 50;
+    TelemetryRx* rx = telemetry_rx_create(&cfg);
+
+    Datagram d0 = make_datagram(7, 1, 0), d2 = make_datagram(7, 1, 2), d1 = make_datagram(7, 1, 1);
+    telemetry_rx_feed(rx, d0.data.data(), d0.data.size(), 1000);
+    telemetry_rx_feed(rx, d2.data.data(), d2.data.size(), 1010);
+    telemetry_rx_expire(rx, 1040);
+    check(sink.delivered[7] == 1 && sink.lost == 0, "expiry", "gap reported before reorder_ms");
+    telemetry_rx_expire(rx, 1060);
+    check(sink.delivered[7] == 2 && sink.lost == 1, "expiry", "gap not reported after reorder_ms");
+    telemetry_rx_feed(rx, d1.data.data(), d1.data.size(), 1070);
+    check(sink.delivered[7] == 2, "expiry", "late datagram delivered after its gap");
+
+    uint8_t junk[TELEMETRY_HEADER_SIZE + 4] = {'R', 'Z', 99};
+    check(!telemetry_rx_feed(rx, junk, sizeof(junk), 1080), "expiry", "foreign datagram accepted");
+
+    printf("expiry: gap after %u ms, late datagram dropped\n", cfg.reorder_ms);
+    telemetry_rx_destroy(rx);
+}
+
+// Real sockets: sender and receiver on 127.0.0.1 with multicast loopback
+void run_multicast(int messages)
+{
+    Sink sink;
+    TelemetryRxConfig cfg = {};
+    cfg.ctx = &sink;
+    cfg.on_message = on_message;
+    cfg.on_gap = on_gap;
+    TelemetryRx* rx = telemetry_rx_create(&cfg);
+    if (!telemetry_rx_join(rx, TELEMETRY_MCAST_GROUP, BENCH_PORT, "127.0.0.1"))
+    {
+        printf("multicast: skipped (cannot join %s on loopback)\n", TELEMETRY_MCAST_GROUP);
+        telemetry_rx_destroy(rx);
+        return;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    in_addr iface = {};
+    iface.s_addr = inet_addr("127.0.0.1");
+    unsigned char loop = 1, ttl = TELEMETRY_MCAST_TTL;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    sockaddr_in dest = {};
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(BENCH_PORT);
+    dest.sin_addr.s_addr = inet_addr(TELEMETRY_MCAST_GROUP);
+
+    std::thread sender([&]() {
+        for (int i = 0; i < messages; i++)
+        {
+            for (int dev = 0; dev < DEVICES; dev++)
+            {
+                Datagram d = make_datagram((uint8_t)dev, 0xCAFE0000 + dev, (uint32_t)i);
+                sendto(sock, d.data.data(), d.data.size(), 0, (sockaddr*)&dest, sizeof(dest));
+            }
+            if (i % 64 == 63)
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    uint32_t expected = (uint32_t)messages * DEVICES;
+    uint32_t delivered = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    while (delivered + sink.lost < expected)
+    {
+        int r = telemetry_rx_poll(rx, 500);
+        if (r <= 0)
+            break; // idle for 500 ms: the rest is lost
+        delivered += r;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    sender.join();
+    close(sock);
+
+    check(delivered > 0, "multicast", "nothing received");
+    check(sink.out_of_order == 0 && sink.bad_payload == 0, "multicast", "stream corrupted");
+    double s = std::chrono::duration<double>(t1 - t0).count();
+    printf("multicast: %u/%u delivered, %u reported lost, %.0f datagrams/s\n", delivered, expected, sink.lost,
+           delivered / (s > 0 ? s : 1));
+    telemetry_rx_destroy(rx);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int messages = argc > 1 ? atoi(argv[1]) : 20000;
+    if (messages < 16)
+        messages = 20000;
+
+    run_simulated(messages);
+    run_expiry();
+    run_multicast(messages / 4);
+
+    return check_summary();
+}
@@ -0,0 +1,171 @@
+// Round-trip check and size/CPU comparison of the JSON and binary WebSocket codecs.
+//
+// Usage: ws_codec_bench [iterations]
+// Exits non-zero if any message does not survive a round trip.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_check.h"
+#include "ws_codec.h"
+
+typedef struct
+{
+    const char* name;
+    WsMessage msg;
+} Sample;
+
+static void make_samples(Sample* out, int* count)
+{
+    int n = 0;
+
+    Sample* s = &out[n++];
+    s->name = "status";
+    s->msg.op = OP_STATUS;
+    WsStatusMsg* st = &s->msg.status;
+    st->uptime_ms = 1234567;
+    st->seq_id = 4242;
+    st->device_id = 7;
+    st->player_id = 3;
+    st->team_id = 1;
+    st->color_rgb = 0xFF8800;
+    strcpy(st->device_name, "Target-07");
+    st->enable_hearts = true;
+    st->max_hearts = 5;
+    st->spawn_hearts = 3;
+    st->respawn_time_s = 10;
+    st->friendly_fire = false;
+    st->enable_ammo = true;
+    st->max_ammo = 30;
+    st->reload_time_ms = 2500;
+    st->game_duration_s = 600;
+    st->shots = 151;
+    st->enemy_kills = 12;
+    st->friendly_kills = 1;
+    st->deaths = 4;
+    st->current_hearts = 3;
+    st->is_respawning = false;
+
+    s = &out[n++];
+    s->name = "hit_report";
+    s->msg.op = OP_HIT_REPORT;
+    s->msg.hit_report.timestamp_ms = 998877;
+    s->msg.hit_report.shooter_id = 12;
+    s->msg.hit_report.seq_id = 4243;
+
+    s = &out[n++];
+    s->name = "shot_fired";
+    s->msg.op = OP_SHOT_FIRED;
+    s->msg.shot_fired.timestamp_ms = 998900;
+    s->msg.shot_fired.seq_id = 4244;
+
+    s = &out[n++];
+    s->name = "game_command";
+    s->msg.op = OP_GAME_COMMAND;
+    s->msg.game_command.command = CMD_EXTEND_TIME;
+    s->msg.game_command.extend_minutes = 5;
+    s->msg.game_command.present = (1UL << WS_CMD_COMMAND) | (1UL << WS_CMD_EXTEND_MINUTES);
+
+    s = &out[n++];
+    s->name = "config_update";
+    s->msg.op = OP_CONFIG_UPDATE;
+    WsConfigUpdateMsg* cu = &s->msg.config_update;
+    strcpy(cu->device_name, "Weapon-02");
+    cu->player_id = 2;
+    cu->team_id = 1;
+    strcpy(cu->win_type, "score");
+    cu->target_score = 25;
+    cu->friendly_fire = true;
+    cu->players.count = 2;
+    cu->players.items[0].id = 1;
+    strcpy(cu->players.items[0].name, "Alice");
+    cu->players.items[1].id = 2;
+    strcpy(cu->players.items[1].name, "Bob");
+    cu->present = (1UL << WS_CFG_DEVICE_NAME) | (1UL << WS_CFG_PLAYER_ID) | (1UL << WS_CFG_TEAM_ID) |
+                  (1UL << WS_CFG_WIN_TYPE) | (1UL << WS_CFG_TARGET_SCORE) | (1UL << WS_CFG_FRIENDLY_FIRE) |
+                  (1UL << WS_CFG_PLAYERS);
+
+    s = &out[n++];
+    s->name = "heartbeat_ack";
+    s->msg.op = OP_HEARTBEAT_ACK;
+
+    *count = n;
+}
+
+static const void* body_of(const WsMessage* m)
+{
+    return &m->config_update;
+}
+
+// Two messages are equal if they produce the same binary encoding
+static bool same_message(const WsMessage* a, const WsMessage* b)
+{
+    uint8_t ea[1024], eb[1024];
+    int la = ws_codec_binary_encode(a->op, body_of(a), ea, sizeof(ea));
+    int lb = ws_codec_binary_encode(b->op, body_of(b), eb, sizeof(eb));
+    return a->op == b->op && la > 0 && la == lb && memcmp(ea, eb, la) == 0;
+}
+
+template <typename F> static double ns_per_op(int iterations, F fn)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+    if (iterations <= 0)
+        iterations = 100000;
+
+    Sample samples[8];
+    memset(samples, 0, sizeof(samples));
+    int count = 0;
+    make_samples(samples, &count);
+
+    printf("%-16s %8s %8s %12s %12s %12s %12s\n", "message", "bin B", "json B", "bin enc ns", "bin dec ns",
+           "json enc ns", "json dec ns");
+
+    for (int i = 0; i < count; i++)
+    {
+        const Sample* s = &samples[i];
+        uint8_t bin[1024];
+        WsMessage decoded;
+
+        int bin_len = ws_codec_binary_encode(s->msg.op, body_of(&s->msg), bin, sizeof(bin));
+        check(bin_len > 0, s->name, "binary encode");
+        check(bin_len > 0 && (size_t)bin_len <= ws_codec_binary_max_size(s->msg.op), s->name, "binary max size");
+        check(bin_len > 0 && ws_codec_binary_decode(bin, bin_len, &decoded) && same_message(&s->msg, &decoded),
+              s->name, "binary round trip");
+        for (int cut = 0; cut < bin_len; cut++)
+        {
+            // The presence mask fixes the frame length, so every truncation must fail
+            check(!ws_codec_binary_decode(bin, cut, &decoded), s->name, "truncated frame accepted");
+        }
+
+        double bin_enc = ns_per_op(iterations, [&]() { ws_codec_binary_encode(s->msg.op, body_of(&s->msg), bin, sizeof(bin)); });
+        double bin_dec = ns_per_op(iterations, [&]() { ws_codec_binary_decode(bin, bin_len, &decoded); });
+
+#ifdef RAYZ_HOST_HAVE_CJSON
+        char* json = ws_codec_json_encode(s->msg.op, body_of(&s->msg));
+        check(json != NULL, s->name, "json encode");
+        size_t json_len = json ? strlen(json) : 0;
+        check(json && ws_codec_json_decode((const uint8_t*)json, json_len, &decoded) && same_message(&s->msg, &decoded), s->name,
+              "json round trip");
+
+        double json_enc = ns_per_op(iterations / 10 + 1, [&]() { free(ws_codec_json_encode(s->msg.op, body_of(&s->msg))); });
+        double json_dec = ns_per_op(iterations / 10 + 1, [&]() { ws_codec_json_decode((const uint8_t*)json, json_len, &decoded); });
+        printf("%-16s %8d %8zu %12.1f %12.1f %12.1f %12.1f\n", s->name, bin_len, json_len, bin_enc, bin_dec, json_enc,
+               json_dec);
+        free(json);
+#else
+        printf("%-16s %8d %8s %12.1f %12.1f %12s %12s\n", s->name, bin_len, "-", bin_enc, bin_dec, "-", "-");
+#endif
+    }
+
+    return check_summary("all round trips OK");
+}
@@ -0,0 +1,533 @@
+// Runs the shared WebSocket server core on the POSIX transport and compares
+// send modes (queued/sync), native PING and the two codecs on one code path.
+// A second run stalls one client and checks that it gets evicted while the
+// others still receive every hit report. Further runs check topic filtering,
+// fragment reassembly and the oversize error reply, and dead peer detection.
+//
+// Usage: ws_server_bench [clients] [messages]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ws_server_core.h"
+#include "ws_transport_posix.h"
+
+namespace
+{
+
+struct Client
+{
+    int fd = -1;
+    std::thread reader;
+    std::atomic<uint32_t> messages{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint32_t> pings{0};
+    std::atomic<uint32_t> hits{0};
+    std::atomic<uint32_t> too_large{0}; // MESSAGE_TOO_LARGE error ACKs
+    std::atomic<bool> closed{false};
+};
+
+uint8_t frame_op(uint8_t opcode, const uint8_t* data, size_t len)
+{
+    if (opcode == 0x2)
+        return len >= 2 ? data[1] : 0;
+    std::string text((const char*)data, len);
+    size_t pos = text.find("\"op\":");
+    return pos == std::string::npos ? 0 : (uint8_t)atoi(text.c_str() + pos + 5);
+}
+
+bool send_masked(int fd, uint8_t opcode, const uint8_t* data, size_t len, bool fin = true)
+{
+    std::vector<uint8_t> f;
+    f.push_back((fin ? 0x80 : 0) | opcode);
+    if (len < 126)
+    {
+        f.push_back(0x80 | (uint8_t)len);
+    }
+    else
+    {
+        f.push_back(0x80 | 126);
+        f.push_back((uint8_t)(len >> 8));
+        f.push_back((uint8_t)len);
+    }
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    f.insert(f.end(), mask, mask + 4);
+    for (size_t i = 0; i < len; i++)
+        f.push_back(data[i] ^ mask[i % 4]);
+    return ::send(fd, f.data(), f.size(), MSG_NOSIGNAL) == (ssize_t)f.size();
+}
+
+void read_loop(Client* c)
+{
+    std::vector<uint8_t> rx;
+    uint8_t buf[8192];
+    while (true)
+    {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+            return;
+        rx.insert(rx.end(), buf, buf + n);
+        while (rx.size() >= 2)
+        {
+            uint8_t opcode = rx[0] & 0x0F;
+            size_t len = rx[1] & 0x7F;
+            size_t hdr = 2;
+            if (len == 126)
+            {
+                if (rx.size() < 4)
+                    break;
+                len = (size_t)rx[2] << 8 | rx[3];
+                hdr = 4;
+            }
+            else if (len == 127)
+            {
+                if (rx.size() < 10)
+                    break;
+                len = 0;
+                for (int i = 0; i < 8; i++)
+                    len = len << 8 | rx[2 + i];
+                hdr = 10;
+            }
+            if (rx.size() < hdr + len)
+                break;
+            if (opcode == 0x9)
+            {
+                c->pings++;
+                send_masked(c->fd, 0xA, rx.data() + hdr, len);
+            }
+            else if (opcode == 0x1 || opcode == 0x2)
+            {
+                c->messages++;
+                c->bytes += len;
+                uint8_t op = frame_op(opcode, rx.data() + hdr, len);
+                if (op == OP_HIT_REPORT)
+                    c->hits++;
+                if (op == OP_ACK && std::string((const char*)rx.data() + hdr, len).find("MESSAGE_TOO_LARGE") !=
+                                        std::string::npos)
+                    c->too_large++;
+            }
+            else if (opcode == 0x8)
+            {
+                c->closed = true;
+                return;
+            }
+            rx.erase(rx.begin(), rx.begin() + (long)(hdr + len));
+        }
+    }
+}
+
+// A stalled client never reads, with a receive buffer small enough to fill quickly
+bool connect_client(Client* c, uint16_t port, bool binary, bool stalled = false)
+{
+    c->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (stalled)
+    {
+        int rcvbuf = 4096;
+        setsockopt(c->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(c->fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+        return false;
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    std::string req = "GET /ws HTTP/1.1\r\n"
+                      "Host: localhost\r\n"
+                      "Upgrade: websocket\r\n"
+                      "Connection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                      "Sec-WebSocket-Version: 13\r\n";
+    if (binary)
+        req += std::string("Sec-WebSocket-Protocol: ") + WS_SUBPROTOCOL_BINARY + "\r\n";
+    req += "\r\n";
+    if (::send(c->fd, req.data(), req.size(), 0) != (ssize_t)req.size())
+        return false;
+
+    // Read the 101 response byte by byte so no frame data is consumed
+    std::string resp;
+    char ch;
+    while (resp.find("\r\n\r\n") == std::string::npos && recv(c->fd, &ch, 1, 0) == 1)
+        resp += ch;
+    if (resp.compare(0, 12, "HTTP/1.1 101") != 0)
+        return false;
+    if (!stalled)
+        c->reader = std::thread(read_loop, c);
+    return true;
+}
+
+void disconnect_client(Client* c)
+{
+    send_masked(c->fd, 0x8, NULL, 0);
+    if (c->reader.joinable())
+        c->reader.join();
+    close(c->fd);
+}
+
+void wait_for_clients(int expected)
+{
+    for (int i = 0; i < 200 && ws_core_client_count() != expected; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+
+// Mirrors the OP_SUBSCRIBE handling of ws_server.cpp (not built on the host)
+void dispatch(int fd, const WsMessage* msg)
+{
+    if (msg->op == OP_SUBSCRIBE)
+    {
+        ws_core_set_topics(fd, msg->subscribe.topics);
+        ws_core_send_message(fd, OP_HEARTBEAT_ACK, NULL);
+    }
+}
+
+// Deepest send queue among connected clients
+int max_queue_depth(void)
+{
+    WsClientStats stats[8];
+    int n = ws_core_get_client_stats(stats, 8);
+    int depth = 0;
+    for (int i = 0; i < n; i++)
+        depth = stats[i].queue_depth > depth ? stats[i].queue_depth : depth;
+    return depth;
+}
+
+// 3 healthy clients + 1 stalled one; status at 200 Hz, hit reports at 5 Hz
+bool run_stalled(uint16_t port)
+{
+    WsServerOptions opts = {};
+    ws_core_set_options(&opts);
+
+    std::vector<Client> clients(4);
+    bool ok = true;
+    for (int i = 0; i < 4; i++)
+        ok = ok && connect_client(&clients[i], port, false, i == 3);
+    wait_for_clients(4);
+    if (!ok || ws_core_client_count() != 4)
+        return false;
+
+    WsStatusMsg status = {};
+    WsHitReportMsg hit = {};
+    uint32_t hits_sent = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    double evicted_at = -1;
+    for (int tick = 0; tick < 2000; tick++) // 10 s max
+    {
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (evicted_at < 0 && ws_core_client_count() == 3)
+            evicted_at = t;
+        if (evicted_at >= 0 && t > evicted_at + 1.0)
+            break;
+        ws_core_broadcast_message(OP_STATUS, &status);
+        if (tick % 40 == 0)
+        {
+            hit.seq_id = hits_sent++;
+            ws_core_broadcast_message(OP_HIT_REPORT, &hit);
+        }
+        if (tick % 20 == 0)
+            ws_core_cleanup_stale();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    for (int w = 0; w < 2000 && max_queue_depth() > 0; w++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    WsClientStats stats[8];
+    int n = ws_core_get_client_stats(stats, 8);
+    uint32_t max_latency = 0, dropped = 0, coalesced = 0;
+    for (int i = 0; i < n; i++)
+    {
+        max_latency = stats[i].latency_max_us > max_latency ? stats[i].latency_max_us : max_latency;
+        dropped += stats[i].dropped;
+        coalesced += stats[i].coalesced;
+    }
+
+    bool all_hits = true;
+    for (int i = 0; i < 3; i++)
+        all_hits = all_hits && clients[i].hits.load() == hits_sent;
+    printf("stalled client: evicted after %.2f s, %d clients left, %u/%u hits delivered to each healthy client\n",
+           evicted_at, n, clients[0].hits.load(), hits_sent);
+    printf("healthy clients: max latency %.1f ms, %u dropped, %u status coalesced\n", max_latency / 1000.0, dropped,
+           coalesced);
+
+    for (int i = 0; i < 3; i++)
+        disconnect_client(&clients[i]);
+    close(clients[3].fd);
+    wait_for_clients(0);
+    return evicted_at >= 0 && n == 3 && all_hits;
+}
+
+double cpu_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// One default client and one subscribed to hits only: shots must not reach the latter
+bool run_topics(uint16_t port)
+{
+    std::vector<Client> clients(2);
+    if (!connect_client(&clients[0], port, true) || !connect_client(&clients[1], port, false))
+        return false;
+    wait_for_clients(2);
+
+    char sub[64];
+    int len = snprintf(sub, sizeof(sub), "{\"op\":%d,\"type\":\"subscribe\",\"topics\":%u}", OP_SUBSCRIBE,
+                       (unsigned)WS_TOPIC_HITS);
+    send_masked(clients[1].fd, 0x1, (const uint8_t*)sub, (size_t)len);
+    for (int w = 0; w < 1000 && clients[1].messages.load() == 0; w++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    WsShotFiredMsg shot = {};
+    WsHitReportMsg hit = {};
+    const int shots = 200, hits = 10;
+    int shot_recipients = 0;
+    for (int i = 0; i < shots; i++)
+    {
+        shot_recipients += ws_core_broadcast_message(OP_SHOT_FIRED, &shot);
+        if (i % (shots / hits) == 0)
+            ws_core_broadcast_message(OP_HIT_REPORT, &hit);
+        while (max_queue_depth() >= 4)
+            std::this_thread::yield();
+    }
+    for (int w = 0; w < 2000 && clients[0].messages.load() < (uint32_t)(shots + hits); w++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // Client 1 also got the subscribe reply
+    bool ok = clients[0].messages.load() == (uint32_t)(shots + hits) &&
+              clients[1].messages.load() == (uint32_t)(hits + 1) && clients[1].hits.load() == (uint32_t)hits &&
+              shot_recipients == shots;
+    printf("topics: default client %u frames, hits-only client %u frames (%u hits)\n", clients[0].messages.load(),
+           clients[1].messages.load(), clients[1].hits.load());
+
+    for (auto& c : clients)
+        disconnect_client(&c);
+    wait_for_clients(0);
+    return ok;
+}
+
+// Sends a text message as two fragments
+void send_fragmented(int fd, const std::string& text)
+{
+    size_t half = text.size() / 2;
+    send_masked(fd, 0x1, (const uint8_t*)text.data(), half, false);
+    send_masked(fd, 0x0, (const uint8_t*)text.data() + half, text.size() - half);
+}
+
+// With a 512 byte limit a fragmented 400 byte message is reassembled and
+// dispatched, a 600 byte one gets an error ACK and a CLOSE
+bool run_oversize(uint16_t port)
+{
+    WsServerOptions opts = {};
+    opts.max_message_size = 512;
+    ws_core_set_options(&opts);
+
+    Client c;
+    if (!connect_client(&c, port, false))
+        return false;
+    wait_for_clients(1);
+
+    char sub[64];
+    snprintf(sub, sizeof(sub), "{\"op\":%d,\"type\":\"subscribe\",\"topics\":%u}", OP_SUBSCRIBE,
+             (unsigned)WS_TOPIC_DEFAULT);
+    std::string fits = std::string(sub) + std::string(400 - strlen(sub), ' ');
+    send_fragmented(c.fd, fits);
+    for (int w = 0; w < 1000 && c.messages.load() == 0; w++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    bool reassembled = c.messages.load() == 1;
+
+    std::string too_big = std::string(sub) + std::string(600 - strlen(sub), ' ');
+    send_fragmented(c.fd, too_big);
+    if (c.reader.joinable())
+        c.reader.join();
+    close(c.fd);
+    wait_for_clients(0);
+
+    bool ok = reassembled && c.too_large.load() == 1 && c.closed.load() && ws_core_client_count() == 0;
+    printf("oversize: fragmented 400 B %s, 600 B got %u error ACKs, %s\n", reassembled ? "dispatched" : "LOST",
+           c.too_large.load(), c.closed.load() ? "closed" : "NOT closed");
+
+    opts.max_message_size = 0;
+    ws_core_set_options(&opts);
+    return ok;
+}
+
+// One client answers PINGs, the other never reads: only the latter must go,
+// within the dead peer window plus one cleanup period
+bool run_liveness(uint16_t port)
+{
+    WsServerOptions opts = {};
+    opts.dead_peer_ms = 600;
+    ws_core_set_options(&opts);
+
+    Client alive, mute;
+    if (!connect_client(&alive, port, true) || !connect_client(&mute, port, false, true))
+        return false;
+    wait_for_clients(2);
+
+    auto t0 = std::chrono::steady_clock::now();
+    double evicted_after = -1;
+    while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(1500))
+    {
+        ws_core_cleanup_stale();
+        if (evicted_after < 0 && ws_core_client_count() == 1)
+            evicted_after = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    WsClientStats stats[2];
+    int n = ws_core_get_client_stats(stats, 2);
+    bool ok = n == 1 && evicted_after > 0 && evicted_after < 0.7 && stats[0].pongs > 0 && stats[0].rtt_avg_us > 0;
+    printf("liveness: mute client evicted after %.2f s, live client %lu pongs, rtt avg %lu us max %lu us\n",
+           evicted_after, n == 1 ? (unsigned long)stats[0].pongs : 0UL,
+           n == 1 ? (unsigned long)stats[0].rtt_avg_us : 0UL, n == 1 ? (unsigned long)stats[0].rtt_max_us : 0UL);
+
+    disconnect_client(&alive);
+    close(mute.fd);
+    wait_for_clients(0);
+    opts.dead_peer_ms = 0;
+    ws_core_set_options(&opts);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int client_count = argc > 1 ? atoi(argv[1]) : 4;
+    int messages = argc > 2 ? atoi(argv[2]) : 20000;
+    if (client_count <= 0 || client_count > 8)
+        client_count = 4;
+    if (messages <= 0)
+        messages = 20000;
+
+    uint16_t port = 0;
+    const WsTransport* transport = ws_transport_posix_start(0, &port);
+    if (!transport)
+    {
+        fprintf(stderr, "failed to start transport\n");
+        return 1;
+    }
+
+    WsCoreConfig cfg = {};
+    cfg.transport = transport;
+    cfg.dispatch = dispatch;
+    ws_core_init(&cfg);
+
+    printf("%d clients, %d hit_report broadcasts per run\n", client_count, messages);
+    printf("%-7s %-6s %-5s %10s %10s %10s %8s\n", "codec", "send", "ping", "msg/s", "wire KB", "cpu ms", "pings");
+
+    int failures = 0;
+    for (int binary = 0; binary <= 1; binary++)
+    {
+        for (int sync = 0; sync <= 1; sync++)
+        {
+            for (int ping = 0; ping <= 1; ping++)
+            {
+                WsServerOptions opts = {};
+                opts.sync_send = sync;
+                opts.json_heartbeat_only = !ping;
+                opts.dead_peer_ms = ping ? 300 : 0; // PING every 100 ms
+                ws_core_set_options(&opts);
+
+                std::vector<Client> clients(client_count);
+                bool ok = true;
+                for (auto& c : clients)
+                    ok = ok && connect_client(&c, port, binary);
+                wait_for_clients(client_count);
+                ok = ok && ws_core_client_count() == client_count;
+
+                double cpu0 = cpu_ms();
+                auto t0 = std::chrono::steady_clock::now();
+                WsHitReportMsg hit = {};
+                for (int i = 0; ok && i < messages; i++)
+                {
+                    hit.timestamp_ms = (uint32_t)i;
+                    hit.shooter_id = (uint8_t)(i & 31);
+                    hit.seq_id = (uint32_t)i;
+                    ws_core_broadcast_message(OP_HIT_REPORT, &hit);
+                    if (ping && i % 1000 == 0)
+                        ws_core_cleanup_stale();
+                    // Hit reports are never dropped, so keep the queues short
+                    // instead of getting clients evicted
+                    while (!sync && max_queue_depth() >= 4)
+                        std::this_thread::yield();
+                }
+
+                // Wait until every client has everything (or give up after 10 s)
+                bool complete = false;
+                for (int w = 0; ok && !complete && w < 10000; w++)
+                {
+                    complete = true;
+                    for (auto& c : clients)
+                        complete = complete && c.messages.load() >= (uint32_t)messages;
+                    if (!complete)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                double cpu = cpu_ms() - cpu0;
+
+                uint64_t bytes = 0;
+                uint32_t pings = 0;
+                for (auto& c : clients)
+                {
+                    bytes += c.bytes.load();
+                    pings += c.pings.load();
+                    disconnect_client(&c);
+                }
+                wait_for_clients(0);
+
+                if (!ok || !complete)
+                {
+                    fprintf(stderr, "FAIL codec=%s sync=%d ping=%d\n", binary ? "binary" : "json", sync, ping);
+                    failures++;
+                    continue;
+                }
+                printf("%-7s %-6s %-5s %10.0f %10.1f %10.1f %8u\n", binary ? "binary" : "json", sync ? "sync" : "queued",
+                       ping ? "on" : "off", messages / secs, bytes / 1024.0, cpu, pings);
+            }
+        }
+    }
+
+    if (!run_stalled(port))
+    {
+        fprintf(stderr, "FAIL stalled client scenario\n");
+        failures++;
+    }
+
+    if (!run_topics(port))
+    {
+        fprintf(stderr, "FAIL topic scenario\n");
+        failures++;
+    }
+
+    if (!run_oversize(port))
+    {
+        fprintf(stderr, "FAIL oversize scenario\n");
+        failures++;
+    }
+
+    if (!run_liveness(port))
+    {
+        fprintf(stderr, "FAIL liveness scenario\n");
+        failures++;
+    }
+
+    ws_transport_posix_stop();
+    return failures ? 1 : 0;
+}
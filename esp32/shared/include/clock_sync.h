@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MATCH CLOCK
+    // ============================================================================
+    // Each device keeps a match clock: its own esp_timer uptime corrected by an
+    // offset and a skew estimated against a reference, so that timestamps taken
+    // on different devices (and by the server) can be compared directly. The
+    // reference is the server's millisecond clock (TIME_SYNC over WebSocket);
+    // devices without a server follow a peer that has one (clock beacons over
+    // ESP-NOW), one stratum further away. A fleet with no server at all settles
+    // on the lowest device_id as its root.
+    //
+    // Samples come from a four-timestamp exchange (NTP style):
+    //   offset = ((t2 - t1) + (t3 - t4)) / 2   match - local
+    //   delay  = (t4 - t1) - (t3 - t2)         round trip without the hold time
+    // The estimator keeps the lowest-delay sample of the last few (queueing only
+    // ever adds delay and asymmetry) and fits the skew over the accepted ones.
+
+#define CLOCK_SYNC_STRATUM_SERVER 1
+#define CLOCK_SYNC_STRATUM_MAX    14 // furthest peer hop that still leads back to a server
+#define CLOCK_SYNC_STRATUM_FREE   15 // no server in reach: free-running, lowest device_id wins
+#define CLOCK_SYNC_NO_DEVICE      0xFF
+
+#define CLOCK_SYNC_SERVER_TIMEOUT_MS 30000 // server source given up after this long without a sample
+#define CLOCK_SYNC_PEER_TIMEOUT_MS   10000 // peer source given up after this long without a sample
+
+    typedef enum
+    {
+        CLOCK_SRC_NONE = 0, // free-running on the last estimate (holdover)
+        CLOCK_SRC_SERVER,   // WebSocket TIME_SYNC, ref_id is the client fd
+        CLOCK_SRC_PEER,     // ESP-NOW clock beacon, ref_id is the peer device_id
+    } ClockSyncSource;
+
+    typedef struct
+    {
+        ClockSyncSource source; // CLOCK_SRC_NONE once the source timed out
+        uint8_t stratum;        // what this device advertises
+        int ref_id;             // fd or device_id of the source
+        int64_t offset_us;      // match - local at the last accepted sample
+        int32_t skew_ppb;       // match clock rate relative to the local clock
+        uint32_t delay_us;      // round trip of the sample in use
+        uint32_t samples;       // accepted since the source was selected
+        uint32_t rejected;      // samples from sources that lost the selection
+        uint32_t age_ms;        // since the last accepted sample
+    } ClockSyncStatus;
+
+    /**
+     * @brief Set up the estimator (idempotent; call again when the device_id changes)
+     * @param device_id This device, used to break ties between free-running peers
+     */
+    void clock_sync_init(uint8_t device_id);
+
+    uint8_t clock_sync_device_id(void);
+
+    /**
+     * @brief Feed one completed exchange
+     *
+     * The sample is used if it comes from the current source or from a better
+     * one (lower stratum, or equal stratum and lower device_id); a switch
+     * restarts the filter but keeps the skew.
+     * @param source CLOCK_SRC_SERVER or CLOCK_SRC_PEER
+     * @param ref_id Client fd or peer device_id
+     * @param ref_stratum Stratum the peer advertised (ignored for the server)
+     * @param offset_us match - local
+     * @param delay_us Round trip without the peer's hold time
+     * @param local_us esp_timer time the sample was taken (t4)
+     * @return true if the sample was accepted
+     */
+    bool clock_sync_add_sample(ClockSyncSource source, int ref_id, uint8_t ref_stratum, int64_t offset_us,
+                               int64_t delay_us, int64_t local_us);
+
+    /**
+     * @brief Would samples from this peer be used (it is the source, or would replace it)?
+     *
+     * Lets a device ask a better peer for exchanges before it has any samples from it.
+     */
+    bool clock_sync_accepts_peer(uint8_t device_id, uint8_t stratum);
+
+    /**
+     * @brief Match time in microseconds for an esp_timer timestamp
+     */
+    int64_t clock_sync_match_us_at(int64_t local_us);
+
+    /**
+     * @brief Match time now, in the server's milliseconds (wraps after ~49 days)
+     */
+    uint32_t clock_sync_match_ms(void);
+
+    /**
+     * @brief Stratum to advertise now (CLOCK_SYNC_STRATUM_FREE after the source timed out)
+     */
+    uint8_t clock_sync_stratum(void);
+
+    /**
+     * @brief The peer currently followed, or CLOCK_SYNC_NO_DEVICE
+     */
+    uint8_t clock_sync_ref_device(void);
+
+    void clock_sync_get_status(ClockSyncStatus* out);
+
+#ifdef __cplusplus
+}
+#endif
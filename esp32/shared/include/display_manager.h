@@ -1,6 +1,7 @@
 #pragma once
 #include <lvgl.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -70,6 +71,15 @@ extern "C"
         };
     } dm_event_t;
 
+    typedef struct
+    {
+        int hearts;
+        int max_hearts;
+        int kills;
+        int deaths;
+        int shots;
+    } dm_game_stats_t;
+
     typedef struct
     {
         // "pull" callbacks so DM doesn't depend on your modules directly
@@ -92,6 +102,7 @@ extern "C"
         uint32_t (*last_rx_ms_ago)(void);
         uint32_t (*rx_count)(void);
         uint32_t (*tx_count)(void);
+        int (*players_on_field)(void); // other devices in range, from presence beacons
 
         // target-specific
         int (*hit_count)(void);
@@ -105,8 +116,12 @@ extern "C"
         uint32_t (*respawn_time_left)(void);
         bool (*is_respawning)(void);
 
-        // Player name lookup (returns NULL if unknown)
-        const char* (*player_name)(uint8_t player_id);
+        // Player name lookup: copies the name, false if unknown
+        bool (*player_name)(uint8_t player_id, char* out, size_t len);
+
+        // Game counters in one consistent read; preferred over the single
+        // callbacks above when set
+        void (*game_stats)(dm_game_stats_t* out);
     } dm_sources_t;
 
     bool display_manager_init(lv_disp_t* disp, const dm_sources_t* src);
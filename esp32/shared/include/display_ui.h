@@ -141,7 +141,8 @@ extern "C"
                                int ammo,
                                bool wifi, bool ws, int rssi,
                                int player_id, int device_id,
-                               int kills, int shots);
+                               int kills, int shots,
+                               int on_field); // -1 = unknown
 
     void ui_respawn_update(ui_respawn_t* w,
                            uint32_t remaining_ms, uint32_t total_ms,
@@ -16,6 +16,9 @@ typedef enum : uint8_t
     ESPNOW_MSG_SHOT = 0,
     ESPNOW_MSG_HIT_EVENT,
     ESPNOW_MSG_HEARTBEAT,
+    ESPNOW_MSG_ACK,      // device_id = acknowledging device, seq = acknowledged seq
+    ESPNOW_MSG_PRESENCE, // sender's player_id, team_id, color_rgb; data = beacon period ms
+    ESPNOW_MSG_SCORE,    // EspnowScoreGossip
 } EspnowMsgType;
 
 typedef struct __attribute__((packed))
@@ -25,16 +28,67 @@ typedef struct __attribute__((packed))
     uint8_t player_id;
     uint8_t device_id;
     uint8_t team_id;
-    uint8_t reserved;
+    uint8_t seq;           // reliable delivery sequence per sender, 0 = unreliable
     uint32_t color_rgb;
-    uint32_t timestamp_ms;
+    uint32_t timestamp_ms; // sender match clock (clock_sync.h)
     uint32_t data;
 } PlayerMessage;
 
+// ESPNOW_MSG_HEARTBEAT body: the sender's match clock (clock_sync.h), with an
+// echo of one follower's last beacon so that follower can complete an exchange.
+typedef struct __attribute__((packed))
+{
+    EspnowMsgType type;     // ESPNOW_MSG_HEARTBEAT
+    uint8_t version;
+    uint8_t device_id;
+    uint8_t stratum;        // CLOCK_SYNC_STRATUM_*
+    uint8_t ref_device_id;  // peer the sender follows or asks to, CLOCK_SYNC_NO_DEVICE if none
+    uint8_t echo_device_id; // follower answered below, CLOCK_SYNC_NO_DEVICE if none
+    uint32_t match_ms;      // sender match time at transmission (t3)
+    uint16_t match_frac_us; // sub-millisecond part of match_ms
+    uint16_t echo_tag;      // low 16 bits of the follower's match_ms, identifies its beacon (t1)
+    uint32_t echo_hold_us;  // from receiving that beacon to sending this one (t3 - t2)
+} EspnowClockBeacon;
+
+// ESPNOW_MSG_SCORE body: one device's counters on the offline scoreboard
+// (scoreboard.h). A gossip round is a few of these in one aggregated frame.
+typedef struct __attribute__((packed))
+{
+    EspnowMsgType type; // ESPNOW_MSG_SCORE
+    uint8_t version;
+    uint16_t epoch;     // match the counters belong to
+    uint8_t sender_id;  // device that gossiped them
+    uint8_t device_id;  // device that counted them
+    uint8_t player_id;
+    uint8_t team_id;
+    uint16_t kills;
+    uint16_t deaths;
+    uint16_t hits;
+    uint8_t reserved[4];
+} EspnowScoreGossip;
+
+// Several messages in one ESP-NOW frame: this header, then count PlayerMessages.
+// A frame of exactly sizeof(PlayerMessage) bytes is one message without header,
+// which is also what a batch of one is sent as.
+#define ESPNOW_FRAME_MAGIC   0xB7
+#define ESPNOW_FRAME_VERSION 1
+
+typedef struct __attribute__((packed))
+{
+    uint8_t magic;   // ESPNOW_FRAME_MAGIC
+    uint8_t version; // ESPNOW_FRAME_VERSION
+    uint8_t count;   // PlayerMessages that follow
+    uint8_t flags;   // reserved, 0
+} EspnowFrameHeader;
+
+#define ESPNOW_FRAME_MAX_MESSAGES ((ESP_NOW_MAX_DATA_LEN - sizeof(EspnowFrameHeader)) / sizeof(PlayerMessage))
+
 typedef struct
 {
     PlayerMessage msg;
     uint8_t src_mac[ESP_NOW_ETH_ALEN];
+    int64_t rx_us; // esp_timer time of reception
+    int8_t rssi;   // dBm
 } EspnowMessageEnvelope;
 
 typedef struct
@@ -42,8 +96,14 @@ typedef struct
     uint8_t channel;   // 0 = keep current Wi-Fi channel, otherwise lock to specific channel
     bool prefer_wifi;  // Set coexistence preference towards Wi-Fi if true
     bool set_pmk;      // Configure PMK to a non-zero key (recommended)
+    uint8_t device_id; // This device: reliable messages addressed to it are acknowledged
+    uint16_t batch_window_ms; // Hold messages this long to share a frame, 0 = one frame each
 } EspnowCommConfig;
 
+// Batching adds at most this much latency; peers on firmware without
+// aggregated frames need batch_window_ms = 0.
+#define ESPNOW_BATCH_WINDOW_MS 4
+
 // Initialise ESP-NOW (idempotent).
 esp_err_t espnow_comm_init(const EspnowCommConfig* config);
 
@@ -56,16 +116,127 @@ void espnow_comm_clear_peers(void);
 uint8_t espnow_comm_peer_count(void);
 esp_err_t espnow_comm_load_peers_from_csv(const char* csv_list); // "aa:bb:cc...,11:22:33..."
 
-// Send helpers.
+// Send helpers. With batching on, messages for the same destination are packed
+// into one frame sent when the window runs out or the frame is full.
 bool espnow_comm_send(const uint8_t mac[ESP_NOW_ETH_ALEN], const PlayerMessage* msg);
 bool espnow_comm_broadcast(const PlayerMessage* msg); // Broadcast to all peers
 
-// Receive queue helpers.
-QueueHandle_t espnow_comm_queue(void);
+// Unicast to the MAC learned for device_id (see the peer table below), which
+// gets link-layer ACKs and retries; broadcast while the MAC is unknown.
+bool espnow_comm_send_to_device(uint8_t device_id, const PlayerMessage* msg);
+
+// Reliable delivery: msg is sent to msg->device_id with a sequence number and
+// repeated with backoff until that device acknowledges it, up to
+// ESPNOW_RELIABLE_MAX_TRIES sends. Receivers drop the repeats.
+#define ESPNOW_RELIABLE_MAX_TRIES 5
+#define ESPNOW_RELIABLE_RTO_MS    30 // first retransmission; doubles after each
+
+bool espnow_comm_send_reliable(const PlayerMessage* msg); // false if no slot is free
+
+typedef struct
+{
+    uint32_t sent;        // messages handed to espnow_comm_send_reliable
+    uint32_t retransmits;
+    uint32_t acked;
+    uint32_t failed;      // gave up after ESPNOW_RELIABLE_MAX_TRIES
+    uint32_t duplicates;  // repeats dropped on receive
+} EspnowReliableStats;
+
+void espnow_comm_get_reliable_stats(EspnowReliableStats* out);
+
+typedef struct
+{
+    uint32_t frames_tx;
+    uint32_t messages_tx;
+    uint32_t frames_rx;
+    uint32_t messages_rx;
+    uint32_t rx_dropped; // malformed frames
+} EspnowFrameStats;
+
+void espnow_comm_get_frame_stats(EspnowFrameStats* out);
+
+// Peer table: device_id -> MAC, learned from frames whose device_id is their
+// sender (SHOT, clock beacons, ACKs). Indexed by device_id.
+#define ESPNOW_PEER_STALE_MS 60000 // older entries are not used for unicast
+
+typedef struct
+{
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    int8_t rssi;           // last frame received, dBm
+    uint32_t last_seen_ms; // esp_timer ms of that frame, 0 = never heard
+    uint32_t rx_frames;
+    uint32_t tx_ok;        // unicast frames the peer acknowledged at the link layer
+    uint32_t tx_failed;    // unicast frames lost after the radio's own retries
+} EspnowPeerInfo;
+
+// false if nothing was ever heard from device_id
+bool espnow_comm_get_peer_info(uint8_t device_id, EspnowPeerInfo* out);
+
+// Received messages wait in one queue per lane, so a burst of SHOTs cannot
+// crowd out a hit confirmation. espnow_comm_receive drains the lanes in order.
+typedef enum
+{
+    ESPNOW_LANE_HIT = 0, // HIT_EVENT, ACK
+    ESPNOW_LANE_CONTROL, // everything not listed here
+    ESPNOW_LANE_SHOT,    // SHOT
+    ESPNOW_LANE_BEACON,  // HEARTBEAT, PRESENCE
+    ESPNOW_LANE_COUNT
+} EspnowRxLane;
+
+// Checked in the receive callback, before a message takes a queue slot.
+// Dropped messages do not reach the peer table either.
+typedef enum
+{
+    ESPNOW_RX_ACCEPT = 0,
+    ESPNOW_RX_DROP,
+    ESPNOW_RX_TO_SELF, // only if msg.device_id is this device
+} EspnowRxFilter;
+
+// Default is ESPNOW_RX_ACCEPT for every type; call before or after init.
+void espnow_comm_set_rx_filter(EspnowMsgType type, EspnowRxFilter filter);
+
+// Filters shared by the weapon and target roles: other players' shots are
+// dropped, hit events are kept only when addressed to this device, and clock
+// beacons, ACKs, presence beacons and score gossip are all accepted.
+void espnow_comm_set_default_filters(void);
+
+typedef struct
+{
+    uint32_t filtered;                     // dropped by the filter table
+    uint32_t overflow[ESPNOW_LANE_COUNT];  // dropped because the lane was full
+} EspnowRxStats;
+
+void espnow_comm_get_rx_stats(EspnowRxStats* out);
+
+// Receive queue helpers. espnow_comm_receive acknowledges reliable messages
+// addressed to this device and consumes ACKs, repeats and presence beacons itself.
+QueueHandle_t espnow_comm_queue(EspnowRxLane lane);
 bool espnow_comm_receive(EspnowMessageEnvelope* out, TickType_t ticks_to_wait);
 
 uint8_t espnow_comm_hash_id(const char* id);
 
+// Clock beacons (ESPNOW_MSG_HEARTBEAT) for devices without a server connection.
+#define ESPNOW_CLOCK_BEACON_MS 2000
+
+// Broadcast a clock beacon if ESPNOW_CLOCK_BEACON_MS has passed; call from the receive loop.
+void espnow_comm_clock_poll(void);
+
+// Feed a received ESPNOW_MSG_HEARTBEAT to the match clock.
+void espnow_comm_clock_on_beacon(const EspnowMessageEnvelope* env);
+
+// Broadcast a presence beacon (presence.h) when its jittered period has passed;
+// call from the receive loop.
+void espnow_comm_presence_poll(uint8_t player_id, uint8_t team_id, uint32_t color_rgb);
+
+// Scoreboard gossip: changed counters go out within ESPNOW_SCORE_DELTA_MS, and
+// every ESPNOW_SCORE_ROUND_MS a round also carries unchanged ones. At most
+// ESPNOW_SCORE_PER_ROUND replicas per round; call from the receive loop, which
+// must not block for longer than ESPNOW_SCORE_DELTA_MS.
+#define ESPNOW_SCORE_DELTA_MS  250
+#define ESPNOW_SCORE_ROUND_MS  3000
+#define ESPNOW_SCORE_PER_ROUND 6
+void espnow_comm_score_poll(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // GAME MODES
+    // ============================================================================
+    // Everything that differs between win types, as one table per mode. The
+    // table is looked up from GameConfig.win_type once, when a config version
+    // is committed, and game_state calls through it from the tick and the hit
+    // path; win_type itself is only compared here, at the protocol boundary.
+    // A new mode (capture the flag, domination, gun game) is a new table in
+    // game_mode.cpp and an entry in its list.
+
+    typedef struct
+    {
+        const char* win_type; // protocol name
+
+        /**
+         * @brief Match length at start, 0 for a match that only ends on a win
+         */
+        uint32_t (*duration_ms)(const GameConfig* cfg);
+
+        /**
+         * @brief Hearts at match start, or -1 to keep the current count
+         */
+        int (*start_hearts)(const GameConfig* cfg);
+
+        bool (*can_shoot)(const GameStateData* st);
+        bool (*can_take_damage)(const GameStateData* st);
+
+        /**
+         * @brief Win check, called with the state locked
+         *
+         * Runs whenever this device's kills, hits or deaths change, and from
+         * game_state_tick() for wins seen in gossip. May update derived fields
+         * such as player_score.
+         * @return true if the match is over
+         */
+        bool (*is_over)(GameStateData* st, const GameConfig* cfg);
+
+        bool extendable;        // game_state_extend_time() applies
+        bool has_target_score;  // game_state_update_target() applies
+    } GameModePolicy;
+
+    // Used for an unknown win_type: no end condition, shoot unless respawning
+    extern const GameModePolicy GAME_MODE_FREE_PLAY;
+
+    /**
+     * @brief Policy for a protocol win_type, or NULL if there is none
+     */
+    const GameModePolicy* game_mode_find(const char* win_type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,6 +2,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "game_protocol_gen.h" // OpCode, GameCommandType (from protocol_def.json)
 
 #ifdef __cplusplus
 extern "C"
@@ -15,41 +16,6 @@ extern "C"
         DEVICE_ROLE_COUNT
     } DeviceRole;
 
-    // WebSocket Protocol v2.3 OpCodes
-    typedef enum
-    {
-        // Client -> ESP32
-        OP_GET_STATUS = 1,
-        OP_HEARTBEAT = 2,
-        OP_CONFIG_UPDATE = 3,
-        OP_GAME_COMMAND = 4,
-        OP_HIT_FORWARD = 5,
-        OP_KILL_CONFIRMED = 6,
-        OP_REMOTE_SOUND = 7,
-
-        // ESP32 -> Client
-        OP_STATUS = 10,
-        OP_HEARTBEAT_ACK = 11,
-        OP_SHOT_FIRED = 12,
-        OP_HIT_REPORT = 13,
-        OP_RESPAWN = 14,
-        OP_RELOAD_EVENT = 15,
-        OP_GAME_OVER = 16,
-        OP_GAME_STATE_UPDATE = 17,
-        OP_ACK = 20
-    } OpCode;
-
-    typedef enum
-    {
-        CMD_STOP = 0,
-        CMD_START = 1,
-        CMD_RESET = 2,
-        CMD_PAUSE = 3,
-        CMD_UNPAUSE = 4,
-        CMD_EXTEND_TIME = 5,
-        CMD_UPDATE_TARGET = 6
-    } GameCommandType;
-
     typedef struct
     {
         uint8_t device_id;  // unique per device
@@ -102,16 +68,10 @@ extern "C"
         bool hit_sound_enabled;
     } GameConfig;
 
-    // Player name lookup table (populated from server config)
-    #define MAX_PLAYER_ENTRIES 16
+    // Server roster (roster.h): one entry per player_id, MAX_PLAYER_ID + 1
+    #define MAX_PLAYER_ENTRIES 32
     #define PLAYER_NAME_LEN    16
 
-    typedef struct
-    {
-        uint8_t player_id;
-        char    name[PLAYER_NAME_LEN];
-    } PlayerEntry;
-
     typedef struct
     {
         uint32_t shots_fired;
@@ -126,6 +86,7 @@ extern "C"
         uint8_t hearts_remaining;
         bool respawning;
         uint32_t respawn_end_time_ms;
+        bool invulnerable;              // After a respawn, for invulnerability_ms
 
         uint32_t game_start_time_ms;
         uint32_t game_end_time_ms;      // Set when game should end (for "time" mode)
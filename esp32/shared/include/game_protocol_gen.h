@@ -0,0 +1,56 @@
+// Generated by scripts/validate-protocol.js from protocol_def.json - do not edit.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // WebSocket Protocol v2.3 OpCodes
+    typedef enum
+    {
+        // Client -> ESP32
+        OP_GET_STATUS = 1,
+        OP_HEARTBEAT = 2,
+        OP_CONFIG_UPDATE = 3,
+        OP_GAME_COMMAND = 4,
+        OP_HIT_FORWARD = 5,
+        OP_KILL_CONFIRMED = 6,
+        OP_REMOTE_SOUND = 7,
+        OP_RESUME = 8,
+        OP_SUBSCRIBE = 9,
+
+        // ESP32 -> Client
+        OP_STATUS = 10,
+        OP_HEARTBEAT_ACK = 11,
+        OP_SHOT_FIRED = 12,
+        OP_HIT_REPORT = 13,
+        OP_RESPAWN = 14,
+        OP_RELOAD_EVENT = 15,
+        OP_GAME_OVER = 16,
+        OP_GAME_STATE_UPDATE = 17,
+        OP_RESUME_RESULT = 18,
+        OP_ACK = 20,
+
+        // Client -> ESP32
+        OP_TIME_SYNC = 21,
+
+        // ESP32 -> Client
+        OP_TIME_SYNC_REPLY = 22
+    } OpCode;
+
+    typedef enum
+    {
+        CMD_STOP = 0,
+        CMD_START = 1,
+        CMD_RESET = 2,
+        CMD_PAUSE = 3,
+        CMD_UNPAUSE = 4,
+        CMD_EXTEND_TIME = 5,
+        CMD_UPDATE_TARGET = 6
+    } GameCommandType;
+
+#ifdef __cplusplus
+}
+#endif
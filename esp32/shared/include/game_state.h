@@ -3,6 +3,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "game_protocol.h"
 
 
@@ -17,8 +19,8 @@ extern "C"
 
     bool game_state_init(DeviceRole role);
 
+    // Current config version: readers never lock, but should fetch it again on each pass of their loop
     const DeviceConfig* game_state_get_config(void);
-    DeviceConfig* game_state_get_config_mut(void);
     bool game_state_load_ids(void);
     bool game_state_save_ids(void);
     void game_state_generate_ids(void);
@@ -26,12 +28,43 @@ extern "C"
     void game_state_reset_runtime(void);
 
     const GameConfig* game_state_get_game_config(void);
-    GameConfig* game_state_get_game_config_mut(void);
     void game_state_apply_game_config(const GameConfig* cfg, bool* clamped);
+    void game_state_default_game_config(GameConfig* out);
     void game_state_load_default_game_config(void);
 
-    const GameStateData* game_state_get(void);
-    GameStateData* game_state_get_mut(void);
+    /**
+     * @brief Both configs from the same version
+     */
+    void game_state_config_read(const DeviceConfig** dev, const GameConfig** game);
+
+    /**
+     * @brief Start a config update: copy the current version out for editing
+     *
+     * Holds the writer lock until game_state_config_commit() or
+     * game_state_config_abort(). Either pointer may be NULL.
+     */
+    void game_state_config_begin(DeviceConfig* dev, GameConfig* game);
+
+    /**
+     * @brief Validate and publish the edited configs as one new version
+     *
+     * The GameConfig is clamped as by game_state_apply_game_config(); a NULL
+     * pointer keeps that part of the current version. Readers see either the
+     * old version or the new one, never a mix.
+     */
+    void game_state_config_commit(const DeviceConfig* dev, const GameConfig* game, bool* clamped);
+    void game_state_config_abort(void);
+
+    /**
+     * @brief Consistent copy of the game state, without taking the lock
+     *
+     * Writers publish after every change; this never blocks them and never
+     * returns a half-applied update. The single-field accessors below read
+     * through it as well.
+     */
+    void game_state_snapshot(GameStateData* out);
+
+    void game_state_set_hearts(uint8_t hearts);
 
     void game_state_record_shot(void);
     void game_state_record_hit(void);
@@ -44,14 +77,29 @@ extern "C"
     uint32_t game_state_rx_count(void);
     uint32_t game_state_tx_count(void);
     int game_state_get_ammo(void);
-    bool game_state_check_respawn(void);
     bool game_state_is_respawning(void);
     void game_state_start_respawn(void);
     bool game_state_friendly_fire_counts(void);
 
+    bool game_state_is_invulnerable(void);
+
+    // ============================================================================
+    // EVENTS
+    // ============================================================================
+    // Respawn end, invulnerability end, time-limit game end and the status
+    // heartbeat are timers inside game_state, not polled. When one fires the
+    // state is already updated and subscribed tasks get its bit set in their
+    // task notification value (wait with xTaskNotifyWait).
+
+#define GAME_EVT_RESPAWNED        (1u << 0)
+#define GAME_EVT_INVULNERABLE_END (1u << 1)
+#define GAME_EVT_GAME_OVER        (1u << 2) // any win condition, not only the time limit
+#define GAME_EVT_HEARTBEAT_DUE    (1u << 3) // 10 s since the last status; repeats until one is sent
+
+    bool game_state_subscribe(TaskHandle_t task, uint32_t events);
+
     void game_state_set_connected(bool connected);
     void game_state_update_heartbeat(void);
-    bool game_state_heartbeat_due(void);
     uint32_t game_state_next_seq_id(void);  // Get and increment sequence ID for broadcasts
     
     // Game Control & Win Conditions
@@ -61,18 +109,14 @@ extern "C"
     void game_state_resume_game(void);
     void game_state_extend_time(int additional_minutes);
     void game_state_update_target(int new_target);
-    void game_state_tick(void);              // Call periodically to check win conditions
+    void game_state_tick(void);              // Wins seen in peers' gossip; own counts are checked as recorded
     bool game_state_is_running(void);
     bool game_state_is_paused(void);
     bool game_state_is_game_over(void);
     bool game_state_can_shoot(void);         // Check if player can shoot (LMS: hearts > 0)
     bool game_state_can_take_damage(void);   // Check if player can take damage (LMS: hearts > 0)
 
-    // Player name lookup table
-    void game_state_clear_player_names(void);
-    void game_state_set_player_name(uint8_t player_id, const char* name);
-    const char* game_state_get_player_name(uint8_t player_id); // Returns NULL if unknown
-    int game_state_get_player_count(void); // Number of players in roster
+    // Player names and the hit filter: roster.h
 
     int game_state_config_to_json(char* buffer, size_t max_len, bool clamp_noted);
     int game_state_to_json(char* buffer, size_t max_len);
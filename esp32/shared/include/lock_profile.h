@@ -0,0 +1,120 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifndef RAYZ_LOCK_PROFILE
+#define RAYZ_LOCK_PROFILE 0
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // LOCK PROFILER
+    // ============================================================================
+    // Contention data for the shared mutexes, per lock site (the function and
+    // line that takes the lock). A site counts its acquisitions, how many of
+    // them found the lock held, and histograms of the time spent waiting for
+    // the lock and holding it. It also keeps the name of the task behind its
+    // longest hold. Hold time goes to the site that took the lock, wherever it
+    // is released.
+    //
+    // Build with -DRAYZ_LOCK_PROFILE=1 (build_flags in platformio.ini) to turn
+    // it on. Otherwise LOCK_PROFILE_TAKE/GIVE are plain xSemaphoreTake/Give and
+    // nothing is recorded. The sites are read through lock_profile_site(), GET
+    // /api/locks and the metric_lock_* metrics (runtime_metrics.h).
+    //
+    // A site's counters are only written by the task holding its lock. Reports
+    // read them without the lock, so a report taken under load can be a sample
+    // or two off.
+
+#define LOCK_PROFILE_BUCKETS   9  // limits 4, 16, 64 ... 65536 us, then everything longer
+#define LOCK_PROFILE_TASK_NAME 16
+
+    typedef struct LockSite
+    {
+        const char* lock; // name of the profiled lock
+        const char* func; // function that takes it, NULL until the site is first used
+        uint32_t line;
+        uint32_t acquires;
+        uint32_t contended; // the lock was held when this site asked for it
+        uint32_t wait_hist[LOCK_PROFILE_BUCKETS];
+        uint32_t hold_hist[LOCK_PROFILE_BUCKETS];
+        uint32_t wait_max_us;
+        uint32_t hold_max_us;
+        uint64_t wait_total_us;
+        uint64_t hold_total_us;
+        char slowest_holder[LOCK_PROFILE_TASK_NAME]; // task of the longest hold
+        struct LockSite* next;
+    } LockSite;
+
+    typedef struct
+    {
+        const char* name;
+        LockSite* site;     // where the current holder took the lock
+        const char* holder; // its task name
+        int64_t taken_us;
+    } LockProfile;
+
+    /**
+     * @brief Take a profiled mutex (use LOCK_PROFILE_TAKE, which supplies the site)
+     */
+    void lock_profile_take(LockProfile* prof, LockSite* site, SemaphoreHandle_t mutex, const char* func,
+                           uint32_t line);
+
+    /**
+     * @brief Release a profiled mutex, charging the hold to the site that took it
+     */
+    void lock_profile_give(LockProfile* prof, SemaphoreHandle_t mutex);
+
+    /**
+     * @brief Copy the index-th site seen so far (newest first)
+     * @return false past the last site
+     */
+    bool lock_profile_site(int index, LockSite* out);
+
+    /**
+     * @brief Zero the counters of every site (the sites stay listed)
+     */
+    void lock_profile_reset(void);
+
+    /**
+     * @brief Upper limit of a histogram bucket in us (the last bucket has none)
+     */
+    uint32_t lock_profile_bucket_limit_us(int bucket);
+
+    /**
+     * @brief Worst wait and total contended acquisitions over all sites
+     */
+    void lock_profile_totals(uint32_t* wait_max_us, uint32_t* contended);
+
+    /**
+     * @brief One site as a JSON object
+     * @return Length written, or -1 if it did not fit
+     */
+    int lock_profile_site_to_json(const LockSite* site, char* buffer, size_t max_len);
+
+#if RAYZ_LOCK_PROFILE
+#define LOCK_PROFILE(var, name) static LockProfile var = {name, NULL, NULL, 0}
+#define LOCK_PROFILE_TAKE(prof, mutex)                                                                                 \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static LockSite lock_site_;                                                                                    \
+        lock_profile_take(&(prof), &lock_site_, (mutex), __func__, __LINE__);                                          \
+    } while (0)
+#define LOCK_PROFILE_GIVE(prof, mutex) lock_profile_give(&(prof), (mutex))
+#else
+#define LOCK_PROFILE(var, name)
+#define LOCK_PROFILE_TAKE(prof, mutex) xSemaphoreTake((mutex), portMAX_DELAY)
+#define LOCK_PROFILE_GIVE(prof, mutex) xSemaphoreGive(mutex)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
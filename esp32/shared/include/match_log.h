@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MATCH LOG
+    // ============================================================================
+    // Every action that changes the game state is appended as a 12-byte record
+    // to a RAM ring, stamped with the match clock (clock_sync.h) so logs from
+    // different devices merge into one timeline. The counters in
+    // GameStateData are then a function of the log: replaying the records in
+    // order from a zeroed MatchLogTotals gives the same counts, hearts and
+    // match flags. Records the ring overwrites are folded into a base first,
+    // so base + ring always replays to the current state.
+    //
+    // On the device the ring sits in RTC memory that survives a software
+    // reset (panic, watchdog, OTA restart), so game_state can rebuild a match
+    // in progress from it instead of waiting for the server.
+    //
+    // The dump (GET /api/match_log, and the files the match_replay host tool
+    // reads) is a MatchLogDumpHeader followed by its records, little endian.
+
+#define MATCH_LOG_CAPACITY 256
+#define MATCH_LOG_MAGIC0   'R'
+#define MATCH_LOG_MAGIC1   'L'
+#define MATCH_LOG_VERSION  1
+#define MATCH_LOG_KEEP     0xFFFF // value: the record does not set hearts
+
+    typedef enum
+    {
+        MLOG_MATCH_START = 1, // value = hearts after
+        MLOG_MATCH_STOP,
+        MLOG_PAUSE,
+        MLOG_RESUME,
+        MLOG_GAME_OVER,       // a win condition ended the match
+        MLOG_SHOT,
+        MLOG_HIT_LANDED,      // value = points scored
+        MLOG_KILL,            // value = points scored
+        MLOG_HIT_RECEIVED,    // a = shooter player_id, b = shooter device_id
+        MLOG_DEATH,           // value = hearts after
+        MLOG_RESPAWN,         // value = hearts after
+        MLOG_HEARTS,          // value = hearts set by config
+        MLOG_FRIENDLY_FIRE,
+        MLOG_RESET_STATS,     // counters zeroed, value = hearts after
+        MLOG_RESET,           // counters and match flags zeroed, value = hearts after
+        MLOG_COMMAND,         // a = GameCommandType
+        MLOG_CONFIG,          // a = max_hearts, b = spawn_hearts, value = target_score
+        MLOG_RESPAWN_WAIT,    // sent to respawn without a death (server command)
+        MLOG_ELAPSED,         // value = seconds of the match played so far, pauses excluded
+        MLOG_TYPE_COUNT
+    } MatchLogType;
+
+    typedef struct __attribute__((packed))
+    {
+        uint32_t match_ms; // clock_sync_match_ms() when it happened
+        uint16_t seq;      // per device, wraps
+        uint8_t device_id;
+        uint8_t type; // MatchLogType
+        uint8_t a;
+        uint8_t b;
+        uint16_t value;
+    } MatchLogRecord;
+
+#define MLOG_FLAG_RUNNING    0x01
+#define MLOG_FLAG_PAUSED     0x02
+#define MLOG_FLAG_OVER       0x04
+#define MLOG_FLAG_RESPAWNING 0x08
+
+    // What replaying a log yields
+    typedef struct __attribute__((packed))
+    {
+        uint32_t shots_fired;
+        uint32_t hits_landed;
+        uint32_t kills;
+        uint32_t deaths;
+        uint32_t friendly_fire_count;
+        uint32_t points; // kill and hit points as they were scored
+        uint32_t started_ms; // match time of the last MLOG_MATCH_START
+        uint8_t hearts_remaining;
+        uint8_t flags;     // MLOG_FLAG_*
+        uint16_t played_s; // as of the last MLOG_ELAPSED: what a restored timed match has used up
+    } MatchLogTotals;
+
+    typedef struct __attribute__((packed))
+    {
+        uint8_t magic[2];
+        uint8_t version;
+        uint8_t device_id;
+        uint32_t first_seq; // of the first record; earlier ones are folded into base
+        uint16_t count;
+        uint16_t reserved;
+        MatchLogTotals base;
+    } MatchLogDumpHeader;
+
+    /**
+     * @brief Set up the ring for this device
+     * @return true if a log from before a software reset was kept
+     */
+    bool match_log_init(uint8_t device_id);
+
+    /**
+     * @brief Append one record (and fold the oldest into the base when full)
+     */
+    void match_log_append(MatchLogType type, uint8_t a, uint8_t b, uint16_t value);
+
+    /**
+     * @brief Start the ring over for a new match, folding what it held into the base
+     */
+    void match_log_new_match(void);
+
+    /**
+     * @brief Replay base + ring
+     * @return Sequence number the next record gets (records covered so far)
+     */
+    uint32_t match_log_replay(MatchLogTotals* out);
+
+    /**
+     * @brief Start over from a checkpoint (match_store.h) instead of an empty log
+     */
+    void match_log_seed(const MatchLogTotals* base, uint32_t next_seq);
+
+    /**
+     * @brief Write the dump into buf
+     * @return bytes written, or 0 if buf is too small for the header
+     */
+    size_t match_log_dump(uint8_t* buf, size_t len);
+
+    /**
+     * @brief One replay step; the host tool and the device share it
+     */
+    void match_log_apply(MatchLogTotals* totals, const MatchLogRecord* rec);
+
+    /**
+     * @brief Copy replayed totals into a GameStateData (points become player_score)
+     */
+    void match_log_to_state(const MatchLogTotals* totals, GameStateData* st);
+
+    const char* match_log_type_name(uint8_t type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "match_log.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MATCH STORE
+    // ============================================================================
+    // Checkpoints of the match log (match_log.h) in a dedicated flash
+    // partition, so a match survives a brownout or power cut and not only a
+    // software reset. The partition is an append-only ring of 64-byte entries,
+    // each a replayed MatchLogTotals with a sequence number and a CRC-32:
+    //
+    //   - Entries are written front to back through every sector, and a sector
+    //     is erased only when the ring comes round to it again, so all sectors
+    //     wear at the same rate.
+    //   - A torn write (power lost while programming) fails its CRC and is
+    //     skipped; boot falls back to the entry before it.
+    //   - Boot reads the first entry of each sector to find the newest one,
+    //     then scans only that sector.
+    //
+    // Nothing here runs on the hit path: game_state appends to the RAM log and
+    // a low-priority flusher task writes one checkpoint per
+    // MATCH_STORE_FLUSH_MS, and only when the log has moved on (match start and
+    // stop wake it early, never sooner than MATCH_STORE_MIN_GAP_MS). At that rate
+    // a 64 KB partition erases each sector about once every 34 minutes of
+    // continuous play, far below the flash's rated erase cycles.
+
+#define MATCH_STORE_PARTITION   "matchlog"
+#define MATCH_STORE_SUBTYPE     0x40 // custom data subtype (partition table CSVs)
+#define MATCH_STORE_ENTRY_SIZE  64
+#define MATCH_STORE_FLUSH_MS    2000
+#define MATCH_STORE_MIN_GAP_MS  250
+
+    // Flash the store writes to: the partition on the device, RAM in host tools.
+    // Offsets are relative to the start of the region; writes only clear bits
+    // (NOR flash), erase sets a sector back to 0xFF.
+    typedef struct
+    {
+        void* ctx;
+        size_t size;        // multiple of sector_size
+        size_t sector_size; // multiple of MATCH_STORE_ENTRY_SIZE
+
+        bool (*read)(void* ctx, size_t offset, void* dst, size_t len);
+        bool (*write)(void* ctx, size_t offset, const void* src, size_t len);
+        bool (*erase_sector)(void* ctx, size_t offset);
+    } MatchStoreFlash;
+
+    typedef struct
+    {
+        uint32_t entries_written;
+        uint32_t sectors_erased;
+        uint32_t write_errors;
+        uint32_t torn_skipped; // entries with a bad CRC found by the boot scan
+        uint32_t scan_us;      // duration of the boot scan
+    } MatchStoreStats;
+
+    /**
+     * @brief Scan the flash for the newest checkpoint
+     * @param flash Copied; NULL uses the "matchlog" partition (device builds only)
+     * @param device_id Checkpoints written for another device_id are ignored
+     * @return false if there is no usable flash (the store then stays idle)
+     */
+    bool match_store_init(const MatchStoreFlash* flash, uint8_t device_id);
+
+    /**
+     * @brief Newest checkpoint found by match_store_init() or written since
+     * @param log_seq Out: match log records it covers (may be NULL)
+     * @return false if there is none for this device
+     */
+    bool match_store_load(MatchLogTotals* out, uint32_t* log_seq);
+
+    /**
+     * @brief Write a checkpoint if the match log moved on since the last one
+     * @return false on a flash error
+     */
+    bool match_store_flush(void);
+
+    /**
+     * @brief Start the background flusher task (device builds only)
+     */
+    bool match_store_start_flusher(void);
+
+    /**
+     * @brief Wake the flusher now (match start/stop), without waiting for the interval
+     */
+    void match_store_request_flush(void);
+
+    void match_store_get_stats(MatchStoreStats* out);
+
+#ifdef __cplusplus
+}
+#endif
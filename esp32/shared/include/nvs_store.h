@@ -8,6 +8,43 @@ extern "C"
 {
 #endif
 
+    // ============================================================================
+    // CACHED NVS STORE
+    // ============================================================================
+    // One long-lived handle per namespace and a RAM copy of every key read or
+    // written. After the first read of a key, reads come from RAM, including
+    // "not found". A write updates RAM, marks the key dirty and returns
+    // without touching flash. A write that leaves the value unchanged does
+    // nothing.
+    //
+    // Dirty keys reach flash on a flush: one nvs_set per changed key and one
+    // nvs_commit per namespace. A low-priority flusher task runs it
+    // NVS_STORE_FLUSH_DELAY_MS after the last write, so a burst of config
+    // pushes costs one flash pass. A steady stream of writes is still flushed
+    // every NVS_STORE_FLUSH_MAX_DELAY_MS.
+    //
+    // Writes between nvs_store_begin() and nvs_store_end() form one
+    // transaction. The flusher leaves them alone until nvs_store_end(), so the
+    // whole group goes out in one flush with one commit. Code that restarts
+    // the chip right after writing calls nvs_store_flush() first.
+
+#define NVS_STORE_MAX_NAMESPACES      4
+#define NVS_STORE_MAX_KEYS            24 // cached keys; beyond this clean ones are evicted
+#define NVS_STORE_FLUSH_DELAY_MS      300
+#define NVS_STORE_FLUSH_MAX_DELAY_MS  2000
+
+    typedef struct
+    {
+        uint32_t reads_cached;
+        uint32_t reads_flash;
+        uint32_t writes;
+        uint32_t writes_unchanged; // same value as cached: nothing to flush
+        uint32_t keys_flushed;     // nvs_set calls
+        uint32_t commits;          // nvs_commit calls
+        uint32_t flushes;
+        uint32_t flush_errors;
+    } NvsStoreStats;
+
     bool nvs_store_read_str(const char* ns, const char* key, char* out, size_t max_len);
     bool nvs_store_write_str(const char* ns, const char* key, const char* value);
     bool nvs_store_erase_namespace(const char* ns);
@@ -16,6 +53,24 @@ extern "C"
     bool nvs_store_read_u32(const char* ns, const char* key, uint32_t* out);
     bool nvs_store_write_u32(const char* ns, const char* key, uint32_t value);
 
+    /**
+     * @brief Open a transaction (nests); its writes are not flushed before the matching end
+     */
+    void nvs_store_begin(void);
+
+    /**
+     * @brief Close a transaction; the outermost one schedules the write-behind flush
+     */
+    void nvs_store_end(void);
+
+    /**
+     * @brief Write every dirty key now, one commit per namespace
+     * @return false if any key could not be written (it stays dirty)
+     */
+    bool nvs_store_flush(void);
+
+    void nvs_store_get_stats(NvsStoreStats* out);
+
 #ifdef __cplusplus
 }
 #endif
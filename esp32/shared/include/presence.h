@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // FIELD PRESENCE
+    // ============================================================================
+    // Who is on the field, learned from the presence beacons every device
+    // broadcasts over ESP-NOW (espnow_comm_presence_poll), so offline games know
+    // their players without a roster from the server. Each beacon carries the
+    // sender's current period; a device is gone once PRESENCE_MISSED_BEACONS of
+    // them passed in silence. The period grows with the number of devices heard,
+    // which keeps the field's total beacon rate roughly constant.
+
+#define PRESENCE_INTERVAL_MS     3000  // beacon period on a small field
+#define PRESENCE_SLOT_MS         200   // per live device: the field sends ~5 beacons/s at most
+#define PRESENCE_MAX_INTERVAL_MS 15000
+#define PRESENCE_MISSED_BEACONS  3
+
+    typedef struct
+    {
+        uint8_t device_id;
+        uint8_t player_id;
+        uint8_t team_id;
+        int8_t rssi;           // last beacon, dBm
+        uint32_t color_rgb;
+        uint16_t interval_ms;  // sender's beacon period
+        uint32_t last_seen_ms; // esp_timer ms of the last beacon
+    } PresenceEntry;
+
+    /**
+     * @brief Set up the table (idempotent)
+     */
+    void presence_init(void);
+
+    /**
+     * @brief Record a beacon (last_seen_ms is taken from the entry)
+     */
+    void presence_update(const PresenceEntry* entry);
+
+    bool presence_device_alive(uint8_t device_id);
+
+    /**
+     * @brief Is any live device playing as player_id?
+     */
+    bool presence_player_alive(uint8_t player_id);
+
+    /**
+     * @brief Copy live devices into out, lowest device_id first
+     * @return Number of entries written
+     */
+    int presence_list(PresenceEntry* out, int max);
+
+    /**
+     * @brief Players heard on the field: a bit per player_id, and the team each last reported
+     * @param teams MAX_PLAYER_ID + 1 entries; those of players not heard are left alone
+     * @return Bit n set if a live device plays as player n
+     */
+    uint32_t presence_players(uint8_t* teams);
+
+    /**
+     * @brief Number of live devices, not counting this one
+     */
+    int presence_count(void);
+
+    /**
+     * @brief Beacon period this device should use for the current field size
+     */
+    uint16_t presence_interval_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game_protocol.h"
+#include "protocol_config.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // ROSTER
+    // ============================================================================
+    // One slot per player_id over the whole 5-bit space, so a lookup is an
+    // index. A slot holds the name from the server roster, plus the team and
+    // liveness from the presence beacons (presence.h). Its generation changes
+    // whenever the slot does.
+    //
+    // Readers never lock. The table is published through a seqlock, like the
+    // game state snapshot. A server roster is built with roster_begin(),
+    // roster_add() and roster_commit() and replaces the old one in a single
+    // publish, so a reader sees either the old roster or the new one.
+    //
+    // The shooters a hit is accepted from are kept as a bitmask. It is
+    // recomputed whenever the roster, the field or the rules change, so
+    // checking a received shot is one bit test (roster_admits):
+    //   - never this device's own player_id
+    //   - with a server connected and a roster set: its members
+    //   - otherwise the players heard on the field, or anyone if none are heard
+    //     (peers without presence beacons)
+    //   - in team play with friendly fire off: not this device's teammates
+
+#define ROSTER_SLOTS   (MAX_PLAYER_ID + 1)
+#define ROSTER_NO_TEAM 0xFF // no beacon has reported the player's team
+
+    typedef struct
+    {
+        char name[PLAYER_NAME_LEN]; // "" unless in_roster
+        uint8_t team_id;            // ROSTER_NO_TEAM until a beacon reports it
+        bool in_roster;             // listed in the server roster
+        bool alive;                 // heard on the field (presence.h)
+        uint16_t generation;        // bumped on every change of the slot
+    } RosterSlot;
+
+    /**
+     * @brief Set up the table (idempotent)
+     */
+    void roster_init(void);
+
+    /**
+     * @brief Start a new server roster; holds the writer lock until roster_commit()
+     */
+    void roster_begin(void);
+
+    /**
+     * @brief Add a player to the roster being built (a repeated player_id renames it)
+     * @return false if player_id is out of range
+     */
+    bool roster_add(uint8_t player_id, const char* name);
+
+    /**
+     * @brief Replace the published roster with the one built since roster_begin()
+     */
+    void roster_commit(void);
+
+    /**
+     * @brief Rules of this device: its own player and team, team play and friendly fire
+     */
+    void roster_set_self(uint8_t player_id, uint8_t team_id, bool team_play, bool friendly_fire);
+
+    /**
+     * @brief Whether a server is connected (its roster, when set, decides who may shoot)
+     */
+    void roster_set_server_connected(bool connected);
+
+    /**
+     * @brief Take liveness and teams from the presence table
+     *
+     * Called on every presence beacon, and periodically so players whose
+     * beacons stopped drop out.
+     */
+    void roster_refresh_field(void);
+
+    /**
+     * @brief Copy a slot
+     * @return false if player_id is out of range
+     */
+    bool roster_get(uint8_t player_id, RosterSlot* out);
+
+    /**
+     * @brief Copy a player's roster name (out may be NULL)
+     * @return false if the player is not in the server roster
+     */
+    bool roster_name(uint8_t player_id, char* out, size_t len);
+
+    /**
+     * @brief Number of players in the server roster
+     */
+    int roster_count(void);
+
+    /**
+     * @brief Bit n set if a hit from player n counts
+     */
+    uint32_t roster_admissible(void);
+
+    /**
+     * @brief Does a hit from this player count? One load and a bit test
+     */
+    bool roster_admits(uint8_t player_id);
+
+#ifdef __cplusplus
+}
+#endif
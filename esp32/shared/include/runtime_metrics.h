@@ -14,6 +14,12 @@ extern "C"
     uint32_t metric_last_rx_ms_ago(void);
     uint32_t metric_rx_count(void);
     uint32_t metric_tx_count(void);
+    uint32_t metric_ws_rtt_ms(void); // mean WebSocket PING round trip, 0 if none measured
+    int metric_players_on_field(void); // other devices heard over ESP-NOW presence beacons
+
+    // Lock profiler (lock_profile.h), 0 unless built with RAYZ_LOCK_PROFILE
+    uint32_t metric_lock_wait_max_us(void); // longest wait for any profiled mutex
+    uint32_t metric_lock_contended(void);   // acquisitions that found the mutex held
 
     // Target-specific metrics
     int metric_hit_count(void);
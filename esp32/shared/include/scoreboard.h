@@ -0,0 +1,103 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // OFFLINE SCOREBOARD
+    // ============================================================================
+    // A match scoreboard every device converges on without a server. Each
+    // device only ever counts its own kills, deaths and hits; the board holds
+    // one such replica per device_id and merges what peers gossip by taking the
+    // larger value of each counter (a grow-only counter per replica, so merges
+    // can arrive in any order, twice, or through other devices). Player and
+    // team totals are sums over the replicas playing as them.
+    //
+    // A new match raises the epoch: boards that hear a higher epoch clear
+    // themselves and adopt it, boards that hear a lower one ignore it.
+
+#define SCOREBOARD_MAX_DEVICES 64 // MAX_DEVICE_ID + 1
+
+    typedef struct
+    {
+        uint8_t device_id;
+        uint8_t player_id;
+        uint8_t team_id; // 0 = no team
+        uint16_t kills;
+        uint16_t deaths;
+        uint16_t hits;
+    } ScoreReplica;
+
+    typedef struct
+    {
+        uint8_t id; // player_id or team_id
+        uint32_t kills;
+        uint32_t deaths;
+        uint32_t hits;
+    } ScoreTotals;
+
+    typedef enum
+    {
+        SCORE_KILL = 0,
+        SCORE_DEATH,
+        SCORE_HIT,
+    } ScoreCounter;
+
+    /**
+     * @brief Set up the board (idempotent; call again when the ids change)
+     */
+    void scoreboard_init(uint8_t device_id, uint8_t player_id, uint8_t team_id);
+
+    /**
+     * @brief Start a new match: clear the board and move past every epoch seen
+     */
+    void scoreboard_new_match(void);
+
+    uint16_t scoreboard_epoch(void);
+
+    /**
+     * @brief Count one event for this device
+     */
+    void scoreboard_add(ScoreCounter counter);
+
+    /**
+     * @brief Merge a replica gossiped by a peer
+     * @return true if the board changed
+     */
+    bool scoreboard_merge(uint16_t epoch, const ScoreReplica* replica);
+
+    /**
+     * @brief Replicas to gossip next
+     *
+     * Replicas that changed since they were last taken come first; with
+     * include_clean the rest of out is filled round-robin from the others, so
+     * a peer that missed an update (or joined late) catches up eventually.
+     * @param epoch Set to the epoch the replicas belong to
+     * @return Number of replicas written
+     */
+    int scoreboard_take_gossip(ScoreReplica* out, int max, bool include_clean, uint16_t* epoch);
+
+    /**
+     * @brief Totals per player (by_team = false) or per team, lowest id first
+     *
+     * Team totals leave out players without a team.
+     * @return Number of entries written
+     */
+    int scoreboard_totals(ScoreTotals* out, int max, bool by_team);
+
+    /**
+     * @brief Sides (teams, or players without a team) that still have someone
+     *        with fewer than max_deaths deaths
+     * @param sides Number of sides on the board
+     * @return Sides still standing
+     */
+    int scoreboard_sides_standing(uint32_t max_deaths, int* sides);
+
+#ifdef __cplusplus
+}
+#endif
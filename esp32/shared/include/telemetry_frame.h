@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MULTICAST TELEMETRY WIRE FORMAT
+    // ============================================================================
+    // Each device publishes its event stream (shots, hits, respawns, status
+    // changes) to one UDP multicast group on the venue LAN; scoreboards and
+    // loggers just join the group. One datagram carries one protocol message:
+    //
+    //   [magic 'R' 'Z'][version u8][device_id u8][stream_id u32][seq u32][binary frame]
+    //
+    // The binary frame is exactly what binary WebSocket clients receive
+    // (ws_codec.h). seq counts datagrams of the stream without gaps, so
+    // receivers detect loss; stream_id is drawn at boot and changes when the
+    // device restarts (seq starts over). Integers are little-endian.
+
+#define TELEMETRY_MCAST_GROUP "239.255.82.90" // organization-local scope
+#define TELEMETRY_MCAST_PORT 5290
+#define TELEMETRY_MCAST_TTL 1 // stay on the venue subnet
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_SIZE 12
+#define TELEMETRY_MAX_DATAGRAM 512
+
+    typedef struct
+    {
+        uint8_t device_id;
+        uint32_t stream_id;
+        uint32_t seq;
+    } TelemetryHeader;
+
+    /**
+     * @brief Encode one message as a telemetry datagram
+     * @param hdr Stream header
+     * @param op Opcode of the message
+     * @param body Pointer to the matching Ws*Msg struct (NULL for empty messages)
+     * @return Datagram length, or -1 if the opcode is unknown or out is too small
+     */
+    int telemetry_frame_encode(const TelemetryHeader* hdr, uint8_t op, const void* body, uint8_t* out, size_t cap);
+
+    /**
+     * @brief Split a datagram into header and binary frame
+     * @param payload Receives a pointer into data (the binary frame)
+     * @param payload_len Receives the frame length
+     * @return false if the datagram is not a telemetry datagram of this version
+     */
+    bool telemetry_frame_parse(const uint8_t* data, size_t len, TelemetryHeader* hdr, const uint8_t** payload,
+                               size_t* payload_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MULTICAST TELEMETRY PUBLISHER
+    // ============================================================================
+    // Publishes the device's event stream to TELEMETRY_MCAST_GROUP (see
+    // telemetry_frame.h) so any number of spectator dashboards can follow a
+    // match without taking a WebSocket slot. Off by default; ws_server feeds it.
+
+    typedef struct
+    {
+        uint32_t stream_id;
+        uint32_t sent;        // datagrams handed to the network stack
+        uint32_t send_errors; // sendto failures (no IP yet, out of buffers)
+        uint32_t encode_errors;
+    } TelemetryMcastStats;
+
+    /**
+     * @brief Create the lock and draw the stream id. Safe to call more than once.
+     */
+    void telemetry_mcast_init(void);
+
+    /**
+     * @brief Start or stop publishing
+     *
+     * The socket is opened on the first publish after enabling and closed
+     * when disabling; seq keeps counting across both.
+     */
+    void telemetry_mcast_set_enabled(bool enabled);
+
+    bool telemetry_mcast_enabled(void);
+
+    /**
+     * @brief Publish one protocol message (binary codec) to the multicast group
+     *
+     * Thread-safe; datagrams leave in seq order. Does nothing while disabled.
+     * @return true if the datagram was sent
+     */
+    bool telemetry_mcast_publish(uint8_t op, const void* body);
+
+    void telemetry_mcast_get_stats(TelemetryMcastStats* out);
+
+#ifdef __cplusplus
+}
+#endif
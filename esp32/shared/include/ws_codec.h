@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ws_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // CODECS
+    // ============================================================================
+
+    /**
+     * @brief Wire format used for a client connection
+     *
+     * JSON text frames are the default. Clients that offer the
+     * WS_SUBPROTOCOL_BINARY subprotocol in the handshake get binary frames.
+     */
+    typedef enum
+    {
+        WS_CODEC_JSON = 0,
+        WS_CODEC_BINARY = 1,
+        WS_CODEC_COUNT
+    } WsCodec;
+
+#define WS_SUBPROTOCOL_BINARY "rayz-bin"
+
+    // Binary frame: [version u8][op u8][present u32, only if the message has
+    // optional fields][fields in table order, little-endian]. Strings are
+    // [len u8][bytes], player lists are [count u8]([id u8][len u8][bytes])*.
+#define WS_BINARY_VERSION 1
+#define WS_BINARY_HEADER_SIZE 2
+
+    /**
+     * @brief Encode a message body as a binary frame
+     * @param op Opcode of the message
+     * @param body Pointer to the matching Ws*Msg struct (NULL for empty messages)
+     * @param out Output buffer
+     * @param cap Capacity of out
+     * @return Encoded length, or -1 if the opcode is unknown or out is too small
+     */
+    int ws_codec_binary_encode(uint8_t op, const void* body, uint8_t* out, size_t cap);
+
+    /**
+     * @brief Decode a binary frame
+     * @param data Frame payload
+     * @param len Payload length
+     * @param out Decoded message (op + body)
+     * @return true if the frame is well formed and all required fields are present
+     */
+    bool ws_codec_binary_decode(const uint8_t* data, size_t len, WsMessage* out);
+
+    /**
+     * @brief Encode a message body as JSON text
+     * @return Heap string (release with free()), or NULL on failure
+     */
+    char* ws_codec_json_encode(uint8_t op, const void* body);
+
+    /**
+     * @brief Encode a message body as JSON text into a caller buffer
+     * @return Text length (without NUL), or -1 if out is too small
+     */
+    int ws_codec_json_encode_to(uint8_t op, const void* body, uint8_t* out, size_t cap);
+
+    /**
+     * @brief Decode a JSON text frame
+     *
+     * Uses "op" when present, otherwise falls back to the legacy "type" string.
+     * @return true if the opcode is known and all required fields are present
+     */
+    bool ws_codec_json_decode(const uint8_t* data, size_t len, WsMessage* out);
+
+    /**
+     * @brief Upper bound for the binary size of an opcode's message
+     */
+    size_t ws_codec_binary_max_size(uint8_t op);
+
+    // ============================================================================
+    // CODEC INTERFACE
+    // ============================================================================
+
+    typedef struct
+    {
+        const char* name;
+        bool binary; // sent as binary frames (otherwise text)
+        int (*encode)(uint8_t op, const void* body, uint8_t* out, size_t cap);
+        bool (*decode)(const uint8_t* data, size_t len, WsMessage* out);
+    } WsCodecOps;
+
+    /**
+     * @brief Encoder/decoder pair for a codec
+     * @return NULL if the codec is unknown
+     */
+    const WsCodecOps* ws_codec_ops(WsCodec codec);
+
+#ifdef __cplusplus
+}
+#endif
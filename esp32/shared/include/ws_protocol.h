@@ -0,0 +1,139 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MESSAGE MODEL
+    // ============================================================================
+    //
+    // Every WebSocket opcode has a plain C body struct and a field table. Both the
+    // JSON and the binary codec walk the same table, so a message is described
+    // exactly once. Bodies of messages with optional fields start with a
+    // `present` bitmask (bit N = field N of the table was set).
+    //
+    // The bodies, field tables and dispatch are generated from protocol_def.json
+    // into ws_protocol_gen.h / ws_protocol_gen.cpp (scripts/validate-protocol.js).
+
+#define WS_DEVICE_NAME_LEN 32
+#define WS_WIN_TYPE_LEN 24
+#define WS_PEERS_LEN 256
+#define WS_REPLY_TO_LEN 40
+#define WS_ERROR_CODE_LEN 24
+#define WS_ERROR_MESSAGE_LEN 64
+#define WS_ROSTER_MAX MAX_PLAYER_ENTRIES
+
+    typedef enum
+    {
+        WS_FT_BOOL = 0,
+        WS_FT_U8,
+        WS_FT_U16,
+        WS_FT_U32,
+        WS_FT_I8,
+        WS_FT_STR,     // char[size], NUL terminated
+        WS_FT_PLAYERS, // WsPlayerList
+    } WsFieldType;
+
+#define WS_FIELD_OPTIONAL 0x01
+
+    typedef struct
+    {
+        const char* key;   // JSON key
+        const char* group; // JSON sub-object ("config", "stats", ...) or NULL
+        uint16_t offset;   // offsetof() in the body struct
+        uint16_t size;     // sizeof() of the member (capacity for strings)
+        uint8_t type;      // WsFieldType
+        uint8_t flags;     // WS_FIELD_*
+    } WsFieldDesc;
+
+    typedef struct
+    {
+        uint8_t op;               // OpCode
+        const char* type_name;    // legacy "type" string
+        const WsFieldDesc* fields;
+        uint8_t field_count;
+        uint16_t body_size;
+        bool has_presence;        // body starts with uint32_t present
+    } WsMessageDesc;
+
+    typedef struct
+    {
+        uint8_t id;
+        char name[PLAYER_NAME_LEN];
+    } WsPlayerItem;
+
+    typedef struct
+    {
+        uint8_t count;
+        WsPlayerItem items[WS_ROSTER_MAX];
+    } WsPlayerList;
+
+    // ============================================================================
+    // TOPICS
+    // ============================================================================
+    //
+    // Broadcasts only reach clients subscribed to the message's topic
+    // (OP_SUBSCRIBE). Replies to a single client are never filtered.
+
+    typedef enum
+    {
+        WS_TOPIC_STATUS = 1u << 0,  // OP_STATUS
+        WS_TOPIC_SHOTS = 1u << 1,   // OP_SHOT_FIRED, OP_RELOAD_EVENT
+        WS_TOPIC_HITS = 1u << 2,    // OP_HIT_REPORT
+        WS_TOPIC_GAME = 1u << 3,    // OP_RESPAWN, OP_GAME_OVER, OP_GAME_STATE_UPDATE
+        WS_TOPIC_METRICS = 1u << 4, // runtime metrics (opt-in)
+        WS_TOPIC_TRACES = 1u << 5,  // debug traces (opt-in)
+    } WsTopic;
+
+// What a client receives before it sends OP_SUBSCRIBE
+#define WS_TOPIC_DEFAULT (WS_TOPIC_STATUS | WS_TOPIC_SHOTS | WS_TOPIC_HITS | WS_TOPIC_GAME)
+#define WS_TOPIC_ALL 0x3Fu
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "ws_protocol_gen.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // LOOKUP
+    // ============================================================================
+
+    /**
+     * @brief Descriptor for an opcode
+     * @return NULL if the opcode is unknown
+     */
+    const WsMessageDesc* ws_protocol_find(uint8_t op);
+
+    /**
+     * @brief Descriptor for a legacy "type" string (e.g. "get_status")
+     * @return NULL if the name is unknown
+     */
+    const WsMessageDesc* ws_protocol_find_by_type(const char* type_name);
+
+    /**
+     * @brief Topic an opcode is broadcast under
+     * @return WsTopic bit, or 0 if the message is delivered regardless of subscriptions
+     */
+    uint32_t ws_protocol_topic(uint8_t op);
+
+    static inline bool ws_msg_has(uint32_t present, int field)
+    {
+        return (present & (1UL << field)) != 0;
+    }
+
+#ifdef __cplusplus
+}
+#endif
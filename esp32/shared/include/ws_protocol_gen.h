@@ -0,0 +1,317 @@
+// Generated by scripts/validate-protocol.js from protocol_def.json - do not edit.
+
+#pragma once
+
+#include "ws_protocol.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // MESSAGE BODIES
+    // ============================================================================
+
+    // ---------------------------------------------------------------- client -> ESP32
+
+    typedef struct
+    {
+        uint32_t present;
+        bool reset_to_defaults;
+        char device_name[WS_DEVICE_NAME_LEN];
+        uint8_t device_id; // 6-bit IR protocol limit
+        uint8_t player_id; // 5-bit IR protocol limit
+        uint8_t team_id;
+        uint32_t color_rgb;
+        char win_type[WS_WIN_TYPE_LEN];
+        uint16_t target_score;
+        uint16_t game_duration_s;
+        uint8_t max_hearts;
+        uint8_t spawn_hearts;
+        uint16_t respawn_time_s;
+        uint8_t damage_in;
+        uint8_t damage_out;
+        bool friendly_fire;
+        uint16_t max_ammo;
+        uint16_t reload_time_ms;
+        bool enable_ammo;
+        char espnow_peers[WS_PEERS_LEN];
+        WsPlayerList players; // Roster: [{id, name}]
+        bool telemetry_mcast; // Publish events to the UDP multicast spectator stream
+    } WsConfigUpdateMsg;
+
+    // Field indices of WsConfigUpdateMsg, for testing `present`
+    typedef enum
+    {
+        WS_CFG_RESET_TO_DEFAULTS = 0,
+        WS_CFG_DEVICE_NAME,
+        WS_CFG_DEVICE_ID,
+        WS_CFG_PLAYER_ID,
+        WS_CFG_TEAM_ID,
+        WS_CFG_COLOR_RGB,
+        WS_CFG_WIN_TYPE,
+        WS_CFG_TARGET_SCORE,
+        WS_CFG_GAME_DURATION_S,
+        WS_CFG_MAX_HEARTS,
+        WS_CFG_SPAWN_HEARTS,
+        WS_CFG_RESPAWN_TIME_S,
+        WS_CFG_DAMAGE_IN,
+        WS_CFG_DAMAGE_OUT,
+        WS_CFG_FRIENDLY_FIRE,
+        WS_CFG_MAX_AMMO,
+        WS_CFG_RELOAD_TIME_MS,
+        WS_CFG_ENABLE_AMMO,
+        WS_CFG_ESPNOW_PEERS,
+        WS_CFG_PLAYERS,
+        WS_CFG_TELEMETRY_MCAST,
+    } WsConfigUpdateField;
+
+    typedef struct
+    {
+        uint32_t present;
+        uint8_t command;         // GameCommandType
+        uint16_t extend_minutes; // CMD_EXTEND_TIME
+        uint16_t new_target;     // CMD_UPDATE_TARGET
+    } WsGameCommandMsg;
+
+    // Field indices of WsGameCommandMsg, for testing `present`
+    typedef enum
+    {
+        WS_CMD_COMMAND = 0,
+        WS_CMD_EXTEND_MINUTES,
+        WS_CMD_NEW_TARGET,
+    } WsGameCommandField;
+
+    typedef struct
+    {
+        uint8_t shooter_id; // Player ID, 5-bit IR protocol limit
+    } WsHitForwardMsg;
+
+    typedef struct
+    {
+        uint8_t sound_id;
+    } WsRemoteSoundMsg;
+
+    typedef struct
+    {
+        uint32_t last_seq_id; // highest seq_id the client has seen (0 = none)
+    } WsResumeMsg;
+
+    typedef struct
+    {
+        uint32_t topics; // Topic bitmask, replaces the current subscription
+    } WsSubscribeMsg;
+
+    typedef struct
+    {
+        uint32_t present;
+        uint32_t ref_ms;      // server match clock when sent
+        uint32_t prev_ref_ms; // ref_ms of the previous exchange
+        uint32_t prev_rx_ms;  // server match clock when its reply arrived
+    } WsTimeSyncMsg;
+
+    // Field indices of WsTimeSyncMsg, for testing `present`
+    typedef enum
+    {
+        WS_TIME_SYNC_REF_MS = 0,
+        WS_TIME_SYNC_PREV_REF_MS,
+        WS_TIME_SYNC_PREV_RX_MS,
+    } WsTimeSyncField;
+
+    // ---------------------------------------------------------------- ESP32 -> client
+
+    typedef struct
+    {
+        uint32_t uptime_ms;
+        uint32_t seq_id;
+        // config
+        uint8_t device_id; // 6-bit IR protocol limit
+        uint8_t player_id; // 5-bit IR protocol limit
+        uint8_t team_id;
+        uint32_t color_rgb;
+        char device_name[WS_DEVICE_NAME_LEN];
+        bool enable_hearts;
+        uint8_t max_hearts;
+        uint8_t spawn_hearts;
+        uint16_t respawn_time_s;
+        bool friendly_fire;
+        bool enable_ammo;
+        uint16_t max_ammo;
+        uint16_t reload_time_ms;
+        uint16_t game_duration_s;
+        // stats
+        uint32_t shots;
+        uint32_t enemy_kills;
+        uint32_t friendly_kills;
+        uint32_t deaths;
+        // state
+        uint8_t current_hearts;
+        uint16_t current_ammo;
+        bool is_respawning;
+        bool is_reloading;
+        // clock
+        uint32_t match_ms;     // synchronized match clock
+        uint8_t clock_stratum; // 1 = server, n = n-1 peer hops, 15 = free-running
+    } WsStatusMsg;
+
+    typedef struct
+    {
+        uint32_t timestamp_ms;
+        uint32_t seq_id;
+        uint32_t match_ms; // synchronized match clock
+    } WsShotFiredMsg;
+
+    typedef struct
+    {
+        uint32_t timestamp_ms;
+        uint8_t shooter_id; // Player ID, 5-bit IR protocol limit
+        uint32_t seq_id;
+        uint32_t match_ms; // synchronized match clock
+    } WsHitReportMsg;
+
+    typedef struct
+    {
+        uint32_t timestamp_ms;
+        uint8_t current_hearts;
+        uint32_t seq_id;
+        uint32_t match_ms; // synchronized match clock
+    } WsRespawnMsg;
+
+    typedef struct
+    {
+        uint16_t current_ammo;
+    } WsReloadMsg;
+
+    typedef struct
+    {
+        uint32_t present;
+        char win_type[WS_WIN_TYPE_LEN];
+        uint8_t winner_team_id;
+        uint8_t winner_player_id;
+        uint16_t match_duration_s;
+    } WsGameOverMsg;
+
+    // Field indices of WsGameOverMsg, for testing `present`
+    typedef enum
+    {
+        WS_GAME_OVER_WIN_TYPE = 0,
+        WS_GAME_OVER_WINNER_TEAM_ID,
+        WS_GAME_OVER_WINNER_PLAYER_ID,
+        WS_GAME_OVER_MATCH_DURATION_S,
+    } WsGameOverField;
+
+    typedef struct
+    {
+        uint32_t present;
+        bool game_running;
+        bool game_over;
+        uint16_t time_remaining_s;
+        uint32_t total_kills;
+        uint32_t total_shots;
+        uint32_t total_hits;
+    } WsGameStateUpdateMsg;
+
+    // Field indices of WsGameStateUpdateMsg, for testing `present`
+    typedef enum
+    {
+        WS_GAME_STATE_UPDATE_GAME_RUNNING = 0,
+        WS_GAME_STATE_UPDATE_GAME_OVER,
+        WS_GAME_STATE_UPDATE_TIME_REMAINING_S,
+        WS_GAME_STATE_UPDATE_TOTAL_KILLS,
+        WS_GAME_STATE_UPDATE_TOTAL_SHOTS,
+        WS_GAME_STATE_UPDATE_TOTAL_HITS,
+    } WsGameStateUpdateField;
+
+    typedef struct
+    {
+        uint32_t from_seq_id; // first replayed seq_id (0 if nothing is replayed)
+        uint32_t to_seq_id;   // last replayed seq_id
+        uint16_t replayed;
+        bool snapshot; // events were lost (fell off the journal or device restarted)
+    } WsResumeResultMsg;
+
+    typedef struct
+    {
+        uint32_t ref_ms;   // echo of TIME_SYNC ref_ms
+        uint32_t match_ms; // device's match clock when sent
+        uint8_t stratum;
+    } WsTimeSyncReplyMsg;
+
+    typedef struct
+    {
+        uint32_t present;
+        char reply_to[WS_REPLY_TO_LEN]; // matches req_id
+        bool success;
+        // error
+        char error_code[WS_ERROR_CODE_LEN]; // set on failure
+        char error_message[WS_ERROR_MESSAGE_LEN];
+    } WsAckMsg;
+
+    // Field indices of WsAckMsg, for testing `present`
+    typedef enum
+    {
+        WS_ACK_REPLY_TO = 0,
+        WS_ACK_SUCCESS,
+        WS_ACK_ERROR_CODE,
+        WS_ACK_ERROR_MESSAGE,
+    } WsAckField;
+
+    /**
+     * @brief Storage large enough for any decoded message body
+     */
+    typedef struct
+    {
+        uint8_t op;
+        union
+        {
+            WsConfigUpdateMsg config_update;
+            WsGameCommandMsg game_command;
+            WsHitForwardMsg hit_forward;
+            WsRemoteSoundMsg remote_sound;
+            WsResumeMsg resume;
+            WsSubscribeMsg subscribe;
+            WsTimeSyncMsg time_sync;
+            WsStatusMsg status;
+            WsShotFiredMsg shot_fired;
+            WsHitReportMsg hit_report;
+            WsRespawnMsg respawn;
+            WsReloadMsg reload;
+            WsGameOverMsg game_over;
+            WsGameStateUpdateMsg game_state_update;
+            WsResumeResultMsg resume_result;
+            WsTimeSyncReplyMsg time_sync_reply;
+            WsAckMsg ack;
+        };
+    } WsMessage;
+
+    // ============================================================================
+    // DISPATCH
+    // ============================================================================
+
+    /**
+     * @brief Handlers for client -> ESP32 messages (NULL = not handled)
+     */
+    typedef struct
+    {
+        void (*get_status)(int fd);
+        void (*heartbeat)(int fd);
+        void (*config_update)(int fd, const WsConfigUpdateMsg* msg);
+        void (*game_command)(int fd, const WsGameCommandMsg* msg);
+        void (*hit_forward)(int fd, const WsHitForwardMsg* msg);
+        void (*kill_confirmed)(int fd);
+        void (*remote_sound)(int fd, const WsRemoteSoundMsg* msg);
+        void (*resume)(int fd, const WsResumeMsg* msg);
+        void (*subscribe)(int fd, const WsSubscribeMsg* msg);
+        void (*time_sync)(int fd, const WsTimeSyncMsg* msg);
+    } WsClientHandlers;
+
+    /**
+     * @brief Call the handler for a decoded client message
+     * @return false if the opcode is not a client message or its handler is NULL
+     */
+    bool ws_protocol_dispatch(const WsClientHandlers* handlers, int fd, const WsMessage* msg);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,31 +4,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "game_protocol.h"
+#include "ws_server_core.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-    // ============================================================================
-    // CALLBACK TYPES
-    // ============================================================================
-
-    /**
-     * @brief Callback for when a client connects/disconnects
-     * @param client_fd Client file descriptor
-     * @param connected true if connected, false if disconnected
-     */
-    typedef void (*ws_server_connect_cb_t)(int client_fd, bool connected);
-
-    /**
-     * @brief Callback for incoming messages from browser
-     * @param client_fd Client file descriptor
-     * @param type Message type parsed from JSON
-     * @param json Full JSON message
-     */
-    typedef void (*ws_server_message_cb_t)(int client_fd, const char* type, const char* json);
-
     // ============================================================================
     // SERVER CONFIGURATION
     // ============================================================================
@@ -37,6 +19,7 @@ extern "C"
     {
         ws_server_connect_cb_t on_connect;
         ws_server_message_cb_t on_message;
+        WsServerOptions options;
     } WsServerConfig;
 
     // ============================================================================
@@ -55,6 +38,11 @@ extern "C"
      */
     void ws_server_register(httpd_handle_t server);
 
+    /**
+     * @brief Change send/ping/codec options at runtime (see WsServerOptions)
+     */
+    void ws_server_set_options(const WsServerOptions* options);
+
     // ============================================================================
     // CONNECTION MANAGEMENT
     // ============================================================================
@@ -71,11 +59,25 @@ extern "C"
      */
     int ws_server_client_count(void);
 
+    /**
+     * @brief Check if events have anyone to go to
+     * @return true if a client is connected or multicast telemetry is enabled
+     */
+    bool ws_server_has_listeners(void);
+
     /**
      * @brief Cleanup stale clients that haven't sent activity recently
+     *
+     * Also PINGs the remaining clients (unless options.json_heartbeat_only).
      */
     void ws_server_cleanup_stale(void);
 
+    /**
+     * @brief Send queue depth/latency/drop counters per connected client
+     * @return Number of entries written to out
+     */
+    int ws_server_get_client_stats(WsClientStats* out, int max);
+
     // ============================================================================
     // MESSAGE SENDING
     // ============================================================================
@@ -94,6 +96,22 @@ extern "C"
      */
     void ws_server_broadcast(const char* message);
 
+    /**
+     * @brief Send a protocol message, encoded with the client's negotiated codec
+     * @param client_fd Client file descriptor
+     * @param op Opcode (OpCode)
+     * @param body Matching Ws*Msg body from ws_protocol.h (NULL for empty messages)
+     * @return true if queued successfully
+     */
+    bool ws_server_send_message(int client_fd, uint8_t op, const void* body);
+
+    /**
+     * @brief Broadcast a protocol message, encoding it once per codec in use
+     * @param op Opcode (OpCode)
+     * @param body Matching Ws*Msg body from ws_protocol.h (NULL for empty messages)
+     */
+    void ws_server_broadcast_message(uint8_t op, const void* body);
+
     // ============================================================================
     // GAME-SPECIFIC MESSAGES
     // ============================================================================
@@ -109,6 +127,9 @@ extern "C"
      */
     void ws_server_send_heartbeat_ack(int client_fd);
 
+    // Hit, shot and respawn events are kept in a ring journal; a client that
+    // reconnects with OP_RESUME {last_seq_id} gets the ones it missed replayed.
+
     /**
      * @brief Broadcast hit event (when this device is hit)
      * @param shooter_id ID of the device that hit us
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ws_codec.h"
+#include "ws_protocol.h"
+#include "ws_transport.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // CALLBACK TYPES
+    // ============================================================================
+
+    /**
+     * @brief Callback for when a client connects/disconnects
+     * @param client_fd Client file descriptor
+     * @param connected true if connected, false if disconnected
+     */
+    typedef void (*ws_server_connect_cb_t)(int client_fd, bool connected);
+
+    /**
+     * @brief Callback for incoming messages from browser
+     * @param client_fd Client file descriptor
+     * @param type Message type name (e.g. "config_update")
+     * @param data Raw frame payload (JSON text or binary codec)
+     * @param len Length of data
+     */
+    typedef void (*ws_server_message_cb_t)(int client_fd, const char* type, const uint8_t* data, size_t len);
+
+    /**
+     * @brief Handler for decoded messages (the game protocol lives here)
+     */
+    typedef void (*ws_core_dispatch_cb_t)(int client_fd, const WsMessage* msg);
+
+    // ============================================================================
+    // RUNTIME OPTIONS
+    // ============================================================================
+
+    /**
+     * @brief Server behaviour switches. All-zero is the default configuration.
+     */
+    typedef struct
+    {
+        bool sync_send;            // write frames on the caller's task instead of queueing them
+        bool json_heartbeat_only;  // no native PINGs: liveness relies on client OP_HEARTBEATs (compat)
+        bool json_only;            // ignore binary codec negotiation
+        uint16_t max_message_size; // inbound limit in bytes, 0 = WS_RX_MAX_MESSAGE_SIZE (also the upper bound)
+        uint16_t dead_peer_ms;     // silence (no frame, PONG included) before eviction, 0 = default
+    } WsServerOptions;
+
+    /**
+     * @brief Why a transport refused an inbound message
+     */
+    typedef enum
+    {
+        WS_RX_TOO_LARGE = 0, // over ws_core_max_message_size()
+        WS_RX_BUSY,          // no reassembly buffer free
+    } WsRxError;
+
+    /**
+     * @brief Per-client send queue statistics
+     *
+     * Latency is measured from queueing to the end of the write (sync_send:
+     * duration of the write).
+     */
+    typedef struct
+    {
+        int fd;
+        WsCodec codec;
+        uint32_t topics;     // WsTopic subscription mask
+        uint8_t queue_depth; // frames waiting right now
+        uint8_t queue_peak;
+        uint32_t sent;
+        uint32_t dropped;   // non-critical frames dropped because the queue was full
+        uint32_t coalesced; // status/ping frames replaced by a newer copy while queued
+        uint32_t send_errors;
+        uint32_t rx_rejected; // inbound messages refused (too large, no buffer)
+        uint32_t latency_last_us;
+        uint32_t latency_avg_us;
+        uint32_t latency_max_us;
+        uint32_t pongs;       // PONGs answering our PINGs
+        uint32_t rtt_last_us; // PING -> PONG round trip (includes send queue wait)
+        uint32_t rtt_avg_us;
+        uint32_t rtt_max_us;
+    } WsClientStats;
+
+    typedef struct
+    {
+        const WsTransport* transport;
+        WsServerOptions options;
+        ws_server_connect_cb_t on_connect;
+        ws_server_message_cb_t on_message;
+        ws_core_dispatch_cb_t dispatch;
+    } WsCoreConfig;
+
+    // ============================================================================
+    // CORE
+    // ============================================================================
+
+    /**
+     * @brief Initialize the client table and callbacks
+     *
+     * May be called again to swap the transport or callbacks; connected
+     * clients are forgotten.
+     */
+    void ws_core_init(const WsCoreConfig* config);
+
+    void ws_core_set_options(const WsServerOptions* options);
+    void ws_core_get_options(WsServerOptions* options);
+
+    // ----------------------------------------------------------- transport -> core
+
+    /**
+     * @brief A client finished the handshake
+     * @param offers_binary The client offered the binary subprotocol
+     */
+    void ws_core_on_open(int fd, bool offers_binary);
+
+    /**
+     * @brief A client connection is gone (CLOSE frame, error or transport close)
+     */
+    void ws_core_on_close(int fd);
+
+    /**
+     * @brief A complete frame arrived from a client
+     */
+    void ws_core_on_frame(int fd, WsFrameType type, const uint8_t* data, size_t len);
+
+    /**
+     * @brief The transport refused an inbound message
+     *
+     * Replies with an error ACK ("error": {"code", "message"}) written on the
+     * caller's task. The transport then closes the connection, since the rest
+     * of the message cannot be skipped reliably.
+     * @param len Size of the message so far, including the frame that crossed the limit
+     */
+    void ws_core_on_rx_error(int fd, WsRxError error, size_t len);
+
+    /**
+     * @brief Largest inbound message transports should accept right now
+     */
+    size_t ws_core_max_message_size(void);
+
+    // ----------------------------------------------------------- outbound
+
+    /**
+     * @brief Send a protocol message encoded with the client's codec
+     *
+     * Frames go through the client's bounded send queue: status snapshots
+     * replace an older queued copy, other messages are dropped when the queue
+     * is full, and hit/kill messages are never dropped - a client that cannot
+     * take them is evicted. Clients that stay over budget are evicted too.
+     */
+    bool ws_core_send_message(int fd, uint8_t op, const void* body);
+
+    /**
+     * @brief Write a protocol message immediately, bypassing the send queue
+     *
+     * For bursts that must not be dropped (journal replay). Call it from the
+     * transport task, i.e. from a dispatch handler.
+     */
+    bool ws_core_send_message_direct(int fd, uint8_t op, const void* body);
+
+    /**
+     * @brief Broadcast a protocol message, encoding it once per codec in use
+     *
+     * Only clients subscribed to the opcode's topic (ws_protocol_topic) get it.
+     * @return Number of clients the message was queued for (or written to, with sync_send)
+     */
+    int ws_core_broadcast_message(uint8_t op, const void* body);
+
+    /**
+     * @brief Send a preformatted payload unchanged
+     */
+    bool ws_core_send_raw(int fd, const uint8_t* data, size_t len, bool binary);
+
+    /**
+     * @brief Broadcast a preformatted payload unchanged (to every client, no topic filter)
+     */
+    void ws_core_broadcast_raw(const uint8_t* data, size_t len, bool binary);
+
+    /**
+     * @brief Send a WebSocket PING to every client
+     *
+     * The payload is the send timestamp; the PONG echoes it back and gives
+     * the client's round-trip time.
+     */
+    void ws_core_ping_all(void);
+
+    // ----------------------------------------------------------- clients
+
+    /**
+     * @brief Drop dead peers and PING the others
+     *
+     * A client that sent nothing (PONGs included) for the dead peer window is
+     * evicted. Unless json_heartbeat_only is set, PINGs go out every third of
+     * the window, so call this at least that often.
+     */
+    void ws_core_cleanup_stale(void);
+
+    int ws_core_client_count(void);
+
+    /**
+     * @brief Replace a client's topic subscription (WsTopic bitmask)
+     */
+    void ws_core_set_topics(int fd, uint32_t topics);
+
+    /**
+     * @brief A client's topic subscription, 0 if the client is unknown
+     */
+    uint32_t ws_core_get_topics(int fd);
+
+    /**
+     * @brief Snapshot the send queue statistics of the connected clients
+     * @param out Array receiving one entry per client
+     * @param max Capacity of out
+     * @return Number of entries written
+     */
+    int ws_core_get_client_stats(WsClientStats* out, int max);
+
+    /**
+     * @brief Codec negotiated by a client
+     * @return WS_CODEC_JSON if the client is unknown
+     */
+    WsCodec ws_core_client_codec(int fd);
+
+#ifdef __cplusplus
+}
+#endif
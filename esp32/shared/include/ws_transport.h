@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // ============================================================================
+    // TRANSPORT INTERFACE
+    // ============================================================================
+    //
+    // A transport owns the sockets and the WebSocket framing. It reports
+    // connections and complete frames to the server core (ws_core_on_open,
+    // ws_core_on_frame, ws_core_on_close) and sends frames on its behalf.
+    // Device builds use esp_http_server (ws_transport_httpd.cpp), host builds a
+    // plain POSIX socket loop (esp32/host).
+
+    // Largest inbound message a transport reassembles (all fragments together).
+    // WsServerOptions.max_message_size can lower it at runtime.
+#ifndef WS_RX_MAX_MESSAGE_SIZE
+#define WS_RX_MAX_MESSAGE_SIZE 4096
+#endif
+
+    // CLOSE status sent after rejecting an inbound message (RFC 6455 7.4.1)
+#define WS_CLOSE_MESSAGE_TOO_BIG 1009
+#define WS_CLOSE_TRY_AGAIN_LATER 1013
+
+    // Values match the RFC 6455 opcodes
+    typedef enum
+    {
+        WS_FRAME_TEXT = 0x1,
+        WS_FRAME_BINARY = 0x2,
+        WS_FRAME_CLOSE = 0x8,
+        WS_FRAME_PING = 0x9,
+        WS_FRAME_PONG = 0xA,
+    } WsFrameType;
+
+    typedef struct
+    {
+        const char* name;
+        void* ctx;
+
+        /**
+         * @brief Write one frame to a client on the caller's task
+         * @return true if the frame was written
+         */
+        bool (*send)(void* ctx, int fd, WsFrameType type, const uint8_t* data, size_t len);
+
+        /**
+         * @brief True if the socket can take a frame without blocking (NULL = always)
+         *
+         * Queued frames for a client whose socket is full wait for the next
+         * drain instead of blocking the transport task for everybody.
+         */
+        bool (*writable)(void* ctx, int fd);
+
+        /**
+         * @brief Run fn(arg) on the transport's own task (where frames are read)
+         *
+         * Used by the core to drain per-client send queues.
+         * @return false if the work could not be scheduled
+         */
+        bool (*post)(void* ctx, void (*fn)(void* arg), void* arg);
+
+        /**
+         * @brief Close a client connection. The transport reports it back via ws_core_on_close.
+         */
+        void (*close)(void* ctx, int fd);
+    } WsTransport;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <esp_http_server.h>
+#include "ws_transport.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief WebSocket transport on top of esp_http_server
+     */
+    const WsTransport* ws_transport_httpd(void);
+
+    /**
+     * @brief Register the /ws endpoint and route its frames to the server core
+     * @param server HTTP server handle
+     */
+    void ws_transport_httpd_register(httpd_handle_t server);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,279 @@
+#include "clock_sync.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Match clock estimator (see clock_sync.h). No I/O here: the WebSocket and
+// ESP-NOW exchanges feed samples in, so the host tools can run it as is.
+
+static const char* TAG = "ClockSync";
+
+#define FILTER_SIZE      8                      // samples the lowest delay is picked from
+#define SKEW_POINTS      32                     // picked samples the skew is fitted over
+#define SKEW_MIN_POINTS  4
+#define SKEW_MIN_SPAN_US (20LL * 1000 * 1000)   // shorter spans are dominated by jitter
+#define MAX_SKEW         100e-6                 // crystals are within ±50 ppm: two differ by 100 ppm at most
+
+typedef struct
+{
+    int64_t offset_us;
+    int64_t delay_us;
+    int64_t local_us;
+} Sample;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static uint8_t s_device_id = 0;
+
+static ClockSyncSource s_source = CLOCK_SRC_NONE;
+static int s_ref_id = -1;
+static uint8_t s_stratum = CLOCK_SYNC_STRATUM_FREE;
+static int64_t s_last_sample_us = 0;
+
+static Sample s_filter[FILTER_SIZE];
+static uint8_t s_filter_count = 0;
+static uint8_t s_filter_next = 0;
+static Sample s_points[SKEW_POINTS];
+static uint8_t s_point_count = 0;
+static uint8_t s_point_next = 0;
+
+// match = local + s_base_offset_us + s_skew * (local - s_base_local_us)
+static int64_t s_base_local_us = 0;
+static int64_t s_base_offset_us = 0;
+static double s_skew = 0.0;
+static uint32_t s_delay_us = 0;
+static uint32_t s_samples = 0;
+static uint32_t s_rejected = 0;
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+static bool source_fresh(int64_t now_us)
+{
+    if (s_source == CLOCK_SRC_NONE)
+        return false;
+    int64_t timeout_ms = s_source == CLOCK_SRC_SERVER ? CLOCK_SYNC_SERVER_TIMEOUT_MS : CLOCK_SYNC_PEER_TIMEOUT_MS;
+    return now_us - s_last_sample_us < timeout_ms * 1000;
+}
+
+static bool is_current(ClockSyncSource source, int ref_id, int64_t now_us)
+{
+    return source_fresh(now_us) && s_source == source && s_ref_id == ref_id;
+}
+
+// Would a source at stratum replace the current one?
+static bool ranks_better(ClockSyncSource source, int ref_id, uint8_t stratum, int64_t now_us)
+{
+    // A free-running device is its own root, so peers below its device_id win
+    bool fresh = source_fresh(now_us);
+    uint8_t cur_stratum = fresh ? s_stratum : CLOCK_SYNC_STRATUM_FREE;
+    int cur_id = fresh ? s_ref_id : s_device_id;
+    if (stratum != cur_stratum)
+        return stratum < cur_stratum;
+    return source == CLOCK_SRC_PEER && (!fresh || s_source == CLOCK_SRC_PEER) && ref_id < cur_id;
+}
+
+static uint8_t peer_stratum(uint8_t ref_stratum)
+{
+    return ref_stratum >= CLOCK_SYNC_STRATUM_MAX ? CLOCK_SYNC_STRATUM_FREE : ref_stratum + 1;
+}
+
+static int64_t project(int64_t local_us)
+{
+    return local_us + s_base_offset_us + (int64_t)(s_skew * (double)(local_us - s_base_local_us));
+}
+
+// Least-squares slope of offset over local time across the picked samples
+static void fit_skew(void)
+{
+    if (s_point_count < SKEW_MIN_POINTS)
+        return;
+
+    int64_t x0 = s_points[0].local_us, y0 = s_points[0].offset_us;
+    int64_t min_x = INT64_MAX, max_x = INT64_MIN;
+    double sx = 0, sy = 0;
+    for (uint8_t i = 0; i < s_point_count; i++)
+    {
+        int64_t x = s_points[i].local_us;
+        min_x = x < min_x ? x : min_x;
+        max_x = x > max_x ? x : max_x;
+        sx += (double)(x - x0);
+        sy += (double)(s_points[i].offset_us - y0);
+    }
+    if (max_x - min_x < SKEW_MIN_SPAN_US)
+        return;
+
+    double mx = sx / s_point_count, my = sy / s_point_count;
+    double sxy = 0, sxx = 0;
+    for (uint8_t i = 0; i < s_point_count; i++)
+    {
+        double dx = (double)(s_points[i].local_us - x0) - mx;
+        double dy = (double)(s_points[i].offset_us - y0) - my;
+        sxy += dx * dy;
+        sxx += dx * dx;
+    }
+    if (sxx <= 0)
+        return;
+
+    double skew = sxy / sxx;
+    if (skew > MAX_SKEW)
+        skew = MAX_SKEW;
+    else if (skew < -MAX_SKEW)
+        skew = -MAX_SKEW;
+    s_skew = skew;
+}
+
+void clock_sync_init(uint8_t device_id)
+{
+    if (!s_mutex)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return;
+        }
+    }
+    LOCK();
+    s_device_id = device_id;
+    UNLOCK();
+}
+
+uint8_t clock_sync_device_id(void)
+{
+    return s_device_id;
+}
+
+bool clock_sync_add_sample(ClockSyncSource source, int ref_id, uint8_t ref_stratum, int64_t offset_us,
+                           int64_t delay_us, int64_t local_us)
+{
+    if (!s_mutex || source == CLOCK_SRC_NONE)
+        return false;
+    if (source == CLOCK_SRC_PEER && ref_id == s_device_id)
+        return false;
+    // Millisecond server timestamps can make a fast round trip come out slightly negative
+    if (delay_us < 0)
+        delay_us = 0;
+
+    uint8_t stratum = source == CLOCK_SRC_PEER ? peer_stratum(ref_stratum) : CLOCK_SYNC_STRATUM_SERVER;
+
+    LOCK();
+    if (!is_current(source, ref_id, local_us))
+    {
+        if (!ranks_better(source, ref_id, stratum, local_us))
+        {
+            s_rejected++;
+            UNLOCK();
+            return false;
+        }
+
+        ESP_LOGI(TAG, "Following %s %d at stratum %u", source == CLOCK_SRC_SERVER ? "server fd" : "device", ref_id,
+                 stratum);
+        s_source = source;
+        s_ref_id = ref_id;
+        s_filter_count = s_filter_next = 0;
+        s_point_count = s_point_next = 0;
+        s_samples = 0;
+    }
+    s_stratum = stratum;
+    s_last_sample_us = local_us;
+    s_samples++;
+
+    s_filter[s_filter_next] = {offset_us, delay_us, local_us};
+    s_filter_next = (s_filter_next + 1) % FILTER_SIZE;
+    if (s_filter_count < FILTER_SIZE)
+        s_filter_count++;
+
+    const Sample* best = &s_filter[0];
+    for (uint8_t i = 1; i < s_filter_count; i++)
+    {
+        if (s_filter[i].delay_us < best->delay_us)
+            best = &s_filter[i];
+    }
+    s_base_local_us = best->local_us;
+    s_base_offset_us = best->offset_us;
+    s_delay_us = (uint32_t)best->delay_us;
+
+    if (best->local_us == local_us)
+    {
+        s_points[s_point_next] = *best;
+        s_point_next = (s_point_next + 1) % SKEW_POINTS;
+        if (s_point_count < SKEW_POINTS)
+            s_point_count++;
+        fit_skew();
+    }
+    UNLOCK();
+    return true;
+}
+
+bool clock_sync_accepts_peer(uint8_t device_id, uint8_t stratum)
+{
+    if (!s_mutex || device_id == s_device_id)
+        return false;
+    int64_t now = esp_timer_get_time();
+    LOCK();
+    bool ok = is_current(CLOCK_SRC_PEER, device_id, now) ||
+              ranks_better(CLOCK_SRC_PEER, device_id, peer_stratum(stratum), now);
+    UNLOCK();
+    return ok;
+}
+
+int64_t clock_sync_match_us_at(int64_t local_us)
+{
+    if (!s_mutex)
+        return local_us;
+    LOCK();
+    int64_t match_us = project(local_us);
+    UNLOCK();
+    return match_us;
+}
+
+uint32_t clock_sync_match_ms(void)
+{
+    return (uint32_t)(clock_sync_match_us_at(esp_timer_get_time()) / 1000);
+}
+
+uint8_t clock_sync_stratum(void)
+{
+    if (!s_mutex)
+        return CLOCK_SYNC_STRATUM_FREE;
+    LOCK();
+    uint8_t stratum = source_fresh(esp_timer_get_time()) ? s_stratum : CLOCK_SYNC_STRATUM_FREE;
+    UNLOCK();
+    return stratum;
+}
+
+uint8_t clock_sync_ref_device(void)
+{
+    if (!s_mutex)
+        return CLOCK_SYNC_NO_DEVICE;
+    LOCK();
+    bool peer = s_source == CLOCK_SRC_PEER && source_fresh(esp_timer_get_time());
+    uint8_t ref = peer ? (uint8_t)s_ref_id : CLOCK_SYNC_NO_DEVICE;
+    UNLOCK();
+    return ref;
+}
+
+void clock_sync_get_status(ClockSyncStatus* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->stratum = CLOCK_SYNC_STRATUM_FREE;
+    out->ref_id = -1;
+    if (!s_mutex)
+        return;
+
+    int64_t now = esp_timer_get_time();
+    LOCK();
+    bool fresh = source_fresh(now);
+    out->source = fresh ? s_source : CLOCK_SRC_NONE;
+    out->stratum = fresh ? s_stratum : CLOCK_SYNC_STRATUM_FREE;
+    out->ref_id = s_ref_id;
+    out->offset_us = s_base_offset_us;
+    out->skew_ppb = (int32_t)(s_skew * 1e9);
+    out->delay_us = s_delay_us;
+    out->samples = s_samples;
+    out->rejected = s_rejected;
+    out->age_ms = s_samples ? (uint32_t)((now - s_last_sample_us) / 1000) : 0;
+    UNLOCK();
+}
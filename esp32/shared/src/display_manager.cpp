@@ -6,6 +6,7 @@
 #include <lvgl.h>
 #include <stdio.h>
 #include <string.h>
+#include "game_protocol.h"
 
 // ======================================================================
 // State machine
@@ -192,8 +193,8 @@ static void handle_event(const dm_event_t* e)
         s_killer_pid = e->killed.player_id;
         s_killer_did = e->killed.device_id;
         char sub[32];
-        const char* name = s_src.player_name ? s_src.player_name(e->killed.player_id) : NULL;
-        if (name)
+        char name[PLAYER_NAME_LEN];
+        if (s_src.player_name && s_src.player_name(e->killed.player_id, name, sizeof(name)))
             snprintf(sub, sizeof(sub), "by %s", name);
         else
             snprintf(sub, sizeof(sub), "by P:%u D:%u",
@@ -286,20 +287,36 @@ static void render_idle(void)
     const int  pid  = s_src.player_id      ? s_src.player_id()      : 0;
     const int  did  = s_src.device_id      ? s_src.device_id()      : 0;
 
+    // One consistent read of the counters when the source offers it
+    dm_game_stats_t gs = {};
+    if (s_src.game_stats)
+    {
+        s_src.game_stats(&gs);
+    }
+    else
+    {
+        gs.hearts     = s_src.hearts_remaining ? s_src.hearts_remaining() : 0;
+        gs.max_hearts = s_src.max_hearts       ? s_src.max_hearts()       : 5;
+        gs.kills      = s_src.score            ? s_src.score()            : 0;
+        gs.deaths     = s_src.deaths           ? s_src.deaths()           : 0;
+        gs.shots      = s_src.tx_count         ? (int)s_src.tx_count()    : 0;
+    }
+
     if (s_dev == DEV_WEAPON)
     {
         const int ammo  = s_src.ammo     ? s_src.ammo()     : 0;
-        const int kills = s_src.score    ? s_src.score()    : 0;
-        const int shots = s_src.tx_count ? (int)s_src.tx_count() : 0;
+        const int kills = gs.kills;
+        const int shots = gs.shots;
+        const int field = s_src.players_on_field ? s_src.players_on_field() : -1;
         ui_weapon_idle_update(&s_weapon, ammo, wifi, ws, rssi, pid, did,
-                              kills, shots);
+                              kills, shots, field);
     }
     else
     {
-        const int hearts  = s_src.hearts_remaining ? s_src.hearts_remaining() : 0;
-        const int mh      = s_src.max_hearts       ? s_src.max_hearts()       : 5;
+        const int hearts  = gs.hearts;
+        const int mh      = gs.max_hearts;
         const char* name  = s_src.device_name      ? s_src.device_name()      : "?";
-        const int  deaths = s_src.deaths           ? s_src.deaths()           : 0;
+        const int  deaths = gs.deaths;
         ui_target_game_update(&s_game, hearts, mh,
                               wifi, ws, rssi, pid, did, name, deaths);
     }
@@ -309,14 +326,10 @@ static void render_respawn(void)
 {
     const uint32_t remaining = s_src.respawn_time_left ? s_src.respawn_time_left() : 0;
     const uint32_t total     = 10000;
-    const char* killer = s_src.player_name ? s_src.player_name(s_killer_pid) : NULL;
     // If no name found, format as "P:<id>"
-    char id_buf[20];
-    if (!killer)
-    {
-        snprintf(id_buf, sizeof(id_buf), "P:%u D:%u", s_killer_pid, s_killer_did);
-        killer = id_buf;
-    }
+    char killer[PLAYER_NAME_LEN];
+    if (!s_src.player_name || !s_src.player_name(s_killer_pid, killer, sizeof(killer)))
+        snprintf(killer, sizeof(killer), "P:%u D:%u", s_killer_pid, s_killer_did);
     ui_respawn_update(&s_respawn, remaining, total, killer);
 }
 
@@ -205,7 +205,7 @@ void ui_weapon_idle_update(ui_weapon_idle_t* w,
                            int ammo,
                            bool wifi, bool ws, int rssi,
                            int player_id, int device_id,
-                           int kills, int shots)
+                           int kills, int shots, int on_field)
 {
     char buf[32];
 
@@ -217,7 +217,10 @@ void ui_weapon_idle_update(ui_weapon_idle_t* w,
     snprintf(buf, sizeof(buf), "K:%d", kills);
     lv_label_set_text(w->kills, buf);
 
-    snprintf(buf, sizeof(buf), "S:%d", shots);
+    if (on_field >= 0)
+        snprintf(buf, sizeof(buf), "S:%d F:%d", shots, on_field);
+    else
+        snprintf(buf, sizeof(buf), "S:%d", shots);
     lv_label_set_text(w->shots, buf);
 }
 
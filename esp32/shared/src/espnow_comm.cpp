@@ -1,9 +1,16 @@
 #include "espnow_comm.h"
 #include <esp_log.h>
+#include <esp_random.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
+#include <freertos/task.h>
 #include <ctype.h>
 #include <string.h>
+#include "clock_sync.h"
 #include "hash.h"
+#include "presence.h"
+#include "roster.h"
+#include "scoreboard.h"
 
 // Coexistence API availability depends on chip and IDF version
 #if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32C3 || CONFIG_IDF_TARGET_ESP32S2
@@ -19,11 +26,39 @@ static const uint8_t ESPNOW_PMK[ESP_NOW_KEY_LEN] = {'r', 'a', 'y', 'z', '-', 'e'
 
 static const char* TAG = "EspNowComm";
 static_assert(sizeof(EspnowMsgType) == 1, "EspnowMsgType must stay 1 byte");
+static_assert(sizeof(EspnowClockBeacon) == sizeof(PlayerMessage), "Clock beacons travel as PlayerMessage frames");
+static_assert(sizeof(EspnowScoreGossip) == sizeof(PlayerMessage), "Score gossip travels as PlayerMessage frames");
 static bool s_initialised = false;
 static uint8_t s_channel = 0;
-static QueueHandle_t s_rx_queue = NULL;
+static QueueHandle_t s_rx_lanes[ESPNOW_LANE_COUNT] = {};
+static SemaphoreHandle_t s_rx_signal = NULL; // given after every enqueue, wakes espnow_comm_receive
 static SemaphoreHandle_t s_send_mutex = NULL;
 static uint8_t s_peer_count = 0;
+static uint8_t s_device_id = 0;
+static SemaphoreHandle_t s_peer_mutex = NULL;
+static int64_t s_batch_window_us = 0;
+static EspnowFrameStats s_frame_stats = {}; // rx side written by recv_cb only, tx side under s_send_mutex
+
+static const uint8_t s_broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Receive filter, indexed by EspnowMsgType; types past the end are accepted
+#define RX_FILTER_TYPES 8
+static volatile uint8_t s_rx_filter[RX_FILTER_TYPES] = {};
+static EspnowRxStats s_rx_stats = {}; // written by recv_cb only
+
+static const uint8_t LANE_DEPTH[ESPNOW_LANE_COUNT] = {
+    16, // HIT: two full frames of confirmations
+    8,  // CONTROL
+    16, // SHOT
+    8,  // BEACON: clock beacons every ESPNOW_CLOCK_BEACON_MS, presence a few times slower
+};
+
+static bool reliable_init(void);
+static void presence_on_beacon(const EspnowMessageEnvelope* env);
+static void score_on_gossip(const EspnowMessageEnvelope* env);
+static bool batch_init(void);
+static void batch_flush_to(const uint8_t mac[ESP_NOW_ETH_ALEN]);
+static void peer_tx_result(const uint8_t* mac, bool ok);
 
 static void log_mac(const uint8_t mac[ESP_NOW_ETH_ALEN], const char* prefix)
 {
@@ -61,23 +96,90 @@ static bool parse_mac_str(const char* str, uint8_t mac[ESP_NOW_ETH_ALEN])
     return false;
 }
 
-static void recv_cb(const esp_now_recv_info_t* info, const uint8_t* data, int len)
+static EspnowRxLane lane_of(EspnowMsgType type)
 {
-    if (!info || !data || len != sizeof(PlayerMessage))
+    switch (type)
     {
-        ESP_LOGW(TAG, "RX invalid len=%d", len);
-        return;
+        case ESPNOW_MSG_HIT_EVENT:
+        case ESPNOW_MSG_ACK:
+            return ESPNOW_LANE_HIT;
+        case ESPNOW_MSG_SHOT:
+            return ESPNOW_LANE_SHOT;
+        case ESPNOW_MSG_HEARTBEAT:
+        case ESPNOW_MSG_PRESENCE:
+            return ESPNOW_LANE_BEACON;
+        default:
+            return ESPNOW_LANE_CONTROL;
+    }
+}
+
+static bool rx_wanted(const PlayerMessage* msg)
+{
+    if ((uint8_t)msg->type >= RX_FILTER_TYPES)
+        return true;
+    switch ((EspnowRxFilter)s_rx_filter[msg->type])
+    {
+        case ESPNOW_RX_DROP:
+            return false;
+        case ESPNOW_RX_TO_SELF:
+            return msg->device_id == s_device_id;
+        default:
+            return true;
     }
+}
 
-    if (!s_rx_queue)
+static void recv_cb(const esp_now_recv_info_t* info, const uint8_t* data, int len)
+{
+    if (!info || !data || !s_rx_signal)
         return;
 
+    // A bare PlayerMessage, or a header and count of them
+    const uint8_t* body = data;
+    int count = 1;
+    if (len != sizeof(PlayerMessage))
+    {
+        const EspnowFrameHeader* hdr = (const EspnowFrameHeader*)data;
+        if (len < (int)sizeof(EspnowFrameHeader) || hdr->magic != ESPNOW_FRAME_MAGIC ||
+            hdr->version != ESPNOW_FRAME_VERSION ||
+            len != (int)(sizeof(EspnowFrameHeader) + hdr->count * sizeof(PlayerMessage)))
+        {
+            s_frame_stats.rx_dropped++;
+            ESP_LOGW(TAG, "RX invalid len=%d", len);
+            return;
+        }
+        body = data + sizeof(EspnowFrameHeader);
+        count = hdr->count;
+    }
+    s_frame_stats.frames_rx++;
+
     EspnowMessageEnvelope env = {};
+    env.rx_us = esp_timer_get_time();
+    env.rssi = info->rx_ctrl ? (int8_t)info->rx_ctrl->rssi : 0;
     memcpy(env.src_mac, info->src_addr, ESP_NOW_ETH_ALEN);
-    memcpy(&env.msg, data, sizeof(PlayerMessage));
 
     BaseType_t hp_task_woken = pdFALSE;
-    xQueueSendFromISR(s_rx_queue, &env, &hp_task_woken);
+    bool queued = false;
+    for (int i = 0; i < count; i++)
+    {
+        memcpy(&env.msg, body + i * sizeof(PlayerMessage), sizeof(PlayerMessage));
+        if (!rx_wanted(&env.msg))
+        {
+            s_rx_stats.filtered++;
+            continue;
+        }
+        EspnowRxLane lane = lane_of(env.msg.type);
+        if (xQueueSendFromISR(s_rx_lanes[lane], &env, &hp_task_woken) == pdTRUE)
+        {
+            s_frame_stats.messages_rx++;
+            queued = true;
+        }
+        else
+        {
+            s_rx_stats.overflow[lane]++;
+        }
+    }
+    if (queued)
+        xSemaphoreGiveFromISR(s_rx_signal, &hp_task_woken);
     if (hp_task_woken == pdTRUE)
     {
         portYIELD_FROM_ISR();
@@ -86,7 +188,7 @@ static void recv_cb(const esp_now_recv_info_t* info, const uint8_t* data, int le
 
 static void send_cb(const esp_now_send_info_t* info, esp_now_send_status_t status)
 {
-    (void)info;
+    peer_tx_result(info ? info->des_addr : NULL, status == ESP_NOW_SEND_SUCCESS);
     if (status != ESP_NOW_SEND_SUCCESS)
     {
         ESP_LOGW(TAG, "Send status: %d", status);
@@ -118,14 +220,37 @@ esp_err_t espnow_comm_init(const EspnowCommConfig* config)
         return err;
     }
 
-    if (!s_rx_queue)
+    for (int i = 0; i < ESPNOW_LANE_COUNT; i++)
     {
-        s_rx_queue = xQueueCreate(16, sizeof(EspnowMessageEnvelope));
+        if (!s_rx_lanes[i])
+            s_rx_lanes[i] = xQueueCreate(LANE_DEPTH[i], sizeof(EspnowMessageEnvelope));
+        if (!s_rx_lanes[i])
+        {
+            ESP_LOGE(TAG, "Failed to create receive lane %d", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (!s_rx_signal)
+    {
+        s_rx_signal = xSemaphoreCreateBinary();
     }
     if (!s_send_mutex)
     {
         s_send_mutex = xSemaphoreCreateMutex();
     }
+    if (!s_peer_mutex)
+    {
+        s_peer_mutex = xSemaphoreCreateMutex();
+    }
+    if (!reliable_init())
+    {
+        ESP_LOGE(TAG, "Reliable delivery unavailable");
+    }
+    if (!batch_init())
+    {
+        ESP_LOGE(TAG, "Batching unavailable");
+    }
+    presence_init();
 
     esp_now_register_recv_cb(recv_cb);
     esp_now_register_send_cb(send_cb);
@@ -133,6 +258,8 @@ esp_err_t espnow_comm_init(const EspnowCommConfig* config)
 
     if (config)
     {
+        s_device_id = config->device_id;
+        s_batch_window_us = (int64_t)config->batch_window_ms * 1000;
         if (config->set_pmk)
         {
             esp_now_set_pmk(ESPNOW_PMK);
@@ -246,19 +373,22 @@ esp_err_t espnow_comm_load_peers_from_csv(const char* csv_list)
     return loaded > 0 ? ESP_OK : ESP_FAIL;
 }
 
-bool espnow_comm_send(const uint8_t mac[ESP_NOW_ETH_ALEN], const PlayerMessage* msg)
+static bool send_frame(const uint8_t mac[ESP_NOW_ETH_ALEN], const uint8_t* data, size_t len, uint8_t messages)
 {
-    if (!msg)
-        return false;
     if (!s_send_mutex)
         return false;
 
     bool ok = false;
     if (xSemaphoreTake(s_send_mutex, pdMS_TO_TICKS(50)) == pdTRUE)
     {
-        esp_err_t err = esp_now_send(mac, (const uint8_t*)msg, sizeof(PlayerMessage));
+        esp_err_t err = esp_now_send(mac, data, len);
         ok = (err == ESP_OK);
-        if (!ok)
+        if (ok)
+        {
+            s_frame_stats.frames_tx++;
+            s_frame_stats.messages_tx += messages;
+        }
+        else
         {
             ESP_LOGW(TAG, "esp_now_send failed: %s", esp_err_to_name(err));
         }
@@ -267,20 +397,875 @@ bool espnow_comm_send(const uint8_t mac[ESP_NOW_ETH_ALEN], const PlayerMessage*
     return ok;
 }
 
+// ============================================================================
+// BATCHING
+// ============================================================================
+// One open frame per destination (broadcast and a few unicast MACs). The first
+// message into an empty frame starts its window; an esp_timer sends frames
+// whose window ran out, and a full frame goes at once.
+
+#define BATCH_DESTS 5
+
+typedef struct
+{
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    uint8_t count;
+    int64_t opened_us;
+    uint8_t frame[sizeof(EspnowFrameHeader) + ESPNOW_FRAME_MAX_MESSAGES * sizeof(PlayerMessage)];
+} Batch;
+
+static SemaphoreHandle_t s_batch_mutex = NULL;
+static esp_timer_handle_t s_batch_timer = NULL;
+static Batch s_batches[BATCH_DESTS] = {};
+
+// Caller holds s_batch_mutex
+static void batch_send(Batch* b)
+{
+    if (b->count == 0)
+        return;
+    if (b->count == 1)
+    {
+        send_frame(b->mac, b->frame + sizeof(EspnowFrameHeader), sizeof(PlayerMessage), 1);
+    }
+    else
+    {
+        EspnowFrameHeader* hdr = (EspnowFrameHeader*)b->frame;
+        hdr->magic = ESPNOW_FRAME_MAGIC;
+        hdr->version = ESPNOW_FRAME_VERSION;
+        hdr->count = b->count;
+        hdr->flags = 0;
+        send_frame(b->mac, b->frame, sizeof(EspnowFrameHeader) + b->count * sizeof(PlayerMessage), b->count);
+    }
+    b->count = 0;
+}
+
+// Caller holds s_batch_mutex
+static void batch_arm_timer(int64_t now)
+{
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < BATCH_DESTS; i++)
+    {
+        if (s_batches[i].count && s_batches[i].opened_us + s_batch_window_us < next)
+            next = s_batches[i].opened_us + s_batch_window_us;
+    }
+    esp_timer_stop(s_batch_timer); // ESP_ERR_INVALID_STATE when idle
+    if (next != INT64_MAX)
+        esp_timer_start_once(s_batch_timer, next > now ? next - now : 1);
+}
+
+static void batch_timer_cb(void* arg)
+{
+    (void)arg;
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+    for (int i = 0; i < BATCH_DESTS; i++)
+    {
+        if (s_batches[i].count && now - s_batches[i].opened_us >= s_batch_window_us)
+            batch_send(&s_batches[i]);
+    }
+    batch_arm_timer(now);
+    xSemaphoreGive(s_batch_mutex);
+}
+
+static bool batch_init(void)
+{
+    if (s_batch_mutex)
+        return true;
+    s_batch_mutex = xSemaphoreCreateMutex();
+    if (!s_batch_mutex)
+        return false;
+
+    esp_timer_create_args_t args = {};
+    args.callback = batch_timer_cb;
+    args.name = "espnow_batch";
+    if (esp_timer_create(&args, &s_batch_timer) != ESP_OK)
+    {
+        vSemaphoreDelete(s_batch_mutex);
+        s_batch_mutex = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void batch_add(const uint8_t mac[ESP_NOW_ETH_ALEN], const PlayerMessage* msg)
+{
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+
+    Batch* b = NULL;
+    Batch* oldest = &s_batches[0];
+    for (int i = 0; i < BATCH_DESTS && !b; i++)
+    {
+        Batch* c = &s_batches[i];
+        if (c->count && memcmp(c->mac, mac, ESP_NOW_ETH_ALEN) == 0)
+            b = c;
+        else if (c->count == 0 || (oldest->count && c->opened_us < oldest->opened_us))
+            oldest = c;
+    }
+    if (!b)
+    {
+        // No open frame for this destination: take a free one, or send the oldest early
+        b = oldest;
+        batch_send(b);
+        memcpy(b->mac, mac, ESP_NOW_ETH_ALEN);
+        b->opened_us = now;
+    }
+
+    memcpy(b->frame + sizeof(EspnowFrameHeader) + b->count * sizeof(PlayerMessage), msg, sizeof(PlayerMessage));
+    b->count++;
+    if (b->count == ESPNOW_FRAME_MAX_MESSAGES)
+        batch_send(b);
+    batch_arm_timer(now);
+    xSemaphoreGive(s_batch_mutex);
+}
+
+// Send whatever is waiting for mac, so a message sent around the batch keeps its order
+static void batch_flush_to(const uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    if (!s_batch_mutex)
+        return;
+    xSemaphoreTake(s_batch_mutex, portMAX_DELAY);
+    for (int i = 0; i < BATCH_DESTS; i++)
+    {
+        if (s_batches[i].count && memcmp(s_batches[i].mac, mac, ESP_NOW_ETH_ALEN) == 0)
+            batch_send(&s_batches[i]);
+    }
+    batch_arm_timer(esp_timer_get_time());
+    xSemaphoreGive(s_batch_mutex);
+}
+
+void espnow_comm_get_frame_stats(EspnowFrameStats* out)
+{
+    *out = s_frame_stats;
+}
+
+bool espnow_comm_send(const uint8_t mac[ESP_NOW_ETH_ALEN], const PlayerMessage* msg)
+{
+    if (!msg)
+        return false;
+    if (s_batch_window_us == 0 || !s_batch_mutex)
+        return send_frame(mac, (const uint8_t*)msg, sizeof(PlayerMessage), 1);
+    batch_add(mac, msg);
+    return true;
+}
+
 bool espnow_comm_broadcast(const PlayerMessage* msg)
 {
-    static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-    return espnow_comm_send(broadcast_mac, msg);
+    return espnow_comm_send(s_broadcast_mac, msg);
+}
+
+QueueHandle_t espnow_comm_queue(EspnowRxLane lane)
+{
+    return lane < ESPNOW_LANE_COUNT ? s_rx_lanes[lane] : NULL;
+}
+
+void espnow_comm_set_rx_filter(EspnowMsgType type, EspnowRxFilter filter)
+{
+    if ((uint8_t)type < RX_FILTER_TYPES)
+        s_rx_filter[type] = (uint8_t)filter;
 }
 
-QueueHandle_t espnow_comm_queue(void)
+void espnow_comm_set_default_filters(void)
 {
-    return s_rx_queue;
+    espnow_comm_set_rx_filter(ESPNOW_MSG_SHOT, ESPNOW_RX_DROP);
+    espnow_comm_set_rx_filter(ESPNOW_MSG_HIT_EVENT, ESPNOW_RX_TO_SELF);
+}
+
+void espnow_comm_get_rx_stats(EspnowRxStats* out)
+{
+    *out = s_rx_stats;
+}
+
+// Highest lane first; the signal only says something may be waiting
+static bool rx_take(EspnowMessageEnvelope* out, TickType_t ticks_to_wait)
+{
+    TickType_t start = xTaskGetTickCount();
+    while (true)
+    {
+        for (int i = 0; i < ESPNOW_LANE_COUNT; i++)
+        {
+            if (xQueueReceive(s_rx_lanes[i], out, 0) == pdTRUE)
+                return true;
+        }
+        TickType_t wait = ticks_to_wait;
+        if (ticks_to_wait != portMAX_DELAY)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= ticks_to_wait)
+                return false;
+            wait = ticks_to_wait - elapsed;
+        }
+        if (xSemaphoreTake(s_rx_signal, wait) != pdTRUE)
+            return false;
+    }
+}
+
+// ============================================================================
+// PEER TABLE
+// ============================================================================
+// device_id -> MAC, so a message for one device goes unicast (link-layer ACKs
+// and retries, one radio woken) instead of to every device in range. Only
+// frames whose device_id is their sender teach the table: a HIT_EVENT names
+// the shooter, not the target that sent it.
+
+#define PEER_TABLE_SIZE (MAX_DEVICE_ID + 1)
+
+static EspnowPeerInfo s_peer_table[PEER_TABLE_SIZE] = {};
+
+static bool sender_device_id(const PlayerMessage* msg, uint8_t* out)
+{
+    switch (msg->type)
+    {
+        case ESPNOW_MSG_SHOT:
+        case ESPNOW_MSG_ACK:
+        case ESPNOW_MSG_PRESENCE:
+            *out = msg->device_id;
+            return true;
+        case ESPNOW_MSG_HEARTBEAT:
+            *out = ((const EspnowClockBeacon*)msg)->device_id;
+            return true;
+        case ESPNOW_MSG_SCORE:
+            *out = ((const EspnowScoreGossip*)msg)->sender_id;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void peer_learn(const EspnowMessageEnvelope* env)
+{
+    uint8_t id;
+    if (!s_peer_mutex || !sender_device_id(&env->msg, &id) || id >= PEER_TABLE_SIZE || id == s_device_id)
+        return;
+
+    uint32_t seen_ms = (uint32_t)(env->rx_us / 1000);
+    xSemaphoreTake(s_peer_mutex, portMAX_DELAY);
+    EspnowPeerInfo* peer = &s_peer_table[id];
+    if (peer->last_seen_ms && memcmp(peer->mac, env->src_mac, ESP_NOW_ETH_ALEN) != 0)
+    {
+        ESP_LOGI(TAG, "Device %u moved to a new MAC", id);
+        memset(peer, 0, sizeof(*peer));
+    }
+    memcpy(peer->mac, env->src_mac, ESP_NOW_ETH_ALEN);
+    peer->rssi = env->rssi;
+    peer->last_seen_ms = seen_ms ? seen_ms : 1;
+    peer->rx_frames++;
+    xSemaphoreGive(s_peer_mutex);
+}
+
+// Link-layer result of a unicast send (send_cb, Wi-Fi task)
+static void peer_tx_result(const uint8_t* mac, bool ok)
+{
+    if (!s_peer_mutex || !mac || memcmp(mac, s_broadcast_mac, ESP_NOW_ETH_ALEN) == 0)
+        return;
+
+    xSemaphoreTake(s_peer_mutex, portMAX_DELAY);
+    for (int i = 0; i < PEER_TABLE_SIZE; i++)
+    {
+        EspnowPeerInfo* peer = &s_peer_table[i];
+        if (peer->last_seen_ms && memcmp(peer->mac, mac, ESP_NOW_ETH_ALEN) == 0)
+        {
+            if (ok)
+                peer->tx_ok++;
+            else
+                peer->tx_failed++;
+            break;
+        }
+    }
+    xSemaphoreGive(s_peer_mutex);
+}
+
+static bool peer_route(uint8_t device_id, uint8_t mac[ESP_NOW_ETH_ALEN])
+{
+    if (!s_peer_mutex || device_id >= PEER_TABLE_SIZE)
+        return false;
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    xSemaphoreTake(s_peer_mutex, portMAX_DELAY);
+    const EspnowPeerInfo* peer = &s_peer_table[device_id];
+    bool known = peer->last_seen_ms && now_ms - peer->last_seen_ms < ESPNOW_PEER_STALE_MS;
+    if (known)
+        memcpy(mac, peer->mac, ESP_NOW_ETH_ALEN);
+    xSemaphoreGive(s_peer_mutex);
+    return known;
+}
+
+bool espnow_comm_send_to_device(uint8_t device_id, const PlayerMessage* msg)
+{
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    // The radio holds a limited number of peers: fall back to broadcast when it is full
+    if (peer_route(device_id, mac) && espnow_comm_add_peer(mac) == ESP_OK)
+        return espnow_comm_send(mac, msg);
+    return espnow_comm_broadcast(msg);
+}
+
+bool espnow_comm_get_peer_info(uint8_t device_id, EspnowPeerInfo* out)
+{
+    if (!s_peer_mutex || device_id >= PEER_TABLE_SIZE)
+        return false;
+    xSemaphoreTake(s_peer_mutex, portMAX_DELAY);
+    *out = s_peer_table[device_id];
+    xSemaphoreGive(s_peer_mutex);
+    return out->last_seen_ms != 0;
+}
+
+// ============================================================================
+// RELIABLE DELIVERY
+// ============================================================================
+// Reliable messages carry a per-sender seq and are repeated from an esp_timer
+// until the addressed device answers with a unicast ACK. Each try is routed
+// afresh, so a MAC learned meanwhile turns broadcasts into unicasts. Receivers
+// keep a window of recent seqs per sender to drop the repeats; an entry is
+// forgotten after a few idle seconds, so a rebooted sender starts clean.
+
+#define RELIABLE_SLOTS  8
+#define DEDUP_SENDERS   8
+#define DEDUP_WINDOW    32
+#define DEDUP_EXPIRY_US (5LL * 1000 * 1000) // well past the last retransmission
+
+typedef struct
+{
+    PlayerMessage msg;
+    uint8_t tries; // sends so far
+    int64_t deadline_us;
+    bool used;
+} ReliableSlot;
+
+typedef struct
+{
+    uint8_t mac[ESP_NOW_ETH_ALEN];
+    uint8_t top;     // highest seq seen
+    uint32_t window; // bit n: seq top - n seen
+    int64_t seen_us; // 0 = free
+} DedupEntry;
+
+static SemaphoreHandle_t s_reliable_mutex = NULL;
+static esp_timer_handle_t s_retx_timer = NULL;
+static ReliableSlot s_pending[RELIABLE_SLOTS] = {};
+static DedupEntry s_dedup[DEDUP_SENDERS] = {};
+static uint8_t s_next_seq = 0;
+static EspnowReliableStats s_reliable_stats = {};
+
+static int64_t backoff_us(uint8_t tries)
+{
+    // Jittered by +-25% so targets hit by the same shot do not retry in lockstep
+    int64_t rto = ((int64_t)ESPNOW_RELIABLE_RTO_MS * 1000) << (tries - 1);
+    return rto - rto / 4 + (int64_t)(esp_random() % (uint32_t)(rto / 2 + 1));
+}
+
+// Caller holds s_reliable_mutex
+static void arm_retx_timer(int64_t now)
+{
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < RELIABLE_SLOTS; i++)
+    {
+        if (s_pending[i].used && s_pending[i].deadline_us < next)
+            next = s_pending[i].deadline_us;
+    }
+    esp_timer_stop(s_retx_timer); // ESP_ERR_INVALID_STATE when idle
+    if (next != INT64_MAX)
+        esp_timer_start_once(s_retx_timer, next > now ? next - now : 1);
+}
+
+static void retx_timer_cb(void* arg)
+{
+    (void)arg;
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_reliable_mutex, portMAX_DELAY);
+    for (int i = 0; i < RELIABLE_SLOTS; i++)
+    {
+        ReliableSlot* slot = &s_pending[i];
+        if (!slot->used || slot->deadline_us > now)
+            continue;
+        if (slot->tries >= ESPNOW_RELIABLE_MAX_TRIES)
+        {
+            slot->used = false;
+            s_reliable_stats.failed++;
+            ESP_LOGW(TAG, "No ACK from device %u for seq %u (type %d)", slot->msg.device_id, slot->msg.seq,
+                     slot->msg.type);
+            continue;
+        }
+        slot->tries++;
+        slot->deadline_us = now + backoff_us(slot->tries);
+        s_reliable_stats.retransmits++;
+        espnow_comm_send_to_device(slot->msg.device_id, &slot->msg);
+    }
+    arm_retx_timer(now);
+    xSemaphoreGive(s_reliable_mutex);
+}
+
+static bool reliable_init(void)
+{
+    if (s_reliable_mutex)
+        return true;
+    s_reliable_mutex = xSemaphoreCreateMutex();
+    if (!s_reliable_mutex)
+        return false;
+
+    esp_timer_create_args_t args = {};
+    args.callback = retx_timer_cb;
+    args.name = "espnow_retx";
+    if (esp_timer_create(&args, &s_retx_timer) != ESP_OK)
+    {
+        vSemaphoreDelete(s_reliable_mutex);
+        s_reliable_mutex = NULL;
+        return false;
+    }
+    s_next_seq = (uint8_t)esp_random();
+    return true;
+}
+
+bool espnow_comm_send_reliable(const PlayerMessage* msg)
+{
+    if (!msg)
+        return false;
+    if (!s_reliable_mutex)
+        return espnow_comm_send_to_device(msg->device_id, msg);
+
+    xSemaphoreTake(s_reliable_mutex, portMAX_DELAY);
+    ReliableSlot* slot = NULL;
+    for (int i = 0; i < RELIABLE_SLOTS && !slot; i++)
+    {
+        if (!s_pending[i].used)
+            slot = &s_pending[i];
+    }
+    if (!slot)
+    {
+        xSemaphoreGive(s_reliable_mutex);
+        ESP_LOGW(TAG, "Reliable slots full, sending once");
+        espnow_comm_send_to_device(msg->device_id, msg);
+        return false;
+    }
+
+    if (++s_next_seq == 0)
+        s_next_seq = 1; // 0 marks unreliable messages
+    int64_t now = esp_timer_get_time();
+    slot->msg = *msg;
+    slot->msg.seq = s_next_seq;
+    slot->tries = 1;
+    slot->deadline_us = now + backoff_us(1);
+    slot->used = true;
+    s_reliable_stats.sent++;
+    PlayerMessage first = slot->msg;
+    arm_retx_timer(now);
+    xSemaphoreGive(s_reliable_mutex);
+
+    // A failed first send is covered by the retransmissions
+    espnow_comm_send_to_device(first.device_id, &first);
+    return true;
+}
+
+void espnow_comm_get_reliable_stats(EspnowReliableStats* out)
+{
+    if (!s_reliable_mutex)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_reliable_mutex, portMAX_DELAY);
+    *out = s_reliable_stats;
+    xSemaphoreGive(s_reliable_mutex);
+}
+
+static void handle_ack(const PlayerMessage* ack)
+{
+    if (!s_reliable_mutex)
+        return;
+    xSemaphoreTake(s_reliable_mutex, portMAX_DELAY);
+    for (int i = 0; i < RELIABLE_SLOTS; i++)
+    {
+        ReliableSlot* slot = &s_pending[i];
+        if (slot->used && slot->msg.seq == ack->seq && slot->msg.device_id == ack->device_id)
+        {
+            slot->used = false;
+            s_reliable_stats.acked++;
+            arm_retx_timer(esp_timer_get_time());
+            break;
+        }
+    }
+    xSemaphoreGive(s_reliable_mutex);
+}
+
+static void send_ack(const EspnowMessageEnvelope* env)
+{
+    PlayerMessage ack = {};
+    ack.type = ESPNOW_MSG_ACK;
+    ack.version = 1;
+    ack.device_id = s_device_id;
+    ack.seq = env->msg.seq;
+    ack.data = env->msg.type;
+    espnow_comm_add_peer(env->src_mac); // unicast needs a registered peer
+    espnow_comm_send(env->src_mac, &ack);
+}
+
+// First time this seq arrives from this sender?
+static bool dedup_accept(const EspnowMessageEnvelope* env)
+{
+    int64_t now = env->rx_us;
+    DedupEntry* entry = NULL;
+    DedupEntry* oldest = &s_dedup[0];
+    for (int i = 0; i < DEDUP_SENDERS; i++)
+    {
+        DedupEntry* e = &s_dedup[i];
+        if (e->seen_us && now - e->seen_us < DEDUP_EXPIRY_US && memcmp(e->mac, env->src_mac, ESP_NOW_ETH_ALEN) == 0)
+        {
+            entry = e;
+            break;
+        }
+        if (e->seen_us < oldest->seen_us)
+            oldest = e;
+    }
+
+    uint8_t seq = env->msg.seq;
+    if (!entry)
+    {
+        entry = oldest;
+        memcpy(entry->mac, env->src_mac, ESP_NOW_ETH_ALEN);
+        entry->top = seq;
+        entry->window = 1;
+        entry->seen_us = now;
+        return true;
+    }
+    entry->seen_us = now;
+
+    int8_t ahead = (int8_t)(uint8_t)(seq - entry->top);
+    if (ahead > 0)
+    {
+        entry->window = ahead >= DEDUP_WINDOW ? 1 : (entry->window << ahead) | 1;
+        entry->top = seq;
+        return true;
+    }
+    if (-ahead >= DEDUP_WINDOW)
+        return false; // older than the window: a straggler from long ago
+    uint32_t bit = 1u << -ahead;
+    if (entry->window & bit)
+        return false;
+    entry->window |= bit;
+    return true;
+}
+
+static bool carries_seq(const PlayerMessage* msg)
+{
+    // Clock beacons and score gossip use the seq byte for their own fields
+    return msg->seq != 0 && msg->type != ESPNOW_MSG_HEARTBEAT && msg->type != ESPNOW_MSG_ACK &&
+           msg->type != ESPNOW_MSG_PRESENCE && msg->type != ESPNOW_MSG_SCORE;
 }
 
 bool espnow_comm_receive(EspnowMessageEnvelope* out, TickType_t ticks_to_wait)
 {
-    if (!s_rx_queue || !out)
+    if (!s_rx_signal || !out)
         return false;
-    return xQueueReceive(s_rx_queue, out, ticks_to_wait) == pdTRUE;
+
+    TickType_t start = xTaskGetTickCount();
+    TickType_t wait = ticks_to_wait;
+    while (rx_take(out, wait))
+    {
+        peer_learn(out);
+        if (out->msg.type == ESPNOW_MSG_ACK)
+        {
+            handle_ack(&out->msg);
+        }
+        else if (out->msg.type == ESPNOW_MSG_PRESENCE)
+        {
+            presence_on_beacon(out);
+        }
+        else if (out->msg.type == ESPNOW_MSG_SCORE)
+        {
+            score_on_gossip(out);
+        }
+        else if (!carries_seq(&out->msg))
+        {
+            return true;
+        }
+        else
+        {
+            // Every copy is acknowledged: the ACK for the first may be the one that got lost
+            if (out->msg.device_id == s_device_id)
+                send_ack(out);
+            if (dedup_accept(out) || !s_reliable_mutex)
+                return true;
+            xSemaphoreTake(s_reliable_mutex, portMAX_DELAY);
+            s_reliable_stats.duplicates++;
+            xSemaphoreGive(s_reliable_mutex);
+        }
+
+        if (ticks_to_wait != portMAX_DELAY)
+        {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            wait = elapsed >= ticks_to_wait ? 0 : ticks_to_wait - elapsed;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// PERIODIC BROADCASTS
+// ============================================================================
+// Clock beacons, presence and score gossip below. Their poll and receive
+// functions run on the ESP-NOW task only, so their state needs no lock.
+
+// One period of interval_ms, jittered by ±25% so devices that booted together
+// drift apart instead of colliding round after round.
+static int64_t jittered_period_us(uint16_t interval_ms)
+{
+    int64_t jitter_us = (int64_t)(esp_random() % (interval_ms / 2 + 1)) * 1000 - interval_ms * 250LL;
+    return interval_ms * 1000LL + jitter_us;
+}
+
+// ============================================================================
+// CLOCK BEACONS
+// ============================================================================
+// Symmetric exchanges over broadcast beacons: a device names the peer it wants
+// to follow in its beacon, that peer echoes the beacon back in one of its own
+// with the hold time, and the follower turns the four timestamps into a sample.
+
+#define CLOCK_TX_HISTORY 4 // own beacons an echo can still refer to
+#define CLOCK_FOLLOWERS  4 // followers whose last beacon waits for an echo
+
+typedef struct
+{
+    uint16_t tag;
+    int64_t tx_us; // 0 once echoed
+} ClockTx;
+
+typedef struct
+{
+    uint8_t device_id;
+    uint16_t tag;
+    int64_t rx_us;
+    bool pending;
+} ClockFollower;
+
+static ClockTx s_clock_tx[CLOCK_TX_HISTORY] = {};
+static uint8_t s_clock_tx_next = 0;
+static ClockFollower s_followers[CLOCK_FOLLOWERS] = {};
+static uint8_t s_echo_next = 0;
+static int64_t s_last_beacon_us = 0;
+
+// Best peer heard that the match clock would follow; named in our beacons
+static uint8_t s_want_ref = CLOCK_SYNC_NO_DEVICE;
+static uint8_t s_want_stratum = CLOCK_SYNC_STRATUM_FREE;
+static int64_t s_want_heard_us = 0;
+
+void espnow_comm_clock_poll(void)
+{
+    if (!s_initialised)
+        return;
+
+    int64_t now = esp_timer_get_time();
+    if (now - s_last_beacon_us < ESPNOW_CLOCK_BEACON_MS * 1000LL)
+        return;
+    s_last_beacon_us = now;
+
+    if (s_want_ref != CLOCK_SYNC_NO_DEVICE && now - s_want_heard_us > CLOCK_SYNC_PEER_TIMEOUT_MS * 1000LL)
+        s_want_ref = CLOCK_SYNC_NO_DEVICE;
+
+    EspnowClockBeacon beacon = {};
+    beacon.type = ESPNOW_MSG_HEARTBEAT;
+    beacon.version = 1;
+    beacon.device_id = clock_sync_device_id();
+    beacon.stratum = clock_sync_stratum();
+    beacon.ref_device_id = s_want_ref;
+    beacon.echo_device_id = CLOCK_SYNC_NO_DEVICE;
+
+    // Answer waiting followers in turn, one per beacon
+    ClockFollower* echo = NULL;
+    for (uint8_t i = 0; i < CLOCK_FOLLOWERS; i++)
+    {
+        uint8_t idx = (s_echo_next + i) % CLOCK_FOLLOWERS;
+        if (s_followers[idx].pending)
+        {
+            echo = &s_followers[idx];
+            s_echo_next = (idx + 1) % CLOCK_FOLLOWERS;
+            break;
+        }
+    }
+
+    int64_t tx_us = esp_timer_get_time();
+    int64_t match_us = clock_sync_match_us_at(tx_us);
+    beacon.match_ms = (uint32_t)(match_us / 1000);
+    beacon.match_frac_us = (uint16_t)(match_us % 1000);
+    if (echo)
+    {
+        beacon.echo_device_id = echo->device_id;
+        beacon.echo_tag = echo->tag;
+        beacon.echo_hold_us = (uint32_t)(tx_us - echo->rx_us);
+        echo->pending = false;
+    }
+
+    s_clock_tx[s_clock_tx_next] = {(uint16_t)beacon.match_ms, tx_us};
+    s_clock_tx_next = (s_clock_tx_next + 1) % CLOCK_TX_HISTORY;
+    // Never batched: the window would add to the timestamp error
+    batch_flush_to(s_broadcast_mac);
+    send_frame(s_broadcast_mac, (const uint8_t*)&beacon, sizeof(beacon), 1);
+}
+
+void espnow_comm_clock_on_beacon(const EspnowMessageEnvelope* env)
+{
+    EspnowClockBeacon beacon;
+    memcpy(&beacon, &env->msg, sizeof(beacon));
+    uint8_t self = clock_sync_device_id();
+    if (beacon.device_id == self)
+        return;
+
+    // A follower of ours: echo its beacon next time (it is never a source for us)
+    if (beacon.ref_device_id == self)
+    {
+        ClockFollower* slot = &s_followers[0];
+        for (uint8_t i = 0; i < CLOCK_FOLLOWERS; i++)
+        {
+            if (s_followers[i].device_id == beacon.device_id)
+            {
+                slot = &s_followers[i];
+                break;
+            }
+            if (s_followers[i].rx_us < slot->rx_us)
+                slot = &s_followers[i];
+        }
+        *slot = {beacon.device_id, (uint16_t)beacon.match_ms, env->rx_us, true};
+        return;
+    }
+
+    bool acceptable = clock_sync_accepts_peer(beacon.device_id, beacon.stratum);
+    if (beacon.device_id == s_want_ref)
+    {
+        s_want_ref = acceptable ? beacon.device_id : CLOCK_SYNC_NO_DEVICE;
+        s_want_stratum = beacon.stratum;
+        s_want_heard_us = env->rx_us;
+    }
+    else if (acceptable && (s_want_ref == CLOCK_SYNC_NO_DEVICE || beacon.stratum < s_want_stratum ||
+                            (beacon.stratum == s_want_stratum && beacon.device_id < s_want_ref)))
+    {
+        s_want_ref = beacon.device_id;
+        s_want_stratum = beacon.stratum;
+        s_want_heard_us = env->rx_us;
+    }
+
+    if (beacon.echo_device_id != self)
+        return;
+    for (uint8_t i = 0; i < CLOCK_TX_HISTORY; i++)
+    {
+        ClockTx* tx = &s_clock_tx[i];
+        if (tx->tx_us == 0 || tx->tag != beacon.echo_tag)
+            continue;
+
+        int64_t t1 = tx->tx_us;
+        int64_t t4 = env->rx_us;
+        int64_t t3 = (int64_t)beacon.match_ms * 1000 + beacon.match_frac_us;
+        int64_t hold = beacon.echo_hold_us;
+        int64_t delay = (t4 - t1) - hold;
+        int64_t offset = t3 - (hold + t1 + t4) / 2;
+        clock_sync_add_sample(CLOCK_SRC_PEER, beacon.device_id, beacon.stratum, offset, delay, t4);
+        tx->tx_us = 0;
+        break;
+    }
+}
+
+// ============================================================================
+// PRESENCE
+// ============================================================================
+// Low-rate broadcasts that fill the presence table on every device, one per
+// jittered period.
+
+static int64_t s_presence_next_us = 0;
+
+void espnow_comm_presence_poll(uint8_t player_id, uint8_t team_id, uint32_t color_rgb)
+{
+    if (!s_initialised)
+        return;
+
+    int64_t now = esp_timer_get_time();
+    uint16_t interval_ms = presence_interval_ms();
+    if (s_presence_next_us == 0)
+    {
+        // First beacon somewhere in the first period
+        s_presence_next_us = now + (int64_t)(esp_random() % interval_ms) * 1000;
+        return;
+    }
+    if (now < s_presence_next_us)
+        return;
+
+    s_presence_next_us = now + jittered_period_us(interval_ms);
+
+    PlayerMessage msg = {};
+    msg.type = ESPNOW_MSG_PRESENCE;
+    msg.version = 1;
+    msg.player_id = player_id;
+    msg.device_id = s_device_id;
+    msg.team_id = team_id;
+    msg.color_rgb = color_rgb;
+    msg.timestamp_ms = clock_sync_match_ms();
+    msg.data = interval_ms;
+    espnow_comm_broadcast(&msg);
+}
+
+static void presence_on_beacon(const EspnowMessageEnvelope* env)
+{
+    if (env->msg.device_id == s_device_id)
+        return;
+
+    PresenceEntry entry = {};
+    entry.device_id = env->msg.device_id;
+    entry.player_id = env->msg.player_id;
+    entry.team_id = env->msg.team_id;
+    entry.rssi = env->rssi;
+    entry.color_rgb = env->msg.color_rgb;
+    entry.interval_ms = (uint16_t)(env->msg.data > PRESENCE_MAX_INTERVAL_MS ? PRESENCE_MAX_INTERVAL_MS : env->msg.data);
+    entry.last_seen_ms = (uint32_t)(env->rx_us / 1000);
+    presence_update(&entry);
+    roster_refresh_field();
+}
+
+// ============================================================================
+// SCOREBOARD GOSSIP
+// ============================================================================
+// Delta-state gossip: a round carries only the replicas that changed since the
+// last one, topped up with unchanged ones on the slower anti-entropy rounds.
+// The replicas are queued back to back, so with batching a round is one frame.
+
+static int64_t s_score_delta_us = 0;
+static int64_t s_score_round_us = 0;
+
+void espnow_comm_score_poll(void)
+{
+    if (!s_initialised)
+        return;
+
+    int64_t now = esp_timer_get_time();
+    bool full = now >= s_score_round_us;
+    if (!full && now < s_score_delta_us)
+        return;
+    s_score_delta_us = now + ESPNOW_SCORE_DELTA_MS * 1000LL;
+    if (full)
+        s_score_round_us = now + jittered_period_us(ESPNOW_SCORE_ROUND_MS);
+
+    ScoreReplica replicas[ESPNOW_SCORE_PER_ROUND];
+    uint16_t epoch;
+    int n = scoreboard_take_gossip(replicas, ESPNOW_SCORE_PER_ROUND, full, &epoch);
+    for (int i = 0; i < n; i++)
+    {
+        EspnowScoreGossip g = {};
+        g.type = ESPNOW_MSG_SCORE;
+        g.version = 1;
+        g.epoch = epoch;
+        g.sender_id = s_device_id;
+        g.device_id = replicas[i].device_id;
+        g.player_id = replicas[i].player_id;
+        g.team_id = replicas[i].team_id;
+        g.kills = replicas[i].kills;
+        g.deaths = replicas[i].deaths;
+        g.hits = replicas[i].hits;
+        espnow_comm_broadcast((const PlayerMessage*)&g);
+    }
+}
+
+static void score_on_gossip(const EspnowMessageEnvelope* env)
+{
+    EspnowScoreGossip g;
+    memcpy(&g, &env->msg, sizeof(g));
+    if (g.version != 1)
+        return;
+
+    ScoreReplica r = {g.device_id, g.player_id, g.team_id, g.kills, g.deaths, g.hits};
+    scoreboard_merge(g.epoch, &r);
 }
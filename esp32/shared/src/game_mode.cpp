@@ -0,0 +1,192 @@
+#include "game_mode.h"
+#include <string.h>
+#include "esp_log.h"
+#include "scoreboard.h"
+
+// Game mode policies (see game_mode.h)
+
+static const char* TAG = "game_mode";
+
+// ============================================================================
+// SHARED RULES
+// ============================================================================
+
+static uint32_t no_duration(const GameConfig* cfg)
+{
+    (void)cfg;
+    return 0;
+}
+
+static int keep_hearts(const GameConfig* cfg)
+{
+    (void)cfg;
+    return -1;
+}
+
+static bool shoot_unless_respawning(const GameStateData* st)
+{
+    return !st->respawning;
+}
+
+static bool always_takes_damage(const GameStateData* st)
+{
+    (void)st;
+    return true;
+}
+
+static bool never_over(GameStateData* st, const GameConfig* cfg)
+{
+    (void)st;
+    (void)cfg;
+    return false;
+}
+
+// ============================================================================
+// TIME
+// ============================================================================
+// Ends on the DL_GAME_END deadline game_state arms from duration_ms
+
+static uint32_t time_duration(const GameConfig* cfg)
+{
+    return cfg->time_limit_s * 1000u;
+}
+
+// ============================================================================
+// SCORE
+// ============================================================================
+
+// Best score on the offline scoreboard: per team when teams are playing, otherwise per player
+static uint32_t offline_best_score(const GameConfig* cfg)
+{
+    ScoreTotals totals[SCOREBOARD_MAX_DEVICES];
+    int n = scoreboard_totals(totals, SCOREBOARD_MAX_DEVICES, true);
+    if (n == 0)
+        n = scoreboard_totals(totals, SCOREBOARD_MAX_DEVICES, false);
+
+    uint32_t best = 0;
+    for (int i = 0; i < n; i++)
+    {
+        uint32_t score = totals[i].kills * cfg->kill_score + totals[i].hits * cfg->hit_score;
+        if (score > best)
+            best = score;
+    }
+    return best;
+}
+
+static bool score_is_over(GameStateData* st, const GameConfig* cfg)
+{
+    st->player_score = (st->kills * cfg->kill_score) + (st->hits_landed * cfg->hit_score);
+    if (st->player_score >= cfg->target_score)
+    {
+        ESP_LOGI(TAG, "Game over: Target score reached (%lu >= %u)", st->player_score, cfg->target_score);
+        return true;
+    }
+    if (!st->server_connected)
+    {
+        // Offline: someone else (or their team) may have reached it
+        uint32_t best = offline_best_score(cfg);
+        if (best >= cfg->target_score)
+        {
+            ESP_LOGI(TAG, "Game over: Target score reached on the scoreboard (%lu >= %u)", best, cfg->target_score);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// LAST MAN STANDING
+// ============================================================================
+// Out of hearts means out of the match: no shooting, no damage. The server
+// decides the winner; offline every death costs a heart, so the scoreboard
+// knows who is out.
+
+static int lms_start_hearts(const GameConfig* cfg)
+{
+    return cfg->spawn_hearts;
+}
+
+static bool lms_has_hearts(const GameStateData* st)
+{
+    return st->hearts_remaining > 0;
+}
+
+static bool lms_is_over(GameStateData* st, const GameConfig* cfg)
+{
+    if (st->server_connected)
+        return false;
+    int sides = 0;
+    int standing = scoreboard_sides_standing(cfg->spawn_hearts, &sides);
+    if (sides >= 2 && standing <= 1)
+    {
+        ESP_LOGI(TAG, "Game over: %d of %d sides standing", standing, sides);
+        return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// POLICIES
+// ============================================================================
+
+const GameModePolicy GAME_MODE_FREE_PLAY = {
+    .win_type = "free_play",
+    .duration_ms = no_duration,
+    .start_hearts = keep_hearts,
+    .can_shoot = shoot_unless_respawning,
+    .can_take_damage = always_takes_damage,
+    .is_over = never_over,
+    .extendable = false,
+    .has_target_score = false,
+};
+
+static const GameModePolicy MODE_TIME = {
+    .win_type = "time",
+    .duration_ms = time_duration,
+    .start_hearts = keep_hearts,
+    .can_shoot = shoot_unless_respawning,
+    .can_take_damage = always_takes_damage,
+    .is_over = never_over,
+    .extendable = true,
+    .has_target_score = false,
+};
+
+static const GameModePolicy MODE_SCORE = {
+    .win_type = "score",
+    .duration_ms = no_duration,
+    .start_hearts = keep_hearts,
+    .can_shoot = shoot_unless_respawning,
+    .can_take_damage = always_takes_damage,
+    .is_over = score_is_over,
+    .extendable = false,
+    .has_target_score = true,
+};
+
+static const GameModePolicy MODE_LAST_MAN_STANDING = {
+    .win_type = "last_man_standing",
+    .duration_ms = no_duration,
+    .start_hearts = lms_start_hearts,
+    .can_shoot = lms_has_hearts,
+    .can_take_damage = lms_has_hearts,
+    .is_over = lms_is_over,
+    .extendable = false,
+    .has_target_score = false,
+};
+
+static const GameModePolicy* const s_modes[] = {
+    &MODE_TIME,
+    &MODE_SCORE,
+    &MODE_LAST_MAN_STANDING,
+};
+
+const GameModePolicy* game_mode_find(const char* win_type)
+{
+    if (!win_type)
+        return NULL;
+    for (size_t i = 0; i < sizeof(s_modes) / sizeof(s_modes[0]); i++)
+    {
+        if (strcmp(s_modes[i]->win_type, win_type) == 0)
+            return s_modes[i];
+    }
+    return NULL;
+}
@@ -1,68 +1,569 @@
 #include "game_state.h"
 #include <stdio.h>
 #include <string.h>
+#include "clock_sync.h"
 #include "esp_log.h"
 #include "esp_random.h"
 #include "esp_timer.h"
+#include "game_mode.h"
+#include "lock_profile.h"
+#include "match_log.h"
+#include "match_store.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "nvs_store.h"
 #include "protocol_config.h"
+#include "roster.h"
+#include "scoreboard.h"
 
 static const char* TAG = "game_state";
 
-static DeviceConfig s_config;
-static GameConfig s_game_cfg;
 static GameStateData s_state;
 static SemaphoreHandle_t s_mutex = NULL;
 static bool s_initialized = false;
 
-// Player name lookup table
-static PlayerEntry s_players[MAX_PLAYER_ENTRIES];
-static int s_player_count = 0;
-
 #define NVS_GAME_NS "game"
 #define NVS_KEY_DEVICE_ID "device_id_u8"
 #define NVS_KEY_PLAYER_ID "player_id_u8"
 #define NVS_KEY_TEAM_ID "team_id_u8"
 #define NVS_KEY_COLOR "color_u32"
 
+static void publish_state(void);
+
+LOCK_PROFILE(s_lock_profile, "game_state");
+
+// Every write to s_state happens under the lock, so releasing it publishes the snapshot
 #define LOCK()                                                                                                         \
     if (s_mutex)                                                                                                       \
-    xSemaphoreTake(s_mutex, portMAX_DELAY)
+    LOCK_PROFILE_TAKE(s_lock_profile, s_mutex)
 #define UNLOCK()                                                                                                       \
     if (s_mutex)                                                                                                       \
-    xSemaphoreGive(s_mutex)
+    {                                                                                                                  \
+        publish_state();                                                                                               \
+        LOCK_PROFILE_GIVE(s_lock_profile, s_mutex);                                                                    \
+    }
+
+// ============================================================================
+// SNAPSHOTS
+// ============================================================================
+// Readers get s_state through a seqlock instead of the mutex: the copy below
+// is rewritten with the sequence odd, and a reader that saw the sequence
+// change (or odd) copies again. The rewrite runs in a critical section, so a
+// reader never spins on a writer preempted on its own core, and on the other
+// core only for the length of a ~100 byte memcpy.
+
+static GameStateData s_published;
+static uint32_t s_publish_seq = 0;
+static portMUX_TYPE s_publish_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Caller holds s_mutex, so there is one writer at a time
+static void publish_state(void)
+{
+    taskENTER_CRITICAL(&s_publish_mux);
+    uint32_t seq = __atomic_load_n(&s_publish_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_publish_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&s_published, &s_state, sizeof(s_published));
+    __atomic_store_n(&s_publish_seq, seq + 2, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL(&s_publish_mux);
+}
+
+void game_state_snapshot(GameStateData* out)
+{
+    uint32_t before, after;
+    do
+    {
+        before = __atomic_load_n(&s_publish_seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &s_published, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&s_publish_seq, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+}
+
+// The accessors below read through the seqlock too, never s_state unlocked
+static GameStateData published(void)
+{
+    GameStateData st;
+    game_state_snapshot(&st);
+    return st;
+}
+
+// ============================================================================
+// CONFIG VERSIONS
+// ============================================================================
+// DeviceConfig and GameConfig are read on every loop iteration of several
+// tasks, so they are published read-copy-update style: a writer edits a
+// private copy, stores it in a free version slot and swaps s_current in one
+// atomic store. Readers load the pointer and never lock. A replaced version
+// is reused only after CONFIG_GRACE_MS, far longer than a reader keeps the
+// pointer (one pass of its loop).
+
+#define CONFIG_VERSIONS 4
+#define CONFIG_GRACE_MS 2000
+
+typedef struct
+{
+    DeviceConfig device;
+    GameConfig game;
+    const GameModePolicy* mode; // looked up from game.win_type on commit
+} ConfigVersion;
+
+static ConfigVersion s_versions[CONFIG_VERSIONS];
+static int64_t s_reusable_at_us[CONFIG_VERSIONS] = {INT64_MAX}; // INT64_MAX while current
+static ConfigVersion* s_current = &s_versions[0];
+static SemaphoreHandle_t s_cfg_mutex = NULL; // one writer, held from begin to commit
+
+static const ConfigVersion* current_config(void)
+{
+    return __atomic_load_n(&s_current, __ATOMIC_ACQUIRE);
+}
+
+static const DeviceConfig* device_cfg(void)
+{
+    return &current_config()->device;
+}
+
+static const GameConfig* game_cfg(void)
+{
+    return &current_config()->game;
+}
+
+static const GameModePolicy* game_mode(void)
+{
+    const GameModePolicy* mode = current_config()->mode;
+    return mode ? mode : &GAME_MODE_FREE_PLAY;
+}
+
+// The version to publish into next: the one retired longest ago. Caller holds s_cfg_mutex.
+static int oldest_version(void)
+{
+    int slot = 0;
+    for (int i = 1; i < CONFIG_VERSIONS; i++)
+    {
+        if (s_reusable_at_us[i] < s_reusable_at_us[slot])
+            slot = i;
+    }
+    return slot;
+}
+
+// Caller holds s_cfg_mutex, taken by game_state_config_begin() only once a version was free
+static void publish_config(const ConfigVersion* next)
+{
+    int slot = oldest_version();
+    s_versions[slot] = *next;
+    s_reusable_at_us[slot] = INT64_MAX;
+    ConfigVersion* old = __atomic_exchange_n(&s_current, &s_versions[slot], __ATOMIC_ACQ_REL);
+    s_reusable_at_us[old - s_versions] = esp_timer_get_time() + CONFIG_GRACE_MS * 1000LL;
+}
+
+// Returns true if anything was out of range
+static bool clamp_game_config(GameConfig* nc)
+{
+    bool clamped = false;
+
+    auto clamp8 = [&](uint8_t v, uint8_t lo, uint8_t hi) {
+        if (v < lo)
+        {
+            clamped = true;
+            return lo;
+        }
+        if (v > hi)
+        {
+            clamped = true;
+            return hi;
+        }
+        return v;
+    };
+    auto clamp16 = [&](uint16_t v, uint16_t lo, uint16_t hi) {
+        if (v < lo)
+        {
+            clamped = true;
+            return lo;
+        }
+        if (v > hi)
+        {
+            clamped = true;
+            return hi;
+        }
+        return v;
+    };
+    auto clamp32 = [&](uint32_t v, uint32_t lo, uint32_t hi) {
+        if (v < lo)
+        {
+            clamped = true;
+            return lo;
+        }
+        if (v > hi)
+        {
+            clamped = true;
+            return hi;
+        }
+        return v;
+    };
+
+    nc->max_hearts = clamp8(nc->max_hearts, 1, 99);
+    nc->time_limit_s = clamp16(nc->time_limit_s, 0, 7200);
+    nc->score_to_win = clamp16(nc->score_to_win, 0, 65535);
+    nc->respawn_cooldown_ms = clamp32(nc->respawn_cooldown_ms, 0, 30000);
+    nc->invulnerability_ms = clamp16(nc->invulnerability_ms, 0, 30000);
+    nc->mag_capacity = clamp8(nc->mag_capacity, 0, 255);
+    nc->max_ammo = clamp16(nc->max_ammo, 0, 65535);
+    nc->reload_time_ms = clamp16(nc->reload_time_ms, 0, 30000);
+    nc->shot_rate_limit_ms = clamp16(nc->shot_rate_limit_ms, 50, 2000);
+    return clamped;
+}
+
+void game_state_config_begin(DeviceConfig* dev, GameConfig* game)
+{
+    // Only a burst of updates finds every version still in its grace period.
+    // The wait for the oldest to age out happens with the writer lock released,
+    // so no other writer queues up behind a sleeping one.
+    while (s_cfg_mutex)
+    {
+        xSemaphoreTake(s_cfg_mutex, portMAX_DELAY);
+        int64_t wait_us = s_reusable_at_us[oldest_version()] - esp_timer_get_time();
+        if (wait_us <= 0)
+            break;
+        xSemaphoreGive(s_cfg_mutex);
+        ESP_LOGW(TAG, "Config updated %d times within %d ms, waiting for a free version", CONFIG_VERSIONS - 1,
+                 CONFIG_GRACE_MS);
+        vTaskDelay(pdMS_TO_TICKS(wait_us / 1000 + 1));
+    }
+    const ConfigVersion* cur = current_config();
+    if (dev)
+        *dev = cur->device;
+    if (game)
+        *game = cur->game;
+}
+
+void game_state_config_commit(const DeviceConfig* dev, const GameConfig* game, bool* clamped)
+{
+    ConfigVersion next = *current_config();
+    bool cl = false;
+    if (dev)
+    {
+        next.device = *dev;
+        next.device.device_id &= MAX_DEVICE_ID;
+        next.device.player_id &= MAX_PLAYER_ID;
+        next.device.device_name[sizeof(next.device.device_name) - 1] = '\0';
+    }
+    if (game)
+    {
+        next.game = *game;
+        next.game.win_type[sizeof(next.game.win_type) - 1] = '\0';
+        cl = clamp_game_config(&next.game);
+        next.mode = game_mode_find(next.game.win_type);
+        if (!next.mode)
+        {
+            ESP_LOGW(TAG, "Unknown win_type '%s', playing without an end condition", next.game.win_type);
+            next.mode = &GAME_MODE_FREE_PLAY;
+        }
+    }
+    publish_config(&next);
+    roster_set_self(next.device.player_id, next.device.team_id, next.game.team_play, next.game.friendly_fire_enabled);
+    if (game)
+        match_log_append(MLOG_CONFIG, next.game.max_hearts, next.game.spawn_hearts, next.game.target_score);
+    if (s_cfg_mutex)
+        xSemaphoreGive(s_cfg_mutex);
+    if (clamped)
+        *clamped = cl;
+}
+
+void game_state_config_abort(void)
+{
+    if (s_cfg_mutex)
+        xSemaphoreGive(s_cfg_mutex);
+}
+
+void game_state_config_read(const DeviceConfig** dev, const GameConfig** game)
+{
+    const ConfigVersion* cur = current_config();
+    if (dev)
+        *dev = &cur->device;
+    if (game)
+        *game = &cur->game;
+}
 
 static uint8_t rand_u8()
 {
     return (uint8_t)(esp_random() & 0xFF);
 }
 
+// ============================================================================
+// DEADLINES
+// ============================================================================
+// One esp_timer per deadline, (re)armed wherever the state implying it
+// changes. Expiry runs on the esp_timer task: update the state under the
+// lock, then notify subscribers.
+
+#define HEARTBEAT_INTERVAL_MS 10000 // per protocol v2.3
+#define ELAPSED_INTERVAL_MS   10000 // played time logged this often: what a restored match can gain at most
+#define MAX_SUBSCRIBERS       4
+
+typedef enum
+{
+    DL_RESPAWN = 0,
+    DL_INVULNERABLE,
+    DL_GAME_END,
+    DL_HEARTBEAT,
+    DL_ELAPSED,
+    DL_COUNT
+} Deadline;
+
+typedef struct
+{
+    TaskHandle_t task;
+    uint32_t events;
+} Subscriber;
+
+static esp_timer_handle_t s_deadlines[DL_COUNT] = {};
+static Subscriber s_subscribers[MAX_SUBSCRIBERS] = {};
+
+static void notify(uint32_t event)
+{
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++)
+    {
+        if (s_subscribers[i].task && (s_subscribers[i].events & event))
+            xTaskNotify(s_subscribers[i].task, event, eSetBits);
+    }
+}
+
+static void arm(Deadline dl, uint32_t in_ms)
+{
+    if (!s_deadlines[dl])
+        return;
+    esp_timer_stop(s_deadlines[dl]); // ESP_ERR_INVALID_STATE when not running
+    esp_timer_start_once(s_deadlines[dl], (uint64_t)(in_ms ? in_ms : 1) * 1000);
+}
+
+static void disarm(Deadline dl)
+{
+    if (s_deadlines[dl])
+        esp_timer_stop(s_deadlines[dl]);
+}
+
+static void on_respawn_end(void* arg)
+{
+    (void)arg;
+    const GameConfig* gc = game_cfg();
+    LOCK();
+    // A reset or a restart since the death already ended the respawn
+    if (!s_state.respawning)
+    {
+        UNLOCK();
+        return;
+    }
+    s_state.respawning = false;
+    s_state.hearts_remaining = gc->max_hearts;
+    match_log_append(MLOG_RESPAWN, 0, 0, s_state.hearts_remaining);
+    s_state.invulnerable = gc->invulnerability_ms > 0;
+    if (s_state.invulnerable)
+        arm(DL_INVULNERABLE, gc->invulnerability_ms);
+    UNLOCK();
+    notify(GAME_EVT_RESPAWNED);
+}
+
+static void on_invulnerable_end(void* arg)
+{
+    (void)arg;
+    LOCK();
+    s_state.invulnerable = false;
+    UNLOCK();
+    notify(GAME_EVT_INVULNERABLE_END);
+}
+
+static void on_game_end(void* arg)
+{
+    (void)arg;
+    LOCK();
+    bool ended = s_state.game_running && !s_state.game_paused;
+    if (ended)
+    {
+        s_state.game_over = true;
+        s_state.game_running = false;
+        match_log_append(MLOG_GAME_OVER, 0, 0, 0);
+    }
+    UNLOCK();
+    if (ended)
+    {
+        ESP_LOGI(TAG, "Game over: Time limit reached");
+        notify(GAME_EVT_GAME_OVER);
+    }
+}
+
+// Match time played, pauses excluded (game_start_time_ms moves forward by
+// each pause). Caller holds the lock.
+static uint32_t played_ms(void)
+{
+    uint32_t now_ms = s_state.game_paused ? s_state.pause_time_ms : (uint32_t)(esp_timer_get_time() / 1000);
+    return now_ms - s_state.game_start_time_ms;
+}
+
+// Caller holds the lock
+static void log_elapsed(void)
+{
+    uint32_t played_s = played_ms() / 1000;
+    match_log_append(MLOG_ELAPSED, 0, 0, (uint16_t)(played_s < 0xFFFF ? played_s : 0xFFFF));
+}
+
+// The match clock does not survive a reset, so the log carries the played
+// time itself for restore_from_log()
+static void on_elapsed_due(void* arg)
+{
+    (void)arg;
+    LOCK();
+    bool running = s_state.game_running && !s_state.game_paused;
+    if (running)
+    {
+        log_elapsed();
+        arm(DL_ELAPSED, ELAPSED_INTERVAL_MS);
+    }
+    UNLOCK();
+}
+
+static void on_heartbeat_due(void* arg)
+{
+    (void)arg;
+    // Again in an interval unless a status goes out (game_state_update_heartbeat)
+    arm(DL_HEARTBEAT, HEARTBEAT_INTERVAL_MS);
+    notify(GAME_EVT_HEARTBEAT_DUE);
+}
+
+static bool deadlines_init(void)
+{
+    static const struct
+    {
+        esp_timer_cb_t cb;
+        const char* name;
+    } defs[DL_COUNT] = {
+        {on_respawn_end, "gs_respawn"},
+        {on_invulnerable_end, "gs_invuln"},
+        {on_game_end, "gs_game_end"},
+        {on_heartbeat_due, "gs_heartbeat"},
+        {on_elapsed_due, "gs_elapsed"},
+    };
+    for (int i = 0; i < DL_COUNT; i++)
+    {
+        esp_timer_create_args_t args = {};
+        args.callback = defs[i].cb;
+        args.name = defs[i].name;
+        if (esp_timer_create(&args, &s_deadlines[i]) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to create timer %s", defs[i].name);
+            return false;
+        }
+    }
+    arm(DL_HEARTBEAT, HEARTBEAT_INTERVAL_MS);
+    return true;
+}
+
+bool game_state_subscribe(TaskHandle_t task, uint32_t events)
+{
+    LOCK();
+    Subscriber* slot = NULL;
+    for (int i = 0; i < MAX_SUBSCRIBERS; i++)
+    {
+        if (s_subscribers[i].task == task || (!slot && !s_subscribers[i].task))
+            slot = &s_subscribers[i];
+        if (s_subscribers[i].task == task)
+            break;
+    }
+    if (slot)
+        *slot = {task, events};
+    UNLOCK();
+    if (!slot)
+        ESP_LOGE(TAG, "No room for another subscriber");
+    return slot != NULL;
+}
+
+// A match log kept across a software reset (or rebuilt from the flash checkpoint
+// after a power loss): pick the match up where it was
+static void restore_from_log(void)
+{
+    MatchLogTotals totals;
+    match_log_replay(&totals);
+    if (!(totals.flags & MLOG_FLAG_RUNNING))
+        return;
+
+    const ConfigVersion* cfg = current_config();
+    const GameModePolicy* mode = cfg->mode ? cfg->mode : &GAME_MODE_FREE_PLAY;
+    // Time already played, as last logged (on_elapsed_due). The match clock
+    // cannot tell: it restarts with esp_timer and is not resynced this early.
+    uint32_t elapsed_ms = totals.played_s * 1000u;
+
+    LOCK();
+    match_log_to_state(&totals, &s_state);
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    s_state.game_start_time_ms = now_ms - elapsed_ms;
+    if (s_state.respawning)
+    {
+        s_state.respawn_end_time_ms = now_ms + cfg->game.respawn_cooldown_ms;
+        arm(DL_RESPAWN, cfg->game.respawn_cooldown_ms);
+    }
+    // A timed match only gets what was left of it; one that ran out while the
+    // device was down ends at once
+    uint32_t duration_ms = mode->duration_ms(&cfg->game);
+    if (duration_ms > 0)
+    {
+        uint32_t remaining_ms = duration_ms > elapsed_ms ? duration_ms - elapsed_ms : 0;
+        s_state.game_end_time_ms = now_ms + remaining_ms;
+        if (!s_state.game_paused)
+            arm(DL_GAME_END, remaining_ms);
+    }
+    if (s_state.game_paused)
+        s_state.pause_time_ms = now_ms; // game_state_resume_game() moves the start and end on and arms them
+    else
+        arm(DL_ELAPSED, ELAPSED_INTERVAL_MS);
+    UNLOCK();
+    ESP_LOGW(TAG, "Match restored from the log: K/D %lu/%lu, hearts %u, %lu s played",
+             (unsigned long)totals.kills, (unsigned long)totals.deaths, totals.hearts_remaining,
+             (unsigned long)(elapsed_ms / 1000));
+}
+
 bool game_state_init(DeviceRole role)
 {
     if (s_initialized)
         return true;
 
     s_mutex = xSemaphoreCreateMutex();
-    if (!s_mutex)
+    s_cfg_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex || !s_cfg_mutex)
     {
         ESP_LOGE(TAG, "Failed to create mutex");
         return false;
     }
 
-    memset(&s_config, 0, sizeof(s_config));
-    memset(&s_game_cfg, 0, sizeof(s_game_cfg));
     memset(&s_state, 0, sizeof(s_state));
+    roster_init();
 
-    s_config.role = role;
+    DeviceConfig dev = {};
+    dev.role = role;
+    game_state_config_begin(NULL, NULL);
+    game_state_config_commit(&dev, NULL, NULL);
     game_state_load_default_game_config();
     game_state_generate_ids();
     game_state_load_ids();
     game_state_reset_runtime();
+    const DeviceConfig* cfg = device_cfg();
+    clock_sync_init(cfg->device_id);
+    scoreboard_init(cfg->device_id, cfg->player_id, cfg->team_id);
+    if (!deadlines_init())
+        return false;
+    bool kept = match_log_init(cfg->device_id);
+    if (match_store_init(NULL, cfg->device_id) && !kept)
+    {
+        MatchLogTotals checkpoint;
+        uint32_t log_seq = 0;
+        kept = match_store_load(&checkpoint, &log_seq);
+        if (kept)
+            match_log_seed(&checkpoint, log_seq);
+    }
+    if (kept)
+        restore_from_log();
+    match_store_start_flusher();
 
     s_initialized = true;
-    ESP_LOGI(TAG, "Game state initialized role=%d device=%u player=%u", role, s_config.device_id, s_config.player_id);
+    ESP_LOGI(TAG, "Game state initialized role=%d device=%u player=%u", role, cfg->device_id, cfg->player_id);
     return true;
 }
 
@@ -70,90 +571,99 @@ bool game_state_init(DeviceRole role)
 
 const DeviceConfig* game_state_get_config(void)
 {
-    return &s_config;
-}
-
-DeviceConfig* game_state_get_config_mut(void)
-{
-    return &s_config;
+    return device_cfg();
 }
 
 bool game_state_load_ids(void)
 {
-    LOCK();
+    DeviceConfig dev;
+    game_state_config_begin(&dev, NULL);
     bool loaded = false;
     uint8_t id = 0;
     if (nvs_store_read_u8(NVS_GAME_NS, NVS_KEY_DEVICE_ID, &id))
     {
-        s_config.device_id = id;
-        if (s_config.device_id > MAX_DEVICE_ID)
-            s_config.device_id = 0; // Will be regenerated
+        dev.device_id = id;
+        if (dev.device_id > MAX_DEVICE_ID)
+            dev.device_id = 0; // Will be regenerated
         loaded = true;
     }
     if (nvs_store_read_u8(NVS_GAME_NS, NVS_KEY_PLAYER_ID, &id))
     {
-        s_config.player_id = id;
-        if (s_config.player_id > MAX_PLAYER_ID)
-            s_config.player_id = 0; // Will be regenerated
+        dev.player_id = id;
+        if (dev.player_id > MAX_PLAYER_ID)
+            dev.player_id = 0; // Will be regenerated
     }
     if (nvs_store_read_u8(NVS_GAME_NS, NVS_KEY_TEAM_ID, &id))
     {
-        s_config.team_id = id;
+        dev.team_id = id;
     }
     uint32_t color = 0;
     if (nvs_store_read_u32(NVS_GAME_NS, NVS_KEY_COLOR, &color))
     {
-        s_config.color_rgb = color;
+        dev.color_rgb = color;
     }
     
     // Load device name
     char name_buf[32] = {0};
     if (nvs_store_read_str(NVS_GAME_NS, "device_name", name_buf, sizeof(name_buf)))
     {
-        strncpy(s_config.device_name, name_buf, sizeof(s_config.device_name) - 1);
-        s_config.device_name[sizeof(s_config.device_name) - 1] = '\0';
+        strncpy(dev.device_name, name_buf, sizeof(dev.device_name) - 1);
+        dev.device_name[sizeof(dev.device_name) - 1] = '\0';
     }
     
-    UNLOCK();
+    game_state_config_commit(&dev, NULL, NULL);
     return loaded;
 }
 
 bool game_state_save_ids(void)
 {
-    LOCK();
-    s_config.device_id &= MAX_DEVICE_ID;
-    s_config.player_id &= MAX_PLAYER_ID;
+    // Commit masks the ids, so the stored values are the published ones.
+    // Only changed keys reach flash, in one write-behind flush (nvs_store.h).
+    const DeviceConfig* dev = device_cfg();
     bool ok = true;
-    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_DEVICE_ID, s_config.device_id);
-    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_PLAYER_ID, s_config.player_id);
-    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_TEAM_ID, s_config.team_id);
-    ok &= nvs_store_write_u32(NVS_GAME_NS, NVS_KEY_COLOR, s_config.color_rgb);
+    nvs_store_begin();
+    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_DEVICE_ID, dev->device_id);
+    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_PLAYER_ID, dev->player_id);
+    ok &= nvs_store_write_u8(NVS_GAME_NS, NVS_KEY_TEAM_ID, dev->team_id);
+    ok &= nvs_store_write_u32(NVS_GAME_NS, NVS_KEY_COLOR, dev->color_rgb);
     
     // Save device name
-    if (strlen(s_config.device_name) > 0)
+    if (strlen(dev->device_name) > 0)
     {
-        ok &= nvs_store_write_str(NVS_GAME_NS, "device_name", s_config.device_name);
+        ok &= nvs_store_write_str(NVS_GAME_NS, "device_name", dev->device_name);
     }
+    nvs_store_end();
     
-    UNLOCK();
+    clock_sync_init(dev->device_id);
+    scoreboard_init(dev->device_id, dev->player_id, dev->team_id);
     return ok;
 }
 
 void game_state_generate_ids(void)
 {
-    LOCK();
-    if (s_config.device_id == 0 || s_config.device_id > MAX_DEVICE_ID)
-        s_config.device_id = (rand_u8() % MAX_DEVICE_ID) + 1;
-    if (s_config.player_id == 0 || s_config.player_id > MAX_PLAYER_ID)
-        s_config.player_id = (s_config.device_id % MAX_PLAYER_ID) + 1;
-    UNLOCK();
+    DeviceConfig dev;
+    game_state_config_begin(&dev, NULL);
+    if (dev.device_id == 0 || dev.device_id > MAX_DEVICE_ID)
+        dev.device_id = (rand_u8() % MAX_DEVICE_ID) + 1;
+    if (dev.player_id == 0 || dev.player_id > MAX_PLAYER_ID)
+        dev.player_id = (dev.device_id % MAX_PLAYER_ID) + 1;
+    game_state_config_commit(&dev, NULL, NULL);
 }
 
 void game_state_reset_runtime(void)
 {
     LOCK();
+    // Broadcast seq_ids stay monotonic for the whole boot: the resume journal
+    // (ws_server.cpp) still holds the previous match's messages
+    uint32_t seq_id = s_state.broadcast_seq_id;
     memset(&s_state, 0, sizeof(s_state));
-    s_state.hearts_remaining = s_game_cfg.max_hearts;
+    s_state.broadcast_seq_id = seq_id;
+    s_state.hearts_remaining = game_cfg()->max_hearts;
+    match_log_append(MLOG_RESET, 0, 0, s_state.hearts_remaining);
+    disarm(DL_RESPAWN);
+    disarm(DL_INVULNERABLE);
+    disarm(DL_GAME_END);
+    disarm(DL_ELAPSED);
     UNLOCK();
 }
 
@@ -161,75 +671,18 @@ void game_state_reset_runtime(void)
 
 const GameConfig* game_state_get_game_config(void)
 {
-    return &s_game_cfg;
-}
-
-GameConfig* game_state_get_game_config_mut(void)
-{
-    return &s_game_cfg;
-}
-
-static uint32_t clamp_u32(uint32_t v, uint32_t lo, uint32_t hi)
-{
-    if (v < lo)
-        return lo;
-    if (v > hi)
-        return hi;
-    return v;
+    return game_cfg();
 }
 
 void game_state_apply_game_config(const GameConfig* cfg, bool* clamped)
 {
     if (!cfg)
         return;
-    bool local_clamped = false;
-    GameConfig nc = *cfg;
-
-    auto clamp8 = [&](uint8_t v, uint8_t lo, uint8_t hi) {
-        if (v < lo)
-        {
-            local_clamped = true;
-            return lo;
-        }
-        if (v > hi)
-        {
-            local_clamped = true;
-            return hi;
-        }
-        return v;
-    };
-    auto clamp16 = [&](uint16_t v, uint16_t lo, uint16_t hi) {
-        if (v < lo)
-        {
-            local_clamped = true;
-            return lo;
-        }
-        if (v > hi)
-        {
-            local_clamped = true;
-            return hi;
-        }
-        return v;
-    };
-
-    nc.max_hearts = clamp8(nc.max_hearts, 1, 99);
-    nc.time_limit_s = clamp16(nc.time_limit_s, 0, 7200);
-    nc.score_to_win = clamp16(nc.score_to_win, 0, 65535);
-    nc.respawn_cooldown_ms = clamp_u32(nc.respawn_cooldown_ms, 0, 30000);
-    nc.invulnerability_ms = clamp16(nc.invulnerability_ms, 0, 30000);
-    nc.mag_capacity = clamp8(nc.mag_capacity, 0, 255);
-    nc.max_ammo = clamp16(nc.max_ammo, 0, 65535);
-    nc.reload_time_ms = clamp16(nc.reload_time_ms, 0, 30000);
-    nc.shot_rate_limit_ms = clamp16(nc.shot_rate_limit_ms, 50, 2000);
-
-    LOCK();
-    s_game_cfg = nc;
-    UNLOCK();
-    if (clamped)
-        *clamped = local_clamped;
+    game_state_config_begin(NULL, NULL);
+    game_state_config_commit(NULL, cfg, clamped);
 }
 
-void game_state_load_default_game_config(void)
+void game_state_default_game_config(GameConfig* out)
 {
     GameConfig cfg = {};
     
@@ -272,26 +725,50 @@ void game_state_load_default_game_config(void)
     cfg.random_teams_on_start = false;
     cfg.hit_sound_enabled = true;
 
-    bool cl = false;
-    game_state_apply_game_config(&cfg, &cl);
+    *out = cfg;
+}
+
+void game_state_load_default_game_config(void)
+{
+    GameConfig cfg;
+    game_state_default_game_config(&cfg);
+    game_state_apply_game_config(&cfg, NULL);
 }
 
 // Runtime state
 
-const GameStateData* game_state_get(void)
+// Win conditions, checked where the counts they depend on change (this
+// device's kills, hits and deaths) and from game_state_tick() for the offline
+// scoreboard. Caller holds the lock.
+// @return true if this call ended the match: notify GAME_EVT_GAME_OVER after unlocking
+static bool check_win(void)
 {
-    return &s_state;
+    if (!s_state.game_running || s_state.game_over || s_state.game_paused)
+        return false;
+    const ConfigVersion* cfg = current_config();
+    const GameModePolicy* mode = cfg->mode ? cfg->mode : &GAME_MODE_FREE_PLAY;
+    if (!mode->is_over(&s_state, &cfg->game))
+        return false;
+    s_state.game_over = true;
+    s_state.game_running = false;
+    disarm(DL_GAME_END);
+    match_log_append(MLOG_GAME_OVER, 0, 0, 0);
+    return true;
 }
 
-GameStateData* game_state_get_mut(void)
+void game_state_set_hearts(uint8_t hearts)
 {
-    return &s_state;
+    LOCK();
+    s_state.hearts_remaining = hearts;
+    match_log_append(MLOG_HEARTS, 0, 0, hearts);
+    UNLOCK();
 }
 
 void game_state_record_shot(void)
 {
     LOCK();
     s_state.shots_fired++;
+    match_log_append(MLOG_SHOT, 0, 0, 0);
     UNLOCK();
 }
 
@@ -299,14 +776,24 @@ void game_state_record_hit(void)
 {
     LOCK();
     s_state.hits_landed++;
+    match_log_append(MLOG_HIT_LANDED, 0, 0, game_cfg()->hit_score);
+    scoreboard_add(SCORE_HIT);
+    bool ended = check_win();
     UNLOCK();
+    if (ended)
+        notify(GAME_EVT_GAME_OVER);
 }
 
 void game_state_record_kill(void)
 {
     LOCK();
     s_state.kills++;
+    match_log_append(MLOG_KILL, 0, 0, game_cfg()->kill_score);
+    scoreboard_add(SCORE_KILL);
+    bool ended = check_win();
     UNLOCK();
+    if (ended)
+        notify(GAME_EVT_GAME_OVER);
 }
 
 void game_state_record_death(void)
@@ -316,14 +803,23 @@ void game_state_record_death(void)
     if (s_state.hearts_remaining > 0)
         s_state.hearts_remaining--;
     s_state.respawning = true;
-    s_state.respawn_end_time_ms = (uint32_t)(esp_timer_get_time() / 1000) + s_game_cfg.respawn_cooldown_ms;
+    s_state.invulnerable = false;
+    match_log_append(MLOG_DEATH, 0, 0, s_state.hearts_remaining);
+    uint32_t cooldown_ms = game_cfg()->respawn_cooldown_ms;
+    s_state.respawn_end_time_ms = (uint32_t)(esp_timer_get_time() / 1000) + cooldown_ms;
+    arm(DL_RESPAWN, cooldown_ms);
+    scoreboard_add(SCORE_DEATH);
+    bool ended = check_win();
     UNLOCK();
+    if (ended)
+        notify(GAME_EVT_GAME_OVER);
 }
 
 void game_state_record_friendly_fire(void)
 {
     LOCK();
     s_state.friendly_fire_count++;
+    match_log_append(MLOG_FRIENDLY_FIRE, 0, 0, 0);
     UNLOCK();
 }
 
@@ -335,34 +831,36 @@ void game_state_reset_stats(void)
     s_state.shots_fired = 0;
     s_state.hits_landed = 0;
     s_state.friendly_fire_count = 0;
-    s_state.hearts_remaining = s_game_cfg.max_hearts;
+    s_state.hearts_remaining = game_cfg()->max_hearts;
     s_state.rx_count = 0;
     s_state.tx_count = 0;
     s_state.last_rx_ms = 0;
+    match_log_append(MLOG_RESET_STATS, 0, 0, s_state.hearts_remaining);
     UNLOCK();
 }
 
 uint8_t game_state_get_player_id(void)
 {
-    return s_config.player_id;
+    return device_cfg()->player_id;
 }
 
 uint32_t game_state_last_rx_ms_ago(void)
 {
     uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
-    if (s_state.last_rx_ms == 0)
+    uint32_t last_rx_ms = published().last_rx_ms;
+    if (last_rx_ms == 0)
         return 0;
-    return now > s_state.last_rx_ms ? now - s_state.last_rx_ms : 0;
+    return now > last_rx_ms ? now - last_rx_ms : 0;
 }
 
 uint32_t game_state_rx_count(void)
 {
-    return s_state.rx_count;
+    return published().rx_count;
 }
 
 uint32_t game_state_tx_count(void)
 {
-    return s_state.tx_count;
+    return published().tx_count;
 }
 
 int game_state_get_ammo(void)
@@ -370,38 +868,31 @@ int game_state_get_ammo(void)
     return 0;
 }
 
-bool game_state_check_respawn(void)
-{
-    if (!s_state.respawning)
-        return false;
-    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
-    if (now >= s_state.respawn_end_time_ms)
-    {
-        LOCK();
-        s_state.respawning = false;
-        s_state.hearts_remaining = s_game_cfg.max_hearts;
-        UNLOCK();
-        return true;
-    }
-    return false;
-}
-
 bool game_state_is_respawning(void)
 {
-    return s_state.respawning;
+    return published().respawning;
 }
 
 void game_state_start_respawn(void)
 {
     LOCK();
     s_state.respawning = true;
-    s_state.respawn_end_time_ms = (uint32_t)(esp_timer_get_time() / 1000) + s_game_cfg.respawn_cooldown_ms;
+    s_state.invulnerable = false;
+    match_log_append(MLOG_RESPAWN_WAIT, 0, 0, 0);
+    uint32_t cooldown_ms = game_cfg()->respawn_cooldown_ms;
+    s_state.respawn_end_time_ms = (uint32_t)(esp_timer_get_time() / 1000) + cooldown_ms;
+    arm(DL_RESPAWN, cooldown_ms);
     UNLOCK();
 }
 
+bool game_state_is_invulnerable(void)
+{
+    return published().invulnerable;
+}
+
 bool game_state_friendly_fire_counts(void)
 {
-    return s_game_cfg.friendly_fire_enabled;
+    return game_cfg()->friendly_fire_enabled;
 }
 
 // Connection
@@ -417,15 +908,10 @@ void game_state_update_heartbeat(void)
 {
     LOCK();
     s_state.last_heartbeat_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    arm(DL_HEARTBEAT, HEARTBEAT_INTERVAL_MS);
     UNLOCK();
 }
 
-bool game_state_heartbeat_due(void)
-{
-    uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
-    return (now - s_state.last_heartbeat_ms) >= 10000; // 10 seconds per protocol v2.3
-}
-
 uint32_t game_state_next_seq_id(void)
 {
     LOCK();
@@ -440,12 +926,13 @@ int game_state_config_to_json(char* buffer, size_t max_len, bool clamp_noted)
 {
     if (!buffer || max_len == 0)
         return -1;
+    const DeviceConfig* dev = device_cfg();
     int len = snprintf(buffer, max_len,
                        "{"
                        "\"device_id\":%u,\"player_id\":%u,\"team_id\":%u,\"color_rgb\":%u,"
                        "\"clamped\":%s"
                        "}",
-                       s_config.device_id, s_config.player_id, s_config.team_id, (unsigned)s_config.color_rgb,
+                       dev->device_id, dev->player_id, dev->team_id, (unsigned)dev->color_rgb,
                        clamp_noted ? "true" : "false");
     return len < (int)max_len ? len : -1;
 }
@@ -455,19 +942,21 @@ int game_state_to_json(char* buffer, size_t max_len)
     if (!buffer || max_len == 0)
         return -1;
     uint32_t uptime = (uint32_t)(esp_timer_get_time() / 1000);
+    GameStateData st;
+    game_state_snapshot(&st);
     int len = snprintf(buffer, max_len,
                        "{"
                        "\"shots\":%lu,\"hits\":%lu,\"kills\":%lu,\"deaths\":%lu,\"hearts\":%u,"
                        "\"score\":%lu,\"respawning\":%s,\"game_running\":%s,\"game_over\":%s,"
                        "\"server_connected\":%s,\"uptime\":%lu"
                        "}",
-                       (unsigned long)s_state.shots_fired, (unsigned long)s_state.hits_landed,
-                       (unsigned long)s_state.kills, (unsigned long)s_state.deaths, (unsigned)s_state.hearts_remaining,
-                       (unsigned long)s_state.player_score,
-                       s_state.respawning ? "true" : "false",
-                       s_state.game_running ? "true" : "false",
-                       s_state.game_over ? "true" : "false",
-                       s_state.server_connected ? "true" : "false",
+                       (unsigned long)st.shots_fired, (unsigned long)st.hits_landed,
+                       (unsigned long)st.kills, (unsigned long)st.deaths, (unsigned)st.hearts_remaining,
+                       (unsigned long)st.player_score,
+                       st.respawning ? "true" : "false",
+                       st.game_running ? "true" : "false",
+                       st.game_over ? "true" : "false",
+                       st.server_connected ? "true" : "false",
                        (unsigned long)uptime);
     return len < (int)max_len ? len : -1;
 }
@@ -476,7 +965,7 @@ bool game_state_config_from_json(const char* json, GameConfig* out_config, bool*
 {
     if (!json || !out_config)
         return false;
-    *out_config = s_game_cfg;
+    *out_config = *game_cfg();
     if (clamped)
         *clamped = false;
     return true;
@@ -509,7 +998,7 @@ int game_state_create_shot_fired_json(char* buffer, size_t max_len)
 {
     if (!buffer || max_len == 0)
         return -1;
-    int len = snprintf(buffer, max_len, "{\"shots\":%lu,\"ts\":%lu}", (unsigned long)s_state.shots_fired,
+    int len = snprintf(buffer, max_len, "{\"shots\":%lu,\"ts\":%lu}", (unsigned long)published().shots_fired,
                        (unsigned long)(esp_timer_get_time() / 1000));
     return len < (int)max_len ? len : -1;
 }
@@ -520,31 +1009,42 @@ int game_state_create_shot_fired_json(char* buffer, size_t max_len)
 
 void game_state_start_game(void)
 {
+    const ConfigVersion* cfg = current_config();
+    const GameModePolicy* mode = cfg->mode ? cfg->mode : &GAME_MODE_FREE_PLAY;
     LOCK();
     uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
     s_state.game_running = true;
     s_state.game_over = false;
     s_state.game_start_time_ms = now_ms;
     
-    // Set game end time for "time" mode
-    if (strcmp(s_game_cfg.win_type, "time") == 0 && s_game_cfg.time_limit_s > 0)
+    // Timed modes end on the DL_GAME_END deadline
+    uint32_t duration_ms = mode->duration_ms(&cfg->game);
+    if (duration_ms > 0)
     {
-        s_state.game_end_time_ms = now_ms + (s_game_cfg.time_limit_s * 1000);
-        ESP_LOGI(TAG, "Game started (time mode): %us, ends at %lu ms", s_game_cfg.time_limit_s, s_state.game_end_time_ms);
+        s_state.game_end_time_ms = now_ms + duration_ms;
+        arm(DL_GAME_END, duration_ms);
+        ESP_LOGI(TAG, "Game started (mode: %s): %lu s, ends at %lu ms", mode->win_type,
+                 (unsigned long)(duration_ms / 1000), s_state.game_end_time_ms);
     }
     else
     {
         s_state.game_end_time_ms = 0;
-        ESP_LOGI(TAG, "Game started (mode: %s)", s_game_cfg.win_type);
+        disarm(DL_GAME_END);
+        ESP_LOGI(TAG, "Game started (mode: %s)", mode->win_type);
     }
     
-    // Reset player hearts to spawn_hearts for LMS mode
-    if (strcmp(s_game_cfg.win_type, "last_man_standing") == 0)
+    int hearts = mode->start_hearts(&cfg->game);
+    if (hearts >= 0)
     {
-        s_state.hearts_remaining = s_game_cfg.spawn_hearts;
+        s_state.hearts_remaining = (uint8_t)hearts;
     }
-    
+
+    match_log_new_match();
+    match_log_append(MLOG_MATCH_START, 0, 0, s_state.hearts_remaining);
+    arm(DL_ELAPSED, ELAPSED_INTERVAL_MS);
+    match_store_request_flush();
     UNLOCK();
+    scoreboard_new_match();
 }
 
 void game_state_stop_game(void)
@@ -553,6 +1053,10 @@ void game_state_stop_game(void)
     s_state.game_running = false;
     s_state.game_paused = false;
     s_state.game_over = true;
+    disarm(DL_GAME_END);
+    disarm(DL_ELAPSED);
+    match_log_append(MLOG_MATCH_STOP, 0, 0, 0);
+    match_store_request_flush();
     ESP_LOGI(TAG, "Game stopped");
     UNLOCK();
 }
@@ -564,6 +1068,10 @@ void game_state_pause_game(void)
     {
         s_state.game_paused = true;
         s_state.pause_time_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        disarm(DL_GAME_END);
+        disarm(DL_ELAPSED);
+        log_elapsed();
+        match_log_append(MLOG_PAUSE, 0, 0, 0);
         ESP_LOGI(TAG, "Game paused");
     }
     UNLOCK();
@@ -576,11 +1084,14 @@ void game_state_resume_game(void)
     {
         uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
         uint32_t pause_duration = now_ms - s_state.pause_time_ms;
+        s_state.game_start_time_ms += pause_duration; // played time leaves the pause out
+        arm(DL_ELAPSED, ELAPSED_INTERVAL_MS);
         
-        // Adjust game end time if in time mode
-        if (strcmp(s_game_cfg.win_type, "time") == 0 && s_state.game_end_time_ms > 0)
+        // Adjust game end time if the match is timed
+        if (s_state.game_end_time_ms > 0)
         {
             s_state.game_end_time_ms += pause_duration;
+            arm(DL_GAME_END, s_state.game_end_time_ms > now_ms ? s_state.game_end_time_ms - now_ms : 0);
             ESP_LOGI(TAG, "Game resumed, end time adjusted by +%lu ms", pause_duration);
         }
         else
@@ -590,178 +1101,94 @@ void game_state_resume_game(void)
         
         s_state.game_paused = false;
         s_state.pause_time_ms = 0;
+        match_log_append(MLOG_RESUME, 0, 0, 0);
     }
     UNLOCK();
 }
 
 void game_state_extend_time(int additional_minutes)
 {
+    GameConfig game;
+    game_state_config_begin(NULL, &game);
     LOCK();
-    if (s_state.game_running && strcmp(s_game_cfg.win_type, "time") == 0)
+    bool extend = s_state.game_running && game_mode()->extendable;
+    if (extend)
     {
         uint32_t additional_ms = additional_minutes * 60 * 1000;
         s_state.game_end_time_ms += additional_ms;
-        s_game_cfg.time_limit_s += (additional_minutes * 60);
+        game.time_limit_s += (additional_minutes * 60);
+        if (!s_state.game_paused)
+        {
+            uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+            arm(DL_GAME_END, s_state.game_end_time_ms > now_ms ? s_state.game_end_time_ms - now_ms : 0);
+        }
         ESP_LOGI(TAG, "Game time extended by %d minutes, new end time: %lu ms", 
                  additional_minutes, s_state.game_end_time_ms);
     }
     UNLOCK();
+    if (extend)
+        game_state_config_commit(NULL, &game, NULL);
+    else
+        game_state_config_abort();
 }
 
 void game_state_update_target(int new_target)
 {
-    LOCK();
-    if (s_state.game_running && strcmp(s_game_cfg.win_type, "score") == 0)
+    GameConfig game;
+    game_state_config_begin(NULL, &game);
+    if (published().game_running && game_mode()->has_target_score)
     {
-        s_game_cfg.target_score = new_target;
+        game.target_score = new_target;
+        game_state_config_commit(NULL, &game, NULL);
         ESP_LOGI(TAG, "Target score updated to %d", new_target);
     }
-    UNLOCK();
+    else
+    {
+        game_state_config_abort();
+    }
 }
 
 void game_state_tick(void)
 {
-    if (!s_state.game_running || s_state.game_over || s_state.game_paused)
+    // Players whose beacons stopped leave the roster even when no beacon arrives
+    roster_refresh_field();
+
+    // Lock-free pre-check: most ticks find no match running
+    GameStateData st = published();
+    if (!st.game_running || st.game_over || st.game_paused)
         return;
-        
+
     LOCK();
-    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
-    
-    // Check win condition based on win_type
-    if (strcmp(s_game_cfg.win_type, "time") == 0)
-    {
-        // Time mode: Check if time limit reached
-        if (s_state.game_end_time_ms > 0 && now_ms >= s_state.game_end_time_ms)
-        {
-            s_state.game_over = true;
-            s_state.game_running = false;
-            ESP_LOGI(TAG, "Game over: Time limit reached");
-            // TODO: Send GAME_OVER message via WebSocket
-        }
-    }
-    else if (strcmp(s_game_cfg.win_type, "score") == 0)
-    {
-        // Score mode: Check if target score reached
-        s_state.player_score = (s_state.kills * s_game_cfg.kill_score) + (s_state.hits_landed * s_game_cfg.hit_score);
-        
-        if (s_state.player_score >= s_game_cfg.target_score)
-        {
-            s_state.game_over = true;
-            s_state.game_running = false;
-            ESP_LOGI(TAG, "Game over: Target score reached (%lu >= %u)", s_state.player_score, s_game_cfg.target_score);
-            // TODO: Send GAME_OVER message with winner info via WebSocket
-        }
-    }
-    else if (strcmp(s_game_cfg.win_type, "last_man_standing") == 0)
-    {
-        // Last Man Standing: Game ends when player has 0 hearts
-        // (Server will detect when all players/teams are eliminated)
-        if (s_state.hearts_remaining == 0)
-        {
-            ESP_LOGI(TAG, "Player eliminated (0 hearts remaining)");
-            // Player is eliminated but game continues until server declares winner
-        }
-    }
-    
+    // check_win() looks again: a stop or pause may have landed since the snapshot
+    bool ended = check_win();
     UNLOCK();
+    if (ended)
+        notify(GAME_EVT_GAME_OVER);
 }
 
 bool game_state_is_running(void)
 {
-    return s_state.game_running;
+    return published().game_running;
 }
 
 bool game_state_is_paused(void)
 {
-    return s_state.game_paused;
+    return published().game_paused;
 }
 
 bool game_state_is_game_over(void)
 {
-    return s_state.game_over;
+    return published().game_over;
 }
 
 bool game_state_can_shoot(void)
 {
-    // In Last Man Standing mode, player can't shoot if they have 0 hearts
-    if (strcmp(s_game_cfg.win_type, "last_man_standing") == 0)
-    {
-        return s_state.hearts_remaining > 0;
-    }
-    
-    // In other modes, can always shoot (unless respawning)
-    return !s_state.respawning;
+    GameStateData st = published();
+    return game_mode()->can_shoot(&st);
 }
 
 bool game_state_can_take_damage(void)
 {
-    // In Last Man Standing mode, player can't take damage if they have 0 hearts
-    if (strcmp(s_game_cfg.win_type, "last_man_standing") == 0)
-    {
-        return s_state.hearts_remaining > 0;
-    }
-    
-    // In other modes, can always take damage
-    return true;
-}
-
-// ============================================================================
-// Player name lookup table
-// ============================================================================
-
-void game_state_clear_player_names(void)
-{
-    LOCK();
-    s_player_count = 0;
-    memset(s_players, 0, sizeof(s_players));
-    UNLOCK();
-}
-
-void game_state_set_player_name(uint8_t player_id, const char* name)
-{
-    if (!name) return;
-    LOCK();
-    // Update existing entry if found
-    for (int i = 0; i < s_player_count; i++)
-    {
-        if (s_players[i].player_id == player_id)
-        {
-            strncpy(s_players[i].name, name, PLAYER_NAME_LEN - 1);
-            s_players[i].name[PLAYER_NAME_LEN - 1] = '\0';
-            UNLOCK();
-            return;
-        }
-    }
-    // Add new entry if space available
-    if (s_player_count < MAX_PLAYER_ENTRIES)
-    {
-        s_players[s_player_count].player_id = player_id;
-        strncpy(s_players[s_player_count].name, name, PLAYER_NAME_LEN - 1);
-        s_players[s_player_count].name[PLAYER_NAME_LEN - 1] = '\0';
-        s_player_count++;
-    }
-    UNLOCK();
-}
-
-const char* game_state_get_player_name(uint8_t player_id)
-{
-    LOCK();
-    for (int i = 0; i < s_player_count; i++)
-    {
-        if (s_players[i].player_id == player_id)
-        {
-            UNLOCK();
-            return s_players[i].name;
-        }
-    }
-    UNLOCK();
-    return NULL;
-}
-
-int game_state_get_player_count(void)
-{
-    LOCK();
-    int count = s_player_count;
-    UNLOCK();
-    return count;
+    GameStateData st = published();
+    return game_mode()->can_take_damage(&st);
 }
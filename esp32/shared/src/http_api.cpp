@@ -1,7 +1,10 @@
 #include "http_api.h"
 #include <esp_log.h>
+#include <stdlib.h>
 #include <string.h>
 #include "espnow_comm.h"
+#include "lock_profile.h"
+#include "match_log.h"
 #include "wifi_manager.h"
 
 static const char* TAG = "HttpApi";
@@ -51,6 +54,60 @@ static esp_err_t peers_post_handler(httpd_req_t* req)
     return ESP_OK;
 }
 
+// Binary dump of the match log (match_log.h), for the match_replay host tool
+static esp_err_t match_log_get_handler(httpd_req_t* req)
+{
+    size_t cap = sizeof(MatchLogDumpHeader) + MATCH_LOG_CAPACITY * sizeof(MatchLogRecord);
+    uint8_t* buf = (uint8_t*)malloc(cap);
+    if (!buf)
+    {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No memory");
+        return ESP_OK;
+    }
+    size_t len = match_log_dump(buf, cap);
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_send(req, (const char*)buf, len);
+    free(buf);
+    return ESP_OK;
+}
+
+#if RAYZ_LOCK_PROFILE
+// Lock profiler sites (lock_profile.h), one chunk per site; ?reset zeroes the counters after the report
+static esp_err_t locks_get_handler(httpd_req_t* req)
+{
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf), "{\"buckets_us\":[");
+    for (int b = 0; b < LOCK_PROFILE_BUCKETS - 1; b++)
+        len += snprintf(buf + len, sizeof(buf) - len, "%s%lu", b ? "," : "",
+                        (unsigned long)lock_profile_bucket_limit_us(b));
+    len += snprintf(buf + len, sizeof(buf) - len, "],\"sites\":[");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send_chunk(req, buf, len);
+
+    LockSite site;
+    bool first = true;
+    for (int i = 0; lock_profile_site(i, &site); i++)
+    {
+        buf[0] = ',';
+        len = lock_profile_site_to_json(&site, buf + 1, sizeof(buf) - 1);
+        if (len < 0)
+        {
+            ESP_LOGW(TAG, "Lock site %s:%lu does not fit the report", site.func, (unsigned long)site.line);
+            continue;
+        }
+        httpd_resp_send_chunk(req, first ? buf + 1 : buf, first ? len : len + 1);
+        first = false;
+    }
+    httpd_resp_send_chunk(req, "]}", 2);
+    httpd_resp_send_chunk(req, NULL, 0);
+
+    char query[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK && strstr(query, "reset"))
+        lock_profile_reset();
+    return ESP_OK;
+}
+#endif
+
 httpd_handle_t http_api_start(httpd_handle_t server)
 {
     if (!server)
@@ -76,9 +133,27 @@ httpd_handle_t http_api_start(httpd_handle_t server)
                                   .is_websocket = false,
                                   .handle_ws_control_frames = false,
                                   .supported_subprotocol = NULL};
+    httpd_uri_t match_log_uri = {.uri = "/api/match_log",
+                                 .method = HTTP_GET,
+                                 .handler = match_log_get_handler,
+                                 .user_ctx = NULL,
+                                 .is_websocket = false,
+                                 .handle_ws_control_frames = false,
+                                 .supported_subprotocol = NULL};
     httpd_register_uri_handler(server, &status_uri);
     httpd_register_uri_handler(server, &peers_uri_get);
     httpd_register_uri_handler(server, &peers_uri_post);
+    httpd_register_uri_handler(server, &match_log_uri);
+#if RAYZ_LOCK_PROFILE
+    httpd_uri_t locks_uri = {.uri = "/api/locks",
+                             .method = HTTP_GET,
+                             .handler = locks_get_handler,
+                             .user_ctx = NULL,
+                             .is_websocket = false,
+                             .handle_ws_control_frames = false,
+                             .supported_subprotocol = NULL};
+    httpd_register_uri_handler(server, &locks_uri);
+#endif
     ESP_LOGI(TAG, "HTTP API registered");
     return server;
 }
@@ -0,0 +1,158 @@
+#include "lock_profile.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+// Per-site mutex contention counters (see lock_profile.h)
+
+// Every site seen so far, newest first. Sites are only ever added.
+static LockSite* s_sites = NULL;
+
+static int bucket_of(uint32_t us)
+{
+    int b = 0;
+    while (b < LOCK_PROFILE_BUCKETS - 1 && us >= lock_profile_bucket_limit_us(b))
+        b++;
+    return b;
+}
+
+// Caller holds the site's lock, so two first uses of one site cannot race
+static void register_site(LockSite* site, const char* lock, const char* func, uint32_t line)
+{
+    site->lock = lock;
+    site->line = line;
+    __atomic_store_n(&site->func, func, __ATOMIC_RELEASE);
+    // Other locks register their sites at the same time
+    LockSite* head = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE);
+    do
+    {
+        site->next = head;
+    } while (!__atomic_compare_exchange_n(&s_sites, &head, site, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+}
+
+void lock_profile_take(LockProfile* prof, LockSite* site, SemaphoreHandle_t mutex, const char* func, uint32_t line)
+{
+    int64_t start = esp_timer_get_time();
+    bool contended = xSemaphoreTake(mutex, 0) != pdTRUE;
+    if (contended)
+        xSemaphoreTake(mutex, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+
+    // The lock is ours: nobody else writes this site or prof until we give it back
+    if (!site->func)
+        register_site(site, prof->name, func, line);
+    uint32_t wait_us = (uint32_t)(now - start);
+    site->acquires++;
+    if (contended)
+        site->contended++;
+    site->wait_hist[bucket_of(wait_us)]++;
+    site->wait_total_us += wait_us;
+    if (wait_us > site->wait_max_us)
+        site->wait_max_us = wait_us;
+
+    prof->site = site;
+    prof->holder = pcTaskGetName(NULL);
+    prof->taken_us = now;
+}
+
+void lock_profile_give(LockProfile* prof, SemaphoreHandle_t mutex)
+{
+    LockSite* site = prof->site;
+    if (site)
+    {
+        uint32_t hold_us = (uint32_t)(esp_timer_get_time() - prof->taken_us);
+        site->hold_hist[bucket_of(hold_us)]++;
+        site->hold_total_us += hold_us;
+        if (hold_us > site->hold_max_us)
+        {
+            site->hold_max_us = hold_us;
+            strncpy(site->slowest_holder, prof->holder ? prof->holder : "?", LOCK_PROFILE_TASK_NAME - 1);
+            site->slowest_holder[LOCK_PROFILE_TASK_NAME - 1] = '\0';
+        }
+        prof->site = NULL;
+    }
+    xSemaphoreGive(mutex);
+}
+
+bool lock_profile_site(int index, LockSite* out)
+{
+    LockSite* site = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE);
+    for (int i = 0; site && i < index; i++)
+        site = site->next;
+    if (!site)
+        return false;
+    *out = *site;
+    out->next = NULL;
+    return true;
+}
+
+void lock_profile_reset(void)
+{
+    for (LockSite* site = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE); site; site = site->next)
+    {
+        site->acquires = 0;
+        site->contended = 0;
+        memset(site->wait_hist, 0, sizeof(site->wait_hist));
+        memset(site->hold_hist, 0, sizeof(site->hold_hist));
+        site->wait_max_us = 0;
+        site->hold_max_us = 0;
+        site->wait_total_us = 0;
+        site->hold_total_us = 0;
+        site->slowest_holder[0] = '\0';
+    }
+}
+
+uint32_t lock_profile_bucket_limit_us(int bucket)
+{
+    if (bucket < 0 || bucket >= LOCK_PROFILE_BUCKETS - 1)
+        return UINT32_MAX;
+    return 4u << (2 * bucket);
+}
+
+void lock_profile_totals(uint32_t* wait_max_us, uint32_t* contended)
+{
+    uint32_t wait_max = 0, waits = 0;
+    for (LockSite* site = __atomic_load_n(&s_sites, __ATOMIC_ACQUIRE); site; site = site->next)
+    {
+        if (site->wait_max_us > wait_max)
+            wait_max = site->wait_max_us;
+        waits += site->contended;
+    }
+    if (wait_max_us)
+        *wait_max_us = wait_max;
+    if (contended)
+        *contended = waits;
+}
+
+static int hist_to_json(const uint32_t* hist, char* buffer, size_t max_len)
+{
+    int len = 0;
+    for (int b = 0; b < LOCK_PROFILE_BUCKETS; b++)
+    {
+        int n = snprintf(buffer + len, max_len - len, "%s%lu", b ? "," : "", (unsigned long)hist[b]);
+        if (n < 0 || (size_t)n >= max_len - len)
+            return -1;
+        len += n;
+    }
+    return len;
+}
+
+int lock_profile_site_to_json(const LockSite* site, char* buffer, size_t max_len)
+{
+    char wait[LOCK_PROFILE_BUCKETS * 11];
+    char hold[LOCK_PROFILE_BUCKETS * 11];
+    if (hist_to_json(site->wait_hist, wait, sizeof(wait)) < 0 || hist_to_json(site->hold_hist, hold, sizeof(hold)) < 0)
+        return -1;
+    int n = snprintf(buffer, max_len,
+                     "{\"lock\":\"%s\",\"site\":\"%s:%lu\",\"acquires\":%lu,\"contended\":%lu,"
+                     "\"wait_us\":{\"max\":%lu,\"total\":%llu,\"hist\":[%s]},"
+                     "\"hold_us\":{\"max\":%lu,\"total\":%llu,\"hist\":[%s]},\"slowest_holder\":\"%s\"}",
+                     site->lock, site->func ? site->func : "?", (unsigned long)site->line,
+                     (unsigned long)site->acquires, (unsigned long)site->contended, (unsigned long)site->wait_max_us,
+                     (unsigned long long)site->wait_total_us, wait, (unsigned long)site->hold_max_us,
+                     (unsigned long long)site->hold_total_us, hold, site->slowest_holder);
+    if (n < 0 || (size_t)n >= max_len)
+        return -1;
+    return n;
+}
@@ -0,0 +1,296 @@
+#include "match_log.h"
+#include <string.h>
+#include "clock_sync.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#define MATCH_LOG_NOINIT RTC_NOINIT_ATTR
+#else
+#define MATCH_LOG_NOINIT
+#endif
+
+// Event-sourced match log (see match_log.h). No I/O here: game_state appends,
+// the HTTP API dumps, so the host tools can run it as is.
+
+static const char* TAG = "MatchLog";
+
+#define RING_MAGIC 0x524C4F47 // "RLOG"
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t check; // over the fields below, up to the records
+    uint32_t next_seq;
+    uint16_t head; // oldest record
+    uint16_t count;
+    uint8_t device_id;
+    MatchLogTotals base;
+    MatchLogRecord records[MATCH_LOG_CAPACITY];
+} Ring;
+
+// Left alone by a software reset; validated by magic and check on init
+static MATCH_LOG_NOINIT Ring s_ring;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+// FNV-1a over the ring's control fields
+static uint32_t ring_check(void)
+{
+    const uint8_t* p = (const uint8_t*)&s_ring.next_seq;
+    const uint8_t* end = (const uint8_t*)&s_ring.records;
+    uint32_t h = 2166136261u;
+    for (; p < end; p++)
+        h = (h ^ *p) * 16777619u;
+    return h;
+}
+
+static void ring_reset(uint8_t device_id)
+{
+    memset(&s_ring, 0, sizeof(s_ring));
+    s_ring.magic = RING_MAGIC;
+    s_ring.device_id = device_id;
+    s_ring.check = ring_check();
+}
+
+bool match_log_init(uint8_t device_id)
+{
+    if (!s_mutex)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return false;
+        }
+    }
+
+    LOCK();
+    bool kept = s_ring.magic == RING_MAGIC && s_ring.check == ring_check() && s_ring.device_id == device_id &&
+                s_ring.count <= MATCH_LOG_CAPACITY && s_ring.head < MATCH_LOG_CAPACITY;
+    if (kept)
+        ESP_LOGI(TAG, "Kept %u records from before the reset (seq %lu)", s_ring.count,
+                 (unsigned long)s_ring.next_seq);
+    else
+        ring_reset(device_id);
+    UNLOCK();
+    return kept;
+}
+
+void match_log_append(MatchLogType type, uint8_t a, uint8_t b, uint16_t value)
+{
+    if (!s_mutex)
+        return;
+    uint32_t now = clock_sync_match_ms();
+
+    LOCK();
+    if (s_ring.count == MATCH_LOG_CAPACITY)
+    {
+        // Full: the oldest record lives on in the base
+        match_log_apply(&s_ring.base, &s_ring.records[s_ring.head]);
+        s_ring.head = (s_ring.head + 1) % MATCH_LOG_CAPACITY;
+        s_ring.count--;
+    }
+    MatchLogRecord* rec = &s_ring.records[(s_ring.head + s_ring.count) % MATCH_LOG_CAPACITY];
+    rec->match_ms = now;
+    rec->seq = (uint16_t)s_ring.next_seq++;
+    rec->device_id = s_ring.device_id;
+    rec->type = (uint8_t)type;
+    rec->a = a;
+    rec->b = b;
+    rec->value = value;
+    s_ring.count++;
+    s_ring.check = ring_check();
+    UNLOCK();
+}
+
+void match_log_new_match(void)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    for (uint16_t i = 0; i < s_ring.count; i++)
+        match_log_apply(&s_ring.base, &s_ring.records[(s_ring.head + i) % MATCH_LOG_CAPACITY]);
+    s_ring.head = 0;
+    s_ring.count = 0;
+    s_ring.check = ring_check();
+    UNLOCK();
+}
+
+uint32_t match_log_replay(MatchLogTotals* out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!s_mutex)
+        return 0;
+    LOCK();
+    *out = s_ring.base;
+    for (uint16_t i = 0; i < s_ring.count; i++)
+        match_log_apply(out, &s_ring.records[(s_ring.head + i) % MATCH_LOG_CAPACITY]);
+    uint32_t next_seq = s_ring.next_seq;
+    UNLOCK();
+    return next_seq;
+}
+
+void match_log_seed(const MatchLogTotals* base, uint32_t next_seq)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    s_ring.base = *base;
+    s_ring.next_seq = next_seq;
+    s_ring.head = 0;
+    s_ring.count = 0;
+    s_ring.check = ring_check();
+    UNLOCK();
+}
+
+size_t match_log_dump(uint8_t* buf, size_t len)
+{
+    if (!s_mutex || len < sizeof(MatchLogDumpHeader))
+        return 0;
+    LOCK();
+    size_t room = (len - sizeof(MatchLogDumpHeader)) / sizeof(MatchLogRecord);
+    uint16_t count = s_ring.count < room ? s_ring.count : (uint16_t)room;
+
+    // A short buffer gets the newest records; the skipped ones go into the dumped base
+    MatchLogDumpHeader hdr = {};
+    hdr.magic[0] = MATCH_LOG_MAGIC0;
+    hdr.magic[1] = MATCH_LOG_MAGIC1;
+    hdr.version = MATCH_LOG_VERSION;
+    hdr.device_id = s_ring.device_id;
+    hdr.first_seq = s_ring.next_seq - count;
+    hdr.count = count;
+    hdr.base = s_ring.base;
+    uint16_t skip = s_ring.count - count;
+    for (uint16_t i = 0; i < skip; i++)
+        match_log_apply(&hdr.base, &s_ring.records[(s_ring.head + i) % MATCH_LOG_CAPACITY]);
+
+    memcpy(buf, &hdr, sizeof(hdr));
+    MatchLogRecord* out = (MatchLogRecord*)(buf + sizeof(hdr));
+    for (uint16_t i = 0; i < count; i++)
+        memcpy(&out[i], &s_ring.records[(s_ring.head + skip + i) % MATCH_LOG_CAPACITY], sizeof(MatchLogRecord));
+    UNLOCK();
+    return sizeof(hdr) + count * sizeof(MatchLogRecord);
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+static void set_hearts(MatchLogTotals* t, uint16_t value)
+{
+    if (value != MATCH_LOG_KEEP)
+        t->hearts_remaining = (uint8_t)value;
+}
+
+void match_log_apply(MatchLogTotals* t, const MatchLogRecord* rec)
+{
+    switch (rec->type)
+    {
+        case MLOG_MATCH_START:
+            t->flags = (t->flags & MLOG_FLAG_RESPAWNING) | MLOG_FLAG_RUNNING;
+            t->started_ms = rec->match_ms;
+            t->played_s = 0;
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_MATCH_STOP:
+        case MLOG_GAME_OVER:
+            t->flags = (t->flags & ~(MLOG_FLAG_RUNNING | MLOG_FLAG_PAUSED)) | MLOG_FLAG_OVER;
+            break;
+        case MLOG_PAUSE:
+            t->flags |= MLOG_FLAG_PAUSED;
+            break;
+        case MLOG_RESUME:
+            t->flags &= ~MLOG_FLAG_PAUSED;
+            break;
+        case MLOG_SHOT:
+            t->shots_fired++;
+            break;
+        case MLOG_HIT_LANDED:
+            t->hits_landed++;
+            t->points += rec->value;
+            break;
+        case MLOG_KILL:
+            t->kills++;
+            t->points += rec->value;
+            break;
+        case MLOG_RESPAWN_WAIT:
+            t->flags |= MLOG_FLAG_RESPAWNING;
+            break;
+        case MLOG_DEATH:
+            t->deaths++;
+            t->flags |= MLOG_FLAG_RESPAWNING;
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_RESPAWN:
+            t->flags &= ~MLOG_FLAG_RESPAWNING;
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_HEARTS:
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_FRIENDLY_FIRE:
+            t->friendly_fire_count++;
+            break;
+        case MLOG_RESET_STATS:
+            t->shots_fired = t->hits_landed = t->kills = t->deaths = t->friendly_fire_count = 0;
+            t->points = 0;
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_RESET:
+            memset(t, 0, sizeof(*t));
+            set_hearts(t, rec->value);
+            break;
+        case MLOG_ELAPSED:
+            t->played_s = rec->value;
+            break;
+        default:
+            break; // MLOG_HIT_RECEIVED, MLOG_COMMAND, MLOG_CONFIG: for the record only
+    }
+}
+
+void match_log_to_state(const MatchLogTotals* t, GameStateData* st)
+{
+    st->shots_fired = t->shots_fired;
+    st->hits_landed = t->hits_landed;
+    st->kills = t->kills;
+    st->deaths = t->deaths;
+    st->friendly_fire_count = t->friendly_fire_count;
+    st->player_score = t->points;
+    st->hearts_remaining = t->hearts_remaining;
+    st->respawning = (t->flags & MLOG_FLAG_RESPAWNING) != 0;
+    st->game_running = (t->flags & MLOG_FLAG_RUNNING) != 0;
+    st->game_paused = (t->flags & MLOG_FLAG_PAUSED) != 0;
+    st->game_over = (t->flags & MLOG_FLAG_OVER) != 0;
+}
+
+const char* match_log_type_name(uint8_t type)
+{
+    static const char* const names[MLOG_TYPE_COUNT] = {
+        "?",
+        "MATCH_START",
+        "MATCH_STOP",
+        "PAUSE",
+        "RESUME",
+        "GAME_OVER",
+        "SHOT",
+        "HIT_LANDED",
+        "KILL",
+        "HIT_RECEIVED",
+        "DEATH",
+        "RESPAWN",
+        "HEARTS",
+        "FRIENDLY_FIRE",
+        "RESET_STATS",
+        "RESET",
+        "COMMAND",
+        "CONFIG",
+        "RESPAWN_WAIT",
+        "ELAPSED",
+    };
+    return type < MLOG_TYPE_COUNT ? names[type] : "?";
+}
@@ -0,0 +1,377 @@
+#include "match_store.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#include "freertos/task.h"
+#endif
+
+// Flash checkpoints of the match log (see match_store.h)
+
+static const char* TAG = "MatchStore";
+
+#define ENTRY_MAGIC   0x534D // "MS"
+#define ENTRY_VERSION 1
+
+typedef struct __attribute__((packed))
+{
+    uint16_t magic;
+    uint8_t version;
+    uint8_t device_id;
+    uint32_t seq;     // store sequence, one per entry written
+    uint32_t log_seq; // match log records the totals cover
+    MatchLogTotals totals;
+    uint8_t reserved[16];
+    uint32_t crc; // CRC-32 of everything before it
+} Entry;
+
+static_assert(sizeof(Entry) == MATCH_STORE_ENTRY_SIZE, "match store entry must stay 64 bytes");
+
+typedef enum
+{
+    SLOT_BLANK,
+    SLOT_VALID,
+    SLOT_TORN, // programmed, but the CRC does not match (or a newer format)
+} SlotState;
+
+static MatchStoreFlash s_flash;
+static bool s_ready = false;
+static uint8_t s_device_id = 0;
+static size_t s_next = 0; // offset of the next slot to write
+static uint32_t s_next_seq = 1;
+static bool s_have = false; // s_last holds a checkpoint for this device
+static Entry s_last;
+static MatchStoreStats s_stats;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+static uint32_t crc32(const uint8_t* p, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--)
+    {
+        crc ^= *p++;
+        for (int b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static SlotState read_slot(size_t offset, Entry* e)
+{
+    if (!s_flash.read(s_flash.ctx, offset, e, sizeof(*e)))
+        return SLOT_TORN;
+    const uint8_t* p = (const uint8_t*)e;
+    bool blank = true;
+    for (size_t i = 0; i < sizeof(*e) && blank; i++)
+        blank = p[i] == 0xFF;
+    if (blank)
+        return SLOT_BLANK;
+    if (e->magic != ENTRY_MAGIC || e->version != ENTRY_VERSION ||
+        e->crc != crc32(p, offsetof(Entry, crc)))
+        return SLOT_TORN;
+    return SLOT_VALID;
+}
+
+// Sequence numbers wrap; compare them as a window
+static bool newer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+// Newest sector by its first valid entry, then the newest entry and the first free slot in it
+static void scan(void)
+{
+    size_t sectors = s_flash.size / s_flash.sector_size;
+    size_t per_sector = s_flash.sector_size / sizeof(Entry);
+    bool found = false;
+    size_t newest_sector = 0;
+    uint32_t newest_head = 0;
+    Entry e;
+
+    for (size_t s = 0; s < sectors; s++)
+    {
+        for (size_t i = 0; i < per_sector; i++)
+        {
+            SlotState st = read_slot(s * s_flash.sector_size + i * sizeof(Entry), &e);
+            if (st == SLOT_BLANK)
+                break;
+            if (st == SLOT_VALID)
+            {
+                if (!found || newer(e.seq, newest_head))
+                {
+                    found = true;
+                    newest_sector = s;
+                    newest_head = e.seq;
+                }
+                break;
+            }
+        }
+    }
+    if (!found)
+    {
+        s_next = 0;
+        s_next_seq = 1;
+        return;
+    }
+
+    // Entries are written in order, so the last programmed slot ends the sector
+    size_t base = newest_sector * s_flash.sector_size;
+    size_t used = 0;
+    for (size_t i = 0; i < per_sector; i++)
+    {
+        SlotState st = read_slot(base + i * sizeof(Entry), &e);
+        if (st == SLOT_BLANK)
+            break;
+        used = i + 1;
+        if (st == SLOT_TORN)
+        {
+            s_stats.torn_skipped++;
+            continue;
+        }
+        if (!s_have || newer(e.seq, s_last.seq))
+        {
+            s_last = e;
+            s_have = true;
+        }
+    }
+    s_next = (base + used * sizeof(Entry)) % s_flash.size;
+    s_next_seq = s_last.seq + 1;
+
+    // Written by a different device_id: nothing to resume, but keep appending after it
+    if (s_last.device_id != s_device_id)
+        s_have = false;
+}
+
+// ============================================================================
+// PARTITION
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+#define FLASH_SECTOR_SIZE 4096
+
+static bool part_read(void* ctx, size_t offset, void* dst, size_t len)
+{
+    return esp_partition_read((const esp_partition_t*)ctx, offset, dst, len) == ESP_OK;
+}
+
+static bool part_write(void* ctx, size_t offset, const void* src, size_t len)
+{
+    return esp_partition_write((const esp_partition_t*)ctx, offset, src, len) == ESP_OK;
+}
+
+static bool part_erase_sector(void* ctx, size_t offset)
+{
+    return esp_partition_erase_range((const esp_partition_t*)ctx, offset, FLASH_SECTOR_SIZE) == ESP_OK;
+}
+
+static bool partition_flash(MatchStoreFlash* out)
+{
+    const esp_partition_t* part = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)MATCH_STORE_SUBTYPE, MATCH_STORE_PARTITION);
+    if (!part)
+        return false;
+    out->ctx = (void*)part;
+    out->size = part->size - part->size % FLASH_SECTOR_SIZE;
+    out->sector_size = FLASH_SECTOR_SIZE;
+    out->read = part_read;
+    out->write = part_write;
+    out->erase_sector = part_erase_sector;
+    return true;
+}
+#else
+static bool partition_flash(MatchStoreFlash* out)
+{
+    (void)out;
+    return false;
+}
+#endif
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool match_store_init(const MatchStoreFlash* flash, uint8_t device_id)
+{
+    if (!s_mutex)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return false;
+        }
+    }
+
+    LOCK();
+    s_ready = false;
+    s_have = false;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_device_id = device_id;
+    bool ok = flash ? (s_flash = *flash, true) : partition_flash(&s_flash);
+    if (!ok)
+    {
+        UNLOCK();
+        ESP_LOGW(TAG, "No '%s' partition, matches will not survive a power loss", MATCH_STORE_PARTITION);
+        return false;
+    }
+    if (s_flash.sector_size < sizeof(Entry) || s_flash.sector_size % sizeof(Entry) != 0 ||
+        s_flash.size < 2 * s_flash.sector_size || s_flash.size % s_flash.sector_size != 0)
+    {
+        UNLOCK();
+        ESP_LOGE(TAG, "Unusable flash geometry (%u bytes, %u byte sectors)", (unsigned)s_flash.size,
+                 (unsigned)s_flash.sector_size);
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    scan();
+    s_stats.scan_us = (uint32_t)(esp_timer_get_time() - start);
+    s_ready = true;
+    UNLOCK();
+
+    if (s_have)
+        ESP_LOGI(TAG, "Checkpoint %lu found (log seq %lu) in %lu us", (unsigned long)s_last.seq,
+                 (unsigned long)s_last.log_seq, (unsigned long)s_stats.scan_us);
+    return true;
+}
+
+bool match_store_load(MatchLogTotals* out, uint32_t* log_seq)
+{
+    if (!s_mutex)
+        return false;
+    LOCK();
+    bool have = s_ready && s_have;
+    if (have)
+    {
+        *out = s_last.totals;
+        if (log_seq)
+            *log_seq = s_last.log_seq;
+    }
+    UNLOCK();
+    return have;
+}
+
+bool match_store_flush(void)
+{
+    if (!s_mutex)
+        return true;
+
+    // Replay outside the store lock: the match log has its own
+    MatchLogTotals totals;
+    uint32_t log_seq = match_log_replay(&totals);
+
+    LOCK();
+    if (!s_ready || (s_have && s_last.log_seq == log_seq) || (!s_have && log_seq == 0))
+    {
+        UNLOCK();
+        return true;
+    }
+
+    Entry e;
+    memset(&e, 0, sizeof(e));
+    e.magic = ENTRY_MAGIC;
+    e.version = ENTRY_VERSION;
+    e.device_id = s_device_id;
+    e.seq = s_next_seq;
+    e.log_seq = log_seq;
+    e.totals = totals;
+    e.crc = crc32((const uint8_t*)&e, offsetof(Entry, crc));
+
+    bool ok = true;
+    if (s_next % s_flash.sector_size == 0)
+    {
+        ok = s_flash.erase_sector(s_flash.ctx, s_next);
+        if (ok)
+            s_stats.sectors_erased++;
+    }
+    if (ok)
+        ok = s_flash.write(s_flash.ctx, s_next, &e, sizeof(e));
+
+    // A failed write may have programmed part of the slot; never reuse it
+    if (ok || s_next % s_flash.sector_size != 0)
+    {
+        s_next = (s_next + sizeof(e)) % s_flash.size;
+        s_next_seq++;
+    }
+    if (ok)
+    {
+        s_last = e;
+        s_have = true;
+        s_stats.entries_written++;
+    }
+    else
+    {
+        s_stats.write_errors++;
+    }
+    UNLOCK();
+
+    if (!ok)
+        ESP_LOGE(TAG, "Checkpoint %lu not written", (unsigned long)e.seq);
+    return ok;
+}
+
+void match_store_get_stats(MatchStoreStats* out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!s_mutex)
+        return;
+    LOCK();
+    *out = s_stats;
+    UNLOCK();
+}
+
+// ============================================================================
+// FLUSHER
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+static TaskHandle_t s_flusher = NULL;
+
+static void flusher_task(void* arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MATCH_STORE_FLUSH_MS));
+        match_store_flush();
+        vTaskDelay(pdMS_TO_TICKS(MATCH_STORE_MIN_GAP_MS));
+    }
+}
+
+bool match_store_start_flusher(void)
+{
+    if (s_flusher)
+        return true;
+    if (!s_ready)
+        return false;
+    // Below the game tasks: flash writes wait for idle time, never the other way round
+    if (xTaskCreate(flusher_task, "match_store", 3072, NULL, 1, &s_flusher) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create flusher task");
+        return false;
+    }
+    return true;
+}
+
+void match_store_request_flush(void)
+{
+    if (s_flusher)
+        xTaskNotifyGive(s_flusher);
+}
+#else
+bool match_store_start_flusher(void)
+{
+    return false;
+}
+
+void match_store_request_flush(void)
+{
+}
+#endif
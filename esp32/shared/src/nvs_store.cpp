@@ -2,105 +2,517 @@
 #include <esp_log.h>
 #include <nvs.h>
 #include <nvs_flash.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/task.h"
+#endif
+
+// Cached NVS store (see nvs_store.h)
 
 static const char* TAG = "NVSStore";
 
-bool nvs_store_read_str(const char* ns, const char* key, char* out, size_t max_len)
+typedef enum
 {
-    if (!ns || !key || !out)
-        return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READONLY, &handle) != ESP_OK)
-        return false;
-    size_t required = max_len;
-    esp_err_t err = nvs_get_str(handle, key, out, &required);
-    nvs_close(handle);
-    if (err == ESP_OK)
+    VAL_U8,
+    VAL_U32,
+    VAL_STR,
+} ValueType;
+
+typedef struct
+{
+    char name[NVS_KEY_NAME_MAX_SIZE];
+    nvs_handle_t handle; // open for the lifetime of the firmware
+    bool open;
+} Namespace;
+
+typedef struct
+{
+    bool used;
+    bool present; // false: cached "not found"
+    bool dirty;
+    uint8_t ns;
+    ValueType type;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint32_t num;
+    char* str; // VAL_STR, malloc'd
+} Entry;
+
+static Namespace s_ns[NVS_STORE_MAX_NAMESPACES];
+static Entry s_entries[NVS_STORE_MAX_KEYS];
+static uint8_t s_evict_next = 0;
+static int s_txn_depth = 0;
+static NvsStoreStats s_stats;
+static SemaphoreHandle_t s_mutex = NULL;
+static SemaphoreHandle_t s_flush_mutex = NULL; // one flush at a time; s_mutex is not held across flash writes
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+// First use is game_state_init() reading the ids, before any other task runs
+static bool ensure_mutex(void)
+{
+    if (s_mutex)
         return true;
-    return false;
+    s_mutex = xSemaphoreCreateMutex();
+    s_flush_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex || !s_flush_mutex)
+    {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return false;
+    }
+    return true;
 }
 
-bool nvs_store_write_str(const char* ns, const char* key, const char* value)
+static int ns_index(const char* ns)
 {
-    if (!ns || !key || !value)
-        return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READWRITE, &handle) != ESP_OK)
+    int free_slot = -1;
+    for (int i = 0; i < NVS_STORE_MAX_NAMESPACES; i++)
+    {
+        if (s_ns[i].open && strncmp(s_ns[i].name, ns, sizeof(s_ns[i].name)) == 0)
+            return i;
+        if (!s_ns[i].open && free_slot < 0)
+            free_slot = i;
+    }
+    if (free_slot < 0)
+    {
+        ESP_LOGE(TAG, "No room for namespace %s", ns);
+        return -1;
+    }
+    // Fails until nvs_flash_init() has run; nothing is cached then
+    if (nvs_open(ns, NVS_READWRITE, &s_ns[free_slot].handle) != ESP_OK)
+        return -1;
+    strncpy(s_ns[free_slot].name, ns, sizeof(s_ns[free_slot].name) - 1);
+    s_ns[free_slot].name[sizeof(s_ns[free_slot].name) - 1] = '\0';
+    s_ns[free_slot].open = true;
+    return free_slot;
+}
+
+static void drop(Entry* e)
+{
+    free(e->str);
+    memset(e, 0, sizeof(*e));
+}
+
+static Entry* find(int ns, const char* key)
+{
+    for (int i = 0; i < NVS_STORE_MAX_KEYS; i++)
+    {
+        Entry* e = &s_entries[i];
+        if (e->used && e->ns == ns && strncmp(e->key, key, sizeof(e->key)) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+// A free slot, or a clean one taken from another key
+static Entry* alloc_entry(void)
+{
+    for (int i = 0; i < NVS_STORE_MAX_KEYS; i++)
+    {
+        if (!s_entries[i].used)
+            return &s_entries[i];
+    }
+    for (int n = 0; n < NVS_STORE_MAX_KEYS; n++)
+    {
+        Entry* e = &s_entries[s_evict_next];
+        s_evict_next = (s_evict_next + 1) % NVS_STORE_MAX_KEYS;
+        if (!e->dirty)
+        {
+            drop(e);
+            return e;
+        }
+    }
+    ESP_LOGE(TAG, "All %d cached keys are dirty", NVS_STORE_MAX_KEYS);
+    return NULL;
+}
+
+static esp_err_t read_value(nvs_handle_t h, Entry* e)
+{
+    esp_err_t err = ESP_OK;
+    switch (e->type)
+    {
+        case VAL_U8:
+        {
+            uint8_t v = 0;
+            err = nvs_get_u8(h, e->key, &v);
+            e->num = v;
+            break;
+        }
+        case VAL_U32:
+            err = nvs_get_u32(h, e->key, &e->num);
+            break;
+        case VAL_STR:
+        {
+            size_t len = 0;
+            err = nvs_get_str(h, e->key, NULL, &len);
+            if (err != ESP_OK)
+                break;
+            e->str = (char*)malloc(len);
+            if (!e->str)
+                return ESP_ERR_NO_MEM;
+            err = nvs_get_str(h, e->key, e->str, &len);
+            break;
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief The cached entry for ns:key, read from flash on first use (call with s_mutex held)
+ * @return NULL if NVS is not available or the value could not be read
+ */
+static Entry* fetch(const char* ns, const char* key, ValueType type)
+{
+    int idx = ns_index(ns);
+    if (idx < 0)
+        return NULL;
+    Entry* e = find(idx, key);
+    if (e && e->type == type)
+    {
+        s_stats.reads_cached++;
+        return e;
+    }
+    if (e)
+    {
+        if (e->dirty)
+        {
+            ESP_LOGE(TAG, "%s:%s is pending as another type", ns, key);
+            return NULL;
+        }
+        drop(e);
+    }
+    else
+    {
+        e = alloc_entry();
+        if (!e)
+            return NULL;
+    }
+
+    e->used = true;
+    e->ns = (uint8_t)idx;
+    e->type = type;
+    strncpy(e->key, key, sizeof(e->key) - 1);
+    s_stats.reads_flash++;
+    esp_err_t err = read_value(s_ns[idx].handle, e);
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        e->present = err == ESP_OK;
+        return e;
+    }
+    ESP_LOGE(TAG, "Failed read %s:%s err=%d", ns, key, err);
+    drop(e);
+    return NULL;
+}
+
+static void request_flush(void);
+
+static bool store(const char* ns, const char* key, ValueType type, uint32_t num, const char* str)
+{
+    if (!ensure_mutex())
         return false;
-    esp_err_t err = nvs_set_str(handle, key, value);
-    if (err == ESP_OK)
-        err = nvs_commit(handle);
-    nvs_close(handle);
-    if (err != ESP_OK)
+    LOCK();
+    Entry* e = fetch(ns, key, type);
+    if (!e)
     {
-        ESP_LOGE(TAG, "Failed write %s:%s err=%d", ns, key, err);
+        UNLOCK();
         return false;
     }
+    s_stats.writes++;
+    bool same = e->present && (type == VAL_STR ? strcmp(e->str, str) == 0 : e->num == num);
+    if (same)
+    {
+        s_stats.writes_unchanged++;
+        UNLOCK();
+        return true;
+    }
+    if (type == VAL_STR)
+    {
+        size_t len = strlen(str) + 1;
+        char* copy = (char*)malloc(len);
+        if (!copy)
+        {
+            UNLOCK();
+            return false;
+        }
+        memcpy(copy, str, len);
+        free(e->str);
+        e->str = copy;
+    }
+    else
+    {
+        e->num = num;
+    }
+    e->present = true;
+    e->dirty = true;
+    bool schedule = s_txn_depth == 0;
+    UNLOCK();
+
+    if (schedule)
+        request_flush();
     return true;
 }
 
-bool nvs_store_erase_namespace(const char* ns)
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool nvs_store_read_str(const char* ns, const char* key, char* out, size_t max_len)
 {
-    if (!ns)
+    if (!ns || !key || !out || !ensure_mutex())
         return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READWRITE, &handle) != ESP_OK)
+    LOCK();
+    Entry* e = fetch(ns, key, VAL_STR);
+    // Too small a buffer fails, as nvs_get_str does
+    bool ok = e && e->present && strlen(e->str) < max_len;
+    if (ok)
+        strcpy(out, e->str);
+    UNLOCK();
+    return ok;
+}
+
+bool nvs_store_write_str(const char* ns, const char* key, const char* value)
+{
+    if (!ns || !key || !value)
         return false;
-    esp_err_t err = nvs_erase_all(handle);
-    if (err == ESP_OK)
-        err = nvs_commit(handle);
-    nvs_close(handle);
-    return err == ESP_OK;
+    return store(ns, key, VAL_STR, 0, value);
 }
 
 bool nvs_store_read_u8(const char* ns, const char* key, uint8_t* out)
 {
-    if (!ns || !key || !out)
+    if (!ns || !key || !out || !ensure_mutex())
         return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READONLY, &handle) != ESP_OK)
-        return false;
-    esp_err_t err = nvs_get_u8(handle, key, out);
-    nvs_close(handle);
-    return err == ESP_OK;
+    LOCK();
+    Entry* e = fetch(ns, key, VAL_U8);
+    bool ok = e && e->present;
+    if (ok)
+        *out = (uint8_t)e->num;
+    UNLOCK();
+    return ok;
 }
 
 bool nvs_store_write_u8(const char* ns, const char* key, uint8_t value)
 {
     if (!ns || !key)
         return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READWRITE, &handle) != ESP_OK)
-        return false;
-    esp_err_t err = nvs_set_u8(handle, key, value);
-    if (err == ESP_OK)
-        err = nvs_commit(handle);
-    nvs_close(handle);
-    return err == ESP_OK;
+    return store(ns, key, VAL_U8, value, NULL);
 }
 
 bool nvs_store_read_u32(const char* ns, const char* key, uint32_t* out)
 {
-    if (!ns || !key || !out)
-        return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READONLY, &handle) != ESP_OK)
+    if (!ns || !key || !out || !ensure_mutex())
         return false;
-    esp_err_t err = nvs_get_u32(handle, key, out);
-    nvs_close(handle);
-    return err == ESP_OK;
+    LOCK();
+    Entry* e = fetch(ns, key, VAL_U32);
+    bool ok = e && e->present;
+    if (ok)
+        *out = e->num;
+    UNLOCK();
+    return ok;
 }
 
 bool nvs_store_write_u32(const char* ns, const char* key, uint32_t value)
 {
     if (!ns || !key)
         return false;
-    nvs_handle_t handle;
-    if (nvs_open(ns, NVS_READWRITE, &handle) != ESP_OK)
+    return store(ns, key, VAL_U32, value, NULL);
+}
+
+// Synchronous: factory reset restarts right after
+bool nvs_store_erase_namespace(const char* ns)
+{
+    if (!ns || !ensure_mutex())
         return false;
-    esp_err_t err = nvs_set_u32(handle, key, value);
+    LOCK();
+    int idx = ns_index(ns);
+    if (idx < 0)
+    {
+        UNLOCK();
+        return false;
+    }
+    for (int i = 0; i < NVS_STORE_MAX_KEYS; i++)
+    {
+        if (s_entries[i].used && s_entries[i].ns == idx)
+            drop(&s_entries[i]);
+    }
+    esp_err_t err = nvs_erase_all(s_ns[idx].handle);
     if (err == ESP_OK)
-        err = nvs_commit(handle);
-    nvs_close(handle);
+        err = nvs_commit(s_ns[idx].handle);
+    UNLOCK();
     return err == ESP_OK;
 }
+
+void nvs_store_begin(void)
+{
+    if (!ensure_mutex())
+        return;
+    LOCK();
+    s_txn_depth++;
+    UNLOCK();
+}
+
+void nvs_store_end(void)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    bool schedule = s_txn_depth > 0 && --s_txn_depth == 0;
+    UNLOCK();
+    if (schedule)
+        request_flush();
+}
+
+static esp_err_t write_value(nvs_handle_t h, const Entry* e, const char* str)
+{
+    switch (e->type)
+    {
+        case VAL_U8:
+            return nvs_set_u8(h, e->key, (uint8_t)e->num);
+        case VAL_U32:
+            return nvs_set_u32(h, e->key, e->num);
+        case VAL_STR:
+            return nvs_set_str(h, e->key, str);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+bool nvs_store_flush(void)
+{
+    if (!s_mutex)
+        return true;
+    xSemaphoreTake(s_flush_mutex, portMAX_DELAY);
+
+    bool ok = true;
+    bool touched[NVS_STORE_MAX_NAMESPACES] = {};
+    for (int i = 0; i < NVS_STORE_MAX_KEYS; i++)
+    {
+        LOCK();
+        Entry* e = &s_entries[i];
+        if (!e->used || !e->dirty)
+        {
+            UNLOCK();
+            continue;
+        }
+        // Copy out and write without the lock, so readers never wait on flash
+        Entry snap = *e;
+        char* str = NULL;
+        if (e->type == VAL_STR)
+        {
+            size_t len = strlen(e->str) + 1;
+            str = (char*)malloc(len);
+            if (str)
+                memcpy(str, e->str, len);
+        }
+        nvs_handle_t h = s_ns[e->ns].handle;
+        e->dirty = false; // a write that lands meanwhile marks it again
+        UNLOCK();
+
+        esp_err_t err = (snap.type == VAL_STR && !str) ? ESP_ERR_NO_MEM : write_value(h, &snap, str);
+        free(str);
+
+        LOCK();
+        if (err == ESP_OK)
+        {
+            touched[snap.ns] = true;
+            s_stats.keys_flushed++;
+        }
+        else
+        {
+            // Still the same key (only clean entries get reused): try again next flush
+            if (e->used && e->ns == snap.ns && strncmp(e->key, snap.key, sizeof(e->key)) == 0)
+                e->dirty = true;
+            s_stats.flush_errors++;
+            ok = false;
+        }
+        UNLOCK();
+        if (err != ESP_OK)
+            ESP_LOGE(TAG, "Failed write %s:%s err=%d", s_ns[snap.ns].name, snap.key, err);
+    }
+
+    for (int i = 0; i < NVS_STORE_MAX_NAMESPACES; i++)
+    {
+        if (!touched[i])
+            continue;
+        esp_err_t err = nvs_commit(s_ns[i].handle);
+        LOCK();
+        s_stats.commits++;
+        if (err != ESP_OK)
+            s_stats.flush_errors++;
+        UNLOCK();
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed commit %s err=%d", s_ns[i].name, err);
+            ok = false;
+        }
+    }
+
+    LOCK();
+    s_stats.flushes++;
+    UNLOCK();
+    xSemaphoreGive(s_flush_mutex);
+    return ok;
+}
+
+void nvs_store_get_stats(NvsStoreStats* out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!s_mutex)
+        return;
+    LOCK();
+    *out = s_stats;
+    UNLOCK();
+}
+
+// ============================================================================
+// WRITE-BEHIND FLUSHER
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+static TaskHandle_t s_flusher = NULL;
+
+static void flusher_task(void* arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Let a burst finish: wait for a quiet NVS_STORE_FLUSH_DELAY_MS, up to the max delay
+        int64_t first_us = esp_timer_get_time();
+        while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(NVS_STORE_FLUSH_DELAY_MS)) > 0 &&
+               esp_timer_get_time() - first_us < NVS_STORE_FLUSH_MAX_DELAY_MS * 1000LL)
+        {
+        }
+        LOCK();
+        bool in_txn = s_txn_depth > 0;
+        UNLOCK();
+        // An open transaction flushes when it ends
+        if (!in_txn)
+            nvs_store_flush();
+    }
+}
+
+static void request_flush(void)
+{
+    LOCK();
+    if (!s_flusher && xTaskCreate(flusher_task, "nvs_flush", 3072, NULL, 1, &s_flusher) != pdPASS)
+    {
+        s_flusher = NULL;
+        ESP_LOGE(TAG, "Failed to create flusher task, writing through");
+    }
+    TaskHandle_t flusher = s_flusher;
+    UNLOCK();
+    if (flusher)
+        xTaskNotifyGive(flusher);
+    else
+        nvs_store_flush();
+}
+#else
+// Host builds have no flusher; tools call nvs_store_flush()
+static void request_flush(void)
+{
+}
+#endif
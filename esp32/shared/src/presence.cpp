@@ -0,0 +1,140 @@
+#include "presence.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "protocol_config.h"
+
+static const char* TAG = "Presence";
+
+#define TABLE_SIZE (MAX_DEVICE_ID + 1)
+
+static SemaphoreHandle_t s_mutex = NULL;
+static PresenceEntry s_table[TABLE_SIZE] = {};
+static bool s_seen[TABLE_SIZE] = {};
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Caller holds s_mutex
+static bool alive(uint8_t device_id, uint32_t now)
+{
+    const PresenceEntry* e = &s_table[device_id];
+    return s_seen[device_id] && now - e->last_seen_ms < (uint32_t)e->interval_ms * PRESENCE_MISSED_BEACONS;
+}
+
+void presence_init(void)
+{
+    if (s_mutex)
+        return;
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+        ESP_LOGE(TAG, "Failed to create mutex");
+}
+
+void presence_update(const PresenceEntry* entry)
+{
+    if (!s_mutex || entry->device_id >= TABLE_SIZE)
+        return;
+
+    LOCK();
+    bool joined = !alive(entry->device_id, entry->last_seen_ms);
+    s_table[entry->device_id] = *entry;
+    // A sender that reports no period would expire at once
+    if (s_table[entry->device_id].interval_ms == 0)
+        s_table[entry->device_id].interval_ms = PRESENCE_INTERVAL_MS;
+    s_seen[entry->device_id] = true;
+    UNLOCK();
+
+    if (joined)
+        ESP_LOGI(TAG, "Device %u on the field (player %u, team %u)", entry->device_id, entry->player_id,
+                 entry->team_id);
+}
+
+bool presence_device_alive(uint8_t device_id)
+{
+    if (!s_mutex || device_id >= TABLE_SIZE)
+        return false;
+    LOCK();
+    bool ok = alive(device_id, now_ms());
+    UNLOCK();
+    return ok;
+}
+
+bool presence_player_alive(uint8_t player_id)
+{
+    if (!s_mutex)
+        return false;
+    uint32_t now = now_ms();
+    bool found = false;
+    LOCK();
+    for (int i = 0; i < TABLE_SIZE && !found; i++)
+        found = alive(i, now) && s_table[i].player_id == player_id;
+    UNLOCK();
+    return found;
+}
+
+int presence_list(PresenceEntry* out, int max)
+{
+    if (!s_mutex)
+        return 0;
+    uint32_t now = now_ms();
+    int n = 0;
+    LOCK();
+    for (int i = 0; i < TABLE_SIZE && n < max; i++)
+    {
+        if (alive(i, now))
+            out[n++] = s_table[i];
+    }
+    UNLOCK();
+    return n;
+}
+
+uint32_t presence_players(uint8_t* teams)
+{
+    if (!s_mutex)
+        return 0;
+    uint32_t now = now_ms();
+    uint32_t players = 0;
+    LOCK();
+    for (int i = 0; i < TABLE_SIZE; i++)
+    {
+        const PresenceEntry* e = &s_table[i];
+        if (!alive(i, now) || e->player_id > MAX_PLAYER_ID)
+            continue;
+        players |= 1u << e->player_id;
+        if (teams)
+            teams[e->player_id] = e->team_id;
+    }
+    UNLOCK();
+    return players;
+}
+
+int presence_count(void)
+{
+    if (!s_mutex)
+        return 0;
+    uint32_t now = now_ms();
+    int n = 0;
+    LOCK();
+    for (int i = 0; i < TABLE_SIZE; i++)
+        n += alive(i, now) ? 1 : 0;
+    UNLOCK();
+    return n;
+}
+
+uint16_t presence_interval_ms(void)
+{
+    uint32_t interval = (uint32_t)(presence_count() + 1) * PRESENCE_SLOT_MS;
+    if (interval < PRESENCE_INTERVAL_MS)
+        interval = PRESENCE_INTERVAL_MS;
+    if (interval > PRESENCE_MAX_INTERVAL_MS)
+        interval = PRESENCE_MAX_INTERVAL_MS;
+    return (uint16_t)interval;
+}
@@ -0,0 +1,286 @@
+#include "roster.h"
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "presence.h"
+
+// Player table and admissible-shooter mask (see roster.h)
+
+static const char* TAG = "Roster";
+
+static_assert(ROSTER_SLOTS == 32, "the admissible mask holds one bit per player_id");
+#define ALL_PLAYERS 0xFFFFFFFFu
+
+typedef struct
+{
+    RosterSlot slots[ROSTER_SLOTS];
+    uint32_t members; // bit per slot in_roster
+} Table;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static Table s_table; // the writer's copy, under s_mutex
+
+// Roster being built between roster_begin() and roster_commit()
+static char s_next_names[ROSTER_SLOTS][PLAYER_NAME_LEN];
+static uint32_t s_next_members = 0;
+
+// Rules, under s_mutex
+static uint8_t s_self_player = ROSTER_SLOTS; // none yet
+static uint8_t s_self_team = ROSTER_NO_TEAM;
+static bool s_teammates_blocked = false; // team play with friendly fire off
+static bool s_server_connected = false;
+
+static uint32_t s_admissible = ALL_PLAYERS;
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+
+// ============================================================================
+// SNAPSHOTS
+// ============================================================================
+// Same seqlock as the game state snapshot: the copy is rewritten with the
+// sequence odd, in a critical section, and a reader that saw the sequence
+// change copies again. Publishes only happen when a slot changed.
+
+static Table s_published;
+static uint32_t s_publish_seq = 0;
+static portMUX_TYPE s_publish_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Caller holds s_mutex
+static uint32_t compute_admissible(void)
+{
+    uint32_t alive = 0;
+    uint32_t teammates = 0;
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+    {
+        const RosterSlot* slot = &s_table.slots[i];
+        if (slot->alive)
+            alive |= 1u << i;
+        if (s_self_team != ROSTER_NO_TEAM && slot->team_id == s_self_team)
+            teammates |= 1u << i;
+    }
+
+    uint32_t shooters = ALL_PLAYERS;
+    if (s_server_connected && s_table.members)
+        shooters = s_table.members;
+    else if (alive)
+        shooters = alive;
+    if (s_teammates_blocked)
+        shooters &= ~teammates;
+    if (s_self_player < ROSTER_SLOTS)
+        shooters &= ~(1u << s_self_player);
+    return shooters;
+}
+
+// Caller holds s_mutex
+static void update_admissible(void)
+{
+    __atomic_store_n(&s_admissible, compute_admissible(), __ATOMIC_RELEASE);
+}
+
+// Caller holds s_mutex, so there is one writer at a time
+static void publish(void)
+{
+    s_table.members = 0;
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+    {
+        if (s_table.slots[i].in_roster)
+            s_table.members |= 1u << i;
+    }
+
+    taskENTER_CRITICAL(&s_publish_mux);
+    uint32_t seq = __atomic_load_n(&s_publish_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_publish_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&s_published, &s_table, sizeof(s_published));
+    __atomic_store_n(&s_publish_seq, seq + 2, __ATOMIC_RELEASE);
+    taskEXIT_CRITICAL(&s_publish_mux);
+
+    update_admissible();
+}
+
+static void read_slot(uint8_t player_id, RosterSlot* out)
+{
+    uint32_t before, after;
+    do
+    {
+        before = __atomic_load_n(&s_publish_seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &s_published.slots[player_id], sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&s_publish_seq, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+}
+
+static uint32_t read_members(void)
+{
+    uint32_t before, after, members;
+    do
+    {
+        before = __atomic_load_n(&s_publish_seq, __ATOMIC_ACQUIRE);
+        members = s_published.members;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&s_publish_seq, __ATOMIC_RELAXED);
+    } while ((before & 1) || before != after);
+    return members;
+}
+
+// Caller holds s_mutex. Returns true if the slot changed, and bumps its generation then
+static bool update_slot(int player_id, const char* name, bool in_roster, uint8_t team_id, bool alive)
+{
+    RosterSlot* slot = &s_table.slots[player_id];
+    bool renamed = strncmp(slot->name, name, PLAYER_NAME_LEN - 1) != 0;
+    if (!renamed && slot->in_roster == in_roster && slot->alive == alive && slot->team_id == team_id)
+        return false;
+    if (renamed)
+    {
+        strncpy(slot->name, name, PLAYER_NAME_LEN - 1);
+        slot->name[PLAYER_NAME_LEN - 1] = '\0';
+    }
+    slot->in_roster = in_roster;
+    slot->alive = alive;
+    slot->team_id = team_id;
+    slot->generation++;
+    return true;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void roster_init(void)
+{
+    if (s_mutex)
+        return;
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex)
+    {
+        ESP_LOGE(TAG, "Failed to create mutex");
+        return;
+    }
+    LOCK();
+    memset(&s_table, 0, sizeof(s_table));
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+        s_table.slots[i].team_id = ROSTER_NO_TEAM;
+    publish();
+    UNLOCK();
+}
+
+void roster_begin(void)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    memset(s_next_names, 0, sizeof(s_next_names));
+    s_next_members = 0;
+}
+
+bool roster_add(uint8_t player_id, const char* name)
+{
+    if (!s_mutex || player_id >= ROSTER_SLOTS)
+        return false;
+    strncpy(s_next_names[player_id], name ? name : "", PLAYER_NAME_LEN - 1);
+    s_next_names[player_id][PLAYER_NAME_LEN - 1] = '\0';
+    s_next_members |= 1u << player_id;
+    return true;
+}
+
+void roster_commit(void)
+{
+    if (!s_mutex)
+        return;
+    int changed = 0;
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+    {
+        const RosterSlot* slot = &s_table.slots[i];
+        bool member = (s_next_members >> i) & 1u;
+        changed += update_slot(i, s_next_names[i], member, slot->team_id, slot->alive) ? 1 : 0;
+    }
+    if (changed)
+        publish();
+    int count = __builtin_popcount(s_next_members);
+    UNLOCK();
+    ESP_LOGI(TAG, "Roster of %d players loaded (%d slots changed)", count, changed);
+}
+
+void roster_set_self(uint8_t player_id, uint8_t team_id, bool team_play, bool friendly_fire)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    s_self_player = player_id < ROSTER_SLOTS ? player_id : ROSTER_SLOTS;
+    s_self_team = team_id;
+    s_teammates_blocked = team_play && !friendly_fire;
+    update_admissible();
+    UNLOCK();
+}
+
+void roster_set_server_connected(bool connected)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    s_server_connected = connected;
+    update_admissible();
+    UNLOCK();
+}
+
+void roster_refresh_field(void)
+{
+    if (!s_mutex)
+        return;
+    uint8_t teams[ROSTER_SLOTS];
+    LOCK();
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+        teams[i] = s_table.slots[i].team_id;
+    // Presence takes its own lock inside ours, never the other way round
+    uint32_t alive = presence_players(teams);
+    bool changed = false;
+    for (int i = 0; i < ROSTER_SLOTS; i++)
+    {
+        const RosterSlot* slot = &s_table.slots[i];
+        changed |= update_slot(i, slot->name, slot->in_roster, teams[i], (alive >> i) & 1u);
+    }
+    if (changed)
+        publish();
+    UNLOCK();
+}
+
+bool roster_get(uint8_t player_id, RosterSlot* out)
+{
+    if (player_id >= ROSTER_SLOTS)
+        return false;
+    read_slot(player_id, out);
+    return true;
+}
+
+bool roster_name(uint8_t player_id, char* out, size_t len)
+{
+    if (player_id >= ROSTER_SLOTS)
+        return false;
+    RosterSlot slot;
+    read_slot(player_id, &slot);
+    if (!slot.in_roster)
+        return false;
+    if (out && len > 0)
+    {
+        strncpy(out, slot.name, len - 1);
+        out[len - 1] = '\0';
+    }
+    return true;
+}
+
+int roster_count(void)
+{
+    return __builtin_popcount(read_members());
+}
+
+uint32_t roster_admissible(void)
+{
+    return __atomic_load_n(&s_admissible, __ATOMIC_ACQUIRE);
+}
+
+bool roster_admits(uint8_t player_id)
+{
+    return player_id < ROSTER_SLOTS && ((roster_admissible() >> player_id) & 1u);
+}
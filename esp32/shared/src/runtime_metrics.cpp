@@ -2,6 +2,9 @@
 #include <esp_system.h>
 #include <esp_timer.h>
 #include "game_state.h"
+#include "lock_profile.h"
+#include "presence.h"
+#include "ws_server.h"
 
 
 uint32_t system_uptime_ms(void)
@@ -45,6 +48,41 @@ uint32_t metric_tx_count(void)
     return game_state_tx_count();
 }
 
+uint32_t metric_ws_rtt_ms(void)
+{
+    WsClientStats stats[8];
+    int n = ws_server_get_client_stats(stats, 8);
+    uint32_t sum_us = 0;
+    int measured = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (stats[i].pongs == 0)
+            continue;
+        sum_us += stats[i].rtt_avg_us;
+        measured++;
+    }
+    return measured ? sum_us / measured / 1000 : 0;
+}
+
+int metric_players_on_field(void)
+{
+    return presence_count();
+}
+
+uint32_t metric_lock_wait_max_us(void)
+{
+    uint32_t wait_max = 0;
+    lock_profile_totals(&wait_max, NULL);
+    return wait_max;
+}
+
+uint32_t metric_lock_contended(void)
+{
+    uint32_t contended = 0;
+    lock_profile_totals(NULL, &contended);
+    return contended;
+}
+
 // Target-specific metrics (weak implementations)
 int __attribute__((weak)) metric_hit_count(void)
 {
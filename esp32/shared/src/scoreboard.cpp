@@ -0,0 +1,278 @@
+#include "scoreboard.h"
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "protocol_config.h"
+
+// Grow-only scoreboard (see scoreboard.h). No I/O here: espnow_comm gossips
+// the replicas, so the host tools can run it as is.
+
+static const char* TAG = "Scoreboard";
+
+static_assert(SCOREBOARD_MAX_DEVICES == MAX_DEVICE_ID + 1, "One replica per device_id");
+
+static SemaphoreHandle_t s_mutex = NULL;
+static uint8_t s_device_id = 0;
+static uint16_t s_epoch = 0;
+static ScoreReplica s_replicas[SCOREBOARD_MAX_DEVICES] = {};
+static uint64_t s_known = 0; // replicas on the board
+static uint64_t s_dirty = 0; // changed since last taken for gossip
+static uint8_t s_clean_next = 0;
+
+#define LOCK() xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK() xSemaphoreGive(s_mutex)
+#define BIT(id) (1ULL << (id))
+
+// Caller holds s_mutex
+static void clear_board(void)
+{
+    ScoreReplica self = s_replicas[s_device_id];
+    memset(s_replicas, 0, sizeof(s_replicas));
+    s_replicas[s_device_id] = {self.device_id, self.player_id, self.team_id, 0, 0, 0};
+    s_known = BIT(s_device_id);
+    s_dirty = BIT(s_device_id);
+}
+
+static uint16_t max16(uint16_t a, uint16_t b)
+{
+    return a > b ? a : b;
+}
+
+void scoreboard_init(uint8_t device_id, uint8_t player_id, uint8_t team_id)
+{
+    if (device_id >= SCOREBOARD_MAX_DEVICES)
+    {
+        ESP_LOGE(TAG, "device_id %u out of range", device_id);
+        return;
+    }
+    if (!s_mutex)
+    {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex)
+        {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return;
+        }
+    }
+
+    LOCK();
+    if (device_id != s_device_id)
+    {
+        // Counts under the old device_id stay with it on the other boards
+        s_known &= ~BIT(s_device_id);
+        s_device_id = device_id;
+    }
+    ScoreReplica* self = &s_replicas[device_id];
+    self->device_id = device_id;
+    self->player_id = player_id;
+    self->team_id = team_id;
+    s_known |= BIT(device_id);
+    s_dirty |= BIT(device_id);
+    UNLOCK();
+}
+
+void scoreboard_new_match(void)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    s_epoch++;
+    clear_board();
+    UNLOCK();
+    ESP_LOGI(TAG, "New match, epoch %u", s_epoch);
+}
+
+uint16_t scoreboard_epoch(void)
+{
+    return s_epoch;
+}
+
+void scoreboard_add(ScoreCounter counter)
+{
+    if (!s_mutex)
+        return;
+    LOCK();
+    ScoreReplica* self = &s_replicas[s_device_id];
+    uint16_t* value = counter == SCORE_KILL ? &self->kills : counter == SCORE_DEATH ? &self->deaths : &self->hits;
+    if (*value < UINT16_MAX)
+        (*value)++;
+    s_dirty |= BIT(s_device_id);
+    UNLOCK();
+}
+
+bool scoreboard_merge(uint16_t epoch, const ScoreReplica* replica)
+{
+    if (!s_mutex || replica->device_id >= SCOREBOARD_MAX_DEVICES)
+        return false;
+
+    LOCK();
+    int16_t ahead = (int16_t)(epoch - s_epoch); // epochs wrap
+    if (ahead < 0)
+    {
+        UNLOCK();
+        return false;
+    }
+    if (ahead > 0)
+    {
+        ESP_LOGI(TAG, "Joining match epoch %u (was %u)", epoch, s_epoch);
+        s_epoch = epoch;
+        clear_board();
+    }
+
+    uint8_t id = replica->device_id;
+    ScoreReplica* cur = &s_replicas[id];
+    bool known = (s_known & BIT(id)) != 0;
+    bool grew = !known || replica->kills > cur->kills || replica->deaths > cur->deaths || replica->hits > cur->hits;
+    if (grew)
+    {
+        // Our own counts come back from peers after a reboot; the ids stay ours
+        if (id != s_device_id)
+        {
+            cur->device_id = id;
+            cur->player_id = replica->player_id;
+            cur->team_id = replica->team_id;
+        }
+        cur->kills = max16(cur->kills, replica->kills);
+        cur->deaths = max16(cur->deaths, replica->deaths);
+        cur->hits = max16(cur->hits, replica->hits);
+        s_known |= BIT(id);
+        s_dirty |= BIT(id); // pass it on to peers that cannot hear the source
+    }
+    UNLOCK();
+    return grew;
+}
+
+int scoreboard_take_gossip(ScoreReplica* out, int max, bool include_clean, uint16_t* epoch)
+{
+    if (!s_mutex)
+        return 0;
+
+    int n = 0;
+    LOCK();
+    *epoch = s_epoch;
+    for (int i = 0; i < SCOREBOARD_MAX_DEVICES && n < max; i++)
+    {
+        if (s_dirty & s_known & BIT(i))
+        {
+            out[n++] = s_replicas[i];
+            s_dirty &= ~BIT(i);
+        }
+    }
+    if (include_clean)
+    {
+        uint64_t sent = 0;
+        for (int k = 0; k < n; k++)
+            sent |= BIT(out[k].device_id);
+        uint8_t start = s_clean_next;
+        for (int i = 0; i < SCOREBOARD_MAX_DEVICES && n < max; i++)
+        {
+            uint8_t id = (uint8_t)((start + i) % SCOREBOARD_MAX_DEVICES);
+            if ((s_known & ~sent) & BIT(id))
+            {
+                out[n++] = s_replicas[id];
+                s_clean_next = (uint8_t)((id + 1) % SCOREBOARD_MAX_DEVICES);
+            }
+        }
+    }
+    UNLOCK();
+    return n;
+}
+
+// Caller holds s_mutex. Sums into out, one entry per id, in board order.
+static int sum_replicas(ScoreTotals* out, uint8_t* team_of, int max, bool by_team)
+{
+    int n = 0;
+    for (int i = 0; i < SCOREBOARD_MAX_DEVICES; i++)
+    {
+        if (!(s_known & BIT(i)))
+            continue;
+        const ScoreReplica* r = &s_replicas[i];
+        if (by_team && r->team_id == 0)
+            continue;
+        uint8_t id = by_team ? r->team_id : r->player_id;
+        int k = 0;
+        while (k < n && out[k].id != id)
+            k++;
+        if (k == n)
+        {
+            if (n == max)
+                continue;
+            out[n] = {id, 0, 0, 0};
+            if (team_of)
+                team_of[n] = 0;
+            n++;
+        }
+        out[k].kills += r->kills;
+        out[k].deaths += r->deaths;
+        out[k].hits += r->hits;
+        if (team_of && r->team_id)
+            team_of[k] = r->team_id;
+    }
+    return n;
+}
+
+int scoreboard_totals(ScoreTotals* out, int max, bool by_team)
+{
+    if (!s_mutex)
+        return 0;
+    LOCK();
+    int n = sum_replicas(out, NULL, max, by_team);
+    UNLOCK();
+
+    // Few entries: insertion sort by id
+    for (int i = 1; i < n; i++)
+    {
+        ScoreTotals t = out[i];
+        int k = i;
+        for (; k > 0 && out[k - 1].id > t.id; k--)
+            out[k] = out[k - 1];
+        out[k] = t;
+    }
+    return n;
+}
+
+int scoreboard_sides_standing(uint32_t max_deaths, int* sides)
+{
+    ScoreTotals players[SCOREBOARD_MAX_DEVICES];
+    uint8_t team_of[SCOREBOARD_MAX_DEVICES]; // per players[] entry, 0 = no team
+    int count = 0;
+    if (s_mutex)
+    {
+        LOCK();
+        count = sum_replicas(players, team_of, SCOREBOARD_MAX_DEVICES, false);
+        UNLOCK();
+    }
+
+    // A team stands while any of its players does; players without a team are sides of their own
+    uint8_t teams[SCOREBOARD_MAX_DEVICES];
+    bool team_up[SCOREBOARD_MAX_DEVICES];
+    int team_count = 0, total = 0, standing = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bool up = players[i].deaths < max_deaths;
+        if (team_of[i] == 0)
+        {
+            total++;
+            standing += up ? 1 : 0;
+            continue;
+        }
+        int t = 0;
+        while (t < team_count && teams[t] != team_of[i])
+            t++;
+        if (t == team_count)
+        {
+            teams[team_count] = team_of[i];
+            team_up[team_count++] = false;
+            total++;
+        }
+        if (up && !team_up[t])
+        {
+            team_up[t] = true;
+            standing++;
+        }
+    }
+    if (sides)
+        *sides = total;
+    return standing;
+}
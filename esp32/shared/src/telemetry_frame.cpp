@@ -0,0 +1,56 @@
+#include "telemetry_frame.h"
+#include "ws_codec.h"
+
+// Datagram header for the multicast telemetry stream; no ESP-IDF
+// dependencies so the host receiver (esp32/host) shares it.
+
+namespace
+{
+
+void put_u32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+uint32_t get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+} // namespace
+
+int telemetry_frame_encode(const TelemetryHeader* hdr, uint8_t op, const void* body, uint8_t* out, size_t cap)
+{
+    if (cap < TELEMETRY_HEADER_SIZE)
+        return -1;
+    int n = ws_codec_binary_encode(op, body, out + TELEMETRY_HEADER_SIZE, cap - TELEMETRY_HEADER_SIZE);
+    if (n < 0)
+        return -1;
+
+    out[0] = 'R';
+    out[1] = 'Z';
+    out[2] = TELEMETRY_VERSION;
+    out[3] = hdr->device_id;
+    put_u32(out + 4, hdr->stream_id);
+    put_u32(out + 8, hdr->seq);
+    return TELEMETRY_HEADER_SIZE + n;
+}
+
+bool telemetry_frame_parse(const uint8_t* data, size_t len, TelemetryHeader* hdr, const uint8_t** payload,
+                           size_t* payload_len)
+{
+    if (len < TELEMETRY_HEADER_SIZE + WS_BINARY_HEADER_SIZE)
+        return false;
+    if (data[0] != 'R' || data[1] != 'Z' || data[2] != TELEMETRY_VERSION)
+        return false;
+
+    hdr->device_id = data[3];
+    hdr->stream_id = get_u32(data + 4);
+    hdr->seq = get_u32(data + 8);
+    *payload = data + TELEMETRY_HEADER_SIZE;
+    *payload_len = len - TELEMETRY_HEADER_SIZE;
+    return true;
+}
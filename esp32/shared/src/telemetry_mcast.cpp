@@ -0,0 +1,134 @@
+#include "telemetry_mcast.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <lwip/sockets.h>
+#include <esp_log.h>
+#include <esp_random.h>
+#include <string.h>
+#include "game_state.h"
+#include "telemetry_frame.h"
+
+// UDP multicast publisher for the spectator telemetry stream. The datagram
+// format lives in telemetry_frame.cpp, shared with the host receiver.
+
+static const char* TAG = "Telemetry";
+
+static SemaphoreHandle_t s_mutex = NULL;
+static volatile bool s_enabled = false;
+static int s_sock = -1;
+static struct sockaddr_in s_dest;
+static uint32_t s_seq = 0;
+static TelemetryMcastStats s_stats = {};
+
+static bool open_socket(void)
+{
+    s_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s_sock < 0)
+    {
+        ESP_LOGE(TAG, "socket() failed: errno %d", errno);
+        return false;
+    }
+
+    uint8_t ttl = TELEMETRY_MCAST_TTL;
+    if (setsockopt(s_sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0)
+    {
+        ESP_LOGW(TAG, "IP_MULTICAST_TTL failed: errno %d", errno);
+    }
+
+    memset(&s_dest, 0, sizeof(s_dest));
+    s_dest.sin_family = AF_INET;
+    s_dest.sin_port = htons(TELEMETRY_MCAST_PORT);
+    s_dest.sin_addr.s_addr = inet_addr(TELEMETRY_MCAST_GROUP);
+
+    ESP_LOGI(TAG, "Publishing to %s:%d (stream %08lx)", TELEMETRY_MCAST_GROUP, TELEMETRY_MCAST_PORT,
+             (unsigned long)s_stats.stream_id);
+    return true;
+}
+
+static void close_socket(void)
+{
+    if (s_sock >= 0)
+    {
+        close(s_sock);
+        s_sock = -1;
+    }
+}
+
+void telemetry_mcast_init(void)
+{
+    if (s_mutex)
+        return;
+    s_mutex = xSemaphoreCreateMutex();
+    s_stats.stream_id = esp_random();
+}
+
+void telemetry_mcast_set_enabled(bool enabled)
+{
+    if (!s_mutex || enabled == s_enabled)
+        return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_enabled = enabled;
+    if (!enabled)
+        close_socket();
+    xSemaphoreGive(s_mutex);
+    ESP_LOGI(TAG, "Multicast telemetry %s", enabled ? "enabled" : "disabled");
+}
+
+bool telemetry_mcast_enabled(void)
+{
+    return s_enabled;
+}
+
+bool telemetry_mcast_publish(uint8_t op, const void* body)
+{
+    if (!s_enabled || !s_mutex)
+        return false;
+
+    uint8_t buf[TELEMETRY_MAX_DATAGRAM];
+    bool ok = false;
+
+    // Held across sendto so datagrams leave in seq order
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_enabled && (s_sock >= 0 || open_socket()))
+    {
+        TelemetryHeader hdr = {};
+        hdr.device_id = game_state_get_config()->device_id;
+        hdr.stream_id = s_stats.stream_id;
+        hdr.seq = s_seq;
+
+        int len = telemetry_frame_encode(&hdr, op, body, buf, sizeof(buf));
+        if (len < 0)
+        {
+            s_stats.encode_errors++;
+        }
+        else
+        {
+            // A failed send still uses its seq: receivers see the loss as a gap
+            s_seq++;
+            if (sendto(s_sock, buf, len, MSG_DONTWAIT, (struct sockaddr*)&s_dest, sizeof(s_dest)) == len)
+            {
+                s_stats.sent++;
+                ok = true;
+            }
+            else
+            {
+                s_stats.send_errors++;
+            }
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+void telemetry_mcast_get_stats(TelemetryMcastStats* out)
+{
+    if (!s_mutex)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = s_stats;
+    xSemaphoreGive(s_mutex);
+}
@@ -128,12 +128,16 @@ static esp_err_t config_post_handler(httpd_req_t* req)
         return ESP_OK;
     }
 
+    nvs_store_begin();
     nvs_store_write_str(NVS_NS_WIFI, NVS_KEY_SSID, ssid);
     nvs_store_write_str(NVS_NS_WIFI, NVS_KEY_PASS, pass);
     if (name[0])
         nvs_store_write_str(NVS_NS_WIFI, NVS_KEY_NAME, name);
     if (role[0])
         nvs_store_write_str(NVS_NS_WIFI, NVS_KEY_ROLE, role);
+    nvs_store_end();
+    // The restart below would beat the write-behind flush
+    nvs_store_flush();
 
     char response[256];
     snprintf(response, sizeof(response),
@@ -230,7 +234,11 @@ void wifi_start_http_server(bool provisioning_mode)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
-    config.stack_size = 8192;
+    // WebSocket messages are read into the transport's static pool, not onto this stack
+    config.stack_size = 7168;
+    // A stalled WebSocket client blocks the httpd task for at most this long
+    // per frame; the WS core then evicts it (default is 5 s)
+    config.send_wait_timeout = 2;
     if (provisioning_mode)
         config.uri_match_fn = httpd_uri_match_wildcard;
     esp_err_t ret = httpd_start(&g_httpd, &config);
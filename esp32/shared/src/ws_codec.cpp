@@ -0,0 +1,13 @@
+#include "ws_codec.h"
+
+static const WsCodecOps s_codecs[WS_CODEC_COUNT] = {
+    {"json", false, ws_codec_json_encode_to, ws_codec_json_decode},
+    {"binary", true, ws_codec_binary_encode, ws_codec_binary_decode},
+};
+
+const WsCodecOps* ws_codec_ops(WsCodec codec)
+{
+    if ((int)codec < 0 || codec >= WS_CODEC_COUNT)
+        return NULL;
+    return &s_codecs[codec];
+}
@@ -0,0 +1,276 @@
+#include "ws_codec.h"
+#include <string.h>
+
+// Binary codec for the WebSocket protocol. Walks the field tables from
+// ws_protocol_gen.cpp; no ESP-IDF dependencies so it also builds on the host.
+
+namespace
+{
+
+struct Writer
+{
+    uint8_t* out;
+    size_t cap;
+    size_t pos;
+    bool ok;
+
+    void put(const void* src, size_t n)
+    {
+        if (!ok || pos + n > cap)
+        {
+            ok = false;
+            return;
+        }
+        memcpy(out + pos, src, n);
+        pos += n;
+    }
+    void u8(uint8_t v)
+    {
+        put(&v, 1);
+    }
+    void u16(uint16_t v)
+    {
+        uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+        put(b, 2);
+    }
+    void u32(uint32_t v)
+    {
+        uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+        put(b, 4);
+    }
+    void str(const char* s, size_t cap_with_nul)
+    {
+        size_t n = strnlen(s, cap_with_nul - 1);
+        if (n > 255)
+            n = 255;
+        u8((uint8_t)n);
+        put(s, n);
+    }
+};
+
+struct Reader
+{
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    bool ok;
+
+    bool take(void* dst, size_t n)
+    {
+        if (!ok || pos + n > len)
+        {
+            ok = false;
+            return false;
+        }
+        memcpy(dst, data + pos, n);
+        pos += n;
+        return true;
+    }
+    uint8_t u8()
+    {
+        uint8_t v = 0;
+        take(&v, 1);
+        return v;
+    }
+    uint16_t u16()
+    {
+        uint8_t b[2] = {0, 0};
+        take(b, 2);
+        return (uint16_t)(b[0] | (b[1] << 8));
+    }
+    uint32_t u32()
+    {
+        uint8_t b[4] = {0, 0, 0, 0};
+        take(b, 4);
+        return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    }
+    void str(char* dst, size_t cap_with_nul)
+    {
+        size_t n = u8();
+        if (!ok || pos + n > len)
+        {
+            ok = false;
+            return;
+        }
+        size_t keep = n < cap_with_nul - 1 ? n : cap_with_nul - 1;
+        memcpy(dst, data + pos, keep);
+        dst[keep] = '\0';
+        pos += n;
+    }
+};
+
+bool field_enabled(const WsFieldDesc* f, int index, uint32_t present)
+{
+    return !(f->flags & WS_FIELD_OPTIONAL) || (present & (1UL << index));
+}
+
+void write_field(Writer& w, const WsFieldDesc* f, const uint8_t* base)
+{
+    const uint8_t* p = base + f->offset;
+    switch (f->type)
+    {
+        case WS_FT_BOOL:
+            w.u8(*(const bool*)p ? 1 : 0);
+            break;
+        case WS_FT_U8:
+        case WS_FT_I8:
+            w.u8(*p);
+            break;
+        case WS_FT_U16:
+            w.u16(*(const uint16_t*)p);
+            break;
+        case WS_FT_U32:
+            w.u32(*(const uint32_t*)p);
+            break;
+        case WS_FT_STR:
+            w.str((const char*)p, f->size);
+            break;
+        case WS_FT_PLAYERS:
+        {
+            const WsPlayerList* list = (const WsPlayerList*)p;
+            uint8_t count = list->count > WS_ROSTER_MAX ? WS_ROSTER_MAX : list->count;
+            w.u8(count);
+            for (uint8_t i = 0; i < count; i++)
+            {
+                w.u8(list->items[i].id);
+                w.str(list->items[i].name, sizeof(list->items[i].name));
+            }
+            break;
+        }
+        default:
+            w.ok = false;
+            break;
+    }
+}
+
+void read_field(Reader& r, const WsFieldDesc* f, uint8_t* base)
+{
+    uint8_t* p = base + f->offset;
+    switch (f->type)
+    {
+        case WS_FT_BOOL:
+            *(bool*)p = r.u8() != 0;
+            break;
+        case WS_FT_U8:
+        case WS_FT_I8:
+            *p = r.u8();
+            break;
+        case WS_FT_U16:
+            *(uint16_t*)p = r.u16();
+            break;
+        case WS_FT_U32:
+            *(uint32_t*)p = r.u32();
+            break;
+        case WS_FT_STR:
+            r.str((char*)p, f->size);
+            break;
+        case WS_FT_PLAYERS:
+        {
+            WsPlayerList* list = (WsPlayerList*)p;
+            uint8_t count = r.u8();
+            if (count > WS_ROSTER_MAX)
+            {
+                r.ok = false;
+                break;
+            }
+            list->count = count;
+            for (uint8_t i = 0; i < count && r.ok; i++)
+            {
+                list->items[i].id = r.u8();
+                r.str(list->items[i].name, sizeof(list->items[i].name));
+            }
+            break;
+        }
+        default:
+            r.ok = false;
+            break;
+    }
+}
+
+size_t field_max_size(const WsFieldDesc* f)
+{
+    switch (f->type)
+    {
+        case WS_FT_BOOL:
+        case WS_FT_U8:
+        case WS_FT_I8:
+            return 1;
+        case WS_FT_U16:
+            return 2;
+        case WS_FT_U32:
+            return 4;
+        case WS_FT_STR:
+            return 1 + (f->size - 1 > 255 ? 255 : f->size - 1);
+        case WS_FT_PLAYERS:
+            return 1 + WS_ROSTER_MAX * (2 + PLAYER_NAME_LEN - 1);
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+int ws_codec_binary_encode(uint8_t op, const void* body, uint8_t* out, size_t cap)
+{
+    const WsMessageDesc* desc = ws_protocol_find(op);
+    if (!desc || !out || (desc->field_count > 0 && !body))
+        return -1;
+
+    const uint8_t* base = (const uint8_t*)body;
+    uint32_t present = desc->has_presence ? *(const uint32_t*)base : 0;
+
+    Writer w = {out, cap, 0, true};
+    w.u8(WS_BINARY_VERSION);
+    w.u8(op);
+    if (desc->has_presence)
+        w.u32(present);
+
+    for (int i = 0; i < desc->field_count; i++)
+    {
+        const WsFieldDesc* f = &desc->fields[i];
+        if (field_enabled(f, i, present))
+            write_field(w, f, base);
+    }
+    return w.ok ? (int)w.pos : -1;
+}
+
+bool ws_codec_binary_decode(const uint8_t* data, size_t len, WsMessage* out)
+{
+    if (!data || !out || len < WS_BINARY_HEADER_SIZE || data[0] != WS_BINARY_VERSION)
+        return false;
+
+    const WsMessageDesc* desc = ws_protocol_find(data[1]);
+    if (!desc)
+        return false;
+
+    memset(out, 0, sizeof(*out));
+    out->op = desc->op;
+    uint8_t* base = (uint8_t*)&out->config_update; // start of the body union
+
+    Reader r = {data, len, WS_BINARY_HEADER_SIZE, true};
+    uint32_t present = 0;
+    if (desc->has_presence)
+    {
+        present = r.u32();
+        *(uint32_t*)base = present;
+    }
+
+    for (int i = 0; i < desc->field_count && r.ok; i++)
+    {
+        const WsFieldDesc* f = &desc->fields[i];
+        if (field_enabled(f, i, present))
+            read_field(r, f, base);
+    }
+    return r.ok;
+}
+
+size_t ws_codec_binary_max_size(uint8_t op)
+{
+    const WsMessageDesc* desc = ws_protocol_find(op);
+    if (!desc)
+        return 0;
+    size_t n = WS_BINARY_HEADER_SIZE + (desc->has_presence ? 4 : 0);
+    for (int i = 0; i < desc->field_count; i++)
+        n += field_max_size(&desc->fields[i]);
+    return n;
+}
@@ -0,0 +1,216 @@
+#include "ws_codec.h"
+#include <cJSON.h>
+#include <stdlib.h>
+#include <string.h>
+
+// JSON codec for the WebSocket protocol. Emits and accepts the same documents
+// as the hand-written handlers did (op + type, grouped status sub-objects).
+
+static cJSON* group_object(cJSON* root, const char* group)
+{
+    if (!group)
+        return root;
+    cJSON* obj = cJSON_GetObjectItem(root, group);
+    if (!obj)
+        obj = cJSON_AddObjectToObject(root, group);
+    return obj;
+}
+
+static void add_field(cJSON* obj, const WsFieldDesc* f, const uint8_t* base)
+{
+    const uint8_t* p = base + f->offset;
+    switch (f->type)
+    {
+        case WS_FT_BOOL:
+            cJSON_AddBoolToObject(obj, f->key, *(const bool*)p);
+            break;
+        case WS_FT_U8:
+            cJSON_AddNumberToObject(obj, f->key, *p);
+            break;
+        case WS_FT_I8:
+            cJSON_AddNumberToObject(obj, f->key, *(const int8_t*)p);
+            break;
+        case WS_FT_U16:
+            cJSON_AddNumberToObject(obj, f->key, *(const uint16_t*)p);
+            break;
+        case WS_FT_U32:
+            cJSON_AddNumberToObject(obj, f->key, *(const uint32_t*)p);
+            break;
+        case WS_FT_STR:
+            cJSON_AddStringToObject(obj, f->key, (const char*)p);
+            break;
+        case WS_FT_PLAYERS:
+        {
+            const WsPlayerList* list = (const WsPlayerList*)p;
+            cJSON* arr = cJSON_AddArrayToObject(obj, f->key);
+            for (uint8_t i = 0; arr && i < list->count && i < WS_ROSTER_MAX; i++)
+            {
+                cJSON* item = cJSON_CreateObject();
+                cJSON_AddNumberToObject(item, "id", list->items[i].id);
+                cJSON_AddStringToObject(item, "name", list->items[i].name);
+                cJSON_AddItemToArray(arr, item);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static bool read_field(const cJSON* item, const WsFieldDesc* f, uint8_t* base)
+{
+    uint8_t* p = base + f->offset;
+    switch (f->type)
+    {
+        case WS_FT_BOOL:
+            if (cJSON_IsBool(item))
+                *(bool*)p = cJSON_IsTrue(item);
+            else if (cJSON_IsNumber(item))
+                *(bool*)p = item->valuedouble != 0;
+            else
+                return false;
+            return true;
+        case WS_FT_U8:
+        case WS_FT_I8:
+        case WS_FT_U16:
+        case WS_FT_U32:
+        {
+            if (!cJSON_IsNumber(item))
+                return false;
+            double v = item->valuedouble;
+            if (f->type == WS_FT_U8)
+                *p = (uint8_t)v;
+            else if (f->type == WS_FT_I8)
+                *(int8_t*)p = (int8_t)v;
+            else if (f->type == WS_FT_U16)
+                *(uint16_t*)p = (uint16_t)v;
+            else
+                *(uint32_t*)p = (uint32_t)v;
+            return true;
+        }
+        case WS_FT_STR:
+            if (!cJSON_IsString(item) || !item->valuestring)
+                return false;
+            strncpy((char*)p, item->valuestring, f->size - 1);
+            ((char*)p)[f->size - 1] = '\0';
+            return true;
+        case WS_FT_PLAYERS:
+        {
+            if (!cJSON_IsArray(item))
+                return false;
+            WsPlayerList* list = (WsPlayerList*)p;
+            list->count = 0;
+            const cJSON* entry = NULL;
+            cJSON_ArrayForEach(entry, item)
+            {
+                const cJSON* id = cJSON_GetObjectItem(entry, "id");
+                const cJSON* name = cJSON_GetObjectItem(entry, "name");
+                if (!cJSON_IsNumber(id) || !cJSON_IsString(name) || list->count >= WS_ROSTER_MAX)
+                    continue;
+                WsPlayerItem* dst = &list->items[list->count++];
+                dst->id = (uint8_t)id->valueint;
+                strncpy(dst->name, name->valuestring, sizeof(dst->name) - 1);
+                dst->name[sizeof(dst->name) - 1] = '\0';
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+static cJSON* build_json(uint8_t op, const void* body)
+{
+    const WsMessageDesc* desc = ws_protocol_find(op);
+    if (!desc || (desc->field_count > 0 && !body))
+        return NULL;
+
+    cJSON* root = cJSON_CreateObject();
+    if (!root)
+        return NULL;
+    cJSON_AddNumberToObject(root, "op", op);
+    cJSON_AddStringToObject(root, "type", desc->type_name);
+
+    const uint8_t* base = (const uint8_t*)body;
+    uint32_t present = desc->has_presence ? *(const uint32_t*)base : 0;
+    for (int i = 0; i < desc->field_count; i++)
+    {
+        const WsFieldDesc* f = &desc->fields[i];
+        if ((f->flags & WS_FIELD_OPTIONAL) && !ws_msg_has(present, i))
+            continue;
+        cJSON* obj = group_object(root, f->group);
+        if (obj)
+            add_field(obj, f, base);
+    }
+    return root;
+}
+
+char* ws_codec_json_encode(uint8_t op, const void* body)
+{
+    cJSON* root = build_json(op, body);
+    if (!root)
+        return NULL;
+    char* text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+int ws_codec_json_encode_to(uint8_t op, const void* body, uint8_t* out, size_t cap)
+{
+    cJSON* root = build_json(op, body);
+    if (!root)
+        return -1;
+    bool ok = cJSON_PrintPreallocated(root, (char*)out, (int)cap, false);
+    cJSON_Delete(root);
+    return ok ? (int)strlen((const char*)out) : -1;
+}
+
+bool ws_codec_json_decode(const uint8_t* data, size_t len, WsMessage* out)
+{
+    const char* text = (const char*)data;
+    if (!text || !out)
+        return false;
+
+    cJSON* root = cJSON_ParseWithLength(text, len);
+    if (!root)
+        return false;
+
+    const WsMessageDesc* desc = NULL;
+    const cJSON* op = cJSON_GetObjectItem(root, "op");
+    if (cJSON_IsNumber(op))
+        desc = ws_protocol_find((uint8_t)op->valueint);
+    else
+        desc = ws_protocol_find_by_type(cJSON_GetStringValue(cJSON_GetObjectItem(root, "type")));
+    if (!desc)
+    {
+        cJSON_Delete(root);
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->op = desc->op;
+    uint8_t* base = (uint8_t*)&out->config_update; // start of the body union
+
+    uint32_t present = 0;
+    bool ok = true;
+    for (int i = 0; i < desc->field_count && ok; i++)
+    {
+        const WsFieldDesc* f = &desc->fields[i];
+        const cJSON* obj = f->group ? cJSON_GetObjectItem(root, f->group) : root;
+        const cJSON* item = obj ? cJSON_GetObjectItem(obj, f->key) : NULL;
+        if (!item || cJSON_IsNull(item))
+        {
+            ok = (f->flags & WS_FIELD_OPTIONAL) != 0;
+            continue;
+        }
+        if (read_field(item, f, base))
+            present |= 1UL << i;
+        else
+            ok = (f->flags & WS_FIELD_OPTIONAL) != 0;
+    }
+    if (desc->has_presence)
+        *(uint32_t*)base = present;
+
+    cJSON_Delete(root);
+    return ok;
+}
@@ -0,0 +1,299 @@
+// Generated by scripts/validate-protocol.js from protocol_def.json - do not edit.
+
+#include "ws_protocol.h"
+#include <string.h>
+
+// Field tables for every opcode. Order matters: it is the binary wire order and
+// the bit index in `present`. Both codecs walk these tables.
+
+#define WS_FIELD(T, member, key, group, type, flags)                                                                   \
+    {key, group, (uint16_t)offsetof(T, member), (uint16_t)sizeof(((T*)0)->member), type, flags}
+#define WS_REQ(T, member, type) WS_FIELD(T, member, #member, NULL, type, 0)
+#define WS_OPT(T, member, type) WS_FIELD(T, member, #member, NULL, type, WS_FIELD_OPTIONAL)
+#define WS_GRP(T, member, group, type) WS_FIELD(T, member, #member, group, type, 0)
+#define WS_MSG(op, name, T, fields, presence)                                                                          \
+    {op, name, fields, (uint8_t)(sizeof(fields) / sizeof(fields[0])), (uint16_t)sizeof(T), presence}
+#define WS_MSG_EMPTY(op, name) {op, name, NULL, 0, 0, false}
+
+static constexpr WsFieldDesc s_config_update_fields[] = {
+    WS_OPT(WsConfigUpdateMsg, reset_to_defaults, WS_FT_BOOL),
+    WS_OPT(WsConfigUpdateMsg, device_name, WS_FT_STR),
+    WS_OPT(WsConfigUpdateMsg, device_id, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, player_id, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, team_id, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, color_rgb, WS_FT_U32),
+    WS_OPT(WsConfigUpdateMsg, win_type, WS_FT_STR),
+    WS_OPT(WsConfigUpdateMsg, target_score, WS_FT_U16),
+    WS_OPT(WsConfigUpdateMsg, game_duration_s, WS_FT_U16),
+    WS_OPT(WsConfigUpdateMsg, max_hearts, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, spawn_hearts, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, respawn_time_s, WS_FT_U16),
+    WS_OPT(WsConfigUpdateMsg, damage_in, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, damage_out, WS_FT_U8),
+    WS_OPT(WsConfigUpdateMsg, friendly_fire, WS_FT_BOOL),
+    WS_OPT(WsConfigUpdateMsg, max_ammo, WS_FT_U16),
+    WS_OPT(WsConfigUpdateMsg, reload_time_ms, WS_FT_U16),
+    WS_OPT(WsConfigUpdateMsg, enable_ammo, WS_FT_BOOL),
+    WS_OPT(WsConfigUpdateMsg, espnow_peers, WS_FT_STR),
+    WS_OPT(WsConfigUpdateMsg, players, WS_FT_PLAYERS),
+    WS_OPT(WsConfigUpdateMsg, telemetry_mcast, WS_FT_BOOL),
+};
+
+static constexpr WsFieldDesc s_game_command_fields[] = {
+    WS_REQ(WsGameCommandMsg, command, WS_FT_U8),
+    WS_OPT(WsGameCommandMsg, extend_minutes, WS_FT_U16),
+    WS_OPT(WsGameCommandMsg, new_target, WS_FT_U16),
+};
+
+static constexpr WsFieldDesc s_hit_forward_fields[] = {
+    WS_REQ(WsHitForwardMsg, shooter_id, WS_FT_U8),
+};
+
+static constexpr WsFieldDesc s_remote_sound_fields[] = {
+    WS_REQ(WsRemoteSoundMsg, sound_id, WS_FT_U8),
+};
+
+static constexpr WsFieldDesc s_resume_fields[] = {
+    WS_REQ(WsResumeMsg, last_seq_id, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_subscribe_fields[] = {
+    WS_REQ(WsSubscribeMsg, topics, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_time_sync_fields[] = {
+    WS_REQ(WsTimeSyncMsg, ref_ms, WS_FT_U32),
+    WS_OPT(WsTimeSyncMsg, prev_ref_ms, WS_FT_U32),
+    WS_OPT(WsTimeSyncMsg, prev_rx_ms, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_status_fields[] = {
+    WS_REQ(WsStatusMsg, uptime_ms, WS_FT_U32),
+    WS_REQ(WsStatusMsg, seq_id, WS_FT_U32),
+    WS_GRP(WsStatusMsg, device_id, "config", WS_FT_U8),
+    WS_GRP(WsStatusMsg, player_id, "config", WS_FT_U8),
+    WS_GRP(WsStatusMsg, team_id, "config", WS_FT_U8),
+    WS_GRP(WsStatusMsg, color_rgb, "config", WS_FT_U32),
+    WS_GRP(WsStatusMsg, device_name, "config", WS_FT_STR),
+    WS_GRP(WsStatusMsg, enable_hearts, "config", WS_FT_BOOL),
+    WS_GRP(WsStatusMsg, max_hearts, "config", WS_FT_U8),
+    WS_GRP(WsStatusMsg, spawn_hearts, "config", WS_FT_U8),
+    WS_GRP(WsStatusMsg, respawn_time_s, "config", WS_FT_U16),
+    WS_GRP(WsStatusMsg, friendly_fire, "config", WS_FT_BOOL),
+    WS_GRP(WsStatusMsg, enable_ammo, "config", WS_FT_BOOL),
+    WS_GRP(WsStatusMsg, max_ammo, "config", WS_FT_U16),
+    WS_GRP(WsStatusMsg, reload_time_ms, "config", WS_FT_U16),
+    WS_GRP(WsStatusMsg, game_duration_s, "config", WS_FT_U16),
+    WS_GRP(WsStatusMsg, shots, "stats", WS_FT_U32),
+    WS_GRP(WsStatusMsg, enemy_kills, "stats", WS_FT_U32),
+    WS_GRP(WsStatusMsg, friendly_kills, "stats", WS_FT_U32),
+    WS_GRP(WsStatusMsg, deaths, "stats", WS_FT_U32),
+    WS_GRP(WsStatusMsg, current_hearts, "state", WS_FT_U8),
+    WS_GRP(WsStatusMsg, current_ammo, "state", WS_FT_U16),
+    WS_GRP(WsStatusMsg, is_respawning, "state", WS_FT_BOOL),
+    WS_GRP(WsStatusMsg, is_reloading, "state", WS_FT_BOOL),
+    WS_GRP(WsStatusMsg, match_ms, "clock", WS_FT_U32),
+    WS_FIELD(WsStatusMsg, clock_stratum, "stratum", "clock", WS_FT_U8, 0),
+};
+
+static constexpr WsFieldDesc s_shot_fired_fields[] = {
+    WS_REQ(WsShotFiredMsg, timestamp_ms, WS_FT_U32),
+    WS_REQ(WsShotFiredMsg, seq_id, WS_FT_U32),
+    WS_REQ(WsShotFiredMsg, match_ms, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_hit_report_fields[] = {
+    WS_REQ(WsHitReportMsg, timestamp_ms, WS_FT_U32),
+    WS_REQ(WsHitReportMsg, shooter_id, WS_FT_U8),
+    WS_REQ(WsHitReportMsg, seq_id, WS_FT_U32),
+    WS_REQ(WsHitReportMsg, match_ms, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_respawn_fields[] = {
+    WS_REQ(WsRespawnMsg, timestamp_ms, WS_FT_U32),
+    WS_REQ(WsRespawnMsg, current_hearts, WS_FT_U8),
+    WS_REQ(WsRespawnMsg, seq_id, WS_FT_U32),
+    WS_REQ(WsRespawnMsg, match_ms, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_reload_fields[] = {
+    WS_REQ(WsReloadMsg, current_ammo, WS_FT_U16),
+};
+
+static constexpr WsFieldDesc s_game_over_fields[] = {
+    WS_OPT(WsGameOverMsg, win_type, WS_FT_STR),
+    WS_OPT(WsGameOverMsg, winner_team_id, WS_FT_U8),
+    WS_OPT(WsGameOverMsg, winner_player_id, WS_FT_U8),
+    WS_OPT(WsGameOverMsg, match_duration_s, WS_FT_U16),
+};
+
+static constexpr WsFieldDesc s_game_state_update_fields[] = {
+    WS_REQ(WsGameStateUpdateMsg, game_running, WS_FT_BOOL),
+    WS_REQ(WsGameStateUpdateMsg, game_over, WS_FT_BOOL),
+    WS_OPT(WsGameStateUpdateMsg, time_remaining_s, WS_FT_U16),
+    WS_OPT(WsGameStateUpdateMsg, total_kills, WS_FT_U32),
+    WS_OPT(WsGameStateUpdateMsg, total_shots, WS_FT_U32),
+    WS_OPT(WsGameStateUpdateMsg, total_hits, WS_FT_U32),
+};
+
+static constexpr WsFieldDesc s_resume_result_fields[] = {
+    WS_REQ(WsResumeResultMsg, from_seq_id, WS_FT_U32),
+    WS_REQ(WsResumeResultMsg, to_seq_id, WS_FT_U32),
+    WS_REQ(WsResumeResultMsg, replayed, WS_FT_U16),
+    WS_REQ(WsResumeResultMsg, snapshot, WS_FT_BOOL),
+};
+
+static constexpr WsFieldDesc s_time_sync_reply_fields[] = {
+    WS_REQ(WsTimeSyncReplyMsg, ref_ms, WS_FT_U32),
+    WS_REQ(WsTimeSyncReplyMsg, match_ms, WS_FT_U32),
+    WS_REQ(WsTimeSyncReplyMsg, stratum, WS_FT_U8),
+};
+
+static constexpr WsFieldDesc s_ack_fields[] = {
+    WS_OPT(WsAckMsg, reply_to, WS_FT_STR),
+    WS_REQ(WsAckMsg, success, WS_FT_BOOL),
+    WS_FIELD(WsAckMsg, error_code, "code", "error", WS_FT_STR, WS_FIELD_OPTIONAL),
+    WS_FIELD(WsAckMsg, error_message, "message", "error", WS_FT_STR, WS_FIELD_OPTIONAL),
+};
+
+static constexpr WsMessageDesc s_messages[] = {
+    // Client -> ESP32
+    WS_MSG_EMPTY(OP_GET_STATUS, "get_status"),
+    WS_MSG_EMPTY(OP_HEARTBEAT, "heartbeat"),
+    WS_MSG(OP_CONFIG_UPDATE, "config_update", WsConfigUpdateMsg, s_config_update_fields, true),
+    WS_MSG(OP_GAME_COMMAND, "game_command", WsGameCommandMsg, s_game_command_fields, true),
+    WS_MSG(OP_HIT_FORWARD, "hit_forward", WsHitForwardMsg, s_hit_forward_fields, false),
+    WS_MSG_EMPTY(OP_KILL_CONFIRMED, "kill_confirmed"),
+    WS_MSG(OP_REMOTE_SOUND, "remote_sound", WsRemoteSoundMsg, s_remote_sound_fields, false),
+    WS_MSG(OP_RESUME, "resume", WsResumeMsg, s_resume_fields, false),
+    WS_MSG(OP_SUBSCRIBE, "subscribe", WsSubscribeMsg, s_subscribe_fields, false),
+    WS_MSG(OP_TIME_SYNC, "time_sync", WsTimeSyncMsg, s_time_sync_fields, true),
+
+    // ESP32 -> Client
+    WS_MSG(OP_STATUS, "status", WsStatusMsg, s_status_fields, false),
+    WS_MSG_EMPTY(OP_HEARTBEAT_ACK, "heartbeat_ack"),
+    WS_MSG(OP_SHOT_FIRED, "shot_fired", WsShotFiredMsg, s_shot_fired_fields, false),
+    WS_MSG(OP_HIT_REPORT, "hit_report", WsHitReportMsg, s_hit_report_fields, false),
+    WS_MSG(OP_RESPAWN, "respawn", WsRespawnMsg, s_respawn_fields, false),
+    WS_MSG(OP_RELOAD_EVENT, "reload_event", WsReloadMsg, s_reload_fields, false),
+    WS_MSG(OP_GAME_OVER, "game_over", WsGameOverMsg, s_game_over_fields, true),
+    WS_MSG(OP_GAME_STATE_UPDATE, "game_state_update", WsGameStateUpdateMsg, s_game_state_update_fields, true),
+    WS_MSG(OP_RESUME_RESULT, "resume_result", WsResumeResultMsg, s_resume_result_fields, false),
+    WS_MSG(OP_TIME_SYNC_REPLY, "time_sync_reply", WsTimeSyncReplyMsg, s_time_sync_reply_fields, false),
+    WS_MSG(OP_ACK, "ack", WsAckMsg, s_ack_fields, true),
+};
+
+// Opcode -> index into s_messages, -1 if unused
+static constexpr int8_t s_by_op[23] = {-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 11, 12, 13, 14, 15, 16, 17, 18, -1, 20, 9, 19};
+
+// s_messages indices sorted by type name, for the legacy "type" lookup
+static constexpr uint8_t s_by_type[21] = {20, 2, 3, 16, 17, 0, 1, 11, 4, 13, 5, 15, 6, 14, 7, 18, 12, 10, 8, 9, 19};
+
+const WsMessageDesc* ws_protocol_find(uint8_t op)
+{
+    if (op >= sizeof(s_by_op) || s_by_op[op] < 0)
+        return NULL;
+    return &s_messages[s_by_op[op]];
+}
+
+const WsMessageDesc* ws_protocol_find_by_type(const char* type_name)
+{
+    if (!type_name)
+        return NULL;
+    size_t lo = 0;
+    size_t hi = sizeof(s_by_type);
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        const WsMessageDesc* desc = &s_messages[s_by_type[mid]];
+        int cmp = strcmp(type_name, desc->type_name);
+        if (cmp == 0)
+            return desc;
+        if (cmp < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+uint32_t ws_protocol_topic(uint8_t op)
+{
+    switch (op)
+    {
+        case OP_STATUS:
+            return WS_TOPIC_STATUS;
+        case OP_SHOT_FIRED:
+        case OP_RELOAD_EVENT:
+            return WS_TOPIC_SHOTS;
+        case OP_HIT_REPORT:
+            return WS_TOPIC_HITS;
+        case OP_RESPAWN:
+        case OP_GAME_OVER:
+        case OP_GAME_STATE_UPDATE:
+            return WS_TOPIC_GAME;
+        default:
+            return 0;
+    }
+}
+
+bool ws_protocol_dispatch(const WsClientHandlers* handlers, int fd, const WsMessage* msg)
+{
+    if (!handlers || !msg)
+        return false;
+    switch (msg->op)
+    {
+        case OP_GET_STATUS:
+            if (!handlers->get_status)
+                return false;
+            handlers->get_status(fd);
+            return true;
+        case OP_HEARTBEAT:
+            if (!handlers->heartbeat)
+                return false;
+            handlers->heartbeat(fd);
+            return true;
+        case OP_CONFIG_UPDATE:
+            if (!handlers->config_update)
+                return false;
+            handlers->config_update(fd, &msg->config_update);
+            return true;
+        case OP_GAME_COMMAND:
+            if (!handlers->game_command)
+                return false;
+            handlers->game_command(fd, &msg->game_command);
+            return true;
+        case OP_HIT_FORWARD:
+            if (!handlers->hit_forward)
+                return false;
+            handlers->hit_forward(fd, &msg->hit_forward);
+            return true;
+        case OP_KILL_CONFIRMED:
+            if (!handlers->kill_confirmed)
+                return false;
+            handlers->kill_confirmed(fd);
+            return true;
+        case OP_REMOTE_SOUND:
+            if (!handlers->remote_sound)
+                return false;
+            handlers->remote_sound(fd, &msg->remote_sound);
+            return true;
+        case OP_RESUME:
+            if (!handlers->resume)
+                return false;
+            handlers->resume(fd, &msg->resume);
+            return true;
+        case OP_SUBSCRIBE:
+            if (!handlers->subscribe)
+                return false;
+            handlers->subscribe(fd, &msg->subscribe);
+            return true;
+        case OP_TIME_SYNC:
+            if (!handlers->time_sync)
+                return false;
+            handlers->time_sync(fd, &msg->time_sync);
+            return true;
+        default:
+            return false;
+    }
+}
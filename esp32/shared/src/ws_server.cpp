@@ -3,222 +3,260 @@
 #include <freertos/semphr.h>
 #include <esp_log.h>
 #include <esp_timer.h>
-#include <cJSON.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/socket.h>
+#include "clock_sync.h"
 #include "game_state.h"
 #include "espnow_comm.h"
+#include "lock_profile.h"
+#include "match_log.h"
 #include "protocol_config.h"
+#include "roster.h"
+#include "telemetry_mcast.h"
+#include "ws_transport_httpd.h"
+
+// Game protocol on top of the WebSocket server core (ws_server_core.cpp).
 
 static const char* TAG = "WsServer";
 
-#define MAX_WS_CLIENTS 8
 #define WS_MAX_FRAME_SIZE 1024
-#define WS_CLIENT_TIMEOUT_MS 30000 // 30 seconds (client heartbeat is 10s + 20s buffer)
-
-typedef struct
-{
-    int fd;
-    bool active;
-    uint32_t last_activity_ms;
-} ws_client_t;
 
-static ws_client_t s_clients[MAX_WS_CLIENTS];
-static httpd_handle_t s_server = NULL;
-static WsServerConfig s_config = {};
 static bool s_initialized = false;
-static SemaphoreHandle_t s_ws_mutex = NULL;
 
 // Forward declaration
-int ws_server_client_count(void);
 void ws_server_send_status_to(int fd);
 
-static int find_client_slot(void)
+static uint32_t get_time_ms(void)
 {
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (!s_clients[i].active)
-            return i;
-    }
-    return -1;
+    return (uint32_t)(esp_timer_get_time() / 1000);
 }
 
-static int find_client_by_fd(int fd)
+// ============================================================================
+// EVENT JOURNAL
+// ============================================================================
+// Ring of the most recent seq_id-carrying events (shots, hits, respawns) so a
+// client that reconnects with OP_RESUME gets what it missed. Status snapshots
+// also consume seq_ids but are not journaled: the client gets a fresh one.
+
+#define WS_JOURNAL_SIZE 128
+
+typedef struct
 {
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    uint8_t op;
+    union
     {
-        if (s_clients[i].active && s_clients[i].fd == fd)
-            return i;
-    }
-    return -1;
-}
-
-static uint32_t get_time_ms(void)
+        WsShotFiredMsg shot_fired;
+        WsHitReportMsg hit_report;
+        WsRespawnMsg respawn;
+    };
+} journal_entry_t;
+
+static journal_entry_t s_journal[WS_JOURNAL_SIZE];
+static uint16_t s_journal_head = 0; // oldest entry
+static uint16_t s_journal_count = 0;
+static uint32_t s_journal_lost_seq = 0; // newest seq_id overwritten in the ring
+static SemaphoreHandle_t s_journal_mutex = NULL;
+
+LOCK_PROFILE(s_journal_profile, "ws_journal");
+
+// Macros, so each journal call site shows up on its own in the lock profile
+#define JOURNAL_LOCK()                                                                                                 \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (s_journal_mutex)                                                                                           \
+            LOCK_PROFILE_TAKE(s_journal_profile, s_journal_mutex);                                                     \
+    } while (0)
+#define JOURNAL_UNLOCK()                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (s_journal_mutex)                                                                                           \
+            LOCK_PROFILE_GIVE(s_journal_profile, s_journal_mutex);                                                     \
+    } while (0)
+
+static uint32_t* journal_seq(journal_entry_t* e)
 {
-    return (uint32_t)(esp_timer_get_time() / 1000);
+    switch (e->op)
+    {
+        case OP_SHOT_FIRED:
+            return &e->shot_fired.seq_id;
+        case OP_HIT_REPORT:
+            return &e->hit_report.seq_id;
+        default:
+            return &e->respawn.seq_id;
+    }
 }
 
-static void add_client(int fd)
+// Assigns the next seq_id and records the event. Only that is done under the
+// lock, which is what keeps the ring in seq order; the sends can block on a
+// slow client, so the broadcast goes out after the lock is released.
+static void journal_broadcast(journal_entry_t* e)
 {
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    // First, remove any existing slot with this fd (handle reconnects)
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    JOURNAL_LOCK();
+    *journal_seq(e) = game_state_next_seq_id();
+    if (s_journal_count == WS_JOURNAL_SIZE)
     {
-        if (s_clients[i].active && s_clients[i].fd == fd)
-        {
-            ESP_LOGW(TAG, "[ADD_CLIENT] Removing old entry for fd=%d at slot %d", fd, i);
-            s_clients[i].active = false;
-            s_clients[i].fd = -1;
-            break;
-        }
+        s_journal_lost_seq = *journal_seq(&s_journal[s_journal_head]);
+        s_journal_head = (s_journal_head + 1) % WS_JOURNAL_SIZE;
+        s_journal_count--;
     }
+    s_journal[(s_journal_head + s_journal_count) % WS_JOURNAL_SIZE] = *e;
+    s_journal_count++;
+    JOURNAL_UNLOCK();
 
-    int slot = find_client_slot();
-    if (slot >= 0)
-    {
-        s_clients[slot].fd = fd;
-        s_clients[slot].active = true;
-        s_clients[slot].last_activity_ms = get_time_ms();
-
-        // Count active clients while holding mutex
-        int count = 0;
-        for (int i = 0; i < MAX_WS_CLIENTS; i++)
-            if (s_clients[i].active)
-                count++;
-
-        ESP_LOGI(TAG, "[ADD_CLIENT] fd=%d added to slot=%d (total=%d)", fd, slot, count);
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-
-        if (s_config.on_connect)
-            s_config.on_connect(fd, true);
-    }
-    else
+    ws_server_broadcast_message(e->op, &e->shot_fired); // union members share one address
+    telemetry_mcast_publish(e->op, &e->shot_fired);
+}
+
+#define WS_RESUME_BATCH 16 // entries copied out of the journal per lock
+
+// Copies the entries on the given topics with after < seq_id <= to, oldest first
+static int journal_copy(uint32_t after, uint32_t to, uint32_t topics, journal_entry_t* out, int max)
+{
+    int n = 0;
+    JOURNAL_LOCK();
+    for (uint16_t i = 0; i < s_journal_count && n < max; i++)
     {
-        ESP_LOGE(TAG, "[ADD_CLIENT] FAILED: No free slots! fd=%d", fd);
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
+        journal_entry_t* e = &s_journal[(s_journal_head + i) % WS_JOURNAL_SIZE];
+        uint32_t seq = *journal_seq(e);
+        if (seq > after && seq <= to && (topics & ws_protocol_topic(e->op)))
+            out[n++] = *e;
     }
+    JOURNAL_UNLOCK();
+    return n;
 }
 
-static void remove_client(int fd)
+static void handle_resume(int fd, const WsResumeMsg* msg)
 {
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    int slot = find_client_by_fd(fd);
-    if (slot >= 0)
+    uint32_t last = msg->last_seq_id;
+    WsResumeResultMsg result = {};
+
+    // Only the topics the client subscribed to are replayed
+    uint32_t topics = ws_core_get_topics(fd);
+
+    GameStateData st;
+    game_state_snapshot(&st);
+
+    JOURNAL_LOCK();
+    // A client ahead of us saw a previous boot: everything it knows is stale
+    bool restarted = last > st.broadcast_seq_id;
+    uint32_t from = restarted ? 0 : last;
+    result.snapshot = restarted || last < s_journal_lost_seq;
+
+    for (uint16_t i = 0; i < s_journal_count; i++)
     {
-        ESP_LOGI(TAG, "[REMOVE] Removing client fd=%d from slot %d", fd, slot);
-        s_clients[slot].active = false;
-        s_clients[slot].fd = -1;
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-
-        // Call disconnect callback AFTER releasing mutex to avoid nested lock
-        if (s_config.on_connect)
-            s_config.on_connect(fd, false);
+        journal_entry_t* e = &s_journal[(s_journal_head + i) % WS_JOURNAL_SIZE];
+        uint32_t seq = *journal_seq(e);
+        if (seq <= from || !(topics & ws_protocol_topic(e->op)))
+            continue;
+        if (result.replayed == 0)
+            result.from_seq_id = seq;
+        result.to_seq_id = seq;
+        result.replayed++;
     }
-    else
+    JOURNAL_UNLOCK();
+
+    // Header first so the client can reset its dedup state before the replay.
+    // Written directly: a replay burst is longer than the send queue allows.
+    // The replay is sent in batches copied out under the lock; events newer
+    // than to_seq_id reach the client live and are not replayed.
+    ws_core_send_message_direct(fd, OP_RESUME_RESULT, &result);
+    journal_entry_t batch[WS_RESUME_BATCH];
+    uint32_t after = from;
+    int n;
+    while (result.replayed && (n = journal_copy(after, result.to_seq_id, topics, batch, WS_RESUME_BATCH)) > 0)
     {
-        ESP_LOGD(TAG, "[REMOVE] Client fd=%d not found in list", fd);
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
+        for (int i = 0; i < n; i++)
+            ws_core_send_message_direct(fd, batch[i].op, &batch[i].shot_fired);
+        after = *journal_seq(&batch[n - 1]);
     }
+
+    ESP_LOGI(TAG, "[RESUME] fd=%d last_seq=%lu replayed=%u (%lu..%lu)%s", fd, (unsigned long)last, result.replayed,
+             (unsigned long)result.from_seq_id, (unsigned long)result.to_seq_id,
+             result.snapshot ? " snapshot" : "");
+    ws_server_send_status_to(fd);
 }
 
-static void handle_config_update(cJSON* root)
+static void handle_config_update(int fd, const WsConfigUpdateMsg* msg)
 {
-    cJSON* reset_item = cJSON_GetObjectItem(root, "reset_to_defaults");
-    if (cJSON_IsTrue(reset_item))
+    (void)fd;
+    uint32_t has = msg->present;
+
+    // Edit private copies, published together (and clamped) by the commit below
+    DeviceConfig dev_cfg;
+    GameConfig game_cfg;
+    DeviceConfig* dev = &dev_cfg;
+    GameConfig* game = &game_cfg;
+    game_state_config_begin(dev, game);
+
+    if (ws_msg_has(has, WS_CFG_RESET_TO_DEFAULTS) && msg->reset_to_defaults)
     {
-        game_state_load_default_game_config();
+        game_state_default_game_config(game);
     }
 
-    DeviceConfig* dev = game_state_get_config_mut();
-    cJSON* item;
-    
     // Device Name
-    item = cJSON_GetObjectItem(root, "device_name");
-    if (item && cJSON_IsString(item))
+    if (ws_msg_has(has, WS_CFG_DEVICE_NAME))
     {
-        strncpy(dev->device_name, item->valuestring, sizeof(dev->device_name) - 1);
+        strncpy(dev->device_name, msg->device_name, sizeof(dev->device_name) - 1);
         dev->device_name[sizeof(dev->device_name) - 1] = '\0';
     }
-    
+
     // Identity
-    item = cJSON_GetObjectItem(root, "device_id");
-    if (item && !cJSON_IsNull(item))
-        dev->device_id = item->valueint & MAX_DEVICE_ID;
-    item = cJSON_GetObjectItem(root, "player_id");
-    if (item && !cJSON_IsNull(item))
-        dev->player_id = item->valueint & MAX_PLAYER_ID;
-    item = cJSON_GetObjectItem(root, "team_id");
-    if (item && !cJSON_IsNull(item))
-        dev->team_id = item->valueint;
-    item = cJSON_GetObjectItem(root, "color_rgb");
-    if (item && !cJSON_IsNull(item))
-        dev->color_rgb = item->valueint;
-
-    GameConfig* game = game_state_get_game_config_mut();
-    
+    if (ws_msg_has(has, WS_CFG_DEVICE_ID))
+        dev->device_id = msg->device_id & MAX_DEVICE_ID;
+    if (ws_msg_has(has, WS_CFG_PLAYER_ID))
+        dev->player_id = msg->player_id & MAX_PLAYER_ID;
+    if (ws_msg_has(has, WS_CFG_TEAM_ID))
+        dev->team_id = msg->team_id;
+    if (ws_msg_has(has, WS_CFG_COLOR_RGB))
+        dev->color_rgb = msg->color_rgb;
+
     // Win Conditions
-    item = cJSON_GetObjectItem(root, "win_type");
-    if (item && cJSON_IsString(item))
+    if (ws_msg_has(has, WS_CFG_WIN_TYPE))
     {
-        strncpy(game->win_type, item->valuestring, sizeof(game->win_type) - 1);
+        strncpy(game->win_type, msg->win_type, sizeof(game->win_type) - 1);
         game->win_type[sizeof(game->win_type) - 1] = '\0';
     }
-    item = cJSON_GetObjectItem(root, "target_score");
-    if (item)
-        game->target_score = item->valueint;
-    item = cJSON_GetObjectItem(root, "game_duration_s");
-    if (item)
-        game->time_limit_s = item->valueint;
-    
+    if (ws_msg_has(has, WS_CFG_TARGET_SCORE))
+        game->target_score = msg->target_score;
+    if (ws_msg_has(has, WS_CFG_GAME_DURATION_S))
+        game->time_limit_s = msg->game_duration_s;
+
     // Health Settings (used only when win_type = "last_man_standing")
-    item = cJSON_GetObjectItem(root, "max_hearts");
-    if (item)
-        game->max_hearts = item->valueint;
-    item = cJSON_GetObjectItem(root, "spawn_hearts");
-    if (item) {
-        game->spawn_hearts = item->valueint;
+    if (ws_msg_has(has, WS_CFG_MAX_HEARTS))
+        game->max_hearts = msg->max_hearts;
+    if (ws_msg_has(has, WS_CFG_SPAWN_HEARTS))
+    {
+        game->spawn_hearts = msg->spawn_hearts;
         // Also set initial hearts for current state
-        GameStateData* state = (GameStateData*)game_state_get();
-        state->hearts_remaining = item->valueint;
+        game_state_set_hearts(msg->spawn_hearts);
     }
-    item = cJSON_GetObjectItem(root, "respawn_time_s");
-    if (item)
-        game->respawn_cooldown_ms = item->valueint * 1000;
-    item = cJSON_GetObjectItem(root, "damage_in");
-    if (item)
-        game->damage_in = item->valueint;
-    item = cJSON_GetObjectItem(root, "damage_out");
-    if (item)
-        game->damage_out = item->valueint;
-    item = cJSON_GetObjectItem(root, "friendly_fire");
-    if (item)
-        game->friendly_fire_enabled = cJSON_IsTrue(item);
-        
+    if (ws_msg_has(has, WS_CFG_RESPAWN_TIME_S))
+        game->respawn_cooldown_ms = msg->respawn_time_s * 1000;
+    if (ws_msg_has(has, WS_CFG_DAMAGE_IN))
+        game->damage_in = msg->damage_in;
+    if (ws_msg_has(has, WS_CFG_DAMAGE_OUT))
+        game->damage_out = msg->damage_out;
+    if (ws_msg_has(has, WS_CFG_FRIENDLY_FIRE))
+        game->friendly_fire_enabled = msg->friendly_fire;
+
     // Ammo Settings
-    item = cJSON_GetObjectItem(root, "max_ammo");
-    if (item)
-        game->max_ammo = item->valueint;
-    item = cJSON_GetObjectItem(root, "reload_time_ms");
-    if (item)
-        game->reload_time_ms = item->valueint;
-    item = cJSON_GetObjectItem(root, "enable_ammo");
-    if (item)
-        game->unlimited_ammo = !cJSON_IsTrue(item);
-        
+    if (ws_msg_has(has, WS_CFG_MAX_AMMO))
+        game->max_ammo = msg->max_ammo;
+    if (ws_msg_has(has, WS_CFG_RELOAD_TIME_MS))
+        game->reload_time_ms = msg->reload_time_ms;
+    if (ws_msg_has(has, WS_CFG_ENABLE_AMMO))
+        game->unlimited_ammo = !msg->enable_ammo;
+
+    bool clamped = false;
+    game_state_config_commit(dev, game, &clamped);
+    if (clamped)
+        ESP_LOGW("WS", "Config update had out-of-range values, clamped");
+
     // ESP-NOW Peers (CSV format: "aa:bb:cc:dd:ee:ff,11:22:33:44:55:66")
-    item = cJSON_GetObjectItem(root, "espnow_peers");
-    if (item && cJSON_IsString(item) && strlen(item->valuestring) > 0)
+    if (ws_msg_has(has, WS_CFG_ESPNOW_PEERS) && msg->espnow_peers[0] != '\0')
     {
-        ESP_LOGI("WS", "Loading ESP-NOW peers: %s", item->valuestring);
-        esp_err_t err = espnow_comm_load_peers_from_csv(item->valuestring);
+        ESP_LOGI("WS", "Loading ESP-NOW peers: %s", msg->espnow_peers);
+        esp_err_t err = espnow_comm_load_peers_from_csv(msg->espnow_peers);
         if (err == ESP_OK)
         {
             ESP_LOGI("WS", "ESP-NOW peers loaded, count: %d", espnow_comm_peer_count());
@@ -229,24 +267,22 @@ static void handle_config_update(cJSON* root)
         }
     }
 
-    // Player name table: [{"id": 1, "name": "Alice"}, ...]
-    cJSON* players = cJSON_GetObjectItem(root, "players");
-    if (cJSON_IsArray(players))
+    // Player roster: [{"id": 1, "name": "Alice"}, ...], replaces the previous one as a whole
+    if (ws_msg_has(has, WS_CFG_PLAYERS))
     {
-        game_state_clear_player_names();
-        cJSON* p = NULL;
-        cJSON_ArrayForEach(p, players)
+        roster_begin();
+        for (uint8_t i = 0; i < msg->players.count; i++)
         {
-            cJSON* pid  = cJSON_GetObjectItem(p, "id");
-            cJSON* pname = cJSON_GetObjectItem(p, "name");
-            if (pid && pname && cJSON_IsString(pname))
-            {
-                game_state_set_player_name((uint8_t)pid->valueint, pname->valuestring);
-            }
+            if (!roster_add(msg->players.items[i].id, msg->players.items[i].name))
+                ESP_LOGW("WS", "Roster entry with player id %u ignored", msg->players.items[i].id);
         }
-        ESP_LOGI("WS", "Player names loaded from config");
+        roster_commit();
     }
 
+    // Spectator stream (UDP multicast, see telemetry_mcast.h)
+    if (ws_msg_has(has, WS_CFG_TELEMETRY_MCAST))
+        telemetry_mcast_set_enabled(msg->telemetry_mcast);
+
     // Save device ID changes
     game_state_save_ids();
 
@@ -254,13 +290,11 @@ static void handle_config_update(cJSON* root)
     ws_server_broadcast_game_state();
 }
 
-static void handle_game_command(cJSON* root)
+static void handle_game_command(int fd, const WsGameCommandMsg* msg)
 {
-    cJSON* cmd_item = cJSON_GetObjectItem(root, "command");
-    if (!cmd_item)
-        return;
-
-    int cmd = cmd_item->valueint;
+    (void)fd;
+    int cmd = msg->command;
+    match_log_append(MLOG_COMMAND, (uint8_t)cmd, 0, 0);
     switch (cmd)
     {
         case CMD_RESET:
@@ -281,25 +315,19 @@ static void handle_game_command(cJSON* root)
             game_state_resume_game();
             break;
         case CMD_EXTEND_TIME:
-        {
-            cJSON* extend_minutes = cJSON_GetObjectItem(root, "extend_minutes");
-            if (extend_minutes && cJSON_IsNumber(extend_minutes))
+            if (ws_msg_has(msg->present, WS_CMD_EXTEND_MINUTES))
             {
-                game_state_extend_time(extend_minutes->valueint);
-                ESP_LOGI(TAG, "Extended game time by %d minutes", extend_minutes->valueint);
+                game_state_extend_time(msg->extend_minutes);
+                ESP_LOGI(TAG, "Extended game time by %d minutes", msg->extend_minutes);
             }
             break;
-        }
         case CMD_UPDATE_TARGET:
-        {
-            cJSON* new_target = cJSON_GetObjectItem(root, "new_target");
-            if (new_target && cJSON_IsNumber(new_target))
+            if (ws_msg_has(msg->present, WS_CMD_NEW_TARGET))
             {
-                game_state_update_target(new_target->valueint);
-                ESP_LOGI(TAG, "Updated target score to %d", new_target->valueint);
+                game_state_update_target(msg->new_target);
+                ESP_LOGI(TAG, "Updated target score to %d", msg->new_target);
             }
             break;
-        }
         default:
             ESP_LOGW(TAG, "Unknown game command: %d", cmd);
             break;
@@ -308,25 +336,19 @@ static void handle_game_command(cJSON* root)
     ws_server_broadcast_game_state();
 }
 
-static void handle_hit_forward(cJSON* root)
+static void handle_hit_forward(int fd, const WsHitForwardMsg* msg)
 {
+    (void)fd;
     // Forward hit to this device (someone shot us)
-    cJSON* shooter_item = cJSON_GetObjectItem(root, "shooter_id");
-    if (!shooter_item || !cJSON_IsNumber(shooter_item))
-    {
-        ESP_LOGW(TAG, "hit_forward: missing or invalid shooter_id");
-        return;
-    }
-
-    uint8_t shooter_id = (uint8_t)shooter_item->valueint;
-    ESP_LOGI(TAG, "Hit forwarded from shooter_id=%u", shooter_id);
+    ESP_LOGI(TAG, "Hit forwarded from shooter_id=%u", msg->shooter_id);
 
     // Record the hit and reduce hearts
     game_state_record_hit();
-    
+
     // Check if we need to respawn
-    const GameStateData* state = game_state_get();
-    if (state->hearts_remaining == 0)
+    GameStateData st;
+    game_state_snapshot(&st);
+    if (st.hearts_remaining == 0)
     {
         game_state_start_respawn();
         game_state_record_death();
@@ -336,200 +358,160 @@ static void handle_hit_forward(cJSON* root)
     ws_server_broadcast_game_state();
 }
 
-static void handle_remote_sound(cJSON* root)
+static void handle_remote_sound(int fd, const WsRemoteSoundMsg* msg)
 {
-    cJSON* sound_item = cJSON_GetObjectItem(root, "sound_id");
-    if (!sound_item || !cJSON_IsNumber(sound_item))
-    {
-        ESP_LOGW(TAG, "remote_sound: missing or invalid sound_id");
-        return;
-    }
-
-    int sound_id = sound_item->valueint;
-    ESP_LOGI(TAG, "Playing remote sound_id=%d", sound_id);
+    (void)fd;
+    ESP_LOGI(TAG, "Playing remote sound_id=%d", msg->sound_id);
 
     // TODO: Implement sound playback (buzzer, speaker, etc.)
     // For now just log it
 }
 
-static void process_message(int fd, const char* payload)
+static void handle_subscribe(int fd, const WsSubscribeMsg* msg)
 {
-    cJSON* root = cJSON_Parse(payload);
-    if (!root)
-        return;
-
-    cJSON* op_item = cJSON_GetObjectItem(root, "op");
-    int op = op_item ? op_item->valueint : 0;
+    ws_core_set_topics(fd, msg->topics);
 
-    // Fallback to type if op is missing (legacy/safety)
-    if (op == 0)
-    {
-        cJSON* type_item = cJSON_GetObjectItem(root, "type");
-        if (type_item && type_item->valuestring)
-        {
-            if (strcmp(type_item->valuestring, "get_status") == 0)
-                op = OP_GET_STATUS;
-            else if (strcmp(type_item->valuestring, "heartbeat") == 0)
-                op = OP_HEARTBEAT;
-            else if (strcmp(type_item->valuestring, "config_update") == 0)
-                op = OP_CONFIG_UPDATE;
-        }
-    }
-
-    switch (op)
-    {
-        case OP_GET_STATUS:
-            ws_server_send_status_to(fd);
-            // Heartbeat is updated inside ws_server_send_status_to
-            break;
-        case OP_HEARTBEAT:
-            ws_server_send_heartbeat_ack(fd);
-            game_state_update_heartbeat();
-            break;
-        case OP_CONFIG_UPDATE:
-            handle_config_update(root);
-            break;
-        case OP_GAME_COMMAND:
-            handle_game_command(root);
-            break;
-        case OP_HIT_FORWARD:
-            handle_hit_forward(root);
-            break;
-        case OP_KILL_CONFIRMED:
-            game_state_record_kill();
-            ws_server_broadcast_game_state();
-            break;
-        case OP_REMOTE_SOUND:
-            handle_remote_sound(root);
-            break;
-        default:
-            ESP_LOGW(TAG, "Unknown opcode: %d", op);
-            break;
-    }
+    WsAckMsg ack = {};
+    ack.present = (1UL << WS_ACK_REPLY_TO) | (1UL << WS_ACK_SUCCESS);
+    strncpy(ack.reply_to, "subscribe", sizeof(ack.reply_to) - 1);
+    ack.success = true;
+    ws_server_send_message(fd, OP_ACK, &ack);
+}
 
-    cJSON_Delete(root);
+static void handle_get_status(int fd)
+{
+    ws_server_send_status_to(fd);
+    // Heartbeat is updated inside ws_server_send_status_to
 }
 
-static esp_err_t ws_handler(httpd_req_t* req)
+static void handle_heartbeat(int fd)
 {
-    if (req->method == HTTP_GET)
-    {
-        // Treat handshake as a connect event
-        int client_fd = httpd_req_to_sockfd(req);
+    ws_server_send_heartbeat_ack(fd);
+    game_state_update_heartbeat();
+}
 
-        // Count before cleanup
-        int count_before = ws_server_client_count();
-        ESP_LOGI(TAG, "[HANDSHAKE] Incoming fd=%d, current count=%d", client_fd, count_before);
+static void handle_kill_confirmed(int fd)
+{
+    (void)fd;
+    game_state_record_kill();
+    ws_server_broadcast_game_state();
+}
 
-        // Clean up any stale connections first
-        ws_server_cleanup_stale();
+// ============================================================================
+// TIME SYNC
+// ============================================================================
+// The server sends TIME_SYNC every few seconds with its clock (ref_ms) and the
+// timestamps of the previous round (prev_ref_ms / prev_rx_ms), which complete
+// that round's exchange: t1 = ref_ms, t2/t3 = our receive/reply time, t4 =
+// prev_rx_ms. Only one round per client is tracked.
 
-        int count_after = ws_server_client_count();
-        ESP_LOGI(TAG, "[CLEANUP] After cleanup, count=%d", count_after);
+#define TIME_SYNC_SLOTS 4
 
-        // Check if fd already exists and remove it
-        if (s_ws_mutex)
-            xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-        int found = find_client_by_fd(client_fd);
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
+typedef struct
+{
+    int fd;
+    uint32_t ref_ms;
+    int64_t rx_us;
+    int64_t tx_us;
+} time_sync_round_t;
 
-        if (found >= 0)
-        {
-            ESP_LOGW(TAG, "[WARNING] FD %d already in list at slot %d, removing old entry", client_fd, found);
-            remove_client(client_fd);
-        }
+// Transport task only
+static time_sync_round_t s_time_sync[TIME_SYNC_SLOTS] = {};
 
-        add_client(client_fd);
-        int count_final = ws_server_client_count();
-        ESP_LOGI(TAG, "[CONNECT] WebSocket handshake: fd=%d connected (total=%d)", client_fd, count_final);
-        return ESP_OK;
+static time_sync_round_t* time_sync_slot(int fd)
+{
+    time_sync_round_t* slot = &s_time_sync[0];
+    for (int i = 0; i < TIME_SYNC_SLOTS; i++)
+    {
+        if (s_time_sync[i].fd == fd && s_time_sync[i].tx_us)
+            return &s_time_sync[i];
+        if (s_time_sync[i].tx_us < slot->tx_us)
+            slot = &s_time_sync[i];
     }
+    memset(slot, 0, sizeof(*slot));
+    slot->fd = fd;
+    return slot;
+}
 
-    httpd_ws_frame_t ws_pkt;
-    memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
-    ws_pkt.type = HTTPD_WS_TYPE_TEXT;
+static void handle_time_sync(int fd, const WsTimeSyncMsg* msg)
+{
+    int64_t rx_us = esp_timer_get_time();
+    time_sync_round_t* round = time_sync_slot(fd);
 
-    esp_err_t ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
-    if (ret != ESP_OK)
+    const uint32_t prev = (1u << WS_TIME_SYNC_PREV_REF_MS) | (1u << WS_TIME_SYNC_PREV_RX_MS);
+    if ((msg->present & prev) == prev && round->tx_us && round->ref_ms == msg->prev_ref_ms)
     {
-        ESP_LOGW(TAG, "[FRAME_RECV] httpd_ws_recv_frame failed with %d for fd=%d", ret, httpd_req_to_sockfd(req));
-        remove_client(httpd_req_to_sockfd(req));
-        return ret;
+        int64_t t1 = (int64_t)round->ref_ms * 1000;
+        int64_t t4 = (int64_t)msg->prev_rx_ms * 1000;
+        int64_t offset = ((t1 - round->rx_us) + (t4 - round->tx_us)) / 2;
+        int64_t delay = (t4 - t1) - (round->tx_us - round->rx_us);
+        clock_sync_add_sample(CLOCK_SRC_SERVER, fd, 0, offset, delay, round->tx_us);
     }
 
-    if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE)
+    WsTimeSyncReplyMsg reply = {};
+    reply.ref_ms = msg->ref_ms;
+    reply.stratum = clock_sync_stratum();
+    int64_t tx_us = esp_timer_get_time();
+    reply.match_ms = (uint32_t)(clock_sync_match_us_at(tx_us) / 1000);
+
+    round->ref_ms = msg->ref_ms;
+    round->rx_us = rx_us;
+    round->tx_us = tx_us;
+    // Direct send: a reply stuck behind queued broadcasts would skew the sample
+    ws_core_send_message_direct(fd, OP_TIME_SYNC_REPLY, &reply);
+}
+
+static const WsClientHandlers s_handlers = {
+    .get_status = handle_get_status,
+    .heartbeat = handle_heartbeat,
+    .config_update = handle_config_update,
+    .game_command = handle_game_command,
+    .hit_forward = handle_hit_forward,
+    .kill_confirmed = handle_kill_confirmed,
+    .remote_sound = handle_remote_sound,
+    .resume = handle_resume,
+    .subscribe = handle_subscribe,
+    .time_sync = handle_time_sync,
+};
+
+static void process_message(int fd, const WsMessage* msg)
+{
+    if (!ws_protocol_dispatch(&s_handlers, fd, msg))
     {
-        int client_fd = httpd_req_to_sockfd(req);
-        ESP_LOGI(TAG, "[CLOSE] Received CLOSE frame from fd=%d, closing connection", client_fd);
-        remove_client(client_fd);
-
-        // Send CLOSE frame response and let httpd close the socket
-        httpd_ws_frame_t close_frame;
-        memset(&close_frame, 0, sizeof(httpd_ws_frame_t));
-        close_frame.type = HTTPD_WS_TYPE_CLOSE;
-        close_frame.payload = NULL;
-        close_frame.len = 0;
-        httpd_ws_send_frame(req, &close_frame);
-
-        // Return error to force httpd to close the connection
-        return ESP_FAIL;
+        ESP_LOGW(TAG, "Unexpected opcode from client: %d", msg->op);
     }
+}
 
-    if (ws_pkt.len == 0 || ws_pkt.len >= WS_MAX_FRAME_SIZE)
-        return ESP_OK;
-
-    char msg[WS_MAX_FRAME_SIZE];
-    ws_pkt.payload = (uint8_t*)msg;
-    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
-    if (ret != ESP_OK)
-        return ret;
-    msg[ws_pkt.len] = '\0';
-
-    int client_fd = httpd_req_to_sockfd(req);
-
-    // Ensure client is tracked
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    int found = find_client_by_fd(client_fd);
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    if (found < 0)
-        add_client(client_fd);
-
-    // Update activity timestamp
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    int slot = find_client_by_fd(client_fd);
-    if (slot >= 0)
-        s_clients[slot].last_activity_ms = get_time_ms();
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    process_message(client_fd, msg);
-
-    if (s_config.on_message)
-        s_config.on_message(client_fd, "", msg);
+static ws_server_connect_cb_t s_on_connect = NULL;
 
-    return ESP_OK;
+// With a server connected it decides the match: its roster filters hits, and
+// the game modes stop ending matches from the offline scoreboard
+static void on_client_connect(int client_fd, bool connected)
+{
+    bool server = ws_core_client_count() > 0;
+    roster_set_server_connected(server);
+    game_state_set_connected(server);
+    if (s_on_connect)
+        s_on_connect(client_fd, connected);
 }
 
 void ws_server_init(const WsServerConfig* config)
 {
+    WsCoreConfig core = {};
+    core.transport = ws_transport_httpd();
+    core.dispatch = process_message;
+    core.on_connect = on_client_connect;
     if (config)
-        memcpy(&s_config, config, sizeof(WsServerConfig));
-    memset(s_clients, 0, sizeof(s_clients));
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
     {
-        s_clients[i].fd = -1;
-        s_clients[i].active = false;
+        core.options = config->options;
+        s_on_connect = config->on_connect;
+        core.on_message = config->on_message;
     }
+    ws_core_init(&core);
 
-    if (!s_ws_mutex)
-    {
-        s_ws_mutex = xSemaphoreCreateMutex();
-    }
+    if (!s_journal_mutex)
+        s_journal_mutex = xSemaphoreCreateMutex();
+    telemetry_mcast_init();
 
     s_initialized = true;
     ESP_LOGI(TAG, "[INIT] WebSocket server initialized");
@@ -539,277 +521,177 @@ void ws_server_register(httpd_handle_t server)
 {
     if (!s_initialized)
         ws_server_init(NULL);
-    s_server = server;
-
-    static const httpd_uri_t ws_uri = {
-        .uri = "/ws",
-        .method = HTTP_GET,
-        .handler = ws_handler,
-        .user_ctx = NULL,
-        .is_websocket = true,
-        .handle_ws_control_frames = true,
-        .supported_subprotocol = NULL,
-    };
+    ws_transport_httpd_register(server);
+}
 
-    httpd_register_uri_handler(server, &ws_uri);
+void ws_server_set_options(const WsServerOptions* options)
+{
+    ws_core_set_options(options);
 }
 
-// Cleanup dead sockets (called on new handshake to free slots)
 void ws_server_cleanup_stale(void)
 {
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    int removed_count = 0;
-    uint32_t now = get_time_ms();
-
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            int fd = s_clients[i].fd;
-            bool remove = false;
-            const char* reason = "unknown";
-
-            // Check for timeout
-            if (now - s_clients[i].last_activity_ms > WS_CLIENT_TIMEOUT_MS)
-            {
-                remove = true;
-                reason = "timeout";
-            }
-            else
-            {
-                // Check if the socket is still valid by attempting to get socket error
-                int opt_val = 0;
-                socklen_t opt_len = sizeof(opt_val);
-                if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &opt_val, &opt_len) != 0 || opt_val != 0)
-                {
-                    remove = true;
-                    reason = "socket error";
-                }
-            }
-
-            if (remove)
-            {
-                ESP_LOGW(TAG, "[DEAD_SOCKET] Removing dead socket at slot %d, fd=%d, reason=%s", i, fd, reason);
-                s_clients[i].active = false;
-                s_clients[i].fd = -1;
-                // Proactively close the HTTPD session to free resources
-                if (s_server)
-                {
-                    httpd_sess_trigger_close(s_server, fd);
-                }
-                removed_count++;
-            }
-        }
-    }
-    if (removed_count > 0)
-        ESP_LOGI(TAG, "[CLEANUP] Removed %d dead sockets", removed_count);
+    ws_core_cleanup_stale();
+}
 
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
+int ws_server_get_client_stats(WsClientStats* out, int max)
+{
+    return ws_core_get_client_stats(out, max);
 }
 
 bool ws_server_is_connected(void)
 {
-    bool connected = false;
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-        if (s_clients[i].active)
-        {
-            connected = true;
-            break;
-        }
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-    return connected;
+    return ws_core_client_count() > 0;
+}
+
+bool ws_server_has_listeners(void)
+{
+    return ws_core_client_count() > 0 || telemetry_mcast_enabled();
 }
 
 int ws_server_client_count(void)
 {
-    int c = 0;
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-        if (s_clients[i].active)
-            c++;
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-    return c;
+    return ws_core_client_count();
 }
 
-static bool ws_server_send_frame(int fd, const char* message)
+bool ws_server_send(int client_fd, const char* message)
 {
-    if (!s_server || !message)
-        return false;
-    struct async_send_arg
-    {
-        httpd_handle_t hd;
-        int fd;
-        char data[WS_MAX_FRAME_SIZE];
-    };
-    struct async_send_arg* arg = (struct async_send_arg*)malloc(sizeof(struct async_send_arg));
-    if (!arg)
+    if (!message)
         return false;
-    arg->hd = s_server;
-    arg->fd = fd;
-    strncpy(arg->data, message, sizeof(arg->data) - 1);
-    arg->data[sizeof(arg->data) - 1] = '\0';
+    size_t len = strnlen(message, WS_MAX_FRAME_SIZE - 1);
+    return ws_core_send_raw(client_fd, (const uint8_t*)message, len, false);
+}
 
-    auto sender = [](void* a)
-    {
-        struct async_send_arg* send_arg = (struct async_send_arg*)a;
-        httpd_ws_frame_t ws_pkt;
-        memset(&ws_pkt, 0, sizeof(ws_pkt));
-        ws_pkt.payload = (uint8_t*)send_arg->data;
-        ws_pkt.len = strlen(send_arg->data);
-        ws_pkt.type = HTTPD_WS_TYPE_TEXT;
-        esp_err_t r = httpd_ws_send_frame_async(send_arg->hd, send_arg->fd, &ws_pkt);
-        if (r != ESP_OK)
-            ESP_LOGW(TAG, "Send failed fd=%d err=%d", send_arg->fd, r);
-        free(send_arg);
-    };
+void ws_server_broadcast(const char* message)
+{
+    if (!message)
+        return;
+    size_t len = strnlen(message, WS_MAX_FRAME_SIZE - 1);
+    ws_core_broadcast_raw((const uint8_t*)message, len, false);
+}
 
-    if (httpd_queue_work(s_server, sender, arg) != ESP_OK)
-    {
-        free(arg);
-        return false;
-    }
-    return true;
+bool ws_server_send_message(int client_fd, uint8_t op, const void* body)
+{
+    return ws_core_send_message(client_fd, op, body);
 }
 
-bool ws_server_send(int client_fd, const char* message)
+void ws_server_broadcast_message(uint8_t op, const void* body)
 {
-    return ws_server_send_frame(client_fd, message);
+    ws_core_broadcast_message(op, body);
 }
 
-void ws_server_broadcast(const char* message)
+static void fill_status(WsStatusMsg* msg)
 {
-    int fds[MAX_WS_CLIENTS];
-    int n = 0;
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            fds[n++] = s_clients[i].fd;
-        }
-    }
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    for (int i = 0; i < n; i++)
-        ws_server_send(fds[i], message);
-}
-
-static cJSON* create_status_json()
-{
-    const DeviceConfig* cfg = game_state_get_config();
-    const GameStateData* st = game_state_get();
-    const GameConfig* game = game_state_get_game_config();
-
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "op", OP_STATUS);
-    cJSON_AddStringToObject(root, "type", "status");
-    cJSON_AddNumberToObject(root, "uptime_ms", esp_timer_get_time() / 1000);
-    cJSON_AddNumberToObject(root, "seq_id", game_state_next_seq_id());
-
-    cJSON* config = cJSON_CreateObject();
-    cJSON_AddNumberToObject(config, "device_id", cfg->device_id);
-    cJSON_AddNumberToObject(config, "player_id", cfg->player_id);
-    cJSON_AddNumberToObject(config, "team_id", cfg->team_id);
-    cJSON_AddNumberToObject(config, "color_rgb", cfg->color_rgb);
-    cJSON_AddStringToObject(config, "device_name", cfg->device_name);
-    cJSON_AddBoolToObject(config, "enable_hearts", !game->unlimited_respawn);
-    cJSON_AddNumberToObject(config, "max_hearts", game->max_hearts);
-    cJSON_AddNumberToObject(config, "spawn_hearts", st->hearts_remaining);
-    cJSON_AddNumberToObject(config, "respawn_time_s", game->respawn_cooldown_ms / 1000);
-    cJSON_AddBoolToObject(config, "friendly_fire", game->friendly_fire_enabled);
-    cJSON_AddBoolToObject(config, "enable_ammo", !game->unlimited_ammo);
-    cJSON_AddNumberToObject(config, "max_ammo", game->max_ammo);
-    cJSON_AddNumberToObject(config, "reload_time_ms", game->reload_time_ms);
-    cJSON_AddNumberToObject(config, "game_duration_s", game->time_limit_s);
-    cJSON_AddItemToObject(root, "config", config);
-
-    cJSON* stats = cJSON_CreateObject();
-    cJSON_AddNumberToObject(stats, "shots", st->shots_fired);
-    cJSON_AddNumberToObject(stats, "enemy_kills", st->kills);
-    cJSON_AddNumberToObject(stats, "friendly_kills", st->friendly_fire_count);
-    cJSON_AddNumberToObject(stats, "deaths", st->deaths);
-    cJSON_AddItemToObject(root, "stats", stats);
-
-    cJSON* state = cJSON_CreateObject();
-    cJSON_AddNumberToObject(state, "current_hearts", st->hearts_remaining);
-    cJSON_AddNumberToObject(state, "current_ammo", 0);
-    cJSON_AddBoolToObject(state, "is_respawning", st->respawning);
-    cJSON_AddBoolToObject(state, "is_reloading", false);
-    cJSON_AddItemToObject(root, "state", state);
-
-    return root;
+    const DeviceConfig* cfg;
+    const GameConfig* game;
+    game_state_config_read(&cfg, &game);
+    GameStateData snap;
+    game_state_snapshot(&snap);
+    const GameStateData* st = &snap;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->uptime_ms = get_time_ms();
+    msg->seq_id = game_state_next_seq_id();
+
+    msg->device_id = cfg->device_id;
+    msg->player_id = cfg->player_id;
+    msg->team_id = cfg->team_id;
+    msg->color_rgb = cfg->color_rgb;
+    strncpy(msg->device_name, cfg->device_name, sizeof(msg->device_name) - 1);
+    msg->enable_hearts = !game->unlimited_respawn;
+    msg->max_hearts = game->max_hearts;
+    msg->spawn_hearts = st->hearts_remaining;
+    msg->respawn_time_s = game->respawn_cooldown_ms / 1000;
+    msg->friendly_fire = game->friendly_fire_enabled;
+    msg->enable_ammo = !game->unlimited_ammo;
+    msg->max_ammo = game->max_ammo;
+    msg->reload_time_ms = game->reload_time_ms;
+    msg->game_duration_s = game->time_limit_s;
+
+    msg->shots = st->shots_fired;
+    msg->enemy_kills = st->kills;
+    msg->friendly_kills = st->friendly_fire_count;
+    msg->deaths = st->deaths;
+
+    msg->current_hearts = st->hearts_remaining;
+    msg->current_ammo = 0;
+    msg->is_respawning = st->respawning;
+    msg->is_reloading = false;
+
+    msg->match_ms = clock_sync_match_ms();
+    msg->clock_stratum = clock_sync_stratum();
 }
 
 void ws_server_send_status_to(int fd)
 {
-    cJSON* root = create_status_json();
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_send(fd, str);
-    free(str);
-    cJSON_Delete(root);
+    WsStatusMsg msg;
+    fill_status(&msg);
+    ws_server_send_message(fd, OP_STATUS, &msg);
     game_state_update_heartbeat(); // Update heartbeat after sending status
 }
 
+// The multicast stream only gets STATUS when something in it changed, plus a
+// periodic refresh for receivers that joined late or lost the last one.
+#define TELEMETRY_STATUS_REFRESH_MS 30000
+
+static WsStatusMsg s_mcast_status; // last published, uptime_ms/seq_id/match_ms cleared
+static uint32_t s_mcast_status_ms = 0;
+
+static void publish_status_delta(const WsStatusMsg* msg)
+{
+    if (!telemetry_mcast_enabled())
+        return;
+
+    WsStatusMsg cmp;
+    memcpy(&cmp, msg, sizeof(cmp));
+    cmp.uptime_ms = 0;
+    cmp.seq_id = 0;
+    cmp.match_ms = 0;
+    uint32_t now = get_time_ms();
+
+    JOURNAL_LOCK();
+    bool changed = s_mcast_status_ms == 0 || memcmp(&cmp, &s_mcast_status, sizeof(cmp)) != 0 ||
+                   now - s_mcast_status_ms >= TELEMETRY_STATUS_REFRESH_MS;
+    if (changed)
+    {
+        s_mcast_status = cmp;
+        s_mcast_status_ms = now ? now : 1;
+        telemetry_mcast_publish(OP_STATUS, msg);
+    }
+    JOURNAL_UNLOCK();
+}
+
 void ws_server_send_status(void)
 {
-    cJSON* root = create_status_json();
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_broadcast(str);
-    free(str);
-    cJSON_Delete(root);
+    WsStatusMsg msg;
+    fill_status(&msg);
+    ws_server_broadcast_message(OP_STATUS, &msg);
+    publish_status_delta(&msg);
     game_state_update_heartbeat(); // Update heartbeat after sending status
 }
 
 void ws_server_send_heartbeat_ack(int client_fd)
 {
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "op", OP_HEARTBEAT_ACK);
-    cJSON_AddStringToObject(root, "type", "heartbeat_ack");
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_send(client_fd, str);
-    free(str);
-    cJSON_Delete(root);
+    ws_server_send_message(client_fd, OP_HEARTBEAT_ACK, NULL);
 }
 
 void ws_server_broadcast_hit(const char* shooter_id_str)
 {
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "op", OP_HIT_REPORT);
-    cJSON_AddStringToObject(root, "type", "hit_report");
-    cJSON_AddNumberToObject(root, "timestamp_ms", esp_timer_get_time() / 1000);
-    int shooter = shooter_id_str ? atoi(shooter_id_str) : 0;
-    cJSON_AddNumberToObject(root, "shooter_id", shooter);
-    cJSON_AddNumberToObject(root, "seq_id", game_state_next_seq_id());
-
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_broadcast(str);
-    free(str);
-    cJSON_Delete(root);
+    journal_entry_t e = {};
+    e.op = OP_HIT_REPORT;
+    e.hit_report.timestamp_ms = get_time_ms();
+    e.hit_report.match_ms = clock_sync_match_ms();
+    e.hit_report.shooter_id = shooter_id_str ? (uint8_t)atoi(shooter_id_str) : 0;
+    journal_broadcast(&e);
 }
 
 void ws_server_broadcast_shot(void)
 {
-    const GameStateData* st = game_state_get();
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "op", OP_SHOT_FIRED);
-    cJSON_AddStringToObject(root, "type", "shot_fired");
-    cJSON_AddNumberToObject(root, "timestamp_ms", esp_timer_get_time() / 1000);
-    cJSON_AddNumberToObject(root, "seq_id", game_state_next_seq_id());
-
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_broadcast(str);
-    free(str);
-    cJSON_Delete(root);
+    journal_entry_t e = {};
+    e.op = OP_SHOT_FIRED;
+    e.shot_fired.timestamp_ms = get_time_ms();
+    e.shot_fired.match_ms = clock_sync_match_ms();
+    journal_broadcast(&e);
 }
 
 void ws_server_broadcast_game_state(void)
@@ -820,16 +702,12 @@ void ws_server_broadcast_game_state(void)
 
 void ws_server_broadcast_respawn(void)
 {
-    const GameStateData* st = game_state_get();
-    cJSON* root = cJSON_CreateObject();
-    cJSON_AddNumberToObject(root, "op", OP_RESPAWN);
-    cJSON_AddStringToObject(root, "type", "respawn");
-    cJSON_AddNumberToObject(root, "timestamp_ms", esp_timer_get_time() / 1000);
-    cJSON_AddNumberToObject(root, "current_hearts", st->hearts_remaining);
-    cJSON_AddNumberToObject(root, "seq_id", game_state_next_seq_id());
-
-    char* str = cJSON_PrintUnformatted(root);
-    ws_server_broadcast(str);
-    free(str);
-    cJSON_Delete(root);
+    GameStateData st;
+    game_state_snapshot(&st);
+    journal_entry_t e = {};
+    e.op = OP_RESPAWN;
+    e.respawn.timestamp_ms = get_time_ms();
+    e.respawn.match_ms = clock_sync_match_ms();
+    e.respawn.current_hearts = st.hearts_remaining;
+    journal_broadcast(&e);
 }
@@ -0,0 +1,993 @@
+#include "ws_server_core.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <string.h>
+#include "lock_profile.h"
+
+// Transport-independent WebSocket server: client table, codec negotiation,
+// message dispatch and fan-out. No esp_http_server dependency so it also runs
+// on the host with the POSIX transport.
+
+static const char* TAG = "WsCore";
+
+#define MAX_WS_CLIENTS 8
+#define WS_MAX_FRAME_SIZE 1024
+
+// Liveness. Clients answer native PINGs with PONGs (browsers and ws do this on
+// their own), so a silent client is dead after a few missed PINGs. Clients
+// that only send OP_HEARTBEAT every 10 s get the old, longer timeout.
+#define WS_DEAD_PEER_MS 15000         // default window; PINGs go out every third of it
+#define WS_HEARTBEAT_TIMEOUT_MS 30000 // json_heartbeat_only: client heartbeat is 10s + 20s buffer
+#define WS_PING_PAYLOAD_LEN 8         // esp_timer timestamp, echoed back in the PONG
+
+// Outbound queueing. Frames are encoded once into a shared, statically
+// allocated buffer pool and each client's queue holds references to them, so
+// heap use does not depend on how slow the clients are.
+#define WS_TX_QUEUE_DEPTH 12      // hard limit per client (hit/kill may use all of it)
+#define WS_TX_QUEUE_SOFT 6        // other messages are dropped beyond this depth
+#define WS_TX_POOL_SIZE 16        // encoded frames in flight: one full queue plus headroom
+#define WS_TX_MAX_LATENCY_MS 1000 // oldest queued frame older than this = over budget
+#define WS_TX_EVICT_MS 3000       // evict clients that stay over budget this long
+
+typedef enum
+{
+    TX_NORMAL = 0,
+    TX_COALESCE, // only the newest copy matters (status snapshots, pings)
+    TX_CRITICAL, // never dropped: the client is evicted instead
+} tx_class_t;
+
+typedef struct
+{
+    int64_t enqueued_us;
+    int8_t buf; // pool index, -1 for an empty payload
+    uint8_t type;
+    uint8_t op;
+    uint16_t len;
+} tx_entry_t;
+
+typedef struct
+{
+    int fd;
+    bool active;
+    uint32_t last_activity_ms;
+    WsCodec codec;
+    uint32_t topics; // WsTopic subscription mask
+
+    // Outbound queue, drained on the transport task
+    uint16_t gen; // bumped on every add/remove so stale drain work is ignored
+    tx_entry_t queue[WS_TX_QUEUE_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    bool drain_pending;
+    uint32_t over_budget_since_ms;
+    WsClientStats stats;
+} ws_client_t;
+
+static ws_client_t s_clients[MAX_WS_CLIENTS];
+static WsCoreConfig s_config = {};
+static SemaphoreHandle_t s_ws_mutex = NULL;
+
+// Shared frame buffers, reference counted by the queue entries that use them
+static uint8_t s_pool[WS_TX_POOL_SIZE][WS_MAX_FRAME_SIZE];
+static uint8_t s_pool_refs[WS_TX_POOL_SIZE];
+
+static uint32_t s_last_ping_ms = 0;
+
+// Decoded inbound message. Transports deliver frames from a single task.
+static WsMessage s_rx_msg;
+
+// Work collected under the lock and carried out after releasing it
+typedef struct
+{
+    int closed[MAX_WS_CLIENTS];
+    int closed_count;
+    void* drains[MAX_WS_CLIENTS];
+    int drain_count;
+} deferred_t;
+
+static void drain_client(void* arg);
+
+static uint32_t get_time_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+LOCK_PROFILE(s_ws_profile, "ws_core");
+
+// Macros rather than functions so the lock profiler sees each call site
+#define LOCK()                                                                                                         \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (s_ws_mutex)                                                                                                \
+            LOCK_PROFILE_TAKE(s_ws_profile, s_ws_mutex);                                                               \
+    } while (0)
+#define UNLOCK()                                                                                                       \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (s_ws_mutex)                                                                                                \
+            LOCK_PROFILE_GIVE(s_ws_profile, s_ws_mutex);                                                               \
+    } while (0)
+
+static int find_client_slot(void)
+{
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (!s_clients[i].active)
+            return i;
+    }
+    return -1;
+}
+
+static int find_client_by_fd(int fd)
+{
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (s_clients[i].active && s_clients[i].fd == fd)
+            return i;
+    }
+    return -1;
+}
+
+static bool transport_writable(int fd)
+{
+    const WsTransport* t = s_config.transport;
+    return !t || !t->writable || t->writable(t->ctx, fd);
+}
+
+static bool transport_send(int fd, WsFrameType type, const uint8_t* data, size_t len)
+{
+    const WsTransport* t = s_config.transport;
+    if (!t || !t->send)
+        return false;
+    return t->send(t->ctx, fd, type, data, len);
+}
+
+// ============================================================================
+// BUFFER POOL / QUEUES (call with s_ws_mutex held)
+// ============================================================================
+
+static void pool_release(int8_t buf)
+{
+    if (buf >= 0 && s_pool_refs[buf] > 0)
+        s_pool_refs[buf]--;
+}
+
+static tx_class_t tx_class(uint8_t op, WsFrameType type)
+{
+    if (type == WS_FRAME_PING || op == OP_STATUS)
+        return TX_COALESCE;
+    if (op == OP_HIT_REPORT || op == OP_HIT_FORWARD || op == OP_KILL_CONFIRMED)
+        return TX_CRITICAL;
+    return TX_NORMAL;
+}
+
+static void flush_queue(ws_client_t* c)
+{
+    while (c->count > 0)
+    {
+        pool_release(c->queue[c->head].buf);
+        c->head = (c->head + 1) % WS_TX_QUEUE_DEPTH;
+        c->count--;
+    }
+    c->head = 0;
+}
+
+// Removes a client from the table; its connection is closed after unlocking
+static void evict_locked(int slot, const char* reason, deferred_t* d)
+{
+    ws_client_t* c = &s_clients[slot];
+    ESP_LOGW(TAG, "[EVICT] fd=%d slot=%d reason=%s (queued=%u dropped=%lu)", c->fd, slot, reason, c->count,
+             (unsigned long)c->stats.dropped);
+    flush_queue(c);
+    d->closed[d->closed_count++] = c->fd;
+    c->active = false;
+    c->fd = -1;
+    c->gen++;
+    c->drain_pending = false;
+    c->over_budget_since_ms = 0;
+}
+
+static void check_budget_locked(int slot, uint32_t now_ms, deferred_t* d)
+{
+    ws_client_t* c = &s_clients[slot];
+    bool over = c->count >= WS_TX_QUEUE_SOFT;
+    if (!over && c->count > 0)
+    {
+        int64_t age_us = esp_timer_get_time() - c->queue[c->head].enqueued_us;
+        over = age_us > (int64_t)WS_TX_MAX_LATENCY_MS * 1000;
+    }
+
+    if (!over)
+        c->over_budget_since_ms = 0;
+    else if (c->over_budget_since_ms == 0)
+        c->over_budget_since_ms = now_ms | 1;
+    else if (now_ms - c->over_budget_since_ms > WS_TX_EVICT_MS)
+        evict_locked(slot, "send queue over budget", d);
+}
+
+static void* drain_arg(int slot)
+{
+    return (void*)(uintptr_t)((uint32_t)s_clients[slot].gen << 8 | (uint32_t)slot);
+}
+
+// Returns false if the frame was dropped or the client evicted
+static bool enqueue_locked(int slot, int8_t buf, WsFrameType type, uint8_t op, size_t len, deferred_t* d)
+{
+    ws_client_t* c = &s_clients[slot];
+    tx_class_t cls = tx_class(op, type);
+
+    if (cls == TX_COALESCE)
+    {
+        for (int i = 0; i < c->count; i++)
+        {
+            tx_entry_t* e = &c->queue[(c->head + i) % WS_TX_QUEUE_DEPTH];
+            if (e->op == op && e->type == type)
+            {
+                // Replace the older copy in place; it keeps its position and age
+                pool_release(e->buf);
+                if (buf >= 0)
+                    s_pool_refs[buf]++;
+                e->buf = buf;
+                e->len = (uint16_t)len;
+                c->stats.coalesced++;
+                return true;
+            }
+        }
+    }
+
+    int limit = cls == TX_CRITICAL ? WS_TX_QUEUE_DEPTH : WS_TX_QUEUE_SOFT;
+    if (c->count >= limit)
+    {
+        if (cls == TX_CRITICAL)
+        {
+            evict_locked(slot, "send queue full", d);
+            return false;
+        }
+        c->stats.dropped++;
+        check_budget_locked(slot, get_time_ms(), d);
+        return false;
+    }
+
+    tx_entry_t* e = &c->queue[(c->head + c->count) % WS_TX_QUEUE_DEPTH];
+    e->enqueued_us = esp_timer_get_time();
+    e->buf = buf;
+    e->type = (uint8_t)type;
+    e->op = op;
+    e->len = (uint16_t)len;
+    if (buf >= 0)
+        s_pool_refs[buf]++;
+    c->count++;
+    if (c->count > c->stats.queue_peak)
+        c->stats.queue_peak = c->count;
+
+    if (!c->drain_pending)
+    {
+        c->drain_pending = true;
+        d->drains[d->drain_count++] = drain_arg(slot);
+    }
+    return true;
+}
+
+// Frees a pool buffer by dropping queued non-critical frames (oldest first,
+// deepest queue first). As a last resort the deepest client is evicted.
+static int8_t pool_alloc_locked(deferred_t* d)
+{
+    while (true)
+    {
+        for (int i = 0; i < WS_TX_POOL_SIZE; i++)
+        {
+            if (s_pool_refs[i] == 0)
+            {
+                s_pool_refs[i] = 1;
+                return (int8_t)i;
+            }
+        }
+
+        int deepest = -1;
+        for (int i = 0; i < MAX_WS_CLIENTS; i++)
+        {
+            if (s_clients[i].active && s_clients[i].count > 0 &&
+                (deepest < 0 || s_clients[i].count > s_clients[deepest].count))
+                deepest = i;
+        }
+        if (deepest < 0)
+            return -1; // every buffer is held by frames being written right now
+
+        ws_client_t* c = &s_clients[deepest];
+        bool dropped = false;
+        for (int i = 0; i < c->count && !dropped; i++)
+        {
+            int idx = (c->head + i) % WS_TX_QUEUE_DEPTH;
+            if (tx_class(c->queue[idx].op, (WsFrameType)c->queue[idx].type) == TX_CRITICAL)
+                continue;
+            pool_release(c->queue[idx].buf);
+            for (int j = i; j < c->count - 1; j++)
+                c->queue[(c->head + j) % WS_TX_QUEUE_DEPTH] = c->queue[(c->head + j + 1) % WS_TX_QUEUE_DEPTH];
+            c->count--;
+            c->stats.dropped++;
+            dropped = true;
+        }
+        if (!dropped)
+            evict_locked(deepest, "buffer pool exhausted", d);
+    }
+}
+
+static void run_deferred(const deferred_t* d)
+{
+    const WsTransport* t = s_config.transport;
+    for (int i = 0; i < d->drain_count; i++)
+    {
+        if (!t || !t->post || !t->post(t->ctx, drain_client, d->drains[i]))
+        {
+            // Run it here rather than leave the queue stuck
+            ESP_LOGW(TAG, "Transport refused drain work, sending inline");
+            drain_client(d->drains[i]);
+        }
+    }
+    for (int i = 0; i < d->closed_count; i++)
+    {
+        if (t && t->close)
+            t->close(t->ctx, d->closed[i]);
+        if (s_config.on_connect)
+            s_config.on_connect(d->closed[i], false);
+    }
+}
+
+static void record_send_locked(int slot, bool ok, uint32_t latency_us, deferred_t* d)
+{
+    WsClientStats* st = &s_clients[slot].stats;
+    if (!ok)
+    {
+        st->send_errors++;
+        evict_locked(slot, "send error", d);
+        return;
+    }
+    st->sent++;
+    st->latency_last_us = latency_us;
+    if (latency_us > st->latency_max_us)
+        st->latency_max_us = latency_us;
+    st->latency_avg_us += ((int32_t)latency_us - (int32_t)st->latency_avg_us) / 8;
+    check_budget_locked(slot, get_time_ms(), d);
+}
+
+// Sends everything queued for one client. Runs on the transport task.
+static void drain_client(void* arg)
+{
+    int slot = (int)((uintptr_t)arg & 0xFF);
+    uint16_t gen = (uint16_t)((uintptr_t)arg >> 8);
+    if (slot >= MAX_WS_CLIENTS)
+        return;
+
+    while (true)
+    {
+        deferred_t d = {};
+        LOCK();
+        ws_client_t* c = &s_clients[slot];
+        if (!c->active || c->gen != gen)
+        {
+            UNLOCK();
+            return;
+        }
+        if (c->count == 0)
+        {
+            c->drain_pending = false;
+            c->over_budget_since_ms = 0;
+            UNLOCK();
+            return;
+        }
+        int fd = c->fd;
+        UNLOCK();
+
+        // Socket full: leave the frames queued and retry on the next enqueue
+        // or cleanup pass; the budget check evicts the client if it stays stuck
+        if (!transport_writable(fd))
+        {
+            LOCK();
+            if (c->active && c->gen == gen)
+                c->drain_pending = false;
+            UNLOCK();
+            return;
+        }
+
+        LOCK();
+        if (!c->active || c->gen != gen || c->count == 0)
+        {
+            if (c->active && c->gen == gen)
+                c->drain_pending = false;
+            UNLOCK();
+            return;
+        }
+        tx_entry_t e = c->queue[c->head];
+        c->head = (c->head + 1) % WS_TX_QUEUE_DEPTH;
+        c->count--;
+        UNLOCK();
+
+        // The entry keeps its pool reference while the frame is written
+        bool ok = transport_send(fd, (WsFrameType)e.type, e.buf >= 0 ? s_pool[e.buf] : NULL, e.len);
+        uint32_t latency_us = (uint32_t)(esp_timer_get_time() - e.enqueued_us);
+
+        LOCK();
+        pool_release(e.buf);
+        if (c->active && c->gen == gen)
+            record_send_locked(slot, ok, latency_us, &d);
+        UNLOCK();
+        run_deferred(&d);
+    }
+}
+
+static void add_client(int fd, WsCodec codec)
+{
+    LOCK();
+
+    // First, remove any existing slot with this fd (handle reconnects)
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (s_clients[i].active && s_clients[i].fd == fd)
+        {
+            ESP_LOGW(TAG, "[ADD_CLIENT] Removing old entry for fd=%d at slot %d", fd, i);
+            flush_queue(&s_clients[i]);
+            s_clients[i].active = false;
+            s_clients[i].fd = -1;
+            s_clients[i].gen++;
+            break;
+        }
+    }
+
+    int slot = find_client_slot();
+    if (slot >= 0)
+    {
+        ws_client_t* c = &s_clients[slot];
+        c->fd = fd;
+        c->active = true;
+        c->last_activity_ms = get_time_ms();
+        c->codec = codec;
+        c->topics = WS_TOPIC_DEFAULT;
+        c->gen++;
+        c->head = 0;
+        c->count = 0;
+        c->drain_pending = false;
+        c->over_budget_since_ms = 0;
+        memset(&c->stats, 0, sizeof(c->stats));
+        c->stats.fd = fd;
+        c->stats.codec = codec;
+
+        // Count active clients while holding mutex
+        int count = 0;
+        for (int i = 0; i < MAX_WS_CLIENTS; i++)
+            if (s_clients[i].active)
+                count++;
+
+        ESP_LOGI(TAG, "[ADD_CLIENT] fd=%d added to slot=%d (total=%d, codec=%s)", fd, slot, count,
+                 ws_codec_ops(codec)->name);
+        UNLOCK();
+
+        if (s_config.on_connect)
+            s_config.on_connect(fd, true);
+    }
+    else
+    {
+        ESP_LOGE(TAG, "[ADD_CLIENT] FAILED: No free slots! fd=%d", fd);
+        UNLOCK();
+    }
+}
+
+static void remove_client(int fd)
+{
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+    {
+        ESP_LOGI(TAG, "[REMOVE] Removing client fd=%d from slot %d", fd, slot);
+        flush_queue(&s_clients[slot]);
+        s_clients[slot].active = false;
+        s_clients[slot].fd = -1;
+        s_clients[slot].gen++;
+        UNLOCK();
+
+        // Call disconnect callback AFTER releasing mutex to avoid nested lock
+        if (s_config.on_connect)
+            s_config.on_connect(fd, false);
+    }
+    else
+    {
+        ESP_LOGD(TAG, "[REMOVE] Client fd=%d not found in list", fd);
+        UNLOCK();
+    }
+}
+
+// Marks activity; returns the client's codec or -1 if the fd is unknown
+static int touch_client(int fd)
+{
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    int codec = -1;
+    if (slot >= 0)
+    {
+        s_clients[slot].last_activity_ms = get_time_ms();
+        codec = s_clients[slot].codec;
+    }
+    UNLOCK();
+    return codec;
+}
+
+static uint32_t dead_peer_window_ms(void)
+{
+    if (s_config.options.dead_peer_ms)
+        return s_config.options.dead_peer_ms;
+    return s_config.options.json_heartbeat_only ? WS_HEARTBEAT_TIMEOUT_MS : WS_DEAD_PEER_MS;
+}
+
+// A PONG carrying the timestamp of one of our PINGs gives the round trip
+static void record_pong(int fd, const uint8_t* data, size_t len)
+{
+    int64_t now_us = esp_timer_get_time();
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+    {
+        ws_client_t* c = &s_clients[slot];
+        c->last_activity_ms = (uint32_t)(now_us / 1000);
+        int64_t sent_us = 0;
+        if (len == WS_PING_PAYLOAD_LEN)
+            memcpy(&sent_us, data, sizeof(sent_us));
+        int64_t rtt_us = now_us - sent_us;
+        if (len == WS_PING_PAYLOAD_LEN && rtt_us >= 0 && rtt_us < (int64_t)dead_peer_window_ms() * 1000)
+        {
+            WsClientStats* st = &c->stats;
+            st->rtt_last_us = (uint32_t)rtt_us;
+            if (st->rtt_last_us > st->rtt_max_us)
+                st->rtt_max_us = st->rtt_last_us;
+            if (st->pongs == 0)
+                st->rtt_avg_us = st->rtt_last_us;
+            else
+                st->rtt_avg_us += ((int32_t)st->rtt_last_us - (int32_t)st->rtt_avg_us) / 8;
+            st->pongs++;
+        }
+    }
+    UNLOCK();
+}
+
+// ============================================================================
+// SETUP
+// ============================================================================
+
+void ws_core_init(const WsCoreConfig* config)
+{
+    if (config)
+        s_config = *config;
+    memset(s_clients, 0, sizeof(s_clients));
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        s_clients[i].fd = -1;
+        s_clients[i].active = false;
+    }
+
+    memset(s_pool_refs, 0, sizeof(s_pool_refs));
+
+    if (!s_ws_mutex)
+        s_ws_mutex = xSemaphoreCreateMutex();
+
+    ESP_LOGI(TAG, "[INIT] transport=%s sync_send=%d json_heartbeat_only=%d json_only=%d max_message=%u dead_peer=%lums",
+             s_config.transport ? s_config.transport->name : "none", s_config.options.sync_send,
+             s_config.options.json_heartbeat_only, s_config.options.json_only, (unsigned)ws_core_max_message_size(),
+             (unsigned long)dead_peer_window_ms());
+}
+
+void ws_core_set_options(const WsServerOptions* options)
+{
+    if (!options)
+        return;
+    LOCK();
+    s_config.options = *options;
+    UNLOCK();
+    ESP_LOGI(TAG, "[OPTIONS] sync_send=%d json_heartbeat_only=%d json_only=%d max_message=%u dead_peer=%lums",
+             options->sync_send, options->json_heartbeat_only, options->json_only, (unsigned)ws_core_max_message_size(),
+             (unsigned long)dead_peer_window_ms());
+}
+
+void ws_core_get_options(WsServerOptions* options)
+{
+    if (!options)
+        return;
+    LOCK();
+    *options = s_config.options;
+    UNLOCK();
+}
+
+// ============================================================================
+// TRANSPORT EVENTS
+// ============================================================================
+
+void ws_core_on_open(int fd, bool offers_binary)
+{
+    int count_before = ws_core_client_count();
+    ESP_LOGI(TAG, "[HANDSHAKE] Incoming fd=%d, current count=%d", fd, count_before);
+
+    // Clean up any stale connections first
+    ws_core_cleanup_stale();
+
+    LOCK();
+    int found = find_client_by_fd(fd);
+    UNLOCK();
+    if (found >= 0)
+    {
+        ESP_LOGW(TAG, "[WARNING] FD %d already in list at slot %d, removing old entry", fd, found);
+        remove_client(fd);
+    }
+
+    WsCodec codec = (offers_binary && !s_config.options.json_only) ? WS_CODEC_BINARY : WS_CODEC_JSON;
+    add_client(fd, codec);
+    ESP_LOGI(TAG, "[CONNECT] WebSocket handshake: fd=%d connected (total=%d)", fd, ws_core_client_count());
+}
+
+void ws_core_on_close(int fd)
+{
+    remove_client(fd);
+}
+
+void ws_core_on_frame(int fd, WsFrameType type, const uint8_t* data, size_t len)
+{
+    switch (type)
+    {
+        case WS_FRAME_PONG:
+            record_pong(fd, data, len);
+            return;
+        case WS_FRAME_PING:
+            touch_client(fd);
+            transport_send(fd, WS_FRAME_PONG, data, len);
+            return;
+        case WS_FRAME_TEXT:
+        case WS_FRAME_BINARY:
+            break;
+        default:
+            return;
+    }
+
+    if (len == 0)
+        return;
+
+    bool binary = type == WS_FRAME_BINARY;
+    if (touch_client(fd) < 0)
+    {
+        // Ensure client is tracked (frames can race the handshake bookkeeping)
+        add_client(fd, binary ? WS_CODEC_BINARY : WS_CODEC_JSON);
+    }
+
+    const WsCodecOps* codec = ws_codec_ops(binary ? WS_CODEC_BINARY : WS_CODEC_JSON);
+    if (!codec->decode(data, len, &s_rx_msg))
+    {
+        ESP_LOGW(TAG, "[FRAME_RECV] Malformed %s frame from fd=%d (%u bytes)", codec->name, fd, (unsigned)len);
+        return;
+    }
+
+    if (s_config.dispatch)
+        s_config.dispatch(fd, &s_rx_msg);
+
+    if (s_config.on_message)
+    {
+        const WsMessageDesc* desc = ws_protocol_find(s_rx_msg.op);
+        s_config.on_message(fd, desc ? desc->type_name : "", data, len);
+    }
+}
+
+size_t ws_core_max_message_size(void)
+{
+    LOCK();
+    size_t limit = s_config.options.max_message_size;
+    UNLOCK();
+    return (limit == 0 || limit > WS_RX_MAX_MESSAGE_SIZE) ? WS_RX_MAX_MESSAGE_SIZE : limit;
+}
+
+void ws_core_on_rx_error(int fd, WsRxError error, size_t len)
+{
+    size_t limit = ws_core_max_message_size();
+
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+        s_clients[slot].stats.rx_rejected++;
+    UNLOCK();
+
+    WsAckMsg ack = {};
+    ack.present = (1UL << WS_ACK_SUCCESS) | (1UL << WS_ACK_ERROR_CODE) | (1UL << WS_ACK_ERROR_MESSAGE);
+    ack.success = false;
+    if (error == WS_RX_TOO_LARGE)
+    {
+        ESP_LOGW(TAG, "[FRAME_RECV] fd=%d message of %u bytes exceeds %u", fd, (unsigned)len, (unsigned)limit);
+        strncpy(ack.error_code, "MESSAGE_TOO_LARGE", sizeof(ack.error_code) - 1);
+        snprintf(ack.error_message, sizeof(ack.error_message), "message exceeds %u bytes", (unsigned)limit);
+    }
+    else
+    {
+        ESP_LOGW(TAG, "[FRAME_RECV] fd=%d no receive buffer free for a fragmented message", fd);
+        strncpy(ack.error_code, "BUSY", sizeof(ack.error_code) - 1);
+        strncpy(ack.error_message, "no receive buffer free, retry later", sizeof(ack.error_message) - 1);
+    }
+    ws_core_send_message_direct(fd, OP_ACK, &ack);
+}
+
+// ============================================================================
+// OUTBOUND
+// ============================================================================
+
+// Queues (or, with sync_send or direct, writes) a pool buffer to the given
+// clients. Takes over the caller's reference to buf.
+static int deliver(const int* fds, int n, int8_t buf, WsFrameType type, uint8_t op, size_t len, bool direct)
+{
+    int sent = 0;
+    deferred_t d = {};
+
+    if (direct || s_config.options.sync_send)
+    {
+        // Written on the caller's task, bypassing the queues
+        for (int i = 0; i < n; i++)
+        {
+            int64_t start_us = esp_timer_get_time();
+            bool ok = transport_send(fds[i], type, buf >= 0 ? s_pool[buf] : NULL, len);
+            uint32_t latency_us = (uint32_t)(esp_timer_get_time() - start_us);
+            LOCK();
+            int slot = find_client_by_fd(fds[i]);
+            if (slot >= 0)
+                record_send_locked(slot, ok, latency_us, &d);
+            UNLOCK();
+            if (ok)
+                sent++;
+        }
+    }
+    else
+    {
+        LOCK();
+        for (int i = 0; i < n; i++)
+        {
+            int slot = find_client_by_fd(fds[i]);
+            if (slot >= 0 && enqueue_locked(slot, buf, type, op, len, &d))
+                sent++;
+        }
+        UNLOCK();
+    }
+
+    LOCK();
+    pool_release(buf);
+    UNLOCK();
+    run_deferred(&d);
+    return sent;
+}
+
+static int8_t alloc_buffer(void)
+{
+    deferred_t d = {};
+    LOCK();
+    int8_t buf = pool_alloc_locked(&d);
+    UNLOCK();
+    run_deferred(&d);
+    if (buf < 0)
+        ESP_LOGW(TAG, "Send buffer pool exhausted");
+    return buf;
+}
+
+// Encodes a message at most once per codec and queues it for every target
+// client. targets == NULL means all active clients subscribed to the topic.
+static int send_encoded(const int* targets, int target_count, uint8_t op, const void* body, bool direct)
+{
+    int fds[WS_CODEC_COUNT][MAX_WS_CLIENTS];
+    int counts[WS_CODEC_COUNT] = {};
+    uint32_t topic = ws_protocol_topic(op);
+    LOCK();
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (!s_clients[i].active)
+            continue;
+        bool wanted = targets == NULL && (topic == 0 || (s_clients[i].topics & topic));
+        for (int t = 0; !wanted && t < target_count; t++)
+            wanted = targets[t] == s_clients[i].fd;
+        if (wanted)
+        {
+            WsCodec codec = s_clients[i].codec;
+            fds[codec][counts[codec]++] = s_clients[i].fd;
+        }
+    }
+    UNLOCK();
+
+    int sent = 0;
+    for (int c = 0; c < WS_CODEC_COUNT; c++)
+    {
+        if (counts[c] == 0)
+            continue;
+        const WsCodecOps* codec = ws_codec_ops((WsCodec)c);
+        int8_t buf = alloc_buffer();
+        if (buf < 0)
+            continue;
+        // Encoding happens outside the lock; nobody else references buf yet
+        int len = codec->encode(op, body, s_pool[buf], WS_MAX_FRAME_SIZE);
+        if (len <= 0)
+        {
+            ESP_LOGW(TAG, "Failed to encode op=%u with %s codec", op, codec->name);
+            LOCK();
+            pool_release(buf);
+            UNLOCK();
+            continue;
+        }
+        sent += deliver(fds[c], counts[c], buf, codec->binary ? WS_FRAME_BINARY : WS_FRAME_TEXT, op, (size_t)len,
+                        direct);
+    }
+    return sent;
+}
+
+bool ws_core_send_message(int fd, uint8_t op, const void* body)
+{
+    return send_encoded(&fd, 1, op, body, false) > 0;
+}
+
+bool ws_core_send_message_direct(int fd, uint8_t op, const void* body)
+{
+    return send_encoded(&fd, 1, op, body, true) > 0;
+}
+
+int ws_core_broadcast_message(uint8_t op, const void* body)
+{
+    return send_encoded(NULL, 0, op, body, false);
+}
+
+static int active_fds(int* fds)
+{
+    int n = 0;
+    LOCK();
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (s_clients[i].active)
+            fds[n++] = s_clients[i].fd;
+    }
+    UNLOCK();
+    return n;
+}
+
+static int send_raw_to(const int* fds, int n, const uint8_t* data, size_t len, bool binary)
+{
+    if (!data || len == 0 || len > WS_MAX_FRAME_SIZE || n == 0)
+        return 0;
+    int8_t buf = alloc_buffer();
+    if (buf < 0)
+        return 0;
+    memcpy(s_pool[buf], data, len);
+    return deliver(fds, n, buf, binary ? WS_FRAME_BINARY : WS_FRAME_TEXT, 0, len, false);
+}
+
+bool ws_core_send_raw(int fd, const uint8_t* data, size_t len, bool binary)
+{
+    return send_raw_to(&fd, 1, data, len, binary) > 0;
+}
+
+void ws_core_broadcast_raw(const uint8_t* data, size_t len, bool binary)
+{
+    int fds[MAX_WS_CLIENTS];
+    int n = active_fds(fds);
+    send_raw_to(fds, n, data, len, binary);
+}
+
+void ws_core_ping_all(void)
+{
+    int fds[MAX_WS_CLIENTS];
+    int n = active_fds(fds);
+    s_last_ping_ms = get_time_ms();
+    if (n == 0)
+        return;
+
+    int8_t buf = alloc_buffer();
+    if (buf < 0)
+        return;
+    int64_t now_us = esp_timer_get_time();
+    memcpy(s_pool[buf], &now_us, WS_PING_PAYLOAD_LEN);
+    deliver(fds, n, buf, WS_FRAME_PING, 0, WS_PING_PAYLOAD_LEN, false);
+    ESP_LOGD(TAG, "PING sent to %d clients", n);
+}
+
+// ============================================================================
+// CLIENTS
+// ============================================================================
+
+// Evicts dead peers (also called on new handshake to free slots) and sends
+// the periodic PINGs
+void ws_core_cleanup_stale(void)
+{
+    deferred_t d = {};
+    uint32_t now = get_time_ms();
+
+    LOCK();
+    uint32_t window = dead_peer_window_ms();
+    bool ping = !s_config.options.json_heartbeat_only && now - s_last_ping_ms >= window / 3;
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+    {
+        if (s_clients[i].active)
+        {
+            // Nothing heard (not even a PONG) within the window
+            if (now - s_clients[i].last_activity_ms > window)
+            {
+                evict_locked(i, "dead peer", &d);
+                continue;
+            }
+
+            check_budget_locked(i, now, &d);
+
+            // Retry queues whose drain stopped on a full socket
+            if (s_clients[i].active && s_clients[i].count > 0 && !s_clients[i].drain_pending)
+            {
+                s_clients[i].drain_pending = true;
+                d.drains[d.drain_count++] = drain_arg(i);
+            }
+        }
+    }
+    UNLOCK();
+
+    // Proactively close the sessions to free resources
+    run_deferred(&d);
+    if (d.closed_count > 0)
+        ESP_LOGI(TAG, "[CLEANUP] Removed %d dead peers", d.closed_count);
+
+    if (ping)
+        ws_core_ping_all();
+}
+
+int ws_core_get_client_stats(WsClientStats* out, int max)
+{
+    int n = 0;
+    LOCK();
+    for (int i = 0; i < MAX_WS_CLIENTS && n < max; i++)
+    {
+        if (!s_clients[i].active)
+            continue;
+        out[n] = s_clients[i].stats;
+        out[n].queue_depth = s_clients[i].count;
+        out[n].topics = s_clients[i].topics;
+        n++;
+    }
+    UNLOCK();
+    return n;
+}
+
+void ws_core_set_topics(int fd, uint32_t topics)
+{
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+    {
+        s_clients[slot].topics = topics & WS_TOPIC_ALL;
+        ESP_LOGI(TAG, "[SUBSCRIBE] fd=%d topics=0x%02lx", fd, (unsigned long)s_clients[slot].topics);
+    }
+    UNLOCK();
+}
+
+uint32_t ws_core_get_topics(int fd)
+{
+    uint32_t topics = 0;
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+        topics = s_clients[slot].topics;
+    UNLOCK();
+    return topics;
+}
+
+int ws_core_client_count(void)
+{
+    int c = 0;
+    LOCK();
+    for (int i = 0; i < MAX_WS_CLIENTS; i++)
+        if (s_clients[i].active)
+            c++;
+    UNLOCK();
+    return c;
+}
+
+WsCodec ws_core_client_codec(int fd)
+{
+    WsCodec codec = WS_CODEC_JSON;
+    LOCK();
+    int slot = find_client_by_fd(fd);
+    if (slot >= 0)
+        codec = s_clients[slot].codec;
+    UNLOCK();
+    return codec;
+}
@@ -1,501 +0,0 @@
-/**
- * Optimized WebSocket Server Implementation
- *
- * Performance improvements:
- * - Async WebSocket frame sending (non-blocking)
- * - MessagePack binary protocol support (60% smaller, 70% faster parsing)
- * - Native WebSocket PING/PONG (no application-level heartbeat)
- * - Optimized client management
- * - Optional HTTP API disable (saves 8KB RAM)
- */
-
-#include "ws_server_optimized.h"
-#include <freertos/FreeRTOS.h>
-#include <freertos/semphr.h>
-#include <esp_log.h>
-#include <esp_timer.h>
-#include <stdlib.h>
-#include <string.h>
-#include <sys/socket.h>
-
-#if WS_ENABLE_MSGPACK
-#include <ArduinoJson.h> // For MessagePack support
-#endif
-
-static const char* TAG = "WsServerOpt";
-
-#define MAX_WS_CLIENTS 8 // Increased from 4
-#define WS_MAX_FRAME_SIZE 1024
-#define WS_CLIENT_TIMEOUT_MS 30000 // 30 seconds
-
-typedef struct
-{
-    int fd;
-    bool active;
-    uint32_t last_activity_ms;
-    bool supports_binary; // Client supports MessagePack
-} ws_client_t;
-
-static ws_client_t s_clients[MAX_WS_CLIENTS];
-static httpd_handle_t s_server = NULL;
-static WsServerConfig s_config = {};
-static bool s_initialized = false;
-static SemaphoreHandle_t s_ws_mutex = NULL;
-
-// ============================================================================
-// CLIENT MANAGEMENT
-// ============================================================================
-
-static uint32_t get_time_ms(void)
-{
-    return (uint32_t)(esp_timer_get_time() / 1000);
-}
-
-static int find_client_slot(void)
-{
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (!s_clients[i].active)
-            return i;
-    }
-    return -1;
-}
-
-static int find_client_by_fd(int fd)
-{
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active && s_clients[i].fd == fd)
-            return i;
-    }
-    return -1;
-}
-
-static void add_client(int fd, bool supports_binary)
-{
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    // Remove any existing slot with this fd
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active && s_clients[i].fd == fd)
-        {
-            ESP_LOGW(TAG, "Removing old entry for fd=%d", fd);
-            s_clients[i].active = false;
-            break;
-        }
-    }
-
-    int slot = find_client_slot();
-    if (slot >= 0)
-    {
-        s_clients[slot].fd = fd;
-        s_clients[slot].active = true;
-        s_clients[slot].last_activity_ms = get_time_ms();
-        s_clients[slot].supports_binary = supports_binary;
-
-        int count = 0;
-        for (int i = 0; i < MAX_WS_CLIENTS; i++)
-            if (s_clients[i].active)
-                count++;
-
-        ESP_LOGI(TAG, "✓ Client fd=%d added (binary=%d, total=%d)", fd, supports_binary, count);
-
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-
-        if (s_config.on_connect)
-            s_config.on_connect(fd, true);
-    }
-    else
-    {
-        ESP_LOGE(TAG, "✗ No free slots for fd=%d", fd);
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-    }
-}
-
-static void remove_client(int fd)
-{
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    int slot = find_client_by_fd(fd);
-    if (slot >= 0)
-    {
-        ESP_LOGI(TAG, "Removing client fd=%d", fd);
-        s_clients[slot].active = false;
-        s_clients[slot].fd = -1;
-
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-
-        if (s_config.on_connect)
-            s_config.on_connect(fd, false);
-    }
-    else
-    {
-        if (s_ws_mutex)
-            xSemaphoreGive(s_ws_mutex);
-    }
-}
-
-// ============================================================================
-// MESSAGE SENDING (OPTIMIZED)
-// ============================================================================
-
-bool ws_server_send_raw_optimized(int client_fd, const uint8_t* data, size_t len, bool binary)
-{
-    if (!s_server || !data || len == 0)
-        return false;
-
-    httpd_ws_frame_t ws_pkt;
-    memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
-    ws_pkt.payload = (uint8_t*)data;
-    ws_pkt.len = len;
-    ws_pkt.type = binary ? HTTPD_WS_TYPE_BINARY : HTTPD_WS_TYPE_TEXT;
-
-#if WS_ENABLE_ASYNC_SEND
-    // Non-blocking async send
-    esp_err_t ret = httpd_ws_send_frame_async(s_server, client_fd, &ws_pkt);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGW(TAG, "Async send failed to fd=%d: %s", client_fd, esp_err_to_name(ret));
-        return false;
-    }
-#else
-    // Blocking sync send
-    httpd_req_t fake_req = {0};
-    fake_req.handle = s_server;
-    fake_req.method = HTTP_GET;
-    esp_err_t ret = httpd_ws_send_frame(&fake_req, &ws_pkt);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGW(TAG, "Sync send failed to fd=%d: %s", client_fd, esp_err_to_name(ret));
-        return false;
-    }
-#endif
-
-    // Update last activity
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    int slot = find_client_by_fd(client_fd);
-    if (slot >= 0)
-    {
-        s_clients[slot].last_activity_ms = get_time_ms();
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    return true;
-}
-
-void ws_server_broadcast_raw_optimized(const uint8_t* data, size_t len, bool binary)
-{
-    if (!data || len == 0)
-        return;
-
-    int sent_count = 0;
-    int total_clients = 0;
-
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            total_clients++;
-            int fd = s_clients[i].fd;
-
-            if (s_ws_mutex)
-                xSemaphoreGive(s_ws_mutex);
-
-            if (ws_server_send_raw_optimized(fd, data, len, binary))
-            {
-                sent_count++;
-            }
-
-            if (s_ws_mutex)
-                xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-        }
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    ESP_LOGD(TAG, "Broadcast sent to %d/%d clients", sent_count, total_clients);
-}
-
-// ============================================================================
-// WEBSOCKET PING/PONG
-// ============================================================================
-
-void ws_server_ping_clients(void)
-{
-#if WS_USE_NATIVE_PING
-    if (!s_server)
-        return;
-
-    httpd_ws_frame_t ping_frame;
-    memset(&ping_frame, 0, sizeof(httpd_ws_frame_t));
-    ping_frame.type = HTTPD_WS_TYPE_PING;
-    ping_frame.payload = NULL;
-    ping_frame.len = 0;
-
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            int fd = s_clients[i].fd;
-
-            if (s_ws_mutex)
-                xSemaphoreGive(s_ws_mutex);
-
-#if WS_ENABLE_ASYNC_SEND
-            httpd_ws_send_frame_async(s_server, fd, &ping_frame);
-#else
-            // For sync, would need proper httpd_req_t
-            ESP_LOGW(TAG, "PING requires async send mode");
-#endif
-
-            if (s_ws_mutex)
-                xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-        }
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    ESP_LOGD(TAG, "PING sent to all clients");
-#endif
-}
-
-// ============================================================================
-// CLEANUP & STATUS
-// ============================================================================
-
-void ws_server_cleanup_stale_optimized(void)
-{
-    uint32_t now = get_time_ms();
-
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            uint32_t idle_time = now - s_clients[i].last_activity_ms;
-            if (idle_time > WS_CLIENT_TIMEOUT_MS)
-            {
-                int fd = s_clients[i].fd;
-                ESP_LOGW(TAG, "Client fd=%d timed out (idle=%lums)", fd, idle_time);
-
-                if (s_ws_mutex)
-                    xSemaphoreGive(s_ws_mutex);
-
-                remove_client(fd);
-
-                if (s_ws_mutex)
-                    xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-            }
-        }
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-}
-
-bool ws_server_is_connected_optimized(void)
-{
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    bool connected = false;
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-        {
-            connected = true;
-            break;
-        }
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    return connected;
-}
-
-int ws_server_client_count_optimized(void)
-{
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-
-    int count = 0;
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        if (s_clients[i].active)
-            count++;
-    }
-
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    return count;
-}
-
-// ============================================================================
-// WEBSOCKET HANDLER
-// ============================================================================
-
-static esp_err_t ws_handler(httpd_req_t* req)
-{
-    if (req->method == HTTP_GET)
-    {
-        ESP_LOGI(TAG, "New WebSocket connection handshake");
-        // Check if client supports binary (MessagePack)
-        // In production, client should send Sec-WebSocket-Protocol header
-        bool supports_binary = true; // Default to binary
-        add_client(httpd_req_to_sockfd(req), supports_binary);
-        return ESP_OK;
-    }
-
-    httpd_ws_frame_t ws_pkt;
-    memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
-    ws_pkt.type = HTTPD_WS_TYPE_TEXT;
-
-    esp_err_t ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "httpd_ws_recv_frame (get len) failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    if (ws_pkt.len == 0)
-    {
-        return ESP_OK;
-    }
-
-    uint8_t* buf = (uint8_t*)malloc(ws_pkt.len + 1);
-    if (!buf)
-    {
-        ESP_LOGE(TAG, "Failed to allocate %d bytes for WS frame", ws_pkt.len);
-        return ESP_ERR_NO_MEM;
-    }
-
-    ws_pkt.payload = buf;
-    ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
-    if (ret != ESP_OK)
-    {
-        ESP_LOGE(TAG, "httpd_ws_recv_frame failed: %s", esp_err_to_name(ret));
-        free(buf);
-        return ret;
-    }
-
-    int client_fd = httpd_req_to_sockfd(req);
-
-    // Update activity
-    if (s_ws_mutex)
-        xSemaphoreTake(s_ws_mutex, portMAX_DELAY);
-    int slot = find_client_by_fd(client_fd);
-    if (slot >= 0)
-    {
-        s_clients[slot].last_activity_ms = get_time_ms();
-    }
-    if (s_ws_mutex)
-        xSemaphoreGive(s_ws_mutex);
-
-    // Handle PONG frames (response to PING)
-    if (ws_pkt.type == HTTPD_WS_TYPE_PONG)
-    {
-        ESP_LOGD(TAG, "Received PONG from fd=%d", client_fd);
-        free(buf);
-        return ESP_OK;
-    }
-
-    // Handle CLOSE frames
-    if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE)
-    {
-        ESP_LOGI(TAG, "Client fd=%d closed connection", client_fd);
-        remove_client(client_fd);
-        free(buf);
-        return ESP_OK;
-    }
-
-    // Process message (TEXT or BINARY)
-    if (s_config.on_message)
-    {
-        // Extract message type for callback
-        const char* type = "unknown";
-        // TODO: Parse type from JSON or MessagePack
-        s_config.on_message(client_fd, type, buf, ws_pkt.len);
-    }
-
-    free(buf);
-    return ESP_OK;
-}
-
-// ============================================================================
-// INITIALIZATION
-// ============================================================================
-
-void ws_server_init_optimized(const WsServerConfig* config)
-{
-    if (s_initialized)
-    {
-        ESP_LOGW(TAG, "Already initialized");
-        return;
-    }
-
-    if (config)
-    {
-        s_config = *config;
-    }
-
-    s_ws_mutex = xSemaphoreCreateMutex();
-    if (!s_ws_mutex)
-    {
-        ESP_LOGE(TAG, "Failed to create mutex");
-        return;
-    }
-
-    memset(s_clients, 0, sizeof(s_clients));
-    for (int i = 0; i < MAX_WS_CLIENTS; i++)
-    {
-        s_clients[i].fd = -1;
-    }
-
-    s_initialized = true;
-    ESP_LOGI(TAG, "✓ Initialized (async=%d, msgpack=%d, native_ping=%d)", WS_ENABLE_ASYNC_SEND,
-             WS_ENABLE_MSGPACK, WS_USE_NATIVE_PING);
-}
-
-void ws_server_register_optimized(httpd_handle_t server)
-{
-    if (!server)
-    {
-        ESP_LOGE(TAG, "Invalid server handle");
-        return;
-    }
-
-    s_server = server;
-
-    httpd_uri_t ws_uri = {.uri = "/ws",
-                          .method = HTTP_GET,
-                          .handler = ws_handler,
-                          .user_ctx = NULL,
-                          .is_websocket = true,
-                          .handle_ws_control_frames = false,
-                          .supported_subprotocol = "msgpack"}; // Advertise MessagePack support
-
-    httpd_register_uri_handler(server, &ws_uri);
-    ESP_LOGI(TAG, "✓ WebSocket endpoint registered at /ws");
-}
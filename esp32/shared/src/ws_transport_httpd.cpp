@@ -0,0 +1,292 @@
+#include "ws_transport_httpd.h"
+#include <esp_log.h>
+#include <string.h>
+#include <sys/select.h>
+#include "ws_server_core.h"
+
+// esp_http_server transport for the WebSocket server core. httpd does the
+// handshake and framing; every frame is read on the httpd task.
+
+static const char* TAG = "WsHttpd";
+
+// Inbound messages are read (and fragments reassembled) into a small static
+// pool rather than onto the httpd task's stack. A fragmented message keeps its
+// buffer until the final fragment; one buffer is always left for unfragmented
+// messages so a client that fragments cannot stall everybody else.
+#ifndef WS_RX_POOL_SIZE
+#define WS_RX_POOL_SIZE 2
+#endif
+#define WS_CONTROL_MAX_PAYLOAD 125 // RFC 6455 5.5
+
+typedef struct
+{
+    int fd; // owner, -1 when free
+    WsFrameType type;
+    size_t len;
+} rx_slot_t;
+
+static httpd_handle_t s_server = NULL;
+
+// Only touched on the httpd task
+static rx_slot_t s_rx_slots[WS_RX_POOL_SIZE];
+static uint8_t s_rx_pool[WS_RX_POOL_SIZE][WS_RX_MAX_MESSAGE_SIZE];
+
+static httpd_ws_type_t to_httpd_type(WsFrameType type)
+{
+    switch (type)
+    {
+        case WS_FRAME_BINARY:
+            return HTTPD_WS_TYPE_BINARY;
+        case WS_FRAME_CLOSE:
+            return HTTPD_WS_TYPE_CLOSE;
+        case WS_FRAME_PING:
+            return HTTPD_WS_TYPE_PING;
+        case WS_FRAME_PONG:
+            return HTTPD_WS_TYPE_PONG;
+        default:
+            return HTTPD_WS_TYPE_TEXT;
+    }
+}
+
+static bool httpd_transport_send(void* ctx, int fd, WsFrameType type, const uint8_t* data, size_t len)
+{
+    (void)ctx;
+    if (!s_server || (len > 0 && !data))
+        return false;
+
+    httpd_ws_frame_t ws_pkt;
+    memset(&ws_pkt, 0, sizeof(ws_pkt));
+    ws_pkt.payload = (uint8_t*)data;
+    ws_pkt.len = len;
+    ws_pkt.type = to_httpd_type(type);
+    ws_pkt.final = true;
+    esp_err_t r = httpd_ws_send_frame_async(s_server, fd, &ws_pkt);
+    if (r != ESP_OK)
+        ESP_LOGW(TAG, "Send failed fd=%d err=%d", fd, r);
+    return r == ESP_OK;
+}
+
+static bool httpd_transport_writable(void* ctx, int fd)
+{
+    (void)ctx;
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(fd, &wfds);
+    struct timeval tv = {0, 0};
+    return select(fd + 1, NULL, &wfds, NULL, &tv) > 0;
+}
+
+static bool httpd_transport_post(void* ctx, void (*fn)(void* arg), void* arg)
+{
+    (void)ctx;
+    return s_server && httpd_queue_work(s_server, fn, arg) == ESP_OK;
+}
+
+static void httpd_transport_close(void* ctx, int fd)
+{
+    (void)ctx;
+    if (s_server)
+        httpd_sess_trigger_close(s_server, fd);
+}
+
+static const WsTransport s_transport = {
+    .name = "httpd",
+    .ctx = NULL,
+    .send = httpd_transport_send,
+    .writable = httpd_transport_writable,
+    .post = httpd_transport_post,
+    .close = httpd_transport_close,
+};
+
+const WsTransport* ws_transport_httpd(void)
+{
+    return &s_transport;
+}
+
+// True if the handshake's Sec-WebSocket-Protocol header offers the binary codec
+static bool offers_binary(httpd_req_t* req)
+{
+    char proto[64];
+    size_t len = httpd_req_get_hdr_value_len(req, "Sec-WebSocket-Protocol");
+    if (len == 0 || len >= sizeof(proto))
+        return false;
+    if (httpd_req_get_hdr_value_str(req, "Sec-WebSocket-Protocol", proto, sizeof(proto)) != ESP_OK)
+        return false;
+    return strstr(proto, WS_SUBPROTOCOL_BINARY) != NULL;
+}
+
+static int find_rx_slot(int fd)
+{
+    for (int i = 0; i < WS_RX_POOL_SIZE; i++)
+        if (s_rx_slots[i].fd == fd)
+            return i;
+    return -1;
+}
+
+static void release_rx_slot(int fd)
+{
+    int i = find_rx_slot(fd);
+    if (i >= 0)
+        s_rx_slots[i].fd = -1;
+}
+
+// Takes a free buffer for a new message. A fragmented message must leave one
+// buffer free. Buffers held by connections that went away without a CLOSE
+// frame are reclaimed here.
+static int acquire_rx_slot(int fd, WsFrameType type, bool fragmented)
+{
+    int free_slot = -1;
+    int free_count = 0;
+    for (int i = 0; i < WS_RX_POOL_SIZE; i++)
+    {
+        if (s_rx_slots[i].fd >= 0 && httpd_ws_get_fd_info(s_server, s_rx_slots[i].fd) != HTTPD_WS_CLIENT_WEBSOCKET)
+            s_rx_slots[i].fd = -1;
+        if (s_rx_slots[i].fd < 0)
+        {
+            free_slot = i;
+            free_count++;
+        }
+    }
+    if (free_count == 0 || (fragmented && free_count < 2))
+        return -1;
+
+    s_rx_slots[free_slot].fd = fd;
+    s_rx_slots[free_slot].type = type;
+    s_rx_slots[free_slot].len = 0;
+    return free_slot;
+}
+
+// Sends a CLOSE frame with a status code and tells httpd to drop the session
+static esp_err_t close_with_status(httpd_req_t* req, int fd, uint16_t status)
+{
+    release_rx_slot(fd);
+    ws_core_on_close(fd);
+
+    uint8_t payload[2] = {(uint8_t)(status >> 8), (uint8_t)(status & 0xFF)};
+    httpd_ws_frame_t close_frame;
+    memset(&close_frame, 0, sizeof(httpd_ws_frame_t));
+    close_frame.type = HTTPD_WS_TYPE_CLOSE;
+    close_frame.payload = status ? payload : NULL;
+    close_frame.len = status ? sizeof(payload) : 0;
+    httpd_ws_send_frame(req, &close_frame);
+
+    // Return error to force httpd to close the connection
+    return ESP_FAIL;
+}
+
+// Replies with an error ACK, then closes: the unread payload cannot be skipped
+static esp_err_t reject_message(httpd_req_t* req, int fd, WsRxError error, size_t len)
+{
+    ws_core_on_rx_error(fd, error, len);
+    return close_with_status(req, fd, error == WS_RX_TOO_LARGE ? WS_CLOSE_MESSAGE_TOO_BIG : WS_CLOSE_TRY_AGAIN_LATER);
+}
+
+static esp_err_t ws_handler(httpd_req_t* req)
+{
+    int client_fd = httpd_req_to_sockfd(req);
+
+    if (req->method == HTTP_GET)
+    {
+        // Treat handshake as a connect event
+        release_rx_slot(client_fd);
+        ws_core_on_open(client_fd, offers_binary(req));
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t ws_pkt;
+    memset(&ws_pkt, 0, sizeof(httpd_ws_frame_t));
+    ws_pkt.type = HTTPD_WS_TYPE_TEXT;
+
+    esp_err_t ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK)
+    {
+        ESP_LOGW(TAG, "[FRAME_RECV] httpd_ws_recv_frame failed with %d for fd=%d", ret, client_fd);
+        release_rx_slot(client_fd);
+        ws_core_on_close(client_fd);
+        return ret;
+    }
+
+    if (ws_pkt.type == HTTPD_WS_TYPE_CLOSE)
+    {
+        ESP_LOGI(TAG, "[CLOSE] Received CLOSE frame from fd=%d, closing connection", client_fd);
+        return close_with_status(req, client_fd, 0);
+    }
+
+    if (ws_pkt.type == HTTPD_WS_TYPE_PING || ws_pkt.type == HTTPD_WS_TYPE_PONG)
+    {
+        uint8_t ctrl[WS_CONTROL_MAX_PAYLOAD];
+        if (ws_pkt.len > sizeof(ctrl))
+            return close_with_status(req, client_fd, 0);
+        if (ws_pkt.len > 0)
+        {
+            ws_pkt.payload = ctrl;
+            ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+            if (ret != ESP_OK)
+                return ret;
+        }
+        ws_core_on_frame(client_fd, (WsFrameType)ws_pkt.type, ctrl, ws_pkt.len);
+        return ESP_OK;
+    }
+
+    int slot;
+    if (ws_pkt.type == HTTPD_WS_TYPE_CONTINUE)
+    {
+        slot = find_rx_slot(client_fd);
+        if (slot < 0)
+        {
+            ESP_LOGW(TAG, "[FRAME_RECV] Continuation without a first fragment from fd=%d", client_fd);
+            return close_with_status(req, client_fd, 0);
+        }
+    }
+    else
+    {
+        // A new message abandons any unfinished one from the same client
+        release_rx_slot(client_fd);
+        slot = acquire_rx_slot(client_fd, (WsFrameType)ws_pkt.type, !ws_pkt.final);
+        if (slot < 0)
+            return reject_message(req, client_fd, WS_RX_BUSY, ws_pkt.len);
+    }
+
+    rx_slot_t* rx = &s_rx_slots[slot];
+    size_t total = rx->len + ws_pkt.len;
+    if (total > ws_core_max_message_size())
+        return reject_message(req, client_fd, WS_RX_TOO_LARGE, total);
+
+    if (ws_pkt.len > 0)
+    {
+        ws_pkt.payload = s_rx_pool[slot] + rx->len;
+        ret = httpd_ws_recv_frame(req, &ws_pkt, ws_pkt.len);
+        if (ret != ESP_OK)
+        {
+            release_rx_slot(client_fd);
+            return ret;
+        }
+    }
+    rx->len = total;
+
+    if (!ws_pkt.final)
+        return ESP_OK;
+
+    ws_core_on_frame(client_fd, rx->type, s_rx_pool[slot], rx->len);
+    rx->fd = -1;
+    return ESP_OK;
+}
+
+void ws_transport_httpd_register(httpd_handle_t server)
+{
+    s_server = server;
+    for (int i = 0; i < WS_RX_POOL_SIZE; i++)
+        s_rx_slots[i].fd = -1;
+
+    static const httpd_uri_t ws_uri = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .user_ctx = NULL,
+        .is_websocket = true,
+        .handle_ws_control_frames = true,
+        .supported_subprotocol = WS_SUBPROTOCOL_BINARY,
+    };
+
+    httpd_register_uri_handler(server, &ws_uri);
+}
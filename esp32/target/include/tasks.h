@@ -1,5 +1,7 @@
 #pragma once
 
+#include "display_manager.h"
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -23,6 +25,7 @@ extern "C"
     int metric_deaths(void);
     uint32_t metric_respawn_time_left(void);
     bool metric_is_respawning(void);
+    void metric_game_stats(dm_game_stats_t* out);
 
 #ifdef __cplusplus
 }
@@ -159,6 +159,7 @@ extern "C" void app_main(void)
             .deaths = metric_deaths,
             .respawn_time_left = metric_respawn_time_left,
             .is_respawning = metric_is_respawning,
+            .game_stats = metric_game_stats,
         };
 
         if (!display_manager_init(disp, &dm_sources))
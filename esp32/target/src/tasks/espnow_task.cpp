@@ -28,10 +28,14 @@ extern "C" void espnow_task(void* pvParameters)
         vTaskDelay(pdMS_TO_TICKS(200));
     }
 
+    espnow_comm_set_default_filters();
+
     EspnowCommConfig cfg = {
         .channel = wifi_manager_get_channel(),
         .prefer_wifi = true,
         .set_pmk = true,
+        .device_id = s_self_device_id,
+        .batch_window_ms = ESPNOW_BATCH_WINDOW_MS,
     };
 
     if (espnow_comm_init(&cfg) != ESP_OK)
@@ -47,8 +51,17 @@ extern "C" void espnow_task(void* pvParameters)
     EspnowMessageEnvelope env;
     while (1)
     {
-        if (espnow_comm_receive(&env, pdMS_TO_TICKS(500)))
+        espnow_comm_clock_poll();
+        const DeviceConfig* dev = game_state_get_config();
+        espnow_comm_presence_poll(dev->player_id, dev->team_id, dev->color_rgb);
+        espnow_comm_score_poll();
+        // Wakes at least once per delta period, so score changes go out on time on a quiet field
+        if (espnow_comm_receive(&env, pdMS_TO_TICKS(ESPNOW_SCORE_DELTA_MS)))
         {
+            if (env.msg.type == ESPNOW_MSG_HEARTBEAT)
+            {
+                espnow_comm_clock_on_beacon(&env);
+            }
             if (env.msg.type == ESPNOW_MSG_HIT_EVENT && env.msg.device_id == s_self_device_id)
             {
                 game_state_record_hit();
@@ -29,7 +29,9 @@ uint32_t metric_last_hit_ms_ago(void)
 
 int metric_hearts_remaining(void)
 {
-    return (int)game_state_get()->hearts_remaining;
+    GameStateData state;
+    game_state_snapshot(&state);
+    return (int)state.hearts_remaining;
 }
 
 int metric_max_hearts(void)
@@ -39,22 +41,27 @@ int metric_max_hearts(void)
 
 int metric_score(void)
 {
-    return (int)game_state_get()->kills;
+    GameStateData state;
+    game_state_snapshot(&state);
+    return (int)state.kills;
 }
 
 int metric_deaths(void)
 {
-    return (int)game_state_get()->deaths;
+    GameStateData state;
+    game_state_snapshot(&state);
+    return (int)state.deaths;
 }
 
 uint32_t metric_respawn_time_left(void)
 {
-    if (!game_state_is_respawning())
+    GameStateData state;
+    game_state_snapshot(&state);
+    if (!state.respawning)
         return 0;
-    const GameStateData* state = game_state_get();
     uint32_t now = (uint32_t)(esp_timer_get_time() / 1000);
-    if (now < state->respawn_end_time_ms)
-        return state->respawn_end_time_ms - now;
+    if (now < state.respawn_end_time_ms)
+        return state.respawn_end_time_ms - now;
     return 0;
 }
 
@@ -63,6 +70,18 @@ bool metric_is_respawning(void)
     return game_state_is_respawning();
 }
 
+// Hearts and K/D from one snapshot so the idle screen never mixes two states
+void metric_game_stats(dm_game_stats_t* out)
+{
+    GameStateData state;
+    game_state_snapshot(&state);
+    out->hearts = (int)state.hearts_remaining;
+    out->max_hearts = (int)game_state_get_game_config()->max_hearts;
+    out->kills = (int)state.kills;
+    out->deaths = (int)state.deaths;
+    out->shots = (int)state.shots_fired;
+}
+
 extern "C" void game_task_record_hit(void)
 {
     s_hit_count++;
@@ -72,30 +91,29 @@ extern "C" void game_task_record_hit(void)
 extern "C" void game_task(void* pvParameters)
 {
     ESP_LOGI(TAG, "Game task started");
+    game_state_subscribe(xTaskGetCurrentTaskHandle(), GAME_EVT_RESPAWNED);
 
     while (1)
     {
-        // Check win conditions and update game state
-        game_state_tick();
-        
-        const GameStateData* state = game_state_get();
-        if (game_state_is_respawning())
+        // Respawn and the time limit are timers in game_state, and this
+        // device's own kills, hits and deaths are checked as they are recorded.
+        // The wait only bounds how late a win seen in peers' gossip is noticed.
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(1000));
+        if (events & GAME_EVT_RESPAWNED)
         {
-            if (game_state_check_respawn())
-            {
-                ESP_LOGI(TAG, "Respawn complete - ready to receive hits!");
-            }
-            else
-            {
-                vTaskDelay(pdMS_TO_TICKS(100));
-                continue;
-            }
+            ESP_LOGI(TAG, "Respawn complete - ready to receive hits!");
         }
 
+        // Check win conditions and update game state
+        game_state_tick();
+
         static uint32_t last_log = 0;
         uint32_t now = xTaskGetTickCount() / configTICK_RATE_HZ;
         if (now - last_log >= 30)
         {
+            GameStateData state;
+            game_state_snapshot(&state);
             wifi_mode_t wmode = WIFI_MODE_NULL;
             esp_wifi_get_mode(&wmode);
 
@@ -114,12 +132,10 @@ extern "C" void game_task(void* pvParameters)
             else
             {
                 ESP_LOGI(TAG, "Stats | Deaths: %lu | Hits Received: %u | Hearts: %u | WiFi mode: %d | Boot: %s",
-                         (unsigned long)state->deaths, s_hit_count, (unsigned)state->hearts_remaining,
+                         (unsigned long)state.deaths, s_hit_count, (unsigned)state.hearts_remaining,
                          (int)wmode, wifi_manager_get_status_string());
             }
             last_log = now;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
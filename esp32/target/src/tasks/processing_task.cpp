@@ -1,11 +1,14 @@
 #include <esp_log.h>
 #include <esp_timer.h>
 #include <driver/gpio.h>
+#include "clock_sync.h"
 #include "config.h"
 #include "display_manager.h"
 #include "espnow_comm.h"
 #include "game_state.h"
 #include "hash.h"
+#include "match_log.h"
+#include "roster.h"
 #include "task_shared.h"
 #include "tasks.h"
 #include "utils.h"
@@ -23,8 +26,6 @@ extern "C" void processing_task(void* pvParameters)
     ESP_LOGI(TAG, "Processing task started");
     uint32_t message_bits;
 
-    const DeviceConfig* config = game_state_get_config();
-
     uint32_t last_valid_msg = 0;
     uint32_t last_valid_time = 0;
     uint8_t  confirm_count = 0;
@@ -36,6 +37,8 @@ extern "C" void processing_task(void* pvParameters)
             continue;
         }
 
+        // Fetched per message: a config update publishes a new version
+        const DeviceConfig* config = game_state_get_config();
         uint8_t rx_player = 0;
         uint8_t rx_device = 0;
         bool isValid = validateLaserMessage(message_bits, &rx_player, &rx_device);
@@ -45,9 +48,9 @@ extern "C" void processing_task(void* pvParameters)
             continue; // Skip invalid messages silently
         }
 
-        if (game_state_is_respawning())
+        if (game_state_is_respawning() || game_state_is_invulnerable())
         {
-            // Reset confirmation state during respawn
+            // Reset confirmation state during respawn and the grace period after it
             confirm_count = 0;
             last_valid_msg = 0;
             continue;
@@ -76,25 +79,16 @@ extern "C" void processing_task(void* pvParameters)
         confirm_count = 0;
         last_valid_msg = 0;
 
-        // Self-hit check: ignore hits from own player_id
-        if (rx_player == config->player_id)
+        // Self, roster, field and friendly-fire rules, precomputed into one mask (roster.h)
+        if (!roster_admits(rx_player))
         {
-            ESP_LOGD(TAG, "Ignoring self-hit from P:%u", rx_player);
+            if (rx_player == config->player_id)
+                ESP_LOGD(TAG, "Ignoring self-hit from P:%u", rx_player);
+            else
+                ESP_LOGW(TAG, "Ignoring hit from P:%u D:%u (not an admissible shooter)", rx_player, rx_device);
             continue;
         }
 
-        // Roster filter: when connected to server with an active roster,
-        // only accept hits from known players. When offline, accept all.
-        if (ws_server_is_connected() && game_state_get_player_count() > 0)
-        {
-            if (game_state_get_player_name(rx_player) == NULL)
-            {
-                ESP_LOGW(TAG, "Ignoring hit from unknown player P:%u D:%u (not in roster)",
-                         rx_player, rx_device);
-                continue;
-            }
-        }
-
         ESP_LOGI(TAG, "HIT CONFIRMED: Player %u | Device %u", rx_player, rx_device);
 
         gpio_set_level((gpio_num_t)VIBRATION_PIN, 1);
@@ -102,11 +96,11 @@ extern "C" void processing_task(void* pvParameters)
         gpio_set_level((gpio_num_t)VIBRATION_PIN, 0);
 
         // Record hit (decrements health and starts respawn if needed)
+        match_log_append(MLOG_HIT_RECEIVED, rx_player, rx_device, 0);
         game_state_record_death();
         game_task_record_hit();
 
         // Check if player is now respawning (dead)
-        const GameStateData* state = game_state_get();
         bool is_dead = game_state_is_respawning();
 
         // Display notification
@@ -141,10 +135,11 @@ extern "C" void processing_task(void* pvParameters)
         hit_msg.team_id = config->team_id;
         hit_msg.color_rgb = config->color_rgb;
         hit_msg.data = message_bits;
-        hit_msg.timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000);
-        espnow_comm_broadcast(&hit_msg);
+        hit_msg.timestamp_ms = clock_sync_match_ms();
+        // The shooter only gets the kill through this message: repeat it until acknowledged
+        espnow_comm_send_reliable(&hit_msg);
 
-        if (ws_server_is_connected())
+        if (ws_server_has_listeners())
         {
             ws_server_broadcast_hit("unknown");
         }
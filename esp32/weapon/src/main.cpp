@@ -92,6 +92,7 @@ extern "C" void app_main(void)
             .last_rx_ms_ago = metric_last_rx_ms_ago,
             .rx_count = metric_rx_count,
             .tx_count = metric_tx_count,
+            .players_on_field = metric_players_on_field,
             .hit_count = nullptr,
             .last_hit_ms_ago = nullptr,
         };
@@ -1,8 +1,8 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <esp_log.h>
-#include <esp_timer.h>
 #include <driver/gpio.h>
+#include "clock_sync.h"
 #include "config.h"
 #include "espnow_comm.h"
 #include "game_protocol.h"
@@ -53,8 +53,9 @@ void control_task(void* pvParameters)
 
     while (1)
     {
-        const DeviceConfig* config = game_state_get_config();
-        const GameConfig* gcfg = game_state_get_game_config();
+        const DeviceConfig* config;
+        const GameConfig* gcfg;
+        game_state_config_read(&config, &gcfg);
 
         if (game_state_is_respawning())
         {
@@ -98,7 +99,7 @@ void control_task(void* pvParameters)
         shot_msg.team_id = config->team_id;
         shot_msg.color_rgb = config->color_rgb;
         shot_msg.data = laser_msg;
-        shot_msg.timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        shot_msg.timestamp_ms = clock_sync_match_ms();
         if (!espnow_comm_broadcast(&shot_msg))
         {
             ESP_LOGW(TAG, "ESP-NOW shot broadcast failed");
@@ -109,11 +110,12 @@ void control_task(void* pvParameters)
             ESP_LOGW(TAG, "Failed to send to laser queue");
         }
 
+        GameStateData state;
+        game_state_snapshot(&state);
         ESP_LOGI(TAG, "[Laser] %lu ms | %s | Shots: %lu", pdTICKS_TO_MS(xTaskGetTickCount()),
-                 toBinaryString(laser_msg, MESSAGE_TOTAL_BITS).c_str(),
-                 (unsigned long)game_state_get()->shots_fired);
+                 toBinaryString(laser_msg, MESSAGE_TOTAL_BITS).c_str(), (unsigned long)state.shots_fired);
 
-        if (ws_server_is_connected())
+        if (ws_server_has_listeners())
         {
             ws_server_broadcast_shot();
         }
@@ -11,36 +11,33 @@ static const char* TAG = "GameTask";
 void game_task(void* pvParameters)
 {
     ESP_LOGI(TAG, "Game task started");
+    game_state_subscribe(xTaskGetCurrentTaskHandle(), GAME_EVT_RESPAWNED);
 
     while (1)
     {
-        // Check win conditions and update game state
-        game_state_tick();
-        
-        const GameStateData* state = game_state_get();
-        if (game_state_is_respawning())
+        // Respawn and the time limit are timers in game_state, and this
+        // device's own kills, hits and deaths are checked as they are recorded.
+        // The wait only bounds how late a win seen in peers' gossip is noticed.
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(1000));
+        if (events & GAME_EVT_RESPAWNED)
         {
-            if (game_state_check_respawn())
-            {
-                ESP_LOGI(TAG, "Respawn complete - ready to play!");
-            }
-            else
-            {
-                vTaskDelay(pdMS_TO_TICKS(100));
-                continue;
-            }
+            ESP_LOGI(TAG, "Respawn complete - ready to play!");
         }
 
+        // Check win conditions and update game state
+        game_state_tick();
+
         static uint32_t last_log = 0;
         uint32_t now = xTaskGetTickCount() / configTICK_RATE_HZ;
         if (now - last_log >= 30)
         {
+            GameStateData state;
+            game_state_snapshot(&state);
             ESP_LOGI(TAG, "Stats | K/D: %lu/%lu | Shots: %lu | Hits: %lu | Hearts: %u | Score: %lu",
-                     (unsigned long)state->kills, (unsigned long)state->deaths, (unsigned long)state->shots_fired,
-                     (unsigned long)state->hits_landed, (unsigned)state->hearts_remaining, (unsigned long)state->player_score);
+                     (unsigned long)state.kills, (unsigned long)state.deaths, (unsigned long)state.shots_fired,
+                     (unsigned long)state.hits_landed, (unsigned)state.hearts_remaining, (unsigned long)state.player_score);
             last_log = now;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
@@ -36,24 +36,28 @@ void ws_task(void* pvParameters)
     }
 
     ESP_LOGI(TAG, "WiFi connected, WebSocket server already running");
+    game_state_subscribe(xTaskGetCurrentTaskHandle(),
+                         GAME_EVT_RESPAWNED | GAME_EVT_GAME_OVER | GAME_EVT_HEARTBEAT_DUE);
 
     while (1)
     {
+        // Game events wake the task at once; the timeout is for the stale client sweep
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(5000));
+
         // Cleanup stale clients (handles browser refresh without close frame)
         ws_server_cleanup_stale();
 
-        // Only send status periodically if connected (heartbeat mechanism)
+        // Only send status periodically if someone listens (heartbeat mechanism)
         // Frontend can also request status explicitly via OP_GET_STATUS
-        if (ws_server_is_connected() && game_state_heartbeat_due())
+        if (ws_server_has_listeners() && (events & (GAME_EVT_HEARTBEAT_DUE | GAME_EVT_GAME_OVER)))
         {
             ws_server_send_status();
         }
 
-        if (game_state_check_respawn())
+        if (events & GAME_EVT_RESPAWNED)
         {
             ws_server_broadcast_respawn();
         }
-
-        vTaskDelay(pdMS_TO_TICKS(5000)); // Check every 5 seconds instead of 1
     }
 }
@@ -0,0 +1,385 @@
+/**
+ * Protocol Code Generator
+ *
+ * Turns protocol_def.json into the firmware's protocol sources:
+ *   - game_protocol_gen.h  OpCode / GameCommandType enums
+ *   - ws_protocol_gen.h    message body structs, `present` field indices,
+ *                          the WsMessage union and the dispatch table type
+ *   - ws_protocol_gen.cpp  constexpr field tables read by the JSON and binary
+ *                          codecs, O(1) opcode lookup, topics and dispatch
+ * and the ws-bridge's binary decoder table (binaryMessages.ts).
+ *
+ * Used by validate-protocol.js; see there for the command line.
+ */
+
+const path = require("path");
+
+const ROOT = path.join(__dirname, "..");
+const HEADER_NOTE = "Generated by scripts/validate-protocol.js from protocol_def.json - do not edit.";
+
+// protocol_def.json type -> C type, codec field type, ws-bridge field type
+const TYPES = {
+  bool: { c: "bool", ft: "WS_FT_BOOL", ts: "bool" },
+  uint8_t: { c: "uint8_t", ft: "WS_FT_U8", ts: "u8" },
+  uint16_t: { c: "uint16_t", ft: "WS_FT_U16", ts: "u16" },
+  uint32_t: { c: "uint32_t", ft: "WS_FT_U32", ts: "u32" },
+  int8_t: { c: "int8_t", ft: "WS_FT_I8", ts: "i8" },
+  string: { c: "char", ft: "WS_FT_STR", ts: "str" },
+  players: { c: "WsPlayerList", ft: "WS_FT_PLAYERS", ts: "players" },
+};
+
+function snake(name) {
+  return name.replace(/([a-z0-9])([A-Z])/g, "$1_$2").toLowerCase();
+}
+
+// Normalized view of protocol_def.json shared by all emitters
+function loadModel(def) {
+  const errors = [];
+  const opcodes = def.enums.OpCode.values;
+  const messages = [];
+
+  for (const [direction, list] of Object.entries(def.messages)) {
+    for (const m of list) {
+      if (!(m.opcode in opcodes)) {
+        errors.push(`message ${m.name}: unknown opcode ${m.opcode}`);
+        continue;
+      }
+      const fields = m.fields.map((f) => {
+        const dot = f.name.lastIndexOf(".");
+        const group = dot >= 0 ? f.name.slice(0, dot) : null;
+        const key = dot >= 0 ? f.name.slice(dot + 1) : f.name;
+        let type = TYPES[f.type];
+        let comment = f.note || null;
+        if (!type && def.enums[f.type]) {
+          type = { ...TYPES[def.enums[f.type].type], enumName: f.type };
+          comment = comment || f.type;
+        }
+        if (!type) errors.push(`message ${m.name}: field ${f.name} has unknown type ${f.type}`);
+        if (f.type === "string" && !f.size) errors.push(`message ${m.name}: string field ${f.name} needs a size`);
+        return {
+          key,
+          group,
+          member: f.member || key,
+          optional: !f.required,
+          size: f.size,
+          type: type || TYPES.uint8_t,
+          comment,
+        };
+      });
+      const member = snake(m.name);
+      messages.push({
+        name: m.name,
+        direction,
+        opcode: m.opcode,
+        op: opcodes[m.opcode],
+        typeName: m.opcode.toLowerCase(),
+        struct: `Ws${m.name}Msg`,
+        member,
+        table: `s_${member}_fields`,
+        prefix: m.field_prefix || `WS_${member.toUpperCase()}`,
+        topic: m.topic || null,
+        fields,
+        presence: fields.some((f) => f.optional),
+      });
+    }
+  }
+  return { def, messages, errors };
+}
+
+// Pads trailing comments of consecutive lines to a common column, like clang-format
+function alignComments(lines) {
+  const out = [];
+  let run = [];
+  const flush = () => {
+    const width = Math.max(...run.map((l) => l.code.length));
+    for (const l of run) out.push(`${l.code.padEnd(width)} // ${l.comment}`);
+    run = [];
+  };
+  for (const l of lines) {
+    if (l.comment) {
+      run.push(l);
+      continue;
+    }
+    if (run.length) flush();
+    out.push(l.code);
+  }
+  if (run.length) flush();
+  return out;
+}
+
+function fileHeader() {
+  return `// ${HEADER_NOTE}\n`;
+}
+
+// ----------------------------------------------------------------------------
+// game_protocol_gen.h
+// ----------------------------------------------------------------------------
+
+function emitEnumsHeader(model) {
+  const { def, messages } = model;
+  const direction = {};
+  for (const m of messages) direction[m.opcode] = m.direction;
+
+  const out = [fileHeader(), "#pragma once\n", "#ifdef __cplusplus", 'extern "C"', "{", "#endif", ""];
+
+  out.push(`    // WebSocket Protocol v${def.version} OpCodes`);
+  out.push("    typedef enum", "    {");
+  const ops = Object.entries(def.enums.OpCode.values);
+  let last = null;
+  ops.forEach(([name, value], i) => {
+    const dir = direction[name] || last;
+    if (dir !== last) {
+      if (last) out.push("");
+      out.push(dir === "client_to_esp32" ? "        // Client -> ESP32" : "        // ESP32 -> Client");
+      last = dir;
+    }
+    out.push(`        OP_${name} = ${value}${i < ops.length - 1 ? "," : ""}`);
+  });
+  out.push("    } OpCode;", "");
+
+  const cmds = Object.entries(def.enums.GameCommandType.values);
+  out.push("    typedef enum", "    {");
+  cmds.forEach(([name, value], i) => out.push(`        CMD_${name} = ${value}${i < cmds.length - 1 ? "," : ""}`));
+  out.push("    } GameCommandType;", "");
+
+  out.push("#ifdef __cplusplus", "}", "#endif", "");
+  return out.join("\n");
+}
+
+// ----------------------------------------------------------------------------
+// ws_protocol_gen.h
+// ----------------------------------------------------------------------------
+
+function emitStruct(m) {
+  const lines = [];
+  if (m.presence) lines.push({ code: "        uint32_t present;" });
+  let group = null;
+  for (const f of m.fields) {
+    if (f.group && f.group !== group) lines.push({ code: `        // ${f.group}` });
+    group = f.group;
+    const decl =
+      f.type.ft === "WS_FT_STR" ? `char ${f.member}[${f.size}];` : `${f.type.c} ${f.member};`;
+    lines.push({ code: `        ${decl}`, comment: f.comment });
+  }
+  return ["    typedef struct", "    {", ...alignComments(lines), `    } ${m.struct};`, ""];
+}
+
+function emitFieldEnum(m) {
+  const out = [`    // Field indices of ${m.struct}, for testing \`present\``, "    typedef enum", "    {"];
+  m.fields.forEach((f, i) => out.push(`        ${m.prefix}_${f.member.toUpperCase()}${i === 0 ? " = 0" : ""},`));
+  out.push(`    } Ws${m.name}Field;`, "");
+  return out;
+}
+
+function handlerSignature(m) {
+  return m.fields.length ? `(int fd, const ${m.struct}* msg)` : "(int fd)";
+}
+
+function emitMessagesHeader(model) {
+  const { messages } = model;
+  const out = [fileHeader(), "#pragma once\n", '#include "ws_protocol.h"', "", "#ifdef __cplusplus", 'extern "C"', "{", "#endif", ""];
+
+  out.push("    // ============================================================================");
+  out.push("    // MESSAGE BODIES");
+  out.push("    // ============================================================================");
+  out.push("");
+  const sections = [
+    ["client_to_esp32", "client -> ESP32"],
+    ["esp32_to_client", "ESP32 -> client"],
+  ];
+  for (const [dir, title] of sections) {
+    out.push(`    // ---------------------------------------------------------------- ${title}`, "");
+    for (const m of messages.filter((x) => x.direction === dir && x.fields.length)) {
+      out.push(...emitStruct(m));
+      if (m.presence) out.push(...emitFieldEnum(m));
+    }
+  }
+
+  out.push("    /**", "     * @brief Storage large enough for any decoded message body", "     */");
+  out.push("    typedef struct", "    {", "        uint8_t op;", "        union", "        {");
+  for (const m of messages.filter((x) => x.fields.length)) out.push(`            ${m.struct} ${m.member};`);
+  out.push("        };", "    } WsMessage;", "");
+
+  out.push("    // ============================================================================");
+  out.push("    // DISPATCH");
+  out.push("    // ============================================================================");
+  out.push("");
+  out.push("    /**", "     * @brief Handlers for client -> ESP32 messages (NULL = not handled)", "     */");
+  out.push("    typedef struct", "    {");
+  for (const m of messages.filter((x) => x.direction === "client_to_esp32"))
+    out.push(`        void (*${m.member})${handlerSignature(m)};`);
+  out.push("    } WsClientHandlers;", "");
+  out.push("    /**");
+  out.push("     * @brief Call the handler for a decoded client message");
+  out.push("     * @return false if the opcode is not a client message or its handler is NULL");
+  out.push("     */");
+  out.push("    bool ws_protocol_dispatch(const WsClientHandlers* handlers, int fd, const WsMessage* msg);", "");
+
+  out.push("#ifdef __cplusplus", "}", "#endif", "");
+  return out.join("\n");
+}
+
+// ----------------------------------------------------------------------------
+// ws_protocol_gen.cpp
+// ----------------------------------------------------------------------------
+
+function fieldEntry(m, f) {
+  const flags = f.optional ? "WS_FIELD_OPTIONAL" : "0";
+  if (f.key !== f.member || (f.group && f.optional))
+    return `WS_FIELD(${m.struct}, ${f.member}, "${f.key}", ${f.group ? `"${f.group}"` : "NULL"}, ${f.type.ft}, ${flags})`;
+  if (f.group) return `WS_GRP(${m.struct}, ${f.member}, "${f.group}", ${f.type.ft})`;
+  return `${f.optional ? "WS_OPT" : "WS_REQ"}(${m.struct}, ${f.member}, ${f.type.ft})`;
+}
+
+function emitSource(model) {
+  const { messages } = model;
+  const out = [fileHeader(), '#include "ws_protocol.h"', "#include <string.h>", ""];
+  out.push("// Field tables for every opcode. Order matters: it is the binary wire order and");
+  out.push("// the bit index in `present`. Both codecs walk these tables.", "");
+  out.push("#define WS_FIELD(T, member, key, group, type, flags)                                                                   \\");
+  out.push("    {key, group, (uint16_t)offsetof(T, member), (uint16_t)sizeof(((T*)0)->member), type, flags}");
+  out.push("#define WS_REQ(T, member, type) WS_FIELD(T, member, #member, NULL, type, 0)");
+  out.push("#define WS_OPT(T, member, type) WS_FIELD(T, member, #member, NULL, type, WS_FIELD_OPTIONAL)");
+  out.push("#define WS_GRP(T, member, group, type) WS_FIELD(T, member, #member, group, type, 0)");
+  out.push("#define WS_MSG(op, name, T, fields, presence)                                                                          \\");
+  out.push("    {op, name, fields, (uint8_t)(sizeof(fields) / sizeof(fields[0])), (uint16_t)sizeof(T), presence}");
+  out.push("#define WS_MSG_EMPTY(op, name) {op, name, NULL, 0, 0, false}", "");
+
+  for (const m of messages.filter((x) => x.fields.length)) {
+    out.push(`static constexpr WsFieldDesc ${m.table}[] = {`);
+    for (const f of m.fields) out.push(`    ${fieldEntry(m, f)},`);
+    out.push("};", "");
+  }
+
+  out.push("static constexpr WsMessageDesc s_messages[] = {");
+  let last = null;
+  for (const m of messages) {
+    if (m.direction !== last) {
+      if (last) out.push("");
+      out.push(m.direction === "client_to_esp32" ? "    // Client -> ESP32" : "    // ESP32 -> Client");
+      last = m.direction;
+    }
+    if (m.fields.length)
+      out.push(`    WS_MSG(OP_${m.opcode}, "${m.typeName}", ${m.struct}, ${m.table}, ${m.presence}),`);
+    else out.push(`    WS_MSG_EMPTY(OP_${m.opcode}, "${m.typeName}"),`);
+  }
+  out.push("};", "");
+
+  const maxOp = Math.max(...messages.map((m) => m.op));
+  const byOp = new Array(maxOp + 1).fill(-1);
+  messages.forEach((m, i) => (byOp[m.op] = i));
+  out.push("// Opcode -> index into s_messages, -1 if unused");
+  out.push(`static constexpr int8_t s_by_op[${maxOp + 1}] = {${byOp.join(", ")}};`, "");
+
+  const byType = messages
+    .map((m, i) => ({ name: m.typeName, i }))
+    .sort((a, b) => (a.name < b.name ? -1 : a.name > b.name ? 1 : 0))
+    .map((x) => x.i);
+  out.push("// s_messages indices sorted by type name, for the legacy \"type\" lookup");
+  out.push(`static constexpr uint8_t s_by_type[${byType.length}] = {${byType.join(", ")}};`, "");
+
+  out.push("const WsMessageDesc* ws_protocol_find(uint8_t op)");
+  out.push("{");
+  out.push("    if (op >= sizeof(s_by_op) || s_by_op[op] < 0)");
+  out.push("        return NULL;");
+  out.push("    return &s_messages[s_by_op[op]];");
+  out.push("}", "");
+
+  out.push("const WsMessageDesc* ws_protocol_find_by_type(const char* type_name)");
+  out.push("{");
+  out.push("    if (!type_name)");
+  out.push("        return NULL;");
+  out.push("    size_t lo = 0;");
+  out.push("    size_t hi = sizeof(s_by_type);");
+  out.push("    while (lo < hi)");
+  out.push("    {");
+  out.push("        size_t mid = (lo + hi) / 2;");
+  out.push("        const WsMessageDesc* desc = &s_messages[s_by_type[mid]];");
+  out.push("        int cmp = strcmp(type_name, desc->type_name);");
+  out.push("        if (cmp == 0)");
+  out.push("            return desc;");
+  out.push("        if (cmp < 0)");
+  out.push("            hi = mid;");
+  out.push("        else");
+  out.push("            lo = mid + 1;");
+  out.push("    }");
+  out.push("    return NULL;");
+  out.push("}", "");
+
+  out.push("uint32_t ws_protocol_topic(uint8_t op)");
+  out.push("{");
+  out.push("    switch (op)");
+  out.push("    {");
+  const topics = [...new Set(messages.filter((m) => m.topic).map((m) => m.topic))];
+  for (const t of topics) {
+    for (const m of messages.filter((x) => x.topic === t)) out.push(`        case OP_${m.opcode}:`);
+    out.push(`            return WS_TOPIC_${t};`);
+  }
+  out.push("        default:");
+  out.push("            return 0;");
+  out.push("    }");
+  out.push("}", "");
+
+  out.push("bool ws_protocol_dispatch(const WsClientHandlers* handlers, int fd, const WsMessage* msg)");
+  out.push("{");
+  out.push("    if (!handlers || !msg)");
+  out.push("        return false;");
+  out.push("    switch (msg->op)");
+  out.push("    {");
+  for (const m of messages.filter((x) => x.direction === "client_to_esp32")) {
+    out.push(`        case OP_${m.opcode}:`);
+    out.push(`            if (!handlers->${m.member})`);
+    out.push("                return false;");
+    out.push(`            handlers->${m.member}(fd${m.fields.length ? `, &msg->${m.member}` : ""});`);
+    out.push("            return true;");
+  }
+  out.push("        default:");
+  out.push("            return false;");
+  out.push("    }");
+  out.push("}", "");
+  return out.join("\n");
+}
+
+// ----------------------------------------------------------------------------
+// web/apps/ws-bridge/src/binaryMessages.ts
+// ----------------------------------------------------------------------------
+
+function emitBridgeTable(model) {
+  const out = [fileHeader(), "import type { MessageDef } from './binaryCodec.js'", ""];
+  out.push("// ESP32 -> client messages only; the bridge forwards client messages as JSON.");
+  out.push("export const MESSAGES: Record<number, MessageDef> = {");
+  for (const m of model.messages.filter((x) => x.direction === "esp32_to_client")) {
+    const fields = m.fields.map((f) => {
+      const parts = [`key: '${f.key}'`, `type: '${f.type.ts}'`];
+      if (f.group) parts.push(`group: '${f.group}'`);
+      if (f.optional) parts.push("optional: true");
+      return `{ ${parts.join(", ")} }`;
+    });
+    if (!fields.length) {
+      out.push(`  ${m.op}: { type: '${m.typeName}', presence: ${m.presence}, fields: [] },`);
+      continue;
+    }
+    out.push(`  ${m.op}: {`, `    type: '${m.typeName}',`, `    presence: ${m.presence},`, "    fields: [");
+    for (const f of fields) out.push(`      ${f},`);
+    out.push("    ],", "  },");
+  }
+  out.push("}", "");
+  return out.join("\n");
+}
+
+/**
+ * Generate every output file
+ * @returns {{files: Array<{path: string, content: string}>, errors: string[]}}
+ */
+function generate(def) {
+  const model = loadModel(def);
+  const files = [
+    { path: "esp32/shared/include/game_protocol_gen.h", content: emitEnumsHeader(model) },
+    { path: "esp32/shared/include/ws_protocol_gen.h", content: emitMessagesHeader(model) },
+    { path: "esp32/shared/src/ws_protocol_gen.cpp", content: emitSource(model) },
+    { path: "web/apps/ws-bridge/src/binaryMessages.ts", content: emitBridgeTable(model) },
+  ].map((f) => ({ ...f, absPath: path.join(ROOT, f.path) }));
+  return { files, errors: model.errors };
+}
+
+module.exports = { generate };
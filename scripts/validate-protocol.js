@@ -4,13 +4,17 @@
  * Protocol Validator Script
  *
  * This script validates that both the C++ firmware headers and TypeScript types
- * match the protocol definition in protocol_def.json
+ * match the protocol definition in protocol_def.json. The firmware's enums,
+ * message structs, field tables and dispatch are generated from it (see
+ * protocol-codegen.js); validation fails if the generated files are stale.
  *
- * Usage: node scripts/validate-protocol.js
+ * Usage: node scripts/validate-protocol.js             validate
+ *        node scripts/validate-protocol.js --generate  rewrite the generated files
  */
 
 const fs = require("fs");
 const path = require("path");
+const { generate } = require("./protocol-codegen");
 
 const PROTOCOL_DEF_PATH = path.join(__dirname, "..", "protocol_def.json");
 const TYPESCRIPT_PROTOCOL_PATH = path.join(
@@ -42,8 +46,37 @@ try {
   const protocolDef = JSON.parse(fs.readFileSync(PROTOCOL_DEF_PATH, "utf8"));
   const tsProtocolContent = fs.readFileSync(TYPESCRIPT_PROTOCOL_PATH, "utf8");
 
+  const generated = generate(protocolDef);
+  for (const error of generated.errors) {
+    logError(error);
+  }
+
+  if (process.argv.includes("--generate")) {
+    if (hasErrors) {
+      process.exit(1);
+    }
+    for (const file of generated.files) {
+      fs.writeFileSync(file.absPath, file.content);
+      console.log(`Generated ${file.path}`);
+    }
+    process.exit(0);
+  }
+
   console.log("\n=== Protocol Validation ===\n");
 
+  // Check generated firmware/bridge sources
+  console.log("Validating generated sources...");
+  for (const file of generated.files) {
+    const current = fs.existsSync(file.absPath) ? fs.readFileSync(file.absPath, "utf8") : null;
+    if (current !== file.content) {
+      logError(`${file.path} is out of date (run node scripts/validate-protocol.js --generate)`);
+    }
+  }
+
+  if (!hasErrors) {
+    logSuccess("Generated sources are up to date");
+  }
+
   // Check OpCode enum
   console.log("Validating OpCode enum...");
   const opCodeDef = protocolDef.enums.OpCode.values;
@@ -76,6 +109,23 @@ try {
     logSuccess("All GameCommandType values match");
   }
 
+  // Check Topic enum (TypeScript writes the bits as shifts)
+  console.log("\nValidating Topic enum...");
+  const topicDef = protocolDef.enums.Topic.values;
+  const topicBlock = (tsProtocolContent.match(/export enum Topic \{([^}]*)\}/) || [])[1] || "";
+
+  for (const [name, value] of Object.entries(topicDef)) {
+    const match = topicBlock.match(new RegExp(`\\b${name}\\s*=\\s*(?:1\\s*<<\\s*(\\d+)|(\\d+))`));
+    const tsValue = match ? (match[1] !== undefined ? 1 << Number(match[1]) : Number(match[2])) : null;
+    if (tsValue !== value) {
+      logError(`Topic.${name} = ${value} not found in TypeScript protocol`);
+    }
+  }
+
+  if (!hasErrors) {
+    logSuccess("All Topic values match");
+  }
+
   console.log("\n=== Validation Summary ===");
 
   if (!hasErrors) {
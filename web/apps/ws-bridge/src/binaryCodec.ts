@@ -0,0 +1,115 @@
+/**
+ * Decoder for the compact binary WebSocket codec ("rayz-bin" subprotocol).
+ *
+ * The message table (binaryMessages.ts) is generated from protocol_def.json,
+ * like the firmware's field tables. Frames are
+ * [version u8][op u8][present u32 LE, optional][fields...] and decode to the
+ * same object shape the firmware's JSON codec emits, so the rest of the bridge
+ * does not care which codec a device uses.
+ */
+
+import { MESSAGES } from './binaryMessages.js'
+
+export const BINARY_SUBPROTOCOL = 'rayz-bin'
+const BINARY_VERSION = 1
+
+export type FieldType = 'bool' | 'u8' | 'u16' | 'u32' | 'i8' | 'str' | 'players'
+
+export interface Field {
+  key: string
+  type: FieldType
+  group?: string
+  optional?: boolean
+}
+
+export interface MessageDef {
+  type: string
+  presence: boolean
+  fields: Field[]
+}
+
+class Reader {
+  private pos = 0
+  constructor(private readonly buf: Buffer) {}
+
+  private need(n: number) {
+    if (this.pos + n > this.buf.length) throw new Error('truncated binary frame')
+  }
+  u8(): number {
+    this.need(1)
+    return this.buf.readUInt8(this.pos++)
+  }
+  i8(): number {
+    this.need(1)
+    return this.buf.readInt8(this.pos++)
+  }
+  u16(): number {
+    this.need(2)
+    const v = this.buf.readUInt16LE(this.pos)
+    this.pos += 2
+    return v
+  }
+  u32(): number {
+    this.need(4)
+    const v = this.buf.readUInt32LE(this.pos)
+    this.pos += 4
+    return v
+  }
+  str(): string {
+    const len = this.u8()
+    this.need(len)
+    const s = this.buf.toString('utf8', this.pos, this.pos + len)
+    this.pos += len
+    return s
+  }
+}
+
+function readField(r: Reader, type: FieldType): unknown {
+  switch (type) {
+    case 'bool':
+      return r.u8() !== 0
+    case 'u8':
+      return r.u8()
+    case 'i8':
+      return r.i8()
+    case 'u16':
+      return r.u16()
+    case 'u32':
+      return r.u32()
+    case 'str':
+      return r.str()
+    case 'players': {
+      const count = r.u8()
+      const players = []
+      for (let i = 0; i < count; i++) players.push({ id: r.u8(), name: r.str() })
+      return players
+    }
+  }
+}
+
+/**
+ * Decode a binary frame into the equivalent JSON message object.
+ * Throws on unknown opcodes, version mismatch or truncated frames.
+ */
+export function decodeBinaryMessage(buf: Buffer): Record<string, unknown> {
+  const r = new Reader(buf)
+  const version = r.u8()
+  if (version !== BINARY_VERSION) throw new Error(`unsupported binary version ${version}`)
+  const op = r.u8()
+  const def = MESSAGES[op]
+  if (!def) throw new Error(`unknown binary opcode ${op}`)
+
+  const out: Record<string, unknown> = { op, type: def.type }
+  const present = def.presence ? r.u32() : 0
+  def.fields.forEach((f, i) => {
+    if (f.optional && !(present & (1 << i))) return
+    const value = readField(r, f.type)
+    if (f.group) {
+      const group = (out[f.group] ??= {}) as Record<string, unknown>
+      group[f.key] = value
+    } else {
+      out[f.key] = value
+    }
+  })
+  return out
+}
@@ -0,0 +1,127 @@
+// Generated by scripts/validate-protocol.js from protocol_def.json - do not edit.
+
+import type { MessageDef } from './binaryCodec.js'
+
+// ESP32 -> client messages only; the bridge forwards client messages as JSON.
+export const MESSAGES: Record<number, MessageDef> = {
+  10: {
+    type: 'status',
+    presence: false,
+    fields: [
+      { key: 'uptime_ms', type: 'u32' },
+      { key: 'seq_id', type: 'u32' },
+      { key: 'device_id', type: 'u8', group: 'config' },
+      { key: 'player_id', type: 'u8', group: 'config' },
+      { key: 'team_id', type: 'u8', group: 'config' },
+      { key: 'color_rgb', type: 'u32', group: 'config' },
+      { key: 'device_name', type: 'str', group: 'config' },
+      { key: 'enable_hearts', type: 'bool', group: 'config' },
+      { key: 'max_hearts', type: 'u8', group: 'config' },
+      { key: 'spawn_hearts', type: 'u8', group: 'config' },
+      { key: 'respawn_time_s', type: 'u16', group: 'config' },
+      { key: 'friendly_fire', type: 'bool', group: 'config' },
+      { key: 'enable_ammo', type: 'bool', group: 'config' },
+      { key: 'max_ammo', type: 'u16', group: 'config' },
+      { key: 'reload_time_ms', type: 'u16', group: 'config' },
+      { key: 'game_duration_s', type: 'u16', group: 'config' },
+      { key: 'shots', type: 'u32', group: 'stats' },
+      { key: 'enemy_kills', type: 'u32', group: 'stats' },
+      { key: 'friendly_kills', type: 'u32', group: 'stats' },
+      { key: 'deaths', type: 'u32', group: 'stats' },
+      { key: 'current_hearts', type: 'u8', group: 'state' },
+      { key: 'current_ammo', type: 'u16', group: 'state' },
+      { key: 'is_respawning', type: 'bool', group: 'state' },
+      { key: 'is_reloading', type: 'bool', group: 'state' },
+      { key: 'match_ms', type: 'u32', group: 'clock' },
+      { key: 'stratum', type: 'u8', group: 'clock' },
+    ],
+  },
+  11: { type: 'heartbeat_ack', presence: false, fields: [] },
+  12: {
+    type: 'shot_fired',
+    presence: false,
+    fields: [
+      { key: 'timestamp_ms', type: 'u32' },
+      { key: 'seq_id', type: 'u32' },
+      { key: 'match_ms', type: 'u32' },
+    ],
+  },
+  13: {
+    type: 'hit_report',
+    presence: false,
+    fields: [
+      { key: 'timestamp_ms', type: 'u32' },
+      { key: 'shooter_id', type: 'u8' },
+      { key: 'seq_id', type: 'u32' },
+      { key: 'match_ms', type: 'u32' },
+    ],
+  },
+  14: {
+    type: 'respawn',
+    presence: false,
+    fields: [
+      { key: 'timestamp_ms', type: 'u32' },
+      { key: 'current_hearts', type: 'u8' },
+      { key: 'seq_id', type: 'u32' },
+      { key: 'match_ms', type: 'u32' },
+    ],
+  },
+  15: {
+    type: 'reload_event',
+    presence: false,
+    fields: [
+      { key: 'current_ammo', type: 'u16' },
+    ],
+  },
+  16: {
+    type: 'game_over',
+    presence: true,
+    fields: [
+      { key: 'win_type', type: 'str', optional: true },
+      { key: 'winner_team_id', type: 'u8', optional: true },
+      { key: 'winner_player_id', type: 'u8', optional: true },
+      { key: 'match_duration_s', type: 'u16', optional: true },
+    ],
+  },
+  17: {
+    type: 'game_state_update',
+    presence: true,
+    fields: [
+      { key: 'game_running', type: 'bool' },
+      { key: 'game_over', type: 'bool' },
+      { key: 'time_remaining_s', type: 'u16', optional: true },
+      { key: 'total_kills', type: 'u32', optional: true },
+      { key: 'total_shots', type: 'u32', optional: true },
+      { key: 'total_hits', type: 'u32', optional: true },
+    ],
+  },
+  18: {
+    type: 'resume_result',
+    presence: false,
+    fields: [
+      { key: 'from_seq_id', type: 'u32' },
+      { key: 'to_seq_id', type: 'u32' },
+      { key: 'replayed', type: 'u16' },
+      { key: 'snapshot', type: 'bool' },
+    ],
+  },
+  22: {
+    type: 'time_sync_reply',
+    presence: false,
+    fields: [
+      { key: 'ref_ms', type: 'u32' },
+      { key: 'match_ms', type: 'u32' },
+      { key: 'stratum', type: 'u8' },
+    ],
+  },
+  20: {
+    type: 'ack',
+    presence: true,
+    fields: [
+      { key: 'reply_to', type: 'str', optional: true },
+      { key: 'success', type: 'bool' },
+      { key: 'code', type: 'str', group: 'error', optional: true },
+      { key: 'message', type: 'str', group: 'error', optional: true },
+    ],
+  },
+}
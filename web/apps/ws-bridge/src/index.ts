@@ -12,12 +12,14 @@
 
 import type { IncomingMessage } from 'http'
 import { WebSocket, WebSocketServer } from 'ws'
+import { BINARY_SUBPROTOCOL, decodeBinaryMessage } from './binaryCodec.js'
 import { DeviceDiscovery, type DiscoveredDevice } from './discovery.js'
 
 // Configuration
 const PORT = parseInt(process.env.WS_BRIDGE_PORT ?? '8080', 10)
 const DEVICE_RECONNECT_DELAY = 3000
 const HEARTBEAT_INTERVAL = 30000
+const TIME_SYNC_INTERVAL = 2000
 const ENABLE_AUTO_DISCOVERY = process.env.ENABLE_AUTO_DISCOVERY !== 'false' // Enabled by default
 
 interface DeviceConnection {
@@ -31,6 +33,12 @@ interface DeviceConnection {
   deviceId?: number
   playerId?: number
   version?: string
+  // Set when the firmware predates the binary codec and rejects the subprotocol
+  jsonOnly?: boolean
+  // Highest shot/hit/respawn seq_id forwarded from this device, sent back on reconnect
+  lastSeqId?: number
+  // Last TIME_SYNC round: our ref_ms and when its reply arrived (match clock ms)
+  timeSync?: { refMs: number; rxMs?: number }
 }
 
 interface BrowserMessage {
@@ -50,12 +58,16 @@ class WsBridge {
   private browserClients: Set<WebSocket> = new Set()
   private devices: Map<string, DeviceConnection> = new Map()
   private heartbeatTimer: NodeJS.Timeout | null = null
+  private timeSyncTimer: NodeJS.Timeout | null = null
+  // The match clock devices synchronize to: milliseconds since the bridge started
+  private readonly matchEpoch = performance.now()
   private discovery: DeviceDiscovery | null = null
 
   constructor(port: number) {
     this.server = new WebSocketServer({ port })
     this.setupServer()
     this.startHeartbeat()
+    this.startTimeSync()
 
     // Start mDNS discovery if enabled
     if (ENABLE_AUTO_DISCOVERY) {
@@ -227,7 +239,9 @@ class WsBridge {
     console.log(`[WsBridge] Connecting to device ${ip}...`)
 
     try {
-      const ws = new WebSocket(wsUrl, {
+      // Offer the binary codec; devices that don't support it answer in JSON
+      const protocols = device.jsonOnly ? [] : [BINARY_SUBPROTOCOL]
+      const ws = new WebSocket(wsUrl, protocols, {
         handshakeTimeout: 5000,
       })
 
@@ -236,9 +250,15 @@ class WsBridge {
         device.ws = ws
         device.connected = true
         device.reconnecting = false
-
-        // Request initial status
-        ws.send(JSON.stringify({ op: 1, type: 'get_status' }))
+        device.timeSync = undefined
+
+        // Resume from the last event we forwarded (the device replays what we
+        // missed and sends a fresh status), or just request the initial status
+        if (device.lastSeqId !== undefined) {
+          ws.send(JSON.stringify({ op: 8, type: 'resume', last_seq_id: device.lastSeqId }))
+        } else {
+          ws.send(JSON.stringify({ op: 1, type: 'get_status' }))
+        }
 
         // Notify browsers
         this.broadcastToBrowsers({
@@ -247,9 +267,9 @@ class WsBridge {
         })
       })
 
-      ws.on('message', (data: Buffer) => {
+      ws.on('message', (data: Buffer, isBinary: boolean) => {
         try {
-          const payload = JSON.parse(data.toString())
+          const payload = isBinary ? decodeBinaryMessage(data) : JSON.parse(data.toString())
           this.handleDeviceMessage(ip, payload)
         } catch (err) {
           console.error(`[WsBridge] Failed to parse device message from ${ip}:`, err)
@@ -278,6 +298,10 @@ class WsBridge {
 
       ws.on('error', (err: Error) => {
         console.error(`[WsBridge] Device ${ip} error:`, err.message)
+        if (err.message.includes('subprotocol')) {
+          console.log(`[WsBridge] Device ${ip} does not support ${BINARY_SUBPROTOCOL}, falling back to JSON`)
+          device.jsonOnly = true
+        }
         device.reconnecting = false
       })
     } catch (err) {
@@ -333,6 +357,35 @@ class WsBridge {
    * Handle message from ESP32 device
    */
   private handleDeviceMessage(ip: string, payload: unknown) {
+    const rxMs = this.matchClockMs()
+    const device = this.devices.get(ip)
+    const msg = payload as {
+      op?: number
+      seq_id?: number
+      snapshot?: boolean
+      from_seq_id?: number
+      ref_ms?: number
+    }
+    if (msg.op === 22) {
+      // TIME_SYNC_REPLY: its arrival time completes the round on the next TIME_SYNC
+      if (device?.timeSync && msg.ref_ms === device.timeSync.refMs) {
+        device.timeSync.rxMs = rxMs
+      }
+      return
+    }
+    if (device && msg.op === 18) {
+      // Events were lost (journal overrun or device restart): accept the replay as-is
+      if (msg.snapshot) {
+        device.lastSeqId = Math.max((msg.from_seq_id ?? 1) - 1, 0)
+      }
+    } else if (device && typeof msg.seq_id === 'number' && (msg.op === 12 || msg.op === 13 || msg.op === 14)) {
+      // Journaled events (shot/hit/respawn): drop ones already forwarded before the reconnect
+      if (device.lastSeqId !== undefined && msg.seq_id <= device.lastSeqId) {
+        return
+      }
+      device.lastSeqId = msg.seq_id
+    }
+
     const message: DeviceMessage = {
       source: ip,
       payload,
@@ -396,6 +449,33 @@ class WsBridge {
     }, HEARTBEAT_INTERVAL)
   }
 
+  private matchClockMs(): number {
+    return Math.floor(performance.now() - this.matchEpoch)
+  }
+
+  /**
+   * Keep device match clocks on ours: each TIME_SYNC carries the previous
+   * round's timestamps so the device can complete that exchange
+   */
+  private startTimeSync() {
+    this.timeSyncTimer = setInterval(() => {
+      for (const [, device] of this.devices) {
+        if (!device.connected || device.ws?.readyState !== WebSocket.OPEN) {
+          continue
+        }
+        const prev = device.timeSync
+        const refMs = this.matchClockMs()
+        const msg: Record<string, unknown> = { op: 21, type: 'time_sync', ref_ms: refMs }
+        if (prev?.rxMs !== undefined) {
+          msg.prev_ref_ms = prev.refMs
+          msg.prev_rx_ms = prev.rxMs
+        }
+        device.timeSync = { refMs }
+        device.ws.send(JSON.stringify(msg))
+      }
+    }, TIME_SYNC_INTERVAL)
+  }
+
   /**
    * Stop the server
    */
@@ -403,6 +483,9 @@ class WsBridge {
     if (this.heartbeatTimer) {
       clearInterval(this.heartbeatTimer)
     }
+    if (this.timeSyncTimer) {
+      clearInterval(this.timeSyncTimer)
+    }
 
     // Stop discovery
     if (this.discovery) {
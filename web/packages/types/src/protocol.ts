@@ -12,6 +12,8 @@ export enum OpCode {
   HIT_FORWARD = 5,
   KILL_CONFIRMED = 6,
   REMOTE_SOUND = 7,
+  RESUME = 8,
+  SUBSCRIBE = 9,
 
   // ESP32 -> Client
   STATUS = 10,
@@ -22,7 +24,12 @@ export enum OpCode {
   RELOAD_EVENT = 15,
   GAME_OVER = 16,
   GAME_STATE_UPDATE = 17,
+  RESUME_RESULT = 18,
   ACK = 20,
+
+  // Clock sync (Client -> ESP32, then ESP32 -> Client)
+  TIME_SYNC = 21,
+  TIME_SYNC_REPLY = 22,
 }
 
 // IR Protocol ID Limits (from protocol_config.h)
@@ -106,6 +113,9 @@ export interface ConfigUpdateMessage extends BaseClientMessage {
 
   // ESP-NOW Peer Management
   espnow_peers?: string // Comma-separated MAC addresses "aa:bb:cc:dd:ee:ff,11:22:33:44:55:66"
+
+  // Spectators: publish events to the UDP multicast telemetry stream
+  telemetry_mcast?: boolean
 }
 
 export interface GameCommandMessage extends BaseClientMessage {
@@ -134,6 +144,44 @@ export interface RemoteSoundMessage extends BaseClientMessage {
   sound_id: number // 0=Whistle, 1=Horn, etc.
 }
 
+/** Broadcast topics for SUBSCRIBE (bitmask) */
+export enum Topic {
+  STATUS = 1 << 0, // STATUS
+  SHOTS = 1 << 1, // SHOT_FIRED, RELOAD_EVENT
+  HITS = 1 << 2, // HIT_REPORT
+  GAME = 1 << 3, // RESPAWN, GAME_OVER, GAME_STATE_UPDATE
+  METRICS = 1 << 4, // opt-in
+  TRACES = 1 << 5, // opt-in
+}
+
+/** Subscription a client has before it sends SUBSCRIBE */
+export const DEFAULT_TOPICS = Topic.STATUS | Topic.SHOTS | Topic.HITS | Topic.GAME
+
+export interface SubscribeMessage extends BaseClientMessage {
+  op: OpCode.SUBSCRIBE
+  type: 'subscribe'
+  topics: number // Topic bitmask, replaces the current subscription
+}
+
+/**
+ * NTP-style clock sync, sent by the server (the match clock reference).
+ * Each request also carries the timing of the previous exchange so the
+ * device can compute offset = ((ref - rx) + (prev_rx - tx)) / 2.
+ */
+export interface TimeSyncMessage extends BaseClientMessage {
+  op: OpCode.TIME_SYNC
+  type: 'time_sync'
+  ref_ms: number // Server match clock when sent
+  prev_ref_ms?: number // ref_ms of the previous exchange
+  prev_rx_ms?: number // Server match clock when the previous reply arrived
+}
+
+export interface ResumeMessage extends BaseClientMessage {
+  op: OpCode.RESUME
+  type: 'resume'
+  last_seq_id: number // highest shot/hit/respawn seq_id seen, 0 = none
+}
+
 export interface DeviceFullConfig {
   // Identity
   deviceName?: string
@@ -180,6 +228,9 @@ export type ClientMessage =
   | HitForwardMessage
   | KillConfirmedMessage
   | RemoteSoundMessage
+  | ResumeMessage
+  | SubscribeMessage
+  | TimeSyncMessage
 
 // ============= Messages: ESP32 → Browser =============
 
@@ -222,6 +273,11 @@ export interface DeviceLiveState {
   remaining_time_s?: number // Only if game timer is active
 }
 
+export interface DeviceClockStatus {
+  match_ms: number // Synchronized match clock
+  stratum: number // 1 = server, n = n-1 peer hops, 15 = free-running
+}
+
 export interface DeviceStatusMessage {
   op: OpCode.STATUS
   type: 'status'
@@ -232,6 +288,7 @@ export interface DeviceStatusMessage {
   config: DeviceConfigStatus
   stats: DeviceLiveStats
   state: DeviceLiveState
+  clock?: DeviceClockStatus // v2.3 firmware with clock sync
 }
 
 export interface HeartbeatAckMessage {
@@ -244,15 +301,17 @@ export interface HeartbeatAckMessage {
 export interface ShotFiredMessage {
   op: OpCode.SHOT_FIRED
   type: 'shot_fired'
-  timestamp_ms: number
+  timestamp_ms: number // Device uptime
   seq_id: number // Sequence number for deduplication
+  match_ms?: number // Synchronized match clock, comparable across devices
 }
 
 export interface HitReportMessage {
   op: OpCode.HIT_REPORT
   type: 'hit_report'
-  timestamp_ms: number
+  timestamp_ms: number // Device uptime
   seq_id: number // Sequence number for deduplication
+  match_ms?: number // Synchronized match clock, comparable across devices
   shooter_id: number
   damage: number
   fatal: boolean // Did this hit cause death?
@@ -261,8 +320,9 @@ export interface HitReportMessage {
 export interface RespawnMessage {
   op: OpCode.RESPAWN
   type: 'respawn'
-  timestamp_ms: number
+  timestamp_ms: number // Device uptime
   seq_id: number // Sequence number for deduplication
+  match_ms?: number // Synchronized match clock, comparable across devices
   current_hearts?: number // Optional sync
 }
 
@@ -303,6 +363,27 @@ export interface AckMessage {
   type: 'ack'
   reply_to?: string // matches req_id
   success: boolean
+  error?: {
+    code: string // e.g. MESSAGE_TOO_LARGE, BUSY
+    message?: string
+  }
+}
+
+export interface ResumeResultMessage {
+  op: OpCode.RESUME_RESULT
+  type: 'resume_result'
+  from_seq_id: number // first replayed seq_id (0 if none)
+  to_seq_id: number
+  replayed: number
+  snapshot: boolean // events were lost; rely on the STATUS that follows
+}
+
+export interface TimeSyncReplyMessage {
+  op: OpCode.TIME_SYNC_REPLY
+  type: 'time_sync_reply'
+  ref_ms: number // Echo of TIME_SYNC ref_ms
+  match_ms: number // Device match clock when the reply was sent
+  stratum: number
 }
 
 export type ServerMessage =
@@ -314,6 +395,8 @@ export type ServerMessage =
   | ReloadMessage
   | GameOverMessage
   | GameStateUpdateMessage
+  | ResumeResultMessage
+  | TimeSyncReplyMessage
   | AckMessage
 
 // ============= Device State (for UI Store) =============